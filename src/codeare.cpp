@@ -19,11 +19,21 @@
  */
 
 #include "codeare.hpp"
-#include "IOContext.hpp"
+#include "AsyncIOContext.hpp"
 #include <thread>
 
 using namespace codeare::matrix::io;
 
+/**
+ * @brief  Queue read of a data-in entry. Returned handler hands the matrix
+ *         over to the connector once it is read.
+ */
+template<class T> static std::function<void()>
+prefetch (AsyncIOContext& ic, Connector& con, const TiXmlElement* entry, const std::string& name) {
+	std::shared_ptr<std::future<Matrix<T> > > f (new std::future<Matrix<T> >(ic.Read<T>(entry)));
+	return [&con, f, name] () { Matrix<T> M = f->get(); con.SetMatrix(name, M); };
+}
+
 
 int main (int argc, char** argv) {
 
@@ -51,9 +61,11 @@ int main (int argc, char** argv) {
 			printf ("*** WARNING: No input data specified to algorithm! \n");
 		} else {
 			TiXmlElement* datain_entry = datain->FirstChildElement();
-			IOContext ic (datain, base_dir, READ);
+			AsyncIOContext ic (datain, base_dir, READ);
 
             if (ic.Strategy()!=SYNGO) {
+                // All reads are queued first and run concurrently
+                std::vector<std::function<void()> > deliver;
                 while (datain_entry) {
                     
                     const std::string data_name = datain_entry->Value();
@@ -72,17 +84,13 @@ int main (int argc, char** argv) {
                     
                     // TODO: check first if entry exists and has right format
                     if        (TypeTraits<float>::Abbrev().compare(data_type) == 0)  {
-                        Matrix<float> M = ic.Read<float>(datain_entry);
-                        con.SetMatrix(data_name, M);
+                        deliver.push_back (prefetch<float>(ic, con, datain_entry, data_name));
                     } else if (TypeTraits<double>::Abbrev().compare(data_type) == 0) {
-                        Matrix<double> M = ic.Read<double>(datain_entry);
-                        con.SetMatrix(data_name, M);
+                        deliver.push_back (prefetch<double>(ic, con, datain_entry, data_name));
                     } else if (TypeTraits<cxfl>::Abbrev().compare(data_type) == 0)   {
-                        Matrix<cxfl> M = ic.Read<cxfl>(datain_entry);
-                        con.SetMatrix(data_name, M);
+                        deliver.push_back (prefetch<cxfl>(ic, con, datain_entry, data_name));
                     } else if (TypeTraits<cxdb>::Abbrev().compare(data_type) == 0)   {
-                        Matrix<cxdb> M = ic.Read<cxdb>(datain_entry);
-                        con.SetMatrix(data_name, M);
+                        deliver.push_back (prefetch<cxdb>(ic, con, datain_entry, data_name));
                     } else  {
                         printf ("*** ERROR: Couldn't load a data set specified in\n");
                         std::cout << "           Entry: " << *datain_entry << std::endl;
@@ -91,8 +99,11 @@ int main (int argc, char** argv) {
                     
                     datain_entry = datain_entry->NextSiblingElement();
                 }
+                // Modules may access their input in Init
+                for (size_t i = 0; i < deliver.size(); ++i)
+                    deliver[i]();
             } else {
-            	ic.Read();
+            	ic.Read().get(); // whole raw data file into the workspace
             }
         }
 
@@ -138,13 +149,15 @@ int main (int argc, char** argv) {
 	    }
 
 		TiXmlElement* dataout = con.GetElement("/config/data-out");
+		std::unique_ptr<AsyncIOContext> out;
+		std::vector<std::pair<std::string, std::future<bool> > > written;
 		if (!dataout)
 			printf ("*** WARNING: No output data expected from algorithm? \n");
 
 		else {
 
 			TiXmlElement* dataout_entry = dataout->FirstChildElement();
-			IOContext out = IOContext (dataout, base_dir, WRITE);
+			out.reset (new AsyncIOContext (dataout, base_dir, WRITE));
 
 			while (dataout_entry) {
 				const std::string data_name = dataout_entry->Value();
@@ -157,19 +170,19 @@ int main (int argc, char** argv) {
 				if        (TypeTraits<float>::Abbrev().compare(data_type) == 0)  {
 					Matrix<float> M;
 					if ((ec = con.GetMatrix(data_name, M)) == codeare::OK)
-						out.Write(M, dataout_entry);
+						written.push_back (std::make_pair (data_name, out->Write(std::move(M), dataout_entry)));
 				} else if (TypeTraits<double>::Abbrev().compare(data_type) == 0) {
 					Matrix<double> M;
 					if ((ec = con.GetMatrix(data_name, M)) == codeare::OK)
-						out.Write(M, dataout_entry);
+						written.push_back (std::make_pair (data_name, out->Write(std::move(M), dataout_entry)));
 				} else if (TypeTraits<cxfl>::Abbrev().compare(data_type) == 0)   {
 					Matrix<cxfl> M;
 					if ((ec = con.GetMatrix(data_name, M)) == codeare::OK)
-						out.Write(M, dataout_entry);
+						written.push_back (std::make_pair (data_name, out->Write(std::move(M), dataout_entry)));
 				} else if (TypeTraits<cxdb>::Abbrev().compare(data_type) == 0)   {
 					Matrix<cxdb> M;
 					if ((ec = con.GetMatrix(data_name, M)) == codeare::OK)
-						out.Write(M, dataout_entry);
+						written.push_back (std::make_pair (data_name, out->Write(std::move(M), dataout_entry)));
 				}
 
 				if (ec == codeare::NO_MATRIX_IN_WORKSPACE_BY_NAME) {
@@ -184,9 +197,25 @@ int main (int argc, char** argv) {
 			}
 		}
 		
+		// Queued writes are flushed while modules are finalised
 	    con.Finalise();
+	    error = 0;
+	    for (size_t i = 0; i < written.size(); ++i) {
+	    	bool ok = false;
+	    	try {
+	    		ok = written[i].second.get();
+	    	} catch (const std::exception& e) {
+	    		printf ("*** ERROR: %s\n", e.what());
+	    	} catch (...) {}
+	    	if (!ok) {
+	    		printf ("*** ERROR: Writing \"%s\" failed\n", written[i].first.c_str());
+	    		error = (int) codeare::FILE_WRITE_FAILED;
+	    	}
+	    }
+	    out.reset();
 
-        error = 0;
+	    if (atoi(debug) > 0)
+	    	AllocatorStats::Instance().Report();
 
 	} 
 		
@@ -0,0 +1,234 @@
+/*
+ *  codeare Copyright (C) 2010-2016
+ *                        Kaveh Vahedipour
+ *                        NYU School of Medicine, New York, USA
+ *
+ *  This program is free software; you can redistribute it and/or modify
+ *  it under the terms of the GNU General Public License as published by
+ *  the Free Software Foundation; either version 2 of the License, or
+ *  (at your option) any later version.
+ *
+ *  This program is distributed in the hope that it will be useful, but
+ *  WITHOUT ANY WARRANTY; without even the implied warranty of
+ *  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU
+ *  General Public License for more details.
+ *
+ *  You should have received a copy of the GNU General Public License
+ *  along with this program; if not, write to the Free Software
+ *  Foundation, Inc., 51 Franklin Street, Fifth Floor, Boston, MA
+ *  02110-1301  USA
+ */
+
+#ifndef __OPERATOR_CACHE_HPP__
+#define __OPERATOR_CACHE_HPP__
+
+#include "Matrix.hpp"
+#include "Algos.hpp"
+
+#include <cstdlib>
+#include <cstring>
+#include <iostream>
+#include <list>
+#include <map>
+#include <memory>
+#include <mutex>
+#include <stdint.h>
+#include <string>
+#include <typeinfo>
+#include <vector>
+
+/**
+ * @brief   64 bit key of everything an operator's set up depends on, e.g.
+ *          trajectory, weights, image size, oversampling and kernel
+ *          parameters. Matrices contribute their fingerprint() (dimensions
+ *          and data), scalars and strings their bytes, all folded in order
+ *          with the same FNV-1a.
+ *
+ * @code
+ *   OperatorHash h;
+ *   h << size(sens) << m_m << m_alpha << Get<float>("kspace") << Get<float>("weights");
+ *   uint64_t key = h.Value();
+ * @endcode
+ */
+class OperatorHash {
+
+public:
+
+	OperatorHash () : m_h (0xcbf29ce484222325ULL) {}
+
+	/**
+	 * @brief      Add n bytes
+	 */
+	inline OperatorHash& Add (const void* p, const size_t n) {
+		const unsigned char* c = (const unsigned char*) p;
+		for (size_t i = 0; i < n; ++i)
+			m_h = (m_h ^ c[i]) * 0x100000001b3ULL;
+		return *this;
+	}
+
+	template<class T> inline OperatorHash& operator<< (const T& t) {
+		return Add (&t, sizeof(T));
+	}
+	inline OperatorHash& operator<< (const std::string& s) {
+		*this << s.size();
+		return Add (s.c_str(), s.size());
+	}
+	template<class T> inline OperatorHash& operator<< (const Vector<T>& v) {
+		*this << v.size();
+		return Add (v.size() ? v.ptr() : 0, v.size()*sizeof(T));
+	}
+	template<class T> inline OperatorHash& operator<< (const Matrix<T>& m) {
+		return *this << fingerprint (m);
+	}
+
+	/**
+	 * @brief      Hash value
+	 */
+	inline uint64_t Value () const {
+		return m_h;
+	}
+
+private:
+
+	uint64_t m_h;
+
+};
+
+
+/**
+ * @brief   Process-wide cache of set up operators (NFFT plans, NCSENSE,
+ *          DFT, CSENSE ...) across jobs, LRU evicted under a memory cap.<br/>
+ *
+ *          Entries are keyed by operator type and an OperatorHash. Take()
+ *          hands an operator out exclusively, i.e. removes it from the cache,
+ *          and Put() returns it when the job is done. Concurrent jobs thus
+ *          never share an operator's mutable buffers.<br/>
+ *
+ *          The cap is initialised from the environment:
+ *          CODEARE_OPERATOR_CACHE=bytes (default 2GB, 0 disables caching).
+ *          Operators are owned by the Workspace singleton, i.e. they outlive
+ *          the modules that made them; modules are therefore kept mapped on
+ *          unload (see Loader).
+ */
+class OperatorCache {
+
+	typedef std::pair<std::string, uint64_t> Key;
+
+	struct Entry {
+		Key                   key;
+		std::shared_ptr<void> op;
+		size_t                bytes;
+	};
+
+	typedef std::list<Entry> LRU;
+
+public:
+
+	OperatorCache () : m_capacity ((size_t)2 << 30), m_bytes(0), m_hits(0), m_misses(0) {
+		const char* env;
+		if ((env = getenv("CODEARE_OPERATOR_CACHE")))
+			m_capacity = strtoull(env, 0, 10);
+	}
+
+	/**
+	 * @brief      Take operator out of the cache
+	 *
+	 * @param  h   Hash of its set up
+	 * @return     Operator or empty if not cached
+	 */
+	template<class O> inline std::shared_ptr<O> Take (const uint64_t h) {
+		std::lock_guard<std::mutex> lock (m_mutex);
+		std::map<Key, LRU::iterator>::iterator it = m_index.find (Key(typeid(O).name(), h));
+		if (it == m_index.end()) {
+			++m_misses;
+			return std::shared_ptr<O>();
+		}
+		std::shared_ptr<O> op = std::static_pointer_cast<O> (it->second->op);
+		m_bytes -= it->second->bytes;
+		m_lru.erase (it->second);
+		m_index.erase (it);
+		++m_hits;
+		return op;
+	}
+
+	/**
+	 * @brief      Put operator (back) into the cache as most recently used.
+	 *             Least recently used ones are evicted beyond the cap.
+	 *
+	 * @param  h   Hash of its set up
+	 * @param  op  Operator
+	 * @param  b   Approximate memory footprint in bytes
+	 */
+	template<class O> inline void Put (const uint64_t h, const std::shared_ptr<O>& op, const size_t b) {
+		std::vector<std::shared_ptr<void> > evicted; // destroyed outside the lock
+		std::lock_guard<std::mutex> lock (m_mutex);
+		const Key key (typeid(O).name(), h);
+		Erase (key, evicted);
+		if (!op || b > m_capacity)
+			return;
+		while (m_bytes + b > m_capacity)
+			Erase (m_lru.back().key, evicted);
+		Entry e = {key, std::static_pointer_cast<void>(op), b};
+		m_lru.push_front (e);
+		m_index[key] = m_lru.begin();
+		m_bytes += b;
+	}
+
+	/**
+	 * @brief      Drop all operators
+	 */
+	inline void Clear () {
+		LRU lru;
+		std::lock_guard<std::mutex> lock (m_mutex);
+		m_index.clear();
+		m_lru.swap (lru);
+		m_bytes = 0;
+	}
+
+	/**
+	 * @brief      Set memory cap (bytes) and evict accordingly
+	 */
+	inline void Capacity (const size_t c) {
+		std::vector<std::shared_ptr<void> > evicted;
+		std::lock_guard<std::mutex> lock (m_mutex);
+		m_capacity = c;
+		while (m_bytes > m_capacity)
+			Erase (m_lru.back().key, evicted);
+	}
+
+	inline size_t Capacity () const { return m_capacity; }
+	inline size_t Bytes    () const { return m_bytes; }
+	inline size_t Entries  () const { return m_lru.size(); }
+	inline size_t Hits     () const { return m_hits; }
+	inline size_t Misses   () const { return m_misses; }
+
+	/**
+	 * @brief      Print usage
+	 */
+	inline void Print (std::ostream& os) const {
+		os << "      Operators: " << Entries() << " cached, " << (Bytes() >> 20) << " of "
+		   << (Capacity() >> 20) << " MB, " << Hits() << " hits, " << Misses() << " misses\n";
+	}
+
+private:
+
+	inline void Erase (const Key& key, std::vector<std::shared_ptr<void> >& evicted) {
+		std::map<Key, LRU::iterator>::iterator it = m_index.find (key);
+		if (it == m_index.end())
+			return;
+		evicted.push_back (it->second->op);
+		m_bytes -= it->second->bytes;
+		m_lru.erase (it->second);
+		m_index.erase (it);
+	}
+
+	LRU                          m_lru;      /**< @brief Most recently used first */
+	std::map<Key, LRU::iterator> m_index;    /**< @brief Lookup */
+	size_t                       m_capacity; /**< @brief Memory cap (bytes) */
+	size_t                       m_bytes;    /**< @brief Cached (bytes) */
+	size_t                       m_hits, m_misses;
+	std::mutex                   m_mutex;
+
+};
+
+#endif /* __OPERATOR_CACHE_HPP__ */
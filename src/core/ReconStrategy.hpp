@@ -132,6 +132,16 @@ namespace RRStrategy {
 		}
 
 
+		/**
+		 * @brief       Process-wide operator cache
+		 *              @see OperatorCache
+		 */
+		OperatorCache&
+		Operators       () const {
+			return global->Operators();
+		}
+
+
 		/**
 		 * @brief       Add a matrix to database map
 		 *
@@ -5,7 +5,7 @@
 
 Workspace* Workspace::m_inst = 0; 
 
-Workspace::Workspace () {}
+Workspace::Workspace () : m_ops (std::make_shared<OperatorCache>()) {}
 
 Workspace::~Workspace () { 
 	Finalise();
@@ -58,6 +58,7 @@ void Workspace::Print (std::ostream& os) const {
 #endif
 	    os << std::endl;
 	}
+    m_ops->Print(os);
     os << "      Parameters:\n" ;
     os << "    -----------------------\n";
     os << p;
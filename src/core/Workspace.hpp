@@ -5,6 +5,7 @@
 #include "Matrix.hpp"
 #include "Configurable.hpp"
 #include "Params.hpp"
+#include "OperatorCache.hpp"
 
 #include <boost/any.hpp>
 #ifdef HAVE_CXX11_SHARED_PTR
@@ -282,6 +283,17 @@ class DLLEXPORT Workspace {
     }
     
 
+    /**
+     * @brief        Process-wide cache of set up operators
+     *
+     * @return       Operator cache
+     */
+    inline OperatorCache&
+    Operators       () const {
+        return *m_ops;
+    }
+
+
     /**
      * @brief        Get string representation of mapping
      *
@@ -356,6 +368,7 @@ class DLLEXPORT Workspace {
 #pragma warning (disable : 4251)
     reflist m_ref;   /**< @brief Names and hash tags               */
 	store   m_store; /**< @brief Data pointers                     */
+	std::shared_ptr<OperatorCache> m_ops; /**< @brief Operators, shared by copies */
 #pragma warning (default : 4251)
 
 	static Workspace* m_inst; /**< @brief Single database instance */
@@ -87,6 +87,42 @@ template<class T, class S> inline unsigned short issame (const Matrix<T>& A, con
 }
 
 
+/**
+ * @brief     64 bit fingerprint of dimensions and content
+ *
+ *            FNV-1a over 64kB blocks hashed in parallel and combined in order,
+ *            i.e. independent of the number of threads.
+ *
+ * Usage:
+ * @code
+ *   Matrix<cxfl> sens = ...;
+ *   uint64_t key = fingerprint (sens);
+ * @endcode
+ *
+ * @param M   Matrix
+ * @return    Fingerprint
+ */
+template <class T> inline static uint64_t fingerprint (const Matrix<T>& M) {
+	const uint64_t prime = 0x100000001b3ULL, basis = 0xcbf29ce484222325ULL;
+	const size_t bs = 65536, n = M.Size()*sizeof(T), nb = (n + bs - 1) / bs;
+	const unsigned char* p = (const unsigned char*) M.Ptr();
+	std::vector<uint64_t> bh (nb);
+#pragma omp parallel for schedule (static)
+	for (long b = 0; b < (long)nb; ++b) {
+		uint64_t h = basis;
+		for (size_t i = b*bs; i < std::min (n, (b+1)*bs); ++i)
+			h = (h ^ p[i]) * prime;
+		bh[b] = h;
+	}
+	uint64_t h = basis;
+	for (size_t d = 0; d < M.NDim(); ++d)
+		h = (h ^ M.Dim(d)) * prime;
+	for (size_t b = 0; b < nb; ++b)
+		h = (h ^ bh[b]) * prime;
+	return h;
+}
+
+
 /**
  * @brief     Is matrix X-dimensional?
  *
@@ -525,7 +561,7 @@ template<class T> inline static Matrix<T> max (const Matrix<T>& M, const size_t&
 	dims[dim] = 1;
 	Matrix<T> ret(dims);
 	for (size_t i = 0; i < n; ++i)
-		ret[i] = *std::max_element(M.Begin()+i*m,M.Begin()+(i+1)*m);
+		ret[i] = codeare::matrix::simd::max(M.Ptr()+i*m, m);
 	return ret;
 }
 template<class T> inline static Matrix<T> max (const View<T,true>& M, const size_t& dim = 0) {
@@ -540,7 +576,7 @@ template<class T> inline static Matrix<T> max (const View<T,true>& M, const size
 	return ret;
 }
 template<class T> inline static T mmax (const Matrix<T>& M) {
-	return *std::max_element(M.Begin(), M.End());
+	return codeare::matrix::simd::max(M.Ptr(), numel(M));
 }
 template <class T> inline static T mmax (const View<T, true>& V) {
 	T mx = -1e20;
@@ -566,7 +602,7 @@ template<class T> inline static Matrix<T> min (const Matrix<T>& M, const size_t&
 	dims[dim] = 1;
 	Matrix<T> ret(dims);
 	for (size_t i = 0; i < n; ++i)
-		ret[i] = *std::min_element(M.Begin()+i*m,M.Begin()+(i+1)*m);
+		ret[i] = codeare::matrix::simd::min(M.Ptr()+i*m, m);
 	return ret;
 }
 template<class T> inline static Matrix<T> min (const View<T,true>& M, const size_t& dim = 0) {
@@ -581,7 +617,7 @@ template<class T> inline static Matrix<T> min (const View<T,true>& M, const size
 	return ret;
 }
 template<class T> inline static T mmin (const Matrix<T>& M) {
-	return *std::min_element(M.Begin(), M.End());
+	return codeare::matrix::simd::min(M.Ptr(), numel(M));
 }
 template <class T> inline static T mmin (const View<T, true>& V) {
 	T mx = 1e-20;
@@ -4,21 +4,209 @@
 #include <limits>
 #include <exception>
 #include <cstddef>
+#include <cstdlib>
+#include <cstring>
 #include <new>
 #include <complex>
+#include <atomic>
+#include <iostream>
+#include <stdint.h>
 #include <xmmintrin.h>
 
+#include "Topology.hpp"
+
+#if !defined(_MSC_VER)
+#  include <sys/mman.h>
+#  include <unistd.h>
+#  define HAVE_TIERED_ALLOCATION
+#endif
+
+/**
+ * @brief   Runtime allocation policy.<br/>
+ *
+ *          ALIGNED: every buffer from _mm_malloc with the container's alignment.
+ *          TIERED (default): buffers of at least page_threshold bytes (64MB) are
+ *          mapped page aligned. Short lived temporaries below stay with
+ *          _mm_malloc, i.e. they cost no system call and page faults. Buffers
+ *          allocated within a LargeBuffers scope opt in to mapping from one
+ *          page, i.e. they can be filled by O_DIRECT reads, and from
+ *          huge_threshold bytes are 2MB aligned and advised for transparent
+ *          huge pages, or taken from hugetlbfs if hugetlb is set. Mapped buffers
+ *          are first touched in parallel, which places their pages on the NUMA
+ *          nodes of the OpenMP threads that later work on them, or interleaved
+ *          over all nodes (see Topology).
+ *
+ *          Initialised from the environment on first use:
+ *          CODEARE_ALLOC=aligned|tiered, CODEARE_ALLOC_PAGE=bytes,
+ *          CODEARE_ALLOC_HUGE=bytes, CODEARE_HUGETLB=0|1, CODEARE_FIRST_TOUCH=0|1,
+ *          CODEARE_NUMA=interleave
+ */
+struct AllocatorPolicy {
+
+    enum Mode {ALIGNED = 0, TIERED};
+
+    Mode   mode;           /**< @brief Allocation mode */
+    size_t page_threshold; /**< @brief Page aligned from here (bytes) */
+    size_t huge_threshold; /**< @brief Huge pages from here (bytes) */
+    bool   hugetlb;        /**< @brief Explicit hugetlbfs pages instead of THP */
+    bool   first_touch;    /**< @brief Parallel first touch of mapped buffers */
+    bool   interleave;     /**< @brief Interleave mapped buffers over NUMA nodes */
+
+    static AllocatorPolicy& Instance () {
+        static AllocatorPolicy policy;
+        return policy;
+    }
+
+private:
+
+    AllocatorPolicy () : mode(TIERED), page_threshold(64<<20), huge_threshold(32<<20),
+                         hugetlb(false), first_touch(true), interleave(false) {
+        const char* env;
+        if ((env = getenv("CODEARE_ALLOC")))
+            mode = (strcmp(env, "aligned") == 0) ? ALIGNED : TIERED;
+        if ((env = getenv("CODEARE_ALLOC_PAGE")))
+            page_threshold = strtoull(env, 0, 10);
+        if ((env = getenv("CODEARE_ALLOC_HUGE")))
+            huge_threshold = strtoull(env, 0, 10);
+        if ((env = getenv("CODEARE_HUGETLB")))
+            hugetlb = (atoi(env) != 0);
+        if ((env = getenv("CODEARE_FIRST_TOUCH")))
+            first_touch = (atoi(env) != 0);
+        if ((env = getenv("CODEARE_NUMA")))
+            interleave = (strcmp(env, "interleave") == 0);
+    }
+
+};
+
+/**
+ * @brief   Opt in to mapped, huge page backed buffers for allocations of the
+ *          calling thread while in scope, e.g. large, long lived data read from
+ *          file (see AllocatorPolicy).
+ *
+ * @code
+ *   {
+ *       LargeBuffers large;
+ *       M = Matrix<T>(dims);
+ *   }
+ * @endcode
+ */
+class LargeBuffers {
+
+public:
+
+    LargeBuffers () { ++Depth(); }
+    ~LargeBuffers () { --Depth(); }
+
+    static bool Active () { return Depth() > 0; }
+
+private:
+
+    LargeBuffers (const LargeBuffers&);
+    LargeBuffers& operator= (const LargeBuffers&);
+
+    static int& Depth () {
+        static thread_local int depth = 0;
+        return depth;
+    }
+
+};
+
+/**
+ * @brief   Allocation statistics per tier
+ */
+struct AllocatorStats {
+
+    enum Tier {SMALL = 0, PAGED, HUGE_PAGED, NTIERS};
+
+    std::atomic<size_t> allocations[NTIERS]; /**< @brief Total # allocations */
+    std::atomic<size_t> live[NTIERS];        /**< @brief # live buffers */
+    std::atomic<size_t> bytes[NTIERS];       /**< @brief Live bytes */
+    std::atomic<size_t> peak[NTIERS];        /**< @brief Peak live bytes */
+
+    static AllocatorStats& Instance () {
+        static AllocatorStats stats;
+        return stats;
+    }
+
+    inline void Allocated (const int tier, const size_t n) {
+        ++allocations[tier];
+        ++live[tier];
+        size_t now = (bytes[tier] += n), p = peak[tier];
+        while (now > p && !peak[tier].compare_exchange_weak(p, now));
+    }
+
+    inline void Deallocated (const int tier, const size_t n) {
+        --live[tier];
+        bytes[tier] -= n;
+    }
+
+    /**
+     * @brief  Print statistics
+     */
+    void Report (std::ostream& os = std::cout) const {
+        static const char* names[NTIERS] = {"small", "paged", "huge"};
+        os << "Allocations (tier: total / live / live MB / peak MB)" << std::endl;
+        for (size_t t = 0; t < NTIERS; ++t)
+            os << "  " << names[t] << ": " << allocations[t] << " / " << live[t] << " / "
+               << bytes[t]/1048576.0 << " / " << peak[t]/1048576.0 << std::endl;
+    }
+
+private:
+
+    AllocatorStats () {
+        for (size_t t = 0; t < NTIERS; ++t)
+            allocations[t] = live[t] = bytes[t] = peak[t] = 0;
+    }
+
+};
+
+/**
+ * @brief   Book keeping in front of every aligned buffer
+ */
+struct AllocationHeader {
+    uint32_t tier;   /**< @brief AllocatorStats::Tier */
+    uint32_t offset; /**< @brief Distance of buffer from start of allocation */
+    uint64_t length; /**< @brief Length of allocation */
+};
+
+static const size_t alloc_page = 4096;
+static const size_t alloc_huge_page = 2 << 20;
+
+inline static size_t alloc_round_up (const size_t n, const size_t a) {
+    return (n + a - 1) / a * a;
+}
+
 template<size_t alignment>
 struct static_allocator {
 
+    static const size_t header = (alignment < sizeof(AllocationHeader)) ?
+        sizeof(AllocationHeader) : alignment;
+
     static void* allocate(size_t n) {
 
         if(n == 0)
             return 0;
 
-        if(n > max_size())
+        if(n > max_size() - alloc_huge_page * 2)
             throw std::bad_alloc();
-        void* ret =
+
+        const AllocatorPolicy& policy = AllocatorPolicy::Instance();
+        char* ret = 0;
+
+#ifdef HAVE_TIERED_ALLOCATION
+        if (policy.mode == AllocatorPolicy::TIERED) {
+            const bool large = LargeBuffers::Active();
+            if (large && n >= policy.huge_threshold)
+                ret = map (n, true, policy);
+            else if (n >= (large ? alloc_page : policy.page_threshold))
+                ret = map (n, false, policy);
+            if (ret)
+                return ret;
+        }
+#endif
+
+        const size_t len = n + header;
+        char* raw = (char*)
 #if defined(__GNUC__) || defined (__INTEL_COMPILER)
             _mm_malloc
 #elif defined (_MSC_VER)
@@ -26,17 +214,37 @@ struct static_allocator {
 #else
             _malloc
 #endif
-            (n,alignment);
+            (len,alignment);
 
-        if(!ret)
+        if(!raw)
             throw std::bad_alloc();
 
+        ret = raw + header;
+        AllocationHeader h = {AllocatorStats::SMALL, (uint32_t)header, len};
+        memcpy (ret - sizeof(h), &h, sizeof(h));
+        AllocatorStats::Instance().Allocated (AllocatorStats::SMALL, len);
+
         return ret;
 
     }
 
     static void deallocate (void* p) {
 
+        if (!p)
+            return;
+
+        AllocationHeader h;
+        memcpy (&h, (char*)p - sizeof(h), sizeof(h));
+        char* raw = (char*)p - h.offset;
+        AllocatorStats::Instance().Deallocated (h.tier, h.length);
+
+#ifdef HAVE_TIERED_ALLOCATION
+        if (h.tier != AllocatorStats::SMALL) {
+            munmap (raw, h.length);
+            return;
+        }
+#endif
+
 #if defined(__GNUC__) || defined (__INTEL_COMPILER) 
         _mm_free
 #elif defined (_MSC_VER)
@@ -44,7 +252,7 @@ struct static_allocator {
 #else
         _free
 #endif
-        (p);
+        (raw);
 
     }
 
@@ -53,6 +261,72 @@ struct static_allocator {
         return std::numeric_limits<size_t>::max();
     }
 
+private:
+
+#ifdef HAVE_TIERED_ALLOCATION
+    /**
+     * @brief  Map page (or 2MB) aligned buffer preceded by one page for the header.
+     *         Returns NULL if the mapping fails, i.e. falls back to _mm_malloc.
+     */
+    static char* map (const size_t n, const bool huge, const AllocatorPolicy& policy) {
+
+        const size_t align = huge ? alloc_huge_page : alloc_page;
+        char* base = 0;
+        char* ret  = 0;
+        size_t len = 0;
+
+#ifdef MAP_HUGETLB
+        if (huge && policy.hugetlb) {
+            // hugetlbfs mappings are huge page granular, header takes the first one
+            len  = alloc_round_up (n, alloc_huge_page) + alloc_huge_page;
+            base = (char*) mmap (0, len, PROT_READ|PROT_WRITE, MAP_PRIVATE|MAP_ANONYMOUS|MAP_HUGETLB, -1, 0);
+            if (base == MAP_FAILED)
+                base = 0;
+            else
+                ret = base + alloc_huge_page;
+        }
+#endif
+
+        if (!base) {
+            const size_t maplen = alloc_round_up (n, alloc_page) + alloc_page + align;
+            base = (char*) mmap (0, maplen, PROT_READ|PROT_WRITE, MAP_PRIVATE|MAP_ANONYMOUS, -1, 0);
+            if (base == MAP_FAILED)
+                return 0;
+            ret = (char*) alloc_round_up ((size_t)base + alloc_page, align);
+            // Trim to [header page, end of buffer]
+            char* begin = ret - alloc_page, * end = ret + alloc_round_up (n, alloc_page);
+            if (begin > base)
+                munmap (base, begin - base);
+            if (base + maplen > end)
+                munmap (end, base + maplen - end);
+            base = begin;
+            len  = end - begin;
+#ifdef MADV_HUGEPAGE
+            if (huge)
+                madvise (ret, end - ret, MADV_HUGEPAGE);
+#endif
+        }
+
+        if (policy.interleave)
+            Topology::Instance().Interleave (ret, alloc_round_up (n, alloc_page));
+
+        if (policy.first_touch) {
+            const long npages = (long)(alloc_round_up (n, alloc_page) / alloc_page);
+#pragma omp parallel for schedule (static)
+            for (long i = 0; i < npages; ++i)
+                ret[i*alloc_page] = 0;
+        }
+
+        AllocationHeader h = {(uint32_t)(huge ? AllocatorStats::HUGE_PAGED : AllocatorStats::PAGED),
+                              (uint32_t)(ret - base), len};
+        memcpy (ret - sizeof(h), &h, sizeof(h));
+        AllocatorStats::Instance().Allocated (h.tier, len);
+
+        return ret;
+
+    }
+#endif
+
 };
 
 /// allocate and de-allocate unaligned memory
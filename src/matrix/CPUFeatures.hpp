@@ -0,0 +1,138 @@
+/*
+ *  codeare Copyright (C) 2010-2016
+ *                        Kaveh Vahedipour
+ *                        NYU School of Medicine, New York, USA
+ *
+ *  This program is free software; you can redistribute it and/or modify
+ *  it under the terms of the GNU General Public License as published by
+ *  the Free Software Foundation; either version 2 of the License, or
+ *  (at your option) any later version.
+ *
+ *  This program is distributed in the hope that it will be useful, but
+ *  WITHOUT ANY WARRANTY; without even the implied warranty of
+ *  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU
+ *  General Public License for more details.
+ *
+ *  You should have received a copy of the GNU General Public License
+ *  along with this program; if not, write to the Free Software
+ *  Foundation, Inc., 51 Franklin Street, Fifth Floor, Boston, MA
+ *  02110-1301  USA
+ */
+
+#ifndef __CPU_FEATURES_HPP__
+#define __CPU_FEATURES_HPP__
+
+#include <cstdlib>
+#include <cstring>
+#include <iostream>
+
+namespace codeare {
+namespace matrix {
+
+/**
+ * @brief   Instruction sets with kernel variants
+ */
+enum ISA {ISA_SSE2, ISA_AVX2, ISA_AVX512};
+
+#if defined(__GNUC__) && (defined(__x86_64__) || defined(__i386__)) && !defined(__INTEL_COMPILER)
+#  define CODEARE_MULTIVERSION 1
+#  define CODEARE_AVX2   __attribute__((target("avx2,fma")))
+#  define CODEARE_AVX512 __attribute__((target("avx2,fma,avx512f,avx512dq,avx512vl")))
+#  define CODEARE_INLINE inline __attribute__((always_inline))
+#else
+#  define CODEARE_MULTIVERSION 0
+#  define CODEARE_AVX2
+#  define CODEARE_AVX512
+#  define CODEARE_INLINE inline
+#endif
+
+/**
+ * @brief   Instruction set used by multiversioned kernels.<br/>
+ *
+ *          Detected once via cpuid on first use: AVX-512 (F, DQ, VL), AVX2
+ *          with FMA, or SSE2. CODEARE_ISA=sse2|avx2|avx512 selects a lower
+ *          one, e.g. for benchmarking; requests beyond the CPU's capabilities
+ *          are ignored with a warning.
+ */
+struct CPUFeatures {
+
+    ISA detected; /**< @brief Widest supported */
+    ISA isa;      /**< @brief In use */
+
+    static CPUFeatures& Instance () {
+        static CPUFeatures features;
+        return features;
+    }
+
+    static const char* Name (const ISA i) {
+        static const char* names[3] = {"sse2", "avx2", "avx512"};
+        return names[i];
+    }
+
+private:
+
+    CPUFeatures () : detected(Detect()), isa(detected) {
+        const char* env = getenv("CODEARE_ISA");
+        if (!env)
+            return;
+        for (int i = ISA_SSE2; i <= ISA_AVX512; ++i)
+            if (strcmp (env, Name((ISA)i)) == 0) {
+                if (i > detected)
+                    std::cerr << "CODEARE_ISA=" << env << " not supported by this CPU, using "
+                              << Name(detected) << std::endl;
+                else
+                    isa = (ISA)i;
+                return;
+            }
+        std::cerr << "CODEARE_ISA=" << env << " unknown, using " << Name(detected) << std::endl;
+    }
+
+    static ISA Detect () {
+#if CODEARE_MULTIVERSION
+        __builtin_cpu_init ();
+        if (__builtin_cpu_supports ("avx512f") && __builtin_cpu_supports ("avx512dq") &&
+            __builtin_cpu_supports ("avx512vl"))
+            return ISA_AVX512;
+        if (__builtin_cpu_supports ("avx2") && __builtin_cpu_supports ("fma"))
+            return ISA_AVX2;
+#endif
+        return ISA_SSE2;
+    }
+
+};
+
+/**
+ * @brief   Instruction set in use
+ */
+inline static ISA isa () {
+    static const ISA i = CPUFeatures::Instance().isa;
+    return i;
+}
+
+}}
+
+
+/**
+ * @brief   Instantiate name##_k (inlined) for each instruction set as
+ *          name##_avx512, name##_avx2 and name##_sse2, and dispatch to one of
+ *          them in name##_isa.
+ */
+#if CODEARE_MULTIVERSION
+#define CODEARE_DISPATCH(name, params, args)                              \
+	CODEARE_AVX512 inline static void name##_avx512 params { name##_k args; } \
+	CODEARE_AVX2   inline static void name##_avx2   params { name##_k args; } \
+	inline static void name##_sse2 params { name##_k args; }              \
+	inline static void name##_isa params {                                \
+		switch (codeare::matrix::isa ()) {                                \
+		case codeare::matrix::ISA_AVX512: name##_avx512 args; break;      \
+		case codeare::matrix::ISA_AVX2:   name##_avx2   args; break;      \
+		default:                          name##_sse2   args; break;      \
+		}                                                                 \
+	}
+#else
+#define CODEARE_DISPATCH(name, params, args)                              \
+	inline static void name##_sse2 params { name##_k args; }              \
+	inline static void name##_isa params { name##_k args; }
+#endif
+
+#endif /* __CPU_FEATURES_HPP__ */
@@ -25,6 +25,7 @@
 #include "Complex.hpp"
 #include "Creators.hpp"
 #include "Algos.hpp"
+#include "VecMath.hpp"
 //#include "Trigonometry.hpp"
 //#include "Print.hpp"
 
@@ -57,6 +58,61 @@ arg (const Matrix<T>& m) {
 		res[i] = TypeTraits<T>::Arg(m[i]);
 	return res;
 }
+
+
+/**
+ * @brief    Absolute values and arguments of complex data in one sweep
+ *           (vectorised, @see codeare::matrix::vmath)
+ *
+ * @param  m Input
+ * @param  r Absolute values (resized if necessary)
+ * @param  p Arguments (resized if necessary)
+ * @param  a Accuracy
+ */
+template<class T> inline static void
+absarg (const Matrix<std::complex<T> >& m, Matrix<T>& r, Matrix<T>& p,
+		const codeare::matrix::vmath::Accuracy a = codeare::matrix::vmath::ACCURATE) {
+	if (numel(r) != numel(m))
+		r = Matrix<T> (size(m));
+	if (numel(p) != numel(m))
+		p = Matrix<T> (size(m));
+	if (numel(m))
+		codeare::matrix::vmath::absarg (m.Ptr(), r.Ptr(), p.Ptr(), numel(m), a);
+}
+
+
+/**
+ * @brief    Absolute values of complex data (vectorised)
+ *
+ * @param  m Input
+ * @param  a Accuracy
+ * @return   Absolute values
+ */
+template<class T> inline static Matrix<T>
+abs (const Matrix<std::complex<T> >& m,
+	 const codeare::matrix::vmath::Accuracy a = codeare::matrix::vmath::ACCURATE) {
+	Matrix<T> res (size(m));
+	if (numel(m))
+		codeare::matrix::vmath::abs (m.Ptr(), res.Ptr(), numel(m), a);
+	return res;
+}
+
+
+/**
+ * @brief    Arguments of complex data (vectorised)
+ *
+ * @param  m Input
+ * @param  a Accuracy
+ * @return   Arguments
+ */
+template<class T> inline static Matrix<T>
+arg (const Matrix<std::complex<T> >& m,
+	 const codeare::matrix::vmath::Accuracy a = codeare::matrix::vmath::ACCURATE) {
+	Matrix<T> res (size(m));
+	if (numel(m))
+		codeare::matrix::vmath::arg (m.Ptr(), res.Ptr(), numel(m), a);
+	return res;
+}
  
 
 /**
@@ -122,16 +178,49 @@ complex2 (const Matrix<T>& mag, const Matrix<S>& arg) {
     assert (numel(mag) == numel(arg));
     Matrix<std::complex<T> > ret (size(arg));
     for (size_t i = 0; i < numel(arg); ++i)
-        ret[i] = std::polar(mag[i],arg[i]);
+        ret[i] = std::polar(mag[i],(T)arg[i]);
     return ret;
 }
 template <class T, class S> inline static Matrix<std::complex<T> > 
 complex2 (const T mag, const Matrix<S>& arg) {
     Matrix<std::complex<T> > ret (size(arg));
     for (size_t i = 0; i < numel(arg); ++i)
-        ret[i] = std::polar(mag[i],arg[i]);
+        ret[i] = std::polar(mag,(T)arg[i]);
+    return ret;
+}
+
+/**
+ * @brief    mag * exp (i arg), fused sin/cos (vectorised, @see codeare::matrix::vmath)
+ */
+template <class T> inline static Matrix<std::complex<T> > 
+complex2 (const Matrix<T>& mag, const Matrix<T>& arg,
+          const codeare::matrix::vmath::Accuracy a = codeare::matrix::vmath::ACCURATE) {
+    assert (numel(mag) == numel(arg));
+    Matrix<std::complex<T> > ret (size(arg));
+    if (numel(arg))
+        codeare::matrix::vmath::polar (mag.Ptr(), arg.Ptr(), ret.Ptr(), numel(arg), a);
     return ret;
 }
+template <class T> inline static Matrix<std::complex<T> > 
+complex2 (const T mag, const Matrix<T>& arg,
+          const codeare::matrix::vmath::Accuracy a = codeare::matrix::vmath::ACCURATE) {
+    Matrix<std::complex<T> > ret (size(arg));
+    if (numel(arg))
+        codeare::matrix::vmath::polar (mag, arg.Ptr(), ret.Ptr(), numel(arg), a);
+    return ret;
+}
+
+/**
+ * @brief    exp (i phi), fused sin/cos (vectorised)
+ *
+ * @param  phi Phases
+ * @param  a   Accuracy
+ * @return     Unit phasors
+ */
+template <class T> inline static Matrix<std::complex<T> > 
+cis (const Matrix<T>& phi, const codeare::matrix::vmath::Accuracy a = codeare::matrix::vmath::ACCURATE) {
+    return complex2 (T(1), phi, a);
+}
 
 template<class T> inline static Matrix<std::complex<T> >
 cpolar (const T& t, const MatrixType<T>& M) {
@@ -140,6 +229,10 @@ cpolar (const T& t, const MatrixType<T>& M) {
         ret[i] = std::polar(t,M[i]);
     return ret;
 }
+template<class T> inline static Matrix<std::complex<T> >
+cpolar (const T& t, const Matrix<T>& M) {
+    return complex2 (t, M);
+}
 
 #endif
 
@@ -5,6 +5,7 @@
 #include "Algos.hpp"
 #if !defined(_MSC_VER) || _MSC_VER>1200
 #  include "RandTraits.hpp"
+#  include "Philox.hpp"
 #endif
 
 
@@ -148,7 +149,7 @@ ones            (const size_t& n) {
  */
 template <class T> inline static Matrix<T>
 ones           (const Vector<size_t>& sz) {
- 	return Matrix<T>(sz) = reinterpret_cast<T>(1);
+ 	return Matrix<T>(sz) = T(1);
 }
 
 
@@ -292,6 +293,43 @@ randn          (const Vector<size_t>& sz) {
 
 }
 
+
+/**
+ * @brief       Uniformly random matrix from counter-based generator.<br/>
+ *              Reproducible for given seed and stream independent of # threads.
+ *
+ * Usage:
+ * @code{.cpp}
+ *   Matrix<cxfl> n = rand<cxfl>(size(data), Philox(seed, replica));
+ * @endcode
+ *
+ * @param  sz   Size vector
+ * @param  rng  Generator
+ * @return      Rand matrix
+ */
+template <class T> inline static Matrix<T>
+rand           (const Vector<size_t>& sz, const Philox& rng) {
+	Matrix<T> res (sz);
+	Random<T,Philox>::Uniform(res, rng);
+	return res;
+}
+
+
+/**
+ * @brief       Normally distributed random matrix from counter-based generator.<br/>
+ *              Reproducible for given seed and stream independent of # threads.
+ *
+ * @param  sz   Size vector
+ * @param  rng  Generator
+ * @return      Randn matrix
+ */
+template <class T> inline static Matrix<T>
+randn          (const Vector<size_t>& sz, const Philox& rng) {
+	Matrix<T> res (sz);
+	Random<T,Philox>::Normal(res, rng);
+	return res;
+}
+
 #endif
 
 /**
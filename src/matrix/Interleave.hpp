@@ -0,0 +1,323 @@
+/*
+ *  codeare Copyright (C) 2010-2016
+ *                        Kaveh Vahedipour
+ *                        NYU School of Medicine, New York, USA
+ *
+ *  This program is free software; you can redistribute it and/or modify
+ *  it under the terms of the GNU General Public License as published by
+ *  the Free Software Foundation; either version 2 of the License, or
+ *  (at your option) any later version.
+ *
+ *  This program is distributed in the hope that it will be useful, but
+ *  WITHOUT ANY WARRANTY; without even the implied warranty of
+ *  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU
+ *  General Public License for more details.
+ *
+ *  You should have received a copy of the GNU General Public License
+ *  along with this program; if not, write to the Free Software
+ *  Foundation, Inc., 51 Franklin Street, Fifth Floor, Boston, MA
+ *  02110-1301  USA
+ */
+
+#ifndef __INTERLEAVE_HPP__
+#define __INTERLEAVE_HPP__
+
+#include "TypeTraits.hpp"
+#include "OMP.hpp"
+#include "CPUFeatures.hpp"
+
+#include <algorithm>
+#include <complex>
+#include <stdint.h>
+
+#if CODEARE_MULTIVERSION
+#include <immintrin.h>
+#endif
+
+/**
+ * @brief   Conversion between interleaved complex and split real/imaginary
+ *          arrays (e.g. MATLAB mxArrays).<br/>
+ *          Work is distributed over OpenMP threads in blocks. Within a block,
+ *          AVX2 or AVX-512 shuffles, selected at run time, convert 8/16
+ *          (float) or 4/8 (double) numbers per iteration; the SSE2 variant is
+ *          left to the compiler. For arrays well beyond the last level cache,
+ *          destinations aligned to the vector width are written with
+ *          non-temporal stores.
+ */
+namespace codeare {
+namespace matrix {
+
+/**
+ * @name    Blocks of n numbers, generic
+ */
+//@{
+template<class T> inline static void
+split_block (const std::complex<T>* in, T* re, T* im, const size_t n, const bool) {
+	for (size_t i = 0; i < n; ++i) {
+		re[i] = in[i].real();
+		im[i] = in[i].imag();
+	}
+}
+template<class T> inline static void
+merge_block (const T* re, const T* im, std::complex<T>* out, const size_t n, const bool) {
+	for (size_t i = 0; i < n; ++i)
+		out[i] = std::complex<T>(re[i], im[i]);
+}
+//@}
+
+#if CODEARE_MULTIVERSION
+
+/**
+ * @name    Blocks of n numbers, AVX2
+ */
+//@{
+CODEARE_AVX2 inline static void
+split_avx2 (const std::complex<float>* in, float* re, float* im, const size_t n, const bool nt) {
+	size_t i = 0;
+	for (; i + 8 <= n; i += 8) {
+		__m256 a  = _mm256_loadu_ps ((const float*)(in+i)), b = _mm256_loadu_ps ((const float*)(in+i+4));
+		__m256 lo = _mm256_permute2f128_ps (a, b, 0x20), hi = _mm256_permute2f128_ps (a, b, 0x31);
+		__m256 r  = _mm256_shuffle_ps (lo, hi, _MM_SHUFFLE(2,0,2,0)),
+			   m  = _mm256_shuffle_ps (lo, hi, _MM_SHUFFLE(3,1,3,1));
+		if (nt) {
+			_mm256_stream_ps (re+i, r); _mm256_stream_ps (im+i, m);
+		} else {
+			_mm256_storeu_ps (re+i, r); _mm256_storeu_ps (im+i, m);
+		}
+	}
+	split_block (in+i, re+i, im+i, n-i, nt);
+}
+CODEARE_AVX2 inline static void
+split_avx2 (const std::complex<double>* in, double* re, double* im, const size_t n, const bool nt) {
+	size_t i = 0;
+	for (; i + 4 <= n; i += 4) {
+		__m256d a  = _mm256_loadu_pd ((const double*)(in+i)), b = _mm256_loadu_pd ((const double*)(in+i+2));
+		__m256d lo = _mm256_permute2f128_pd (a, b, 0x20), hi = _mm256_permute2f128_pd (a, b, 0x31);
+		__m256d r  = _mm256_unpacklo_pd (lo, hi), m = _mm256_unpackhi_pd (lo, hi);
+		if (nt) {
+			_mm256_stream_pd (re+i, r); _mm256_stream_pd (im+i, m);
+		} else {
+			_mm256_storeu_pd (re+i, r); _mm256_storeu_pd (im+i, m);
+		}
+	}
+	split_block (in+i, re+i, im+i, n-i, nt);
+}
+CODEARE_AVX2 inline static void
+merge_avx2 (const float* re, const float* im, std::complex<float>* out, const size_t n, const bool nt) {
+	size_t i = 0;
+	for (; i + 8 <= n; i += 8) {
+		__m256 r  = _mm256_loadu_ps (re+i), m = _mm256_loadu_ps (im+i);
+		__m256 lo = _mm256_unpacklo_ps (r, m), hi = _mm256_unpackhi_ps (r, m);
+		__m256 a  = _mm256_permute2f128_ps (lo, hi, 0x20), b = _mm256_permute2f128_ps (lo, hi, 0x31);
+		if (nt) {
+			_mm256_stream_ps ((float*)(out+i), a); _mm256_stream_ps ((float*)(out+i+4), b);
+		} else {
+			_mm256_storeu_ps ((float*)(out+i), a); _mm256_storeu_ps ((float*)(out+i+4), b);
+		}
+	}
+	merge_block (re+i, im+i, out+i, n-i, nt);
+}
+CODEARE_AVX2 inline static void
+merge_avx2 (const double* re, const double* im, std::complex<double>* out, const size_t n, const bool nt) {
+	size_t i = 0;
+	for (; i + 4 <= n; i += 4) {
+		__m256d r  = _mm256_loadu_pd (re+i), m = _mm256_loadu_pd (im+i);
+		__m256d lo = _mm256_unpacklo_pd (r, m), hi = _mm256_unpackhi_pd (r, m);
+		__m256d a  = _mm256_permute2f128_pd (lo, hi, 0x20), b = _mm256_permute2f128_pd (lo, hi, 0x31);
+		if (nt) {
+			_mm256_stream_pd ((double*)(out+i), a); _mm256_stream_pd ((double*)(out+i+2), b);
+		} else {
+			_mm256_storeu_pd ((double*)(out+i), a); _mm256_storeu_pd ((double*)(out+i+2), b);
+		}
+	}
+	merge_block (re+i, im+i, out+i, n-i, nt);
+}
+//@}
+
+/**
+ * @name    Blocks of n numbers, AVX-512
+ */
+//@{
+CODEARE_AVX512 inline static void
+split_avx512 (const std::complex<float>* in, float* re, float* im, const size_t n, const bool nt) {
+	const __m512i ir = _mm512_setr_epi32 (0,2,4,6,8,10,12,14,16,18,20,22,24,26,28,30),
+		im_ = _mm512_setr_epi32 (1,3,5,7,9,11,13,15,17,19,21,23,25,27,29,31);
+	size_t i = 0;
+	for (; i + 16 <= n; i += 16) {
+		__m512 a = _mm512_loadu_ps ((const float*)(in+i)), b = _mm512_loadu_ps ((const float*)(in+i+8));
+		__m512 r = _mm512_permutex2var_ps (a, ir, b), m = _mm512_permutex2var_ps (a, im_, b);
+		if (nt) {
+			_mm512_stream_ps (re+i, r); _mm512_stream_ps (im+i, m);
+		} else {
+			_mm512_storeu_ps (re+i, r); _mm512_storeu_ps (im+i, m);
+		}
+	}
+	split_block (in+i, re+i, im+i, n-i, nt);
+}
+CODEARE_AVX512 inline static void
+split_avx512 (const std::complex<double>* in, double* re, double* im, const size_t n, const bool nt) {
+	const __m512i ir = _mm512_setr_epi64 (0,2,4,6,8,10,12,14), im_ = _mm512_setr_epi64 (1,3,5,7,9,11,13,15);
+	size_t i = 0;
+	for (; i + 8 <= n; i += 8) {
+		__m512d a = _mm512_loadu_pd ((const double*)(in+i)), b = _mm512_loadu_pd ((const double*)(in+i+4));
+		__m512d r = _mm512_permutex2var_pd (a, ir, b), m = _mm512_permutex2var_pd (a, im_, b);
+		if (nt) {
+			_mm512_stream_pd (re+i, r); _mm512_stream_pd (im+i, m);
+		} else {
+			_mm512_storeu_pd (re+i, r); _mm512_storeu_pd (im+i, m);
+		}
+	}
+	split_block (in+i, re+i, im+i, n-i, nt);
+}
+CODEARE_AVX512 inline static void
+merge_avx512 (const float* re, const float* im, std::complex<float>* out, const size_t n, const bool nt) {
+	const __m512i lo = _mm512_setr_epi32 (0,16,1,17,2,18,3,19,4,20,5,21,6,22,7,23),
+		hi = _mm512_setr_epi32 (8,24,9,25,10,26,11,27,12,28,13,29,14,30,15,31);
+	size_t i = 0;
+	for (; i + 16 <= n; i += 16) {
+		__m512 r = _mm512_loadu_ps (re+i), m = _mm512_loadu_ps (im+i);
+		__m512 a = _mm512_permutex2var_ps (r, lo, m), b = _mm512_permutex2var_ps (r, hi, m);
+		if (nt) {
+			_mm512_stream_ps ((float*)(out+i), a); _mm512_stream_ps ((float*)(out+i+8), b);
+		} else {
+			_mm512_storeu_ps ((float*)(out+i), a); _mm512_storeu_ps ((float*)(out+i+8), b);
+		}
+	}
+	merge_block (re+i, im+i, out+i, n-i, nt);
+}
+CODEARE_AVX512 inline static void
+merge_avx512 (const double* re, const double* im, std::complex<double>* out, const size_t n, const bool nt) {
+	const __m512i lo = _mm512_setr_epi64 (0,8,1,9,2,10,3,11), hi = _mm512_setr_epi64 (4,12,5,13,6,14,7,15);
+	size_t i = 0;
+	for (; i + 8 <= n; i += 8) {
+		__m512d r = _mm512_loadu_pd (re+i), m = _mm512_loadu_pd (im+i);
+		__m512d a = _mm512_permutex2var_pd (r, lo, m), b = _mm512_permutex2var_pd (r, hi, m);
+		if (nt) {
+			_mm512_stream_pd ((double*)(out+i), a); _mm512_stream_pd ((double*)(out+i+4), b);
+		} else {
+			_mm512_storeu_pd ((double*)(out+i), a); _mm512_storeu_pd ((double*)(out+i+4), b);
+		}
+	}
+	merge_block (re+i, im+i, out+i, n-i, nt);
+}
+//@}
+
+/**
+ * @name    Blocks of n numbers, dispatched
+ */
+//@{
+#define INTERLEAVE_DISPATCH(T)                                                          \
+	inline static void                                                                  \
+	split_block (const std::complex<T>* in, T* re, T* im, const size_t n, const bool nt) { \
+		switch (isa ()) {                                                               \
+		case ISA_AVX512: split_avx512 (in, re, im, n, nt); break;                      \
+		case ISA_AVX2:   split_avx2   (in, re, im, n, nt); break;                      \
+		default:         split_block<T> (in, re, im, n, nt); break;                    \
+		}                                                                               \
+	}                                                                                   \
+	inline static void                                                                  \
+	merge_block (const T* re, const T* im, std::complex<T>* out, const size_t n, const bool nt) { \
+		switch (isa ()) {                                                               \
+		case ISA_AVX512: merge_avx512 (re, im, out, n, nt); break;                     \
+		case ISA_AVX2:   merge_avx2   (re, im, out, n, nt); break;                     \
+		default:         merge_block<T> (re, im, out, n, nt); break;                   \
+		}                                                                               \
+	}
+INTERLEAVE_DISPATCH(float)
+INTERLEAVE_DISPATCH(double)
+#undef INTERLEAVE_DISPATCH
+//@}
+
+#endif
+
+}}
+
+
+/**
+ * @brief   Numbers per parallel work item
+ */
+static const size_t interleave_block = 16384;
+
+/**
+ * @brief   Bytes written beyond which stores bypass the cache
+ */
+static const size_t interleave_stream = 64 << 20;
+
+/**
+ * @brief   Whether p is aligned for non-temporal stores of the instruction
+ *          set in use (none for SSE2)
+ */
+inline static bool interleave_aligned (const void* p) {
+	switch (codeare::matrix::isa ()) {
+	case codeare::matrix::ISA_AVX512: return ((uintptr_t)p & 63) == 0;
+	case codeare::matrix::ISA_AVX2:   return ((uintptr_t)p & 31) == 0;
+	default:                          return false;
+	}
+}
+
+/**
+ * @brief   Split interleaved complex array into real and imaginary parts
+ *
+ * @param  in   Complex input (n)
+ * @param  re   Real parts (n)
+ * @param  im   Imaginary parts (n)
+ * @param  n    Number of elements
+ */
+template<class T> inline static void
+deinterleave (const std::complex<T>* in, T* re, T* im, const size_t n) {
+
+	const size_t nb = (n + interleave_block - 1) / interleave_block;
+	const bool nt = n*sizeof(std::complex<T>) > interleave_stream &&
+		interleave_aligned(re) && interleave_aligned(im);
+
+#pragma omp parallel for schedule (static) if (nb > 1)
+	for (long b = 0; b < (long)nb; ++b) {
+		const size_t i0 = b*interleave_block, i1 = std::min (i0+interleave_block, n);
+		codeare::matrix::split_block (in+i0, re+i0, im+i0, i1-i0, nt);
+	}
+
+#if CODEARE_MULTIVERSION
+	if (nt)
+		_mm_sfence();
+#endif
+
+}
+
+/**
+ * @brief   Merge real and imaginary parts into interleaved complex array
+ *
+ * @param  re   Real parts (n)
+ * @param  im   Imaginary parts (n) or NULL for zero
+ * @param  out  Complex output (n)
+ * @param  n    Number of elements
+ */
+template<class T> inline static void
+interleave (const T* re, const T* im, std::complex<T>* out, const size_t n) {
+
+	const size_t nb = (n + interleave_block - 1) / interleave_block;
+	const bool nt = n*sizeof(std::complex<T>) > interleave_stream && interleave_aligned(out);
+
+	if (im == 0) {
+#pragma omp parallel for schedule (static) if (nb > 1)
+		for (long b = 0; b < (long)nb; ++b) {
+			const size_t i1 = std::min ((b+1)*interleave_block, n);
+			for (size_t i = b*interleave_block; i < i1; ++i)
+				out[i] = std::complex<T>(re[i], T(0));
+		}
+		return;
+	}
+
+#pragma omp parallel for schedule (static) if (nb > 1)
+	for (long b = 0; b < (long)nb; ++b) {
+		const size_t i0 = b*interleave_block, i1 = std::min (i0+interleave_block, n);
+		codeare::matrix::merge_block (re+i0, im+i0, out+i0, i1-i0, nt);
+	}
+
+#if CODEARE_MULTIVERSION
+	if (nt)
+		_mm_sfence();
+#endif
+
+}
+
+#endif /* __INTERLEAVE_HPP__ */
@@ -1,4 +1,5 @@
 #include "Matrix.hpp"
+#include "VecMath.hpp"
 
 /**
  * @brief          Cumulative sum of all elements
@@ -15,9 +16,9 @@ template <class T> inline Matrix<T> cumsum (const Matrix<T>& m) {
 
 template<class T> inline static Matrix<T> exp (const Matrix<T>& M) {
     Matrix<T> ret(M.Dim());
-    for (size_t i = 0; i < M.Size(); ++i)
-        ret[i] = exp(M[i]);
-    return M;
+    if (M.Size())
+        codeare::matrix::vmath::exp (M.Ptr(), ret.Ptr(), M.Size());
+    return ret;
 }
 
 template<class T> inline Matrix<short> sign (const Matrix<T>& A) {
@@ -385,8 +385,11 @@ public:
         MATRIX_ASSERT(std::find(_dim.begin(),_dim.end(),size_t(0))==_dim.end(),
         		DIMS_VECTOR_CONTAINS_ZEROS);
         Allocate();
-        for (size_t i = 0; i < Size(); ++i)
-            _M[0] = *(v._pointers[i]);
+        T* r = Ptr();
+        v.Runs ([r](const T* p, const size_t pos, const size_t n, const long s) {
+                for (size_t i = 0; i < n; ++i)
+                    r[pos+i] = p[(long)i*s];
+            });
     }
 #endif
 
@@ -1289,8 +1292,11 @@ public:
     inline Matrix<T,P>& operator= (const View<S,true>& v) {
         _dim = v._dim;
         Allocate();
-        for (size_t i = 0; i < Size(); ++i)
-            _M[i] = v[i];
+        T* r = Ptr();
+        v.Runs ([r](const S* p, const size_t pos, const size_t n, const long s) {
+                for (size_t i = 0; i < n; ++i)
+                    r[pos+i] = p[(long)i*s];
+            });
         return *this;
     }
 #endif
@@ -1605,8 +1611,11 @@ public:
     template <class S>
     inline Matrix<T,P>& operator+= (const View<S,true>& M) {
         MATRIX_ASSERT (_dim==M.Dim(), DIMENSIONS_MUST_MATCH);
-        for (size_t i = 0; i < Size(); ++i)
-            _M[i] += M[i];
+        T* r = Ptr();
+        M.Runs ([r](const S* p, const size_t pos, const size_t n, const long s) {
+                for (size_t i = 0; i < n; ++i)
+                    r[pos+i] += p[(long)i*s];
+            });
         return *this;
     }
 
@@ -1659,8 +1668,11 @@ public:
     template <class S>
     inline Matrix<T,P>& operator-= (const View<S,true>& M) {
         MATRIX_ASSERT (_dim==M.Dim(), DIMENSIONS_MUST_MATCH);
-        for (size_t i = 0; i < Size(); ++i)
-            _M[i] -= M[i];
+        T* r = Ptr();
+        M.Runs ([r](const S* p, const size_t pos, const size_t n, const long s) {
+                for (size_t i = 0; i < n; ++i)
+                    r[pos+i] -= p[(long)i*s];
+            });
         return *this;
     }
 
@@ -1713,8 +1725,11 @@ public:
     template <class S>
     inline Matrix<T,P>& operator*= (const View<S,true>& M) {
         MATRIX_ASSERT (_dim==M.Dim(), DIMENSIONS_MUST_MATCH);
-        for (size_t i = 0; i < Size(); ++i)
-            _M[i] *= M[i];
+        T* r = Ptr();
+        M.Runs ([r](const S* p, const size_t pos, const size_t n, const long s) {
+                for (size_t i = 0; i < n; ++i)
+                    r[pos+i] *= p[(long)i*s];
+            });
         return *this;
     }
 
@@ -1766,8 +1781,11 @@ public:
     template <class S>
     inline Matrix<T,P>& operator/= (const View<S,true>& M) {
         MATRIX_ASSERT (_dim==M.Dim(), DIMENSIONS_MUST_MATCH);
-        for (size_t i = 0; i < Size(); ++i)
-            _M[i] /= M[i];
+        T* r = Ptr();
+        M.Runs ([r](const S* p, const size_t pos, const size_t n, const long s) {
+                for (size_t i = 0; i < n; ++i)
+                    r[pos+i] /= p[(long)i*s];
+            });
         return *this;
     }
 
@@ -1976,7 +1994,7 @@ public:
         vr.push_back (r2);
         vr.push_back (r3);
         vr.push_back (r4);
-        vr.push_back (r4);
+        vr.push_back (r5);
         return RHSView(this, vr);
     }
 #endif
@@ -27,5 +27,9 @@ inline int  omp_get_thread_num () { return 0;}
 inline int  omp_get_num_threads () { return 1;}
 inline void omp_set_num_threads (const int) {}
 inline void omp_set_dynamic(const bool) {}
+inline int  omp_get_max_threads () { return 1;}
+inline int  omp_in_parallel () { return 0;}
+#include <time.h>
+inline double omp_get_wtime () { return (double) clock() / CLOCKS_PER_SEC;}
 #endif
 #endif
@@ -0,0 +1,224 @@
+/*
+ *  codeare Copyright (C) 2010-2016
+ *                        Kaveh Vahedipour
+ *                        NYU School of Medicine, New York, USA
+ *
+ *  This program is free software; you can redistribute it and/or modify
+ *  it under the terms of the GNU General Public License as published by
+ *  the Free Software Foundation; either version 2 of the License, or
+ *  (at your option) any later version.
+ *
+ *  This program is distributed in the hope that it will be useful, but
+ *  WITHOUT ANY WARRANTY; without even the implied warranty of
+ *  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU
+ *  General Public License for more details.
+ *
+ *  You should have received a copy of the GNU General Public License
+ *  along with this program; if not, write to the Free Software
+ *  Foundation, Inc., 51 Franklin Street, Fifth Floor, Boston, MA
+ *  02110-1301  USA
+ */
+
+#ifndef __PHILOX_HPP__
+#define __PHILOX_HPP__
+
+#include "RandTraits.hpp"
+#include "OMP.hpp"
+
+#include <stdint.h>
+#include <cmath>
+
+/**
+ * @brief   Counter-based Philox4x32-10 generator.<br/>
+ *          Salmon et al. Parallel random numbers: as easy as 1, 2, 3. SC'11.
+ *
+ *          Every 128 bit output block is a pure function of (seed, stream, counter).
+ *          Blocks can thus be generated in any order and on any thread, which makes
+ *          parallel fills reproducible independent of the number of threads.
+ */
+class Philox {
+
+public:
+
+    /**
+     * @brief        Construct with seed and stream
+     *
+     * @param  seed  Key (identical seeds produce identical sequences)
+     * @param  stream Independent sub-sequence of seed (e.g. pseudo-replica number)
+     */
+    inline explicit Philox (const uint64_t seed = 0, const uint64_t stream = 0) NOEXCEPT :
+        _seed(seed), _stream(stream) {}
+
+    /**
+     * @brief        Seed
+     */
+    inline uint64_t Seed () const NOEXCEPT { return _seed; }
+
+    /**
+     * @brief        Stream
+     */
+    inline uint64_t Stream () const NOEXCEPT { return _stream; }
+
+    /**
+     * @brief        Same seed, other stream
+     *
+     * @param  stream Stream
+     * @return       Generator
+     */
+    inline Philox Split (const uint64_t stream) const NOEXCEPT {
+        return Philox (_seed, stream);
+    }
+
+    /**
+     * @brief        Generate 4x32 bits for counter
+     *
+     * @param  counter Block counter
+     * @param  out   4 words of output
+     */
+    inline void operator() (const uint64_t counter, uint32_t* out) const NOEXCEPT {
+        uint32_t c0 = (uint32_t)counter, c1 = (uint32_t)(counter>>32),
+            c2 = (uint32_t)_stream, c3 = (uint32_t)(_stream>>32),
+            k0 = (uint32_t)_seed, k1 = (uint32_t)(_seed>>32), h0, l0, h1, l1;
+        for (size_t r = 0; r < 10; ++r) {
+            MulHiLo (0xD2511F53, c0, h0, l0);
+            MulHiLo (0xCD9E8D57, c2, h1, l1);
+            c0 = h1^c1^k0; c1 = l1; c2 = h0^c3^k1; c3 = l0;
+            k0 += 0x9E3779B9; k1 += 0xBB67AE85;
+        }
+        out[0] = c0; out[1] = c1; out[2] = c2; out[3] = c3;
+    }
+
+private:
+
+    inline static void MulHiLo (const uint32_t a, const uint32_t b, uint32_t& hi, uint32_t& lo) NOEXCEPT {
+        uint64_t p = (uint64_t)a * (uint64_t)b;
+        hi = (uint32_t)(p>>32);
+        lo = (uint32_t)p;
+    }
+
+    uint64_t _seed;   /**< @brief Key */
+    uint64_t _stream; /**< @brief Upper half of counter */
+
+};
+
+
+/**
+ * @brief   Conversion of Philox output to uniform variates in (0,1]
+ */
+template<class RT> struct PhiloxTraits;
+
+template<> struct PhiloxTraits<float> {
+    static const size_t stride = 4; /**< @brief Variates per counter */
+    inline static void Convert (const uint32_t* r, float* u) NOEXCEPT {
+        for (size_t i = 0; i < 4; ++i)
+            u[i] = (float)((r[i]>>8)+1) * 5.9604644775390625e-8f;
+    }
+};
+
+template<> struct PhiloxTraits<double> {
+    static const size_t stride = 2; /**< @brief Variates per counter */
+    inline static void Convert (const uint32_t* r, double* u) NOEXCEPT {
+        for (size_t i = 0; i < 2; ++i)
+            u[i] = (double)(((((uint64_t)r[2*i])<<21)^(r[2*i+1]>>11))+1) * 1.1102230246251565e-16;
+    }
+};
+
+
+/**
+ * @brief   Parallel, reproducible random fills with Philox.<br/>
+ *          Complex matrices are filled as interleaved real/imaginary scalars.
+ *          Normal variates are produced by a Box-Muller transform over blocks
+ *          of uniforms, which vectorises through OpenMP SIMD math.
+ */
+template<class T> class Random<T,Philox> {
+
+    typedef typename TypeTraits<T>::RT RT;
+
+    static const size_t block = 64; /**< @brief Counters per work item */
+
+public:
+
+    /**
+     * @brief        Normally distributed entries
+     *
+     * @param  vt    Matrix to fill
+     * @param  rng   Generator
+     * @param  mean  Mean
+     * @param  sigma Standard deviation
+     */
+    inline static void Normal (Matrix<T>& vt, const Philox& rng, const RT mean = 0.0, const RT sigma = 1.0) {
+        Fill (vt, rng, mean, sigma, true);
+    }
+
+    /**
+     * @brief        Normally distributed entries with clock seeded generator
+     */
+    inline static void Normal (Matrix<T>& vt, const RT mean = 0.0, const RT sigma = 1.0) {
+        Normal (vt, Philox((uint64_t)clock()), mean, sigma);
+    }
+
+    /**
+     * @brief        Uniformly distributed entries
+     *
+     * @param  vt    Matrix to fill
+     * @param  rng   Generator
+     * @param  min   Lower bound
+     * @param  max   Upper bound
+     */
+    inline static void Uniform (Matrix<T>& vt, const Philox& rng, const RT min = RandTraits<T>::stdmin(),
+                                const RT max = RandTraits<T>::stdmax()) {
+        Fill (vt, rng, min, max-min, false);
+    }
+
+    /**
+     * @brief        Uniformly distributed entries with clock seeded generator
+     */
+    inline static void Uniform (Matrix<T>& vt, const RT min = RandTraits<T>::stdmin(),
+                                const RT max = RandTraits<T>::stdmax()) {
+        Uniform (vt, Philox((uint64_t)clock()), min, max);
+    }
+
+private:
+
+    inline static void Fill (Matrix<T>& vt, const Philox& rng, const RT a, const RT b, const bool normal) {
+
+        const size_t stride = PhiloxTraits<RT>::stride, nb = block*stride,
+            n = vt.Size() * sizeof(T)/sizeof(RT),
+            nblocks = (n + nb - 1) / nb;
+        RT* p = (RT*) vt.Ptr();
+        const RT twopi = 6.283185307179586;
+
+#pragma omp parallel for schedule (static)
+        for (long k = 0; k < (long)nblocks; ++k) {
+
+            uint32_t r[4*block];
+            RT u[nb], z[nb];
+            const size_t offset = k*nb, len = std::min (nb, n-offset);
+
+            for (size_t j = 0; j < block; ++j)
+                rng (k*block+j, r+4*j);
+            for (size_t j = 0; j < block; ++j)
+                PhiloxTraits<RT>::Convert (r+4*j, u+j*stride);
+
+            if (normal) {
+#pragma omp simd
+                for (size_t j = 0; j < nb/2; ++j) {
+                    RT rho = std::sqrt(RT(-2.0)*std::log(u[2*j])), phi = twopi*u[2*j+1];
+                    z[2*j]   = a + b * rho * std::cos(phi);
+                    z[2*j+1] = a + b * rho * std::sin(phi);
+                }
+            } else {
+#pragma omp simd
+                for (size_t j = 0; j < nb; ++j)
+                    z[j] = a + b * (RT(1.0) - u[j]);
+            }
+
+            std::copy (z, z+len, p+offset);
+
+        }
+
+    }
+
+};
+
+#endif /* __PHILOX_HPP__ */
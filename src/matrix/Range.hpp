@@ -19,7 +19,11 @@ enum RangeParseException {
 };
 
 /**
- * @brief Index range
+ * @brief Index range.<br/>
+ *        Arithmetic progressions (single index, begin:end, begin:stride:end)
+ *        are held as descriptor (begin, stride, size). Explicit index vectors
+ *        are only kept for gather/scatter ranges, i.e. index vectors and
+ *        concatenations, which are not progressions.
  */
 template<bool is_const> class Range {
 
@@ -28,25 +32,28 @@ public:
     /**
      * @brief default constructor
      */
-	inline Range () {}
+	inline Range () : _begin(0), _stride(1), _size(0) {}
 
     /**
      * @brief construct as single index
      *        i.e. A(:,6) is A(R(),R(5))
      */
-	inline Range (const size_t& begend) { HandleSingleInput(begend); }
+	inline Range (const size_t& begend) : _begin(0), _stride(1), _size(0) { HandleSingleInput(begend); }
 
     /**
      * @brief construct with begin and end
      *        i.e. A(6:8,:) is A(R(5:7),R())
      */
-	inline Range (const size_t& begin, const size_t& end) { HandleTwoInputs(begin, end); }
+	inline Range (const size_t& begin, const size_t& end) : _begin(0), _stride(1), _size(0) {
+		HandleTwoInputs(begin, end);
+	}
 
     /**
      * @brief construct with begin, stride and end
      *        i.e. A(:,6:-1:4) translates to A(R(),R(5,-1,3))
      */
-    inline Range (const size_t& begin, const size_t& stride, const size_t& end) {
+    inline Range (const size_t& begin, const size_t& stride, const size_t& end) :
+		_begin(0), _stride(1), _size(0) {
 		HandleThreeInputs(begin, stride, end);
 	}
 
@@ -54,13 +61,21 @@ public:
      * @brief construct with index vector
      *        (i.e. A(:,v) translates to A(R(),R(v)))
      */
-	inline Range (const Vector<size_t>& v) { _idx = v; }
+	inline Range (const Vector<size_t>& v) : _begin(0), _stride(1), _size(0) {
+		bool progression = true;
+		for (size_t i = 2; i < v.size() && progression; ++i)
+			progression = ((long)v[i] - (long)v[i-1] == (long)v[1] - (long)v[0]);
+		if (progression && v.size())
+			Append (v[0], (v.size() > 1) ? (long)v[1] - (long)v[0] : 1, v.size());
+		else
+			_idx = v;
+	}
 
     /**
      * @brief construct with matlab-like string
      *         (i.e. A(:,6:-1:4) translates to A(":","5:-1:3")
      */
-	inline Range (const std::string& rs) { ParseRange(rs); }
+	inline Range (const std::string& rs) : _begin(0), _stride(1), _size(0) { ParseRange(rs); }
 
     /**
      * @brief default destructor
@@ -72,7 +87,7 @@ public:
      * @see Range(const int& begin)
      */
 	inline void Reset (const int& begin) {
-		_idx.clear();
+		Clear();
 		HandleSingleInput (begin);
 	}
 
@@ -81,7 +96,7 @@ public:
      * @see Range(const int& begin, const int& end)
      */
     inline void Reset (const int& begin, const int& end) {
-		_idx.clear();
+		Clear();
 		HandleTwoInputs (begin, end);
 	}
 
@@ -90,7 +105,7 @@ public:
      * @see Range(const int& begin, const int& stride, const int& end)
      */
     inline void Reset (const int& begin, const int& stride, const int& end) {
-		_idx.clear();
+		Clear();
 		HandleThreeInputs (begin, stride, end);
 	}
 
@@ -98,19 +113,39 @@ public:
      * @brief Get size
      * @return Size
      */
-	inline size_t Size() const { return _idx.size(); }
+	inline size_t Size() const { return _idx.empty() ? _size : _idx.size(); }
 
     /**
      * @brief Is this range a singleton
      * @return Singleton or not
      */
-	inline bool IsSingleton() const { return (_idx.size()==1);}
+	inline bool IsSingleton() const { return (Size()==1);}
+
+    /**
+     * @brief Is this range held as descriptor (begin, stride, size)
+     * @return Strided or gather
+     */
+	inline bool IsStrided() const { return _idx.empty(); }
+
+    /**
+     * @brief First index of a strided range
+     * @return First index
+     */
+	inline size_t Begin() const { return _begin; }
+
+    /**
+     * @brief Stride of a strided range
+     * @return Stride
+     */
+	inline long Stride() const { return _stride; }
 
     /**
      * @brief Get i-th index in range
      * @return I-th index in range
      */
-	inline size_t operator[] (const size_t& i) const { return _idx[i]; }
+	inline size_t operator[] (const size_t& i) const {
+		return _idx.empty() ? (size_t)((long)_begin + (long)i*_stride) : _idx[i];
+	}
     
 private:
 
@@ -145,7 +180,7 @@ private:
 	inline void HandleSingleInput (const int& pos) {
 		if (pos < 0)
 			throw  NEGATIVE_BEGIN_INDEX;
-		_idx.push_back(pos);
+		Append (pos, 1, 1);
 	}
 	inline void HandleThreeInputs (const int& begin, const int& stride, const int& end) {
 		if (begin < 0) {
@@ -168,10 +203,7 @@ private:
 			printf ("NEGATIVE_STRIDE_REQUIRES_NEGATIV_RANGE\n");
 			throw NEGATIVE_STRIDE_REQUIRES_NEGATIV_RANGE;
 		}
-		size_t cur = _idx.size();
-		_idx.resize(cur+std::floor(((float)end-(float)begin)/(float)stride)+1);
-		for (size_t i = cur; i < _idx.size(); ++i)
-			_idx[i] = begin + i*stride;
+		Append (begin, stride, (end-begin)/stride + 1);
 	}
 	inline void HandleTwoInputs (const int& begin, const int& end) {
 		if (begin < 0) {
@@ -186,15 +218,40 @@ private:
 			printf ("POSITIVE_STRIDE_REQUIRES_POSITIV_RANGE\n");
 			throw STRIDE_MUST_NOT_BE_ZERO;
 		}
+		Append (begin, 1, end-begin+1);
+	}
+	inline void Append (const size_t& begin, const long& stride, const size_t& n) {
+		if (Size() == 0) {                     // Descriptor
+			_begin  = begin;
+			_stride = stride;
+			_size   = n;
+			return;
+		}
+		if (_idx.empty()) {                    // Concatenation: materialise
+			_idx.resize(_size);
+			for (size_t i = 0; i < _size; ++i)
+				_idx[i] = (long)_begin + (long)i*_stride;
+		}
 		size_t cur = _idx.size();
-		_idx.resize(cur+end-begin+1);
+		_idx.resize(cur+n);
 		for (size_t i = cur; i < _idx.size(); ++i)
-			_idx[i] = begin + i;
+			_idx[i] = (long)begin + (long)(i-cur)*stride;
+	}
+	inline void Clear () {
+		_idx.clear();
+		_begin = 0;
+		_stride = 1;
+		_size = 0;
 	}
 	friend std::ostream& operator<< (std::ostream &os, const Range& r) {
+		if (r._idx.empty())
+			return os << r._begin << ":" << r._stride << ":" << (long)r._begin + ((long)r._size-1)*r._stride;
 		return os << r._idx;
 	}
-	Vector<size_t> _idx;
+	size_t _begin;      /**< @brief First index (strided) */
+	long   _stride;     /**< @brief Stride (strided) */
+	size_t _size;       /**< @brief Size (strided) */
+	Vector<size_t> _idx;/**< @brief Explicit indices (gather/scatter only) */
 };
 
 typedef Range<true> CR;
@@ -0,0 +1,357 @@
+/*
+ *  codeare Copyright (C) 2010-2016
+ *                        Kaveh Vahedipour
+ *                        NYU School of Medicine, New York, USA
+ *
+ *  This program is free software; you can redistribute it and/or modify
+ *  it under the terms of the GNU General Public License as published by
+ *  the Free Software Foundation; either version 2 of the License, or
+ *  (at your option) any later version.
+ *
+ *  This program is distributed in the hope that it will be useful, but
+ *  WITHOUT ANY WARRANTY; without even the implied warranty of
+ *  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU
+ *  General Public License for more details.
+ *
+ *  You should have received a copy of the GNU General Public License
+ *  along with this program; if not, write to the Free Software
+ *  Foundation, Inc., 51 Franklin Street, Fifth Floor, Boston, MA
+ *  02110-1301  USA
+ */
+
+#ifndef __SIMD_KERNELS_HPP__
+#define __SIMD_KERNELS_HPP__
+
+#include "CPUFeatures.hpp"
+
+#include <algorithm>
+#include <complex>
+#include <cstddef>
+
+/**
+ * @brief   Elementwise arithmetic and reductions on contiguous arrays.<br/>
+ *
+ *          Each kernel is compiled for SSE2, AVX2 and AVX-512 and the variant
+ *          matching the CPU (or CODEARE_ISA) is called, such that one binary
+ *          runs on all x86-64 machines at their native vector width. Complex
+ *          arrays are processed as interleaved real/imaginary scalars; complex
+ *          division uses the unscaled formula a conj(b) / |b|^2, like
+ *          VecTraits. Outputs may alias inputs exactly (in-place operation),
+ *          but must not overlap them otherwise.<br/>
+ *
+ *          Results do not depend on the instruction set, except for the
+ *          order of summation in reductions.
+ */
+namespace codeare {
+namespace matrix {
+namespace simd {
+
+/**
+ * @name    Array kernels (inlined into one function per instruction set)
+ */
+//@{
+#define SIMD_BINARY_K(name, op)                                                     \
+	template<class T> CODEARE_INLINE static void                                    \
+	name##_k (const T* a, const T* b, T* c, const size_t n) {                      \
+		_Pragma ("omp simd")                                                        \
+		for (size_t i = 0; i < n; ++i)                                              \
+			c[i] = a[i] op b[i];                                                    \
+	}                                                                               \
+	template<class T> CODEARE_INLINE static void                                    \
+	name##s_k (const T* a, const T s, T* c, const size_t n) {                      \
+		_Pragma ("omp simd")                                                        \
+		for (size_t i = 0; i < n; ++i)                                              \
+			c[i] = a[i] op s;                                                       \
+	}
+SIMD_BINARY_K(add, +)
+SIMD_BINARY_K(sub, -)
+SIMD_BINARY_K(mul, *)
+SIMD_BINARY_K(div, /)
+#undef SIMD_BINARY_K
+
+/**
+ * @brief   c = a + s and c = a - s for n interleaved complex numbers
+ */
+template<class T> CODEARE_INLINE static void
+cadds_k (const T* a, const T sr, const T si, T* c, const size_t n) {
+#pragma omp simd
+	for (size_t i = 0; i < n; ++i) {
+		c[2*i]   = a[2*i]   + sr;
+		c[2*i+1] = a[2*i+1] + si;
+	}
+}
+template<class T> CODEARE_INLINE static void
+csubs_k (const T* a, const T sr, const T si, T* c, const size_t n) {
+#pragma omp simd
+	for (size_t i = 0; i < n; ++i) {
+		c[2*i]   = a[2*i]   - sr;
+		c[2*i+1] = a[2*i+1] - si;
+	}
+}
+
+/**
+ * @brief   c = a * b for n interleaved complex numbers
+ */
+template<class T> CODEARE_INLINE static void
+cmul_k (const T* a, const T* b, T* c, const size_t n) {
+#pragma omp simd
+	for (size_t i = 0; i < n; ++i) {
+		const T ar = a[2*i], ai = a[2*i+1], br = b[2*i], bi = b[2*i+1];
+		c[2*i]   = ar*br - ai*bi;
+		c[2*i+1] = ar*bi + ai*br;
+	}
+}
+template<class T> CODEARE_INLINE static void
+cmuls_k (const T* a, const T br, const T bi, T* c, const size_t n) {
+#pragma omp simd
+	for (size_t i = 0; i < n; ++i) {
+		const T ar = a[2*i], ai = a[2*i+1];
+		c[2*i]   = ar*br - ai*bi;
+		c[2*i+1] = ar*bi + ai*br;
+	}
+}
+
+/**
+ * @brief   c = a / b for n interleaved complex numbers
+ */
+template<class T> CODEARE_INLINE static void
+cdiv_k (const T* a, const T* b, T* c, const size_t n) {
+#pragma omp simd
+	for (size_t i = 0; i < n; ++i) {
+		const T ar = a[2*i], ai = a[2*i+1], br = b[2*i], bi = b[2*i+1], d = br*br + bi*bi;
+		c[2*i]   = (ar*br + ai*bi) / d;
+		c[2*i+1] = (ai*br - ar*bi) / d;
+	}
+}
+template<class T> CODEARE_INLINE static void
+cdivs_k (const T* a, const T br, const T bi, T* c, const size_t n) {
+	const T d = br*br + bi*bi;
+#pragma omp simd
+	for (size_t i = 0; i < n; ++i) {
+		const T ar = a[2*i], ai = a[2*i+1];
+		c[2*i]   = (ar*br + ai*bi) / d;
+		c[2*i+1] = (ai*br - ar*bi) / d;
+	}
+}
+
+/**
+ * @brief   Complex conjugate of n interleaved complex numbers
+ */
+template<class T> CODEARE_INLINE static void
+conj_k (const T* a, T* c, const size_t n) {
+#pragma omp simd
+	for (size_t i = 0; i < n; ++i) {
+		c[2*i]   =  a[2*i];
+		c[2*i+1] = -a[2*i+1];
+	}
+}
+
+/**
+ * @brief   Reductions (r: result)
+ */
+template<class T> CODEARE_INLINE static void
+sum_k (const T* a, const size_t n, T& r) {
+	T s = T(0);
+#pragma omp simd reduction (+:s)
+	for (size_t i = 0; i < n; ++i)
+		s += a[i];
+	r = s;
+}
+template<class T> CODEARE_INLINE static void
+csum_k (const T* a, const size_t n, T& rr, T& ri) {
+	T sr = T(0), si = T(0);
+#pragma omp simd reduction (+:sr,si)
+	for (size_t i = 0; i < n; ++i) {
+		sr += a[2*i];
+		si += a[2*i+1];
+	}
+	rr = sr; ri = si;
+}
+template<class T> CODEARE_INLINE static void
+max_k (const T* a, const size_t n, T& r) {
+	T m = a[0];
+#pragma omp simd reduction (max:m)
+	for (size_t i = 1; i < n; ++i)
+		m = (a[i] > m) ? a[i] : m;
+	r = m;
+}
+template<class T> CODEARE_INLINE static void
+min_k (const T* a, const size_t n, T& r) {
+	T m = a[0];
+#pragma omp simd reduction (min:m)
+	for (size_t i = 1; i < n; ++i)
+		m = (a[i] < m) ? a[i] : m;
+	r = m;
+}
+//@}
+
+/**
+ * @name    Instruction set variants and dispatch
+ */
+//@{
+#define SIMD_DISPATCH(T)                                                                        \
+	CODEARE_DISPATCH(add,  (const T* a, const T* b, T* c, const size_t n), (a, b, c, n))        \
+	CODEARE_DISPATCH(sub,  (const T* a, const T* b, T* c, const size_t n), (a, b, c, n))        \
+	CODEARE_DISPATCH(mul,  (const T* a, const T* b, T* c, const size_t n), (a, b, c, n))        \
+	CODEARE_DISPATCH(div,  (const T* a, const T* b, T* c, const size_t n), (a, b, c, n))        \
+	CODEARE_DISPATCH(adds, (const T* a, const T s, T* c, const size_t n), (a, s, c, n))         \
+	CODEARE_DISPATCH(subs, (const T* a, const T s, T* c, const size_t n), (a, s, c, n))         \
+	CODEARE_DISPATCH(muls, (const T* a, const T s, T* c, const size_t n), (a, s, c, n))         \
+	CODEARE_DISPATCH(divs, (const T* a, const T s, T* c, const size_t n), (a, s, c, n))         \
+	CODEARE_DISPATCH(cadds, (const T* a, const T sr, const T si, T* c, const size_t n),         \
+					 (a, sr, si, c, n))                                                         \
+	CODEARE_DISPATCH(csubs, (const T* a, const T sr, const T si, T* c, const size_t n),         \
+					 (a, sr, si, c, n))                                                         \
+	CODEARE_DISPATCH(cmul, (const T* a, const T* b, T* c, const size_t n), (a, b, c, n))        \
+	CODEARE_DISPATCH(cmuls, (const T* a, const T br, const T bi, T* c, const size_t n),         \
+					 (a, br, bi, c, n))                                                         \
+	CODEARE_DISPATCH(cdiv, (const T* a, const T* b, T* c, const size_t n), (a, b, c, n))        \
+	CODEARE_DISPATCH(cdivs, (const T* a, const T br, const T bi, T* c, const size_t n),         \
+					 (a, br, bi, c, n))                                                         \
+	CODEARE_DISPATCH(conj, (const T* a, T* c, const size_t n), (a, c, n))                       \
+	CODEARE_DISPATCH(sum,  (const T* a, const size_t n, T& r), (a, n, r))                       \
+	CODEARE_DISPATCH(csum, (const T* a, const size_t n, T& rr, T& ri), (a, n, rr, ri))          \
+	CODEARE_DISPATCH(max,  (const T* a, const size_t n, T& r), (a, n, r))                       \
+	CODEARE_DISPATCH(min,  (const T* a, const size_t n, T& r), (a, n, r))
+SIMD_DISPATCH(float)
+SIMD_DISPATCH(double)
+#undef SIMD_DISPATCH
+//@}
+
+/**
+ * @name    Elementwise c = a op b and c = a op s
+ */
+//@{
+#define SIMD_BINARY(name, op)                                                                   \
+	template<class T> inline static void                                                        \
+	name (const T* a, const T* b, T* c, const size_t n) {                                       \
+		for (size_t i = 0; i < n; ++i)                                                          \
+			c[i] = a[i] op b[i];                                                                \
+	}                                                                                           \
+	template<class T> inline static void                                                        \
+	name (const T* a, const T& s, T* c, const size_t n) {                                       \
+		for (size_t i = 0; i < n; ++i)                                                          \
+			c[i] = a[i] op s;                                                                   \
+	}                                                                                           \
+	inline static void name (const float* a, const float* b, float* c, const size_t n) {        \
+		name##_isa (a, b, c, n);                                                                \
+	}                                                                                           \
+	inline static void name (const double* a, const double* b, double* c, const size_t n) {     \
+		name##_isa (a, b, c, n);                                                                \
+	}                                                                                           \
+	inline static void name (const float* a, const float& s, float* c, const size_t n) {        \
+		name##s_isa (a, s, c, n);                                                               \
+	}                                                                                           \
+	inline static void name (const double* a, const double& s, double* c, const size_t n) {     \
+		name##s_isa (a, s, c, n);                                                               \
+	}
+SIMD_BINARY(add, +)
+SIMD_BINARY(sub, -)
+SIMD_BINARY(mul, *)
+SIMD_BINARY(div, /)
+#undef SIMD_BINARY
+
+#define SIMD_COMPLEX(T)                                                                         \
+	inline static void add (const std::complex<T>* a, const std::complex<T>* b,                 \
+							std::complex<T>* c, const size_t n) {                               \
+		add_isa ((const T*)a, (const T*)b, (T*)c, 2*n);                                         \
+	}                                                                                           \
+	inline static void sub (const std::complex<T>* a, const std::complex<T>* b,                 \
+							std::complex<T>* c, const size_t n) {                               \
+		sub_isa ((const T*)a, (const T*)b, (T*)c, 2*n);                                         \
+	}                                                                                           \
+	inline static void mul (const std::complex<T>* a, const std::complex<T>* b,                 \
+							std::complex<T>* c, const size_t n) {                               \
+		cmul_isa ((const T*)a, (const T*)b, (T*)c, n);                                          \
+	}                                                                                           \
+	inline static void div (const std::complex<T>* a, const std::complex<T>* b,                 \
+							std::complex<T>* c, const size_t n) {                               \
+		cdiv_isa ((const T*)a, (const T*)b, (T*)c, n);                                          \
+	}                                                                                           \
+	inline static void add (const std::complex<T>* a, const std::complex<T>& s,                 \
+							std::complex<T>* c, const size_t n) {                               \
+		cadds_isa ((const T*)a, s.real(), s.imag(), (T*)c, n);                                  \
+	}                                                                                           \
+	inline static void sub (const std::complex<T>* a, const std::complex<T>& s,                 \
+							std::complex<T>* c, const size_t n) {                               \
+		csubs_isa ((const T*)a, s.real(), s.imag(), (T*)c, n);                                  \
+	}                                                                                           \
+	inline static void mul (const std::complex<T>* a, const std::complex<T>& s,                 \
+							std::complex<T>* c, const size_t n) {                               \
+		cmuls_isa ((const T*)a, s.real(), s.imag(), (T*)c, n);                                  \
+	}                                                                                           \
+	inline static void div (const std::complex<T>* a, const std::complex<T>& s,                 \
+							std::complex<T>* c, const size_t n) {                               \
+		cdivs_isa ((const T*)a, s.real(), s.imag(), (T*)c, n);                                  \
+	}
+SIMD_COMPLEX(float)
+SIMD_COMPLEX(double)
+#undef SIMD_COMPLEX
+//@}
+
+/**
+ * @brief   Complex conjugate (copy for real types)
+ */
+template<class T> inline static void conj (const T* a, T* c, const size_t n) {
+	if (a != c)
+		std::copy (a, a+n, c);
+}
+template<class T> inline static void conj (const std::complex<T>* a, std::complex<T>* c, const size_t n) {
+	for (size_t i = 0; i < n; ++i)
+		c[i] = std::conj(a[i]);
+}
+inline static void conj (const std::complex<float>* a, std::complex<float>* c, const size_t n) {
+	conj_isa ((const float*)a, (float*)c, n);
+}
+inline static void conj (const std::complex<double>* a, std::complex<double>* c, const size_t n) {
+	conj_isa ((const double*)a, (double*)c, n);
+}
+
+/**
+ * @name    Reductions. max and min require n > 0; their result is
+ *          unspecified if a contains NaN.
+ */
+//@{
+template<class T> inline static T sum (const T* a, const size_t n) {
+	T r = T(0);
+	for (size_t i = 0; i < n; ++i)
+		r += a[i];
+	return r;
+}
+inline static float sum (const float* a, const size_t n) {
+	float r; sum_isa (a, n, r); return r;
+}
+inline static double sum (const double* a, const size_t n) {
+	double r; sum_isa (a, n, r); return r;
+}
+inline static std::complex<float> sum (const std::complex<float>* a, const size_t n) {
+	float rr, ri; csum_isa ((const float*)a, n, rr, ri); return std::complex<float>(rr, ri);
+}
+inline static std::complex<double> sum (const std::complex<double>* a, const size_t n) {
+	double rr, ri; csum_isa ((const double*)a, n, rr, ri); return std::complex<double>(rr, ri);
+}
+
+template<class T> inline static T max (const T* a, const size_t n) {
+	return *std::max_element (a, a+n);
+}
+inline static float max (const float* a, const size_t n) {
+	float r; max_isa (a, n, r); return r;
+}
+inline static double max (const double* a, const size_t n) {
+	double r; max_isa (a, n, r); return r;
+}
+
+template<class T> inline static T min (const T* a, const size_t n) {
+	return *std::min_element (a, a+n);
+}
+inline static float min (const float* a, const size_t n) {
+	float r; min_isa (a, n, r); return r;
+}
+inline static double min (const double* a, const size_t n) {
+	double r; min_isa (a, n, r); return r;
+}
+//@}
+
+}}}
+
+#endif /* __SIMD_KERNELS_HPP__ */
@@ -10,6 +10,7 @@
 
 #include "Vector.hpp"
 #include "TypeTraits.hpp"
+#include "SIMDKernels.hpp"
 #include <algorithm>
 #include <climits>
 
@@ -310,6 +311,12 @@ namespace codeare {
         inline static reg_type packed (const reg_type& a, const reg_type& b) {
 			return VecTraits<T>::plus(a, b);
 		}
+		inline static void apply (const T* a, const T* b, T* c, const size_t n) {
+			codeare::matrix::simd::add (a, b, c, n);
+		}
+		inline static void apply (const T* a, const T& b, T* c, const size_t n) {
+			codeare::matrix::simd::add (a, b, c, n);
+		}
 		inline T operator() (const T& x, const T& y) const {
 			return std::plus<T>()(x, y);
 		}
@@ -323,6 +330,12 @@ namespace codeare {
 		inline static reg_type packed (const reg_type& a, const reg_type& b) {
 			return VecTraits<T>::minus(a, b);
 		}
+		inline static void apply (const T* a, const T* b, T* c, const size_t n) {
+			codeare::matrix::simd::sub (a, b, c, n);
+		}
+		inline static void apply (const T* a, const T& b, T* c, const size_t n) {
+			codeare::matrix::simd::sub (a, b, c, n);
+		}
 		inline T operator() (const T& x, const T& y) const {
 			return std::minus<T>()(x, y);
 		}
@@ -336,6 +349,12 @@ namespace codeare {
         inline static reg_type packed (const reg_type& a, const reg_type& b) {
 			return VecTraits<T>::multiplies(a, b);
 		}
+		inline static void apply (const T* a, const T* b, T* c, const size_t n) {
+			codeare::matrix::simd::mul (a, b, c, n);
+		}
+		inline static void apply (const T* a, const T& b, T* c, const size_t n) {
+			codeare::matrix::simd::mul (a, b, c, n);
+		}
 		inline T operator() (const T& x, const T& y) const {
 			return std::multiplies<T>()(x, y);
 		}
@@ -349,6 +368,12 @@ namespace codeare {
 		inline static reg_type packed (const reg_type& a, const reg_type& b) {
 			return VecTraits<T>::divides(a, b);
 		}
+		inline static void apply (const T* a, const T* b, T* c, const size_t n) {
+			codeare::matrix::simd::div (a, b, c, n);
+		}
+		inline static void apply (const T* a, const T& b, T* c, const size_t n) {
+			codeare::matrix::simd::div (a, b, c, n);
+		}
 		inline T operator() (const T& x, const T& y) const {
 			return std::divides<T>()(x, y);
 		}
@@ -362,6 +387,9 @@ namespace codeare {
 		inline static reg_type packed (const reg_type& a) {
 			return VecTraits<T>::conjugate(a);
 		}
+		inline static void apply (const T* a, T* c, const size_t n) {
+			codeare::matrix::simd::conj (a, c, n);
+		}
 		T operator() (const T& x) const;
 	};
 	template<> inline float conjugate<float>::operator() (const float& f) const { return f; }
@@ -371,43 +399,26 @@ namespace codeare {
 }
 
 
+/**
+ * @brief   Elementwise c = op(a, b), c = op(a) and c = op(a, s). The kernels
+ *          are selected at run time for the CPU (see SIMDKernels.hpp).
+ */
 template<class T, class Op> 
-inline static void Vec (const Vector<T>& a, const Vector<T>& b, Vector<T>& c, const Op& op) {
-    typedef typename VecTraits<T>::reg_type reg_type;
-    const reg_type* va = (const reg_type*) &a[0];
-    const reg_type* vb = (const reg_type*) &b[0];
-    reg_type* vc = (reg_type*) &c[0];
-    int simd_n = std::floor(a.size()/VecTraits<T>::stride);
-    size_t start_r = simd_n*VecTraits<T>::stride;
-    for (size_t i = 0; i < simd_n; ++i)
-        vc[i] = op.packed(va[i], vb[i]);
-    std::transform(a.begin()+start_r, a.end(), b.begin()+start_r, c.begin()+start_r, op);
+inline static void Vec (const Vector<T>& a, const Vector<T>& b, Vector<T>& c, const Op&) {
+    if (a.size())
+        Op::apply (a.ptr(), b.ptr(), c.ptr(), a.size());
 }
 
 template<class T, class Op> 
-inline static void Vec (const Vector<T>& a, Vector<T>& c, const Op& op) {
-    typedef typename VecTraits<T>::reg_type reg_type;
-    const reg_type* va = (const reg_type*) &a[0];
-    reg_type* vc = (reg_type*) &c[0];
-    size_t simd_n = std::floor(a.size()/VecTraits<T>::stride),
-      start_r = simd_n*VecTraits<T>::stride;
-    for (size_t i = 0; i < simd_n; ++i)
-        vc[i] = op.packed(va[i]);
-    std::transform(a.begin()+start_r, a.end(), c.begin()+start_r, op);
+inline static void Vec (const Vector<T>& a, Vector<T>& c, const Op&) {
+    if (a.size())
+        Op::apply (a.ptr(), c.ptr(), a.size());
 }
 
 template<class T, class Op> 
-inline static void Vec (const Vector<T>& a, const T& b, Vector<T>& c, const Op& op) {
-    typedef typename VecTraits<T>::reg_type reg_type;
-    Vector<T> B (VecTraits<T>::stride,b);
-    const reg_type* va = (const reg_type*) &a[0];
-    const reg_type* vb = (const reg_type*) &B[0];
-    reg_type* vc = (reg_type*) &c[0];
-    size_t simd_n = std::floor(a.size()/VecTraits<T>::stride),
-      start_r = simd_n*VecTraits<T>::stride;
-    for (size_t i = 0; i < simd_n; ++i)
-        vc[i] = op.packed(va[i], *vb);
-    std::transform(a.begin()+start_r, a.end(), c.begin()+start_r, std::bind2nd(op,b));
+inline static void Vec (const Vector<T>& a, const T& b, Vector<T>& c, const Op&) {
+    if (a.size())
+        Op::apply (a.ptr(), b, c.ptr(), a.size());
 }
 
 #endif /* SRC_MATRIX_SIMDTRAITS_HPP_ */
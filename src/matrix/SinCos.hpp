@@ -0,0 +1,52 @@
+/*
+ *  codeare Copyright (C) 2010-2016
+ *                        Kaveh Vahedipour
+ *                        NYU School of Medicine, New York, USA
+ *
+ *  This program is free software; you can redistribute it and/or modify
+ *  it under the terms of the GNU General Public License as published by
+ *  the Free Software Foundation; either version 2 of the License, or
+ *  (at your option) any later version.
+ *
+ *  This program is distributed in the hope that it will be useful, but
+ *  WITHOUT ANY WARRANTY; without even the implied warranty of
+ *  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU
+ *  General Public License for more details.
+ *
+ *  You should have received a copy of the GNU General Public License
+ *  along with this program; if not, write to the Free Software
+ *  Foundation, Inc., 51 Franklin Street, Fifth Floor, Boston, MA
+ *  02110-1301  USA
+ */
+
+#ifndef __SINCOS_HPP__
+#define __SINCOS_HPP__
+
+#include "VecMath.hpp"
+
+using codeare::matrix::vmath::sincos_range;
+
+/**
+ * @brief   Sine and cosine of an array (single precision, fast variant:
+ *          Cephes' octant reduction and minimax polynomials, about 2 ulp on
+ *          |x| < sincos_range, libm beyond).
+ *
+ * @param  x   Arguments (n)
+ * @param  s   Sines (n)
+ * @param  c   Cosines (n)
+ * @param  n   Number of elements
+ */
+inline static void
+sincos (const float* x, float* s, float* c, const size_t n) {
+	codeare::matrix::vmath::sincos (x, s, c, n, codeare::matrix::vmath::FAST);
+}
+
+/**
+ * @brief   Sine and cosine of an array (double precision)
+ */
+inline static void
+sincos (const double* x, double* s, double* c, const size_t n) {
+	codeare::matrix::vmath::sincos (x, s, c, n);
+}
+
+#endif /* __SINCOS_HPP__ */
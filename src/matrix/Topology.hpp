@@ -0,0 +1,308 @@
+/*
+ *  codeare Copyright (C) 2010-2016
+ *                        Kaveh Vahedipour
+ *                        NYU School of Medicine, New York, USA
+ *
+ *  This program is free software; you can redistribute it and/or modify
+ *  it under the terms of the GNU General Public License as published by
+ *  the Free Software Foundation; either version 2 of the License, or
+ *  (at your option) any later version.
+ *
+ *  This program is distributed in the hope that it will be useful, but
+ *  WITHOUT ANY WARRANTY; without even the implied warranty of
+ *  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU
+ *  General Public License for more details.
+ *
+ *  You should have received a copy of the GNU General Public License
+ *  along with this program; if not, write to the Free Software
+ *  Foundation, Inc., 51 Franklin Street, Fifth Floor, Boston, MA
+ *  02110-1301  USA
+ */
+
+#ifndef __TOPOLOGY_HPP__
+#define __TOPOLOGY_HPP__
+
+#include <algorithm>
+#include <fstream>
+#include <iostream>
+#include <set>
+#include <sstream>
+#include <string>
+#include <thread>
+#include <vector>
+#include <stdint.h>
+
+#if defined (__linux__)
+#  include <dirent.h>
+#  include <sched.h>
+#  include <unistd.h>
+#  include <sys/syscall.h>
+#endif
+
+#if defined (_OPENMP)
+#  include <omp.h>
+#endif
+
+/**
+ * @brief   NUMA topology of the machine.<br/>
+ *
+ *          Nodes and their CPUs are read from /sys/devices/system/node, sockets
+ *          from the CPUs' physical package ids. Elsewhere, or if /sys is not
+ *          readable, the machine is one node of hardware_concurrency() CPUs.
+ *
+ *          Threads are laid out compactly over nodes: of nt threads, thread t
+ *          runs on node t*Nodes()/nt. Pin() and PinOpenMP() bind threads to
+ *          CPUs accordingly, Partition() places part t of a buffer on the node
+ *          of thread t, such that data and the threads working on them meet.
+ */
+class Topology {
+
+public:
+
+    /**
+     * @brief        Machine topology (discovered once)
+     */
+    static const Topology& Instance () {
+        static Topology topology;
+        return topology;
+    }
+
+    /**
+     * @brief        Number of NUMA nodes
+     */
+    inline size_t Nodes () const { return _cpus.size(); }
+
+    /**
+     * @brief        Number of sockets
+     */
+    inline size_t Sockets () const { return _sockets; }
+
+    /**
+     * @brief        Number of CPUs (hardware threads)
+     */
+    inline size_t CPUs () const {
+        size_t n = 0;
+        for (size_t i = 0; i < _cpus.size(); ++i)
+            n += _cpus[i].size();
+        return n;
+    }
+
+    /**
+     * @brief        CPUs of a node
+     */
+    inline const std::vector<int>& CPUs (const size_t node) const { return _cpus[node]; }
+
+    /**
+     * @brief        Node of thread t of nt
+     */
+    inline size_t NodeOfThread (const size_t t, const size_t nt) const {
+        return (nt > 0) ? std::min (t * Nodes() / nt, Nodes()-1) : 0;
+    }
+
+    /**
+     * @brief        CPU of thread t of nt
+     */
+    inline int CPUOfThread (const size_t t, const size_t nt) const {
+        const size_t node = NodeOfThread (t, nt), first = (node * nt + Nodes() - 1) / Nodes();
+        return _cpus[node][(t - first) % _cpus[node].size()];
+    }
+
+    /**
+     * @brief        Pin calling thread to the CPU of thread t of nt
+     *
+     * @return       Success
+     */
+    inline bool Pin (const size_t t, const size_t nt) const {
+#if defined (__linux__)
+        cpu_set_t set;
+        CPU_ZERO (&set);
+        CPU_SET (CPUOfThread (t, nt), &set);
+        return sched_setaffinity (0, sizeof(set), &set) == 0;
+#else
+        return false;
+#endif
+    }
+
+    /**
+     * @brief        Pin a team of nt OpenMP threads. As the OpenMP runtime keeps
+     *               its threads, subsequent parallel regions of up to nt threads
+     *               run pinned.
+     */
+    inline void PinOpenMP (const size_t nt) const {
+#pragma omp parallel num_threads (nt)
+        {
+#if defined (_OPENMP)
+            Pin (omp_get_thread_num(), nt);
+#else
+            Pin (0, 1);
+#endif
+        }
+    }
+
+    /**
+     * @brief        Interleave pages of a buffer over all nodes
+     *
+     * @param  p     Buffer
+     * @param  bytes Size
+     * @return       Success
+     */
+    inline bool Interleave (void* p, const size_t bytes) const {
+        std::vector<unsigned long> mask = Mask (Nodes(), 0);
+        return Policy (p, bytes, mpol_interleave, mask);
+    }
+
+    /**
+     * @brief        Bind (and move) pages of a buffer to a node
+     *
+     * @param  p     Buffer
+     * @param  bytes Size
+     * @param  node  Node
+     * @return       Success
+     */
+    inline bool Bind (void* p, const size_t bytes, const size_t node) const {
+        std::vector<unsigned long> mask = Mask (1, node);
+        return Policy (p, bytes, mpol_preferred, mask);
+    }
+
+    /**
+     * @brief        Split a buffer into parts equal chunks and place chunk t on the
+     *               node of thread t of parts (page granular)
+     *
+     * @param  p     Buffer
+     * @param  bytes Size
+     * @param  parts Number of parts (e.g. channels processed by one thread each)
+     */
+    inline void Partition (void* p, const size_t bytes, const size_t parts) const {
+        if (Nodes() < 2 || parts < 2)
+            return;
+        const size_t chunk = bytes / parts;
+        for (size_t t = 0; t < parts; ++t)
+            Bind ((char*)p + t*chunk, (t == parts-1) ? bytes - t*chunk : chunk, NodeOfThread (t, parts));
+    }
+
+    /**
+     * @brief        Print topology
+     */
+    void Report (std::ostream& os = std::cout) const {
+        os << "Topology: " << Sockets() << " socket(s), " << Nodes() << " node(s), "
+           << CPUs() << " CPU(s)" << std::endl;
+        for (size_t n = 0; n < Nodes(); ++n) {
+            os << "  node " << n << ":";
+            for (size_t c = 0; c < _cpus[n].size(); ++c)
+                os << " " << _cpus[n][c];
+            os << std::endl;
+        }
+    }
+
+    /**
+     * @brief        Parse Linux cpu list ("0-3,8,10-11")
+     */
+    static std::vector<int> ParseList (const std::string& list) {
+        std::vector<int> cpus;
+        std::stringstream ss (list);
+        std::string range;
+        while (std::getline (ss, range, ',')) {
+            if (range.find_first_of("0123456789") == std::string::npos)
+                continue;
+            int a = 0, b = 0;
+            size_t dash = range.find('-');
+            a = b = atoi (range.c_str());
+            if (dash != std::string::npos)
+                b = atoi (range.c_str() + dash + 1);
+            for (int c = a; c <= b; ++c)
+                cpus.push_back (c);
+        }
+        return cpus;
+    }
+
+private:
+
+    static const int mpol_preferred  = 1; /**< @brief MPOL_PREFERRED */
+    static const int mpol_interleave = 3; /**< @brief MPOL_INTERLEAVE */
+    static const unsigned mpol_mf_move = 2; /**< @brief MPOL_MF_MOVE */
+
+    Topology () : _sockets(1) {
+
+#if defined (__linux__)
+        const std::string root = "/sys/devices/system/node";
+        std::vector<size_t> ids;
+        if (DIR* dir = opendir (root.c_str())) {
+            while (struct dirent* e = readdir (dir)) {
+                std::string name (e->d_name);
+                if (name.compare (0, 4, "node") == 0 && name.size() > 4 &&
+                        name.find_first_not_of ("0123456789", 4) == std::string::npos)
+                    ids.push_back (atoi (name.c_str() + 4));
+            }
+            closedir (dir);
+        }
+        std::sort (ids.begin(), ids.end());
+        for (size_t i = 0; i < ids.size(); ++i) {
+            std::stringstream path;
+            path << root << "/node" << ids[i] << "/cpulist";
+            std::ifstream f (path.str().c_str());
+            std::string list;
+            std::getline (f, list);
+            std::vector<int> cpus = ParseList (list);
+            if (!cpus.empty()) {
+                _cpus.push_back (cpus);
+                _ids.push_back (ids[i]);
+            }
+        }
+
+        std::set<int> packages;
+        for (size_t n = 0; n < _cpus.size(); ++n)
+            for (size_t c = 0; c < _cpus[n].size(); ++c) {
+                std::stringstream path;
+                path << "/sys/devices/system/cpu/cpu" << _cpus[n][c] << "/topology/physical_package_id";
+                std::ifstream f (path.str().c_str());
+                int id;
+                if (f >> id)
+                    packages.insert (id);
+            }
+        _sockets = std::max (packages.size(), (size_t)1);
+#endif
+
+        if (_cpus.empty()) {
+            std::vector<int> cpus (std::max (std::thread::hardware_concurrency(), 1u));
+            for (size_t c = 0; c < cpus.size(); ++c)
+                cpus[c] = (int)c;
+            _cpus.push_back (cpus);
+            _ids.push_back (0);
+        }
+
+    }
+
+    inline std::vector<unsigned long> Mask (const size_t n, const size_t first) const {
+        const size_t bits = 8*sizeof(unsigned long), maxid = _ids.back() + 1;
+        std::vector<unsigned long> mask ((maxid + bits - 1) / bits, 0);
+        for (size_t i = first; i < first + n; ++i)
+            mask[_ids[i]/bits] |= 1ul << (_ids[i]%bits);
+        return mask;
+    }
+
+    /**
+     * @brief        mbind(2) on the page aligned interior of a buffer
+     */
+    inline bool Policy (void* p, const size_t bytes, const int mode,
+                        const std::vector<unsigned long>& mask) const {
+#if defined (__linux__) && defined (SYS_mbind)
+        if (Nodes() < 2)
+            return false;
+        const uintptr_t page = 4096, a = ((uintptr_t)p + page - 1) / page * page,
+            b = ((uintptr_t)p + bytes) / page * page;
+        if (b <= a)
+            return false;
+        return syscall (SYS_mbind, a, b - a, mode, &mask[0], 8*sizeof(unsigned long)*mask.size() + 1,
+                        mpol_mf_move) == 0;
+#else
+        return false;
+#endif
+    }
+
+    std::vector<std::vector<int> > _cpus; /**< @brief CPUs per node */
+    std::vector<size_t> _ids;             /**< @brief Kernel node ids */
+    size_t _sockets;                      /**< @brief # sockets */
+
+};
+
+#endif /* __TOPOLOGY_HPP__ */
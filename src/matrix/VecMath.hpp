@@ -0,0 +1,615 @@
+/*
+ *  codeare Copyright (C) 2010-2016
+ *                        Kaveh Vahedipour
+ *                        NYU School of Medicine, New York, USA
+ *
+ *  This program is free software; you can redistribute it and/or modify
+ *  it under the terms of the GNU General Public License as published by
+ *  the Free Software Foundation; either version 2 of the License, or
+ *  (at your option) any later version.
+ *
+ *  This program is distributed in the hope that it will be useful, but
+ *  WITHOUT ANY WARRANTY; without even the implied warranty of
+ *  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU
+ *  General Public License for more details.
+ *
+ *  You should have received a copy of the GNU General Public License
+ *  along with this program; if not, write to the Free Software
+ *  Foundation, Inc., 51 Franklin Street, Fifth Floor, Boston, MA
+ *  02110-1301  USA
+ */
+
+#ifndef __VECMATH_HPP__
+#define __VECMATH_HPP__
+
+#include "OMP.hpp"
+#include "CPUFeatures.hpp"
+
+#include <algorithm>
+#include <complex>
+#include <limits>
+#include <math.h>
+#include <stdint.h>
+#include <string.h>
+
+/**
+ * @brief   Vectorised elementwise math on arrays.<br/>
+ *
+ *          Branch free polynomial kernels (Cephes, fdlibm) written such that
+ *          the loops vectorise. Each kernel is compiled for SSE2, AVX2 and
+ *          AVX-512 and the widest one supported by the CPU is picked at run
+ *          time. Large arrays are split into chunks processed in parallel.
+ *          Kernels are elementwise, i.e. output may alias input.<br/>
+ *
+ *          ACCURATE: single precision is evaluated in double precision and
+ *          rounded (below 1 ulp); double precision kernels are below 2 ulp.
+ *          FAST: single precision polynomials in single precision (about
+ *          3 ulp, sin/cos absolute error of a few ulp of 1 for arguments
+ *          beyond 100), no overflow protection in abs. Double precision
+ *          kernels have one variant. Floating point exception flags are
+ *          not maintained.
+ */
+namespace codeare {
+namespace matrix {
+namespace vmath {
+
+enum Accuracy {ACCURATE, FAST};
+
+using codeare::matrix::ISA;
+using codeare::matrix::ISA_SSE2;
+using codeare::matrix::ISA_AVX2;
+using codeare::matrix::ISA_AVX512;
+using codeare::matrix::isa;
+
+/**
+ * @brief   Elements beyond which range reduction loses accuracy and libm is
+ *          used instead (fast single, accurate single/double).
+ */
+static const float  sincos_range   = 8192.f;
+static const double sincos_range_d = 1.0e7;
+
+/**
+ * Kernels do not raise floating point exceptions reliably; with trapping
+ * math, GCC refuses to if-convert their selects.
+ */
+#if defined(__GNUC__) && !defined(__clang__)
+#  pragma GCC push_options
+#  pragma GCC optimize ("no-trapping-math")
+#endif
+
+/**
+ * @name    Element kernels
+ */
+//@{
+CODEARE_INLINE static int32_t as_int    (const float x)   { int32_t i; memcpy (&i, &x, 4); return i; }
+CODEARE_INLINE static float   as_float  (const int32_t i) { float x;   memcpy (&x, &i, 4); return x; }
+CODEARE_INLINE static int64_t as_long   (const double x)  { int64_t i; memcpy (&i, &x, 8); return i; }
+CODEARE_INLINE static double  as_double (const int64_t i) { double x;  memcpy (&x, &i, 8); return x; }
+
+/**
+ * @brief   exp (fdlibm). Arguments are clamped such that the two step
+ *          scaling by 2^k over- and underflows like libm.
+ */
+CODEARE_INLINE static double exp_e (const double x) {
+	const double ln2hi = 6.93147180369123816490e-01, ln2lo = 1.90821492927058770002e-10,
+		invln2 = 1.44269504088896338700e+00,
+		P1 =  1.66666666666666019037e-01, P2 = -2.77777777770155933842e-03,
+		P3 =  6.61375632143793436117e-05, P4 = -1.65339022054652515390e-06,
+		P5 =  4.13813679705723846039e-08;
+	const double xl = (x < -760.) ? -760. : x, xc = (xl > 720.) ? 720. : xl;
+	const int32_t k = (int32_t) (invln2*xc + ((xc < 0.) ? -.5 : .5)), k1 = k >> 1, k2 = k - k1;
+	const double hi = xc - k*ln2hi, lo = k*ln2lo, r = hi - lo, rr = r*r;
+	const double c = r - rr*(P1 + rr*(P2 + rr*(P3 + rr*(P4 + rr*P5))));
+	const double y = 1. - ((lo - (r*c)/(2. - c)) - hi);
+	return y * as_double ((int64_t)((uint64_t)(k1 + 1023) << 52)) *
+		as_double ((int64_t)((uint64_t)(k2 + 1023) << 52));
+}
+
+/**
+ * @brief   exp (Cephes), clamped as above
+ */
+CODEARE_INLINE static float exp_e (const float x) {
+	const float xl = (x < -104.f) ? -104.f : x, xc = (xl > 89.f) ? 89.f : xl;
+	const int32_t k = (int32_t) (xc*1.44269504088896341f + ((xc < 0.f) ? -.5f : .5f)), k1 = k >> 1, k2 = k - k1;
+	const float n = (float) k;
+	const float r = (xc - n*0.693359375f) + n*2.12194440e-4f, rr = r*r;
+	const float p = (((((1.9875691500e-4f*r + 1.3981999507e-3f)*r + 8.3334519073e-3f)*r
+		+ 4.1665795894e-2f)*r + 1.6666665459e-1f)*r + 5.0000001201e-1f)*rr + r + 1.f;
+	return p * as_float ((int32_t)((uint32_t)(k1 + 127) << 23)) * as_float ((int32_t)((uint32_t)(k2 + 127) << 23));
+}
+
+/**
+ * @brief   log (fdlibm)
+ */
+CODEARE_INLINE static double log_e (const double x) {
+	const double ln2hi = 6.93147180369123816490e-01, ln2lo = 1.90821492927058770002e-10,
+		Lg1 = 6.666666666666735130e-01, Lg2 = 3.999999999940941908e-01, Lg3 = 2.857142874366239149e-01,
+		Lg4 = 2.222219843214978396e-01, Lg5 = 1.818357216161805012e-01, Lg6 = 1.531383769920937332e-01,
+		Lg7 = 1.479819860511658591e-01;
+	const bool sub = (x < 2.2250738585072014e-308);
+	const double xs = sub ? x * 18014398509481984. : x;               // 2^54
+	const int64_t ix = as_long (xs);
+	const uint32_t hx = (uint32_t)((uint64_t)ix >> 32) + (0x3ff00000 - 0x3fe6a09e);
+	const int32_t k = (int32_t)(hx >> 20) - 0x3ff - (sub ? 54 : 0);
+	const double m = as_double ((int64_t)(((uint64_t)((hx & 0x000fffff) + 0x3fe6a09e) << 32) |
+		((uint64_t)ix & 0xffffffffULL)));
+	const double f = m - 1., hfsq = .5*f*f, s = f/(2. + f), z = s*s, w = z*z;
+	const double R = z*(Lg1 + w*(Lg3 + w*(Lg5 + w*Lg7))) + w*(Lg2 + w*(Lg4 + w*Lg6)), dk = k;
+	const double l = s*(hfsq + R) + dk*ln2lo - hfsq + f + dk*ln2hi;
+	return (x == 0.) ? -HUGE_VAL : (x < 0. || x != x) ? std::numeric_limits<double>::quiet_NaN() :
+		(x == HUGE_VAL) ? x : l;
+}
+
+/**
+ * @brief   log (fdlibm)
+ */
+CODEARE_INLINE static float log_e (const float x) {
+	const float ln2hi = 6.9313812256e-01f, ln2lo = 9.0580006145e-06f,
+		Lg1 = 0.66666662693f, Lg2 = 0.40000972152f, Lg3 = 0.28498786688f, Lg4 = 0.24279078841f;
+	const bool sub = (x < 1.17549435e-38f);
+	const float xs = sub ? x * 33554432.f : x;                           // 2^25
+	const uint32_t ix = (uint32_t)as_int (xs) + (0x3f800000 - 0x3f3504f3);
+	const int32_t k = (int32_t)(ix >> 23) - 0x7f - (sub ? 25 : 0);
+	const float m = as_float ((int32_t)((ix & 0x007fffff) + 0x3f3504f3));
+	const float f = m - 1.f, s = f/(2.f + f), z = s*s, w = z*z;
+	const float R = z*(Lg1 + w*Lg3) + w*(Lg2 + w*Lg4), hfsq = .5f*f*f, dk = (float)k;
+	const float l = s*(hfsq + R) + dk*ln2lo - hfsq + f + dk*ln2hi;
+	return (x == 0.f) ? -HUGE_VALF : (x < 0.f || x != x) ? std::numeric_limits<float>::quiet_NaN() :
+		(x == HUGE_VALF) ? x : l;
+}
+
+/**
+ * @brief   sin and cos (Cephes), |x| < sincos_range_d
+ */
+CODEARE_INLINE static void sincos_e (const double x, double& s, double& c) {
+	const double DP1 = 7.85398125648498535156e-1, DP2 = 3.77489470793079817668e-8,
+		DP3 = 2.69515142907905952645e-15, FOPI = 1.27323954473516268615;
+	const double ax = fabs (x);
+	int32_t j = (int32_t)(ax*FOPI);
+	const int32_t odd = j & 1;
+	j = (j + odd) & 7;
+	const double y = (double)((int32_t)(ax*FOPI) + odd);
+	const double z = ((ax - y*DP1) - y*DP2) - y*DP3, zz = z*z;
+	const double ps = z + z*zz*(((((1.58962301576546568060e-10*zz - 2.50507477628578072866e-8)*zz
+		+ 2.75573136213857245213e-6)*zz - 1.98412698295895385996e-4)*zz + 8.33333333332211858878e-3)*zz
+		- 1.66666666666666307295e-1);
+	const double pc = 1. - .5*zz + zz*zz*(((((-1.13585365213876817300e-11*zz + 2.08757008419747316778e-9)*zz
+		- 2.75573141792967388112e-7)*zz + 2.48015872888517045348e-5)*zz - 1.38888888888730564116e-3)*zz
+		+ 4.16666666666665929218e-2);
+	const bool swap = (j == 2) || (j == 6);
+	const double sv = swap ? pc : ps, cv = swap ? ps : pc;
+	const double ss = (j >= 4) ? -sv : sv;
+	c = (j == 2 || j == 4) ? -cv : cv;
+	s = (x < 0.) ? -ss : ss;
+}
+
+/**
+ * @brief   sin and cos (Cephes, about 2 ulp), |x| < sincos_range
+ */
+CODEARE_INLINE static void sincos_e (const float x, float& s, float& c) {
+	const float fopi = 1.27323954473516f,
+		dp1 = 0.78515625f, dp2 = 2.4187564849853515625e-4f, dp3 = 3.77489497744594108e-8f;
+	const float ax = fabsf (x);
+	const int32_t j = ((int32_t)(ax * fopi) + 1) & ~1;
+	const float y = (float) j;
+	const float r = ((ax - y*dp1) - y*dp2) - y*dp3, z = r*r;
+	const float ps = ((-1.9515295891e-4f*z + 8.3321608736e-3f)*z - 1.6666654611e-1f)*z*r + r;
+	const float pc = ((2.443315711809948e-5f*z - 1.388731625493765e-3f)*z + 4.166664568298827e-2f)*z*z
+		- .5f*z + 1.f;
+	const int32_t q = j & 7;
+	const bool swap = (q == 2) || (q == 6);
+	const float sv = swap ? pc : ps, cv = swap ? ps : pc;
+	const float ss = (q >= 4) ? -sv : sv;
+	c = (q == 2 || q == 4) ? -cv : cv;
+	s = (x < 0.f) ? -ss : ss;
+}
+
+/**
+ * @brief   atan on [0,1] (Cephes)
+ */
+CODEARE_INLINE static double atan01_e (const double a) {
+	const bool red = (a > 0.66);
+	const double t = (a - 1.)/(a + 1.), x = red ? t : a, z = x*x;
+	const double p = ((((-8.750608600031904122785e-1*z - 1.615753718733365076637e1)*z
+		- 7.500855792314704667340e1)*z - 1.228866684490136173410e2)*z - 6.485021904942025371773e1);
+	const double q = (((((z + 2.485846490142306297962e1)*z + 1.650270098316988542046e2)*z
+		+ 4.328810604912902668951e2)*z + 4.853903996359136964868e2)*z + 1.945506571482613964425e2);
+	const double r = x*z*p/q + x;
+	return red ? 7.85398163397448309616e-1 + (r + .5*6.123233995736765886130e-17) : r;
+}
+
+/**
+ * @brief   atan on [0,1] (Cephes)
+ */
+CODEARE_INLINE static float atan01_e (const float a) {
+	const bool red = (a > 0.4142135623730950f);
+	const float t = (a - 1.f)/(a + 1.f), x = red ? t : a, z = x*x;
+	const float r = (((8.05374449538e-2f*z - 1.38776856032e-1f)*z + 1.99777106478e-1f)*z
+		- 3.33329491539e-1f)*z*x + x;
+	return red ? 0.785398163397448309616f + r : r;
+}
+
+/**
+ * @brief   Sign bit set (also for -0 and -NaN)
+ */
+CODEARE_INLINE static bool negative (const float x)  { return as_int (x) < 0; }
+CODEARE_INLINE static bool negative (const double x) { return as_long (x) < 0; }
+CODEARE_INLINE static float  abs_e (const float x)  { return fabsf (x); }
+CODEARE_INLINE static double abs_e (const double x) { return fabs (x); }
+
+/**
+ * @brief   atan2 from atan on [0,1]. NaN propagates through the reduction.
+ *          Not a template: instantiation would happen outside the options
+ *          pushed above.
+ */
+#define VMATH_ATAN2_E(T)                                                \
+	CODEARE_INLINE static T atan2_e (const T y, const T x) {              \
+		const T ax = abs_e (x), ay = abs_e (y), mx = (ay > ax) ? ay : ax, mn = (ay > ax) ? ax : ay; \
+		const T q = mn/mx, a1 = (mx == mn) ? T(1) : q, a = (mx == T(0)) ? T(0) : a1; \
+		const T r = atan01_e (a), r1 = (ay > ax) ? T(1.57079632679489661923) - r : r; \
+		const T r2 = negative (x) ? T(3.14159265358979323846) - r1 : r1; \
+		return negative (y) ? -r2 : r2;                                 \
+	}
+VMATH_ATAN2_E (float)
+VMATH_ATAN2_E (double)
+#undef VMATH_ATAN2_E
+
+/**
+ * @brief   |z| without overflow by exact power of 2 scaling
+ */
+CODEARE_INLINE static double hypot_e (const double re, const double im) {
+	const double ar = fabs (re), ai = fabs (im), mx = (ar > ai) ? ar : ai;
+	const int64_t e = (as_long (mx) >> 52) & 0x7ff, ec = (e > 2045) ? 2045 : e, es = (e == 0) ? 423 : ec;  // 2^-600
+	const double down = as_double ((2046 - es) << 52), up = as_double (es << 52);
+	const double a = ar*down, b = ai*down;
+	const double h = sqrt (a*a + b*b) * up;
+	const bool inf = (ar == HUGE_VAL) | (ai == HUGE_VAL);
+	return inf ? HUGE_VAL : h;
+}
+//@}
+
+
+/**
+ * @name    Array kernels (inlined into one function per instruction set)
+ */
+//@{
+CODEARE_INLINE static void exp_k (const double* x, double* y, const size_t n, const Accuracy) {
+#pragma omp simd
+	for (size_t i = 0; i < n; ++i)
+		y[i] = exp_e (x[i]);
+}
+CODEARE_INLINE static void exp_k (const float* x, float* y, const size_t n, const Accuracy a) {
+	if (a == FAST) {
+#pragma omp simd
+		for (size_t i = 0; i < n; ++i)
+			y[i] = exp_e (x[i]);
+	} else {
+#pragma omp simd
+		for (size_t i = 0; i < n; ++i)
+			y[i] = (float) exp_e ((double)x[i]);
+	}
+}
+
+CODEARE_INLINE static void log_k (const double* x, double* y, const size_t n, const Accuracy) {
+#pragma omp simd
+	for (size_t i = 0; i < n; ++i)
+		y[i] = log_e (x[i]);
+}
+CODEARE_INLINE static void log_k (const float* x, float* y, const size_t n, const Accuracy a) {
+	if (a == FAST) {
+#pragma omp simd
+		for (size_t i = 0; i < n; ++i)
+			y[i] = log_e (x[i]);
+	} else {
+#pragma omp simd
+		for (size_t i = 0; i < n; ++i)
+			y[i] = (float) log_e ((double)x[i]);
+	}
+}
+
+/**
+ * @brief   sin and cos; either output may be 0
+ */
+CODEARE_INLINE static void sincos_k (const double* x, double* s, double* c, const size_t n, const Accuracy) {
+	int big = 0;
+	if (s && c) {
+#pragma omp simd reduction (+:big)
+		for (size_t i = 0; i < n; ++i) {
+			big += (fabs (x[i]) >= sincos_range_d);
+			sincos_e (x[i], s[i], c[i]);
+		}
+	} else if (s) {
+#pragma omp simd reduction (+:big)
+		for (size_t i = 0; i < n; ++i) {
+			double cv;
+			big += (fabs (x[i]) >= sincos_range_d);
+			sincos_e (x[i], s[i], cv);
+		}
+	} else {
+#pragma omp simd reduction (+:big)
+		for (size_t i = 0; i < n; ++i) {
+			double sv;
+			big += (fabs (x[i]) >= sincos_range_d);
+			sincos_e (x[i], sv, c[i]);
+		}
+	}
+	if (big)
+		for (size_t i = 0; i < n; ++i)
+			if (!(fabs (x[i]) < sincos_range_d)) {
+				if (s) s[i] = ::sin (x[i]);
+				if (c) c[i] = ::cos (x[i]);
+			}
+}
+CODEARE_INLINE static int sincos_f (const float* x, float* s, float* c, const size_t n, const float range,
+								  const bool dbl, const bool ws, const bool wc) {
+	int big = 0;
+#pragma omp simd reduction (+:big)
+	for (size_t i = 0; i < n; ++i) {
+		float sv, cv;
+		big += (fabsf (x[i]) >= range);
+		if (dbl) {
+			double sd, cd;
+			sincos_e ((double)x[i], sd, cd);
+			sv = (float)sd;
+			cv = (float)cd;
+		} else
+			sincos_e (x[i], sv, cv);
+		if (ws) s[i] = sv;
+		if (wc) c[i] = cv;
+	}
+	return big;
+}
+CODEARE_INLINE static void sincos_k (const float* x, float* s, float* c, const size_t n, const Accuracy a) {
+	int big;
+	const float range = (a == FAST) ? sincos_range : (float)sincos_range_d;
+	if (a == FAST)
+		big = (s && c) ? sincos_f (x, s, c, n, range, false, true, true) :
+			s ? sincos_f (x, s, c, n, range, false, true, false) : sincos_f (x, s, c, n, range, false, false, true);
+	else
+		big = (s && c) ? sincos_f (x, s, c, n, range, true, true, true) :
+			s ? sincos_f (x, s, c, n, range, true, true, false) : sincos_f (x, s, c, n, range, true, false, true);
+	if (big)
+		for (size_t i = 0; i < n; ++i)
+			if (!(fabsf (x[i]) < range)) {
+				if (s) s[i] = sinf (x[i]);
+				if (c) c[i] = cosf (x[i]);
+			}
+}
+
+CODEARE_INLINE static void atan2_k (const double* y, const double* x, double* r, const size_t n, const Accuracy) {
+#pragma omp simd
+	for (size_t i = 0; i < n; ++i)
+		r[i] = atan2_e (y[i], x[i]);
+}
+CODEARE_INLINE static void atan2_k (const float* y, const float* x, float* r, const size_t n, const Accuracy a) {
+	if (a == FAST) {
+#pragma omp simd
+		for (size_t i = 0; i < n; ++i)
+			r[i] = atan2_e (y[i], x[i]);
+	} else {
+#pragma omp simd
+		for (size_t i = 0; i < n; ++i)
+			r[i] = (float) atan2_e ((double)y[i], (double)x[i]);
+	}
+}
+
+/**
+ * @brief   mag * (cos phi + i sin phi) into interleaved z; mag 0: m0
+ */
+template<class T> CODEARE_INLINE static void
+polar_k (const T* mag, const T m0, const T* phi, T* z, const size_t n, const Accuracy a) {
+	const size_t b = 256;
+	T s[b], c[b];
+	for (size_t i0 = 0; i0 < n; i0 += b) {
+		const size_t m = std::min (b, n - i0);
+		sincos_k (phi + i0, s, c, m, a);
+		T* zi = z + 2*i0;
+		if (mag) {
+			const T* mi = mag + i0;
+#pragma omp simd
+			for (size_t i = 0; i < m; ++i) {
+				zi[2*i]   = mi[i]*c[i];
+				zi[2*i+1] = mi[i]*s[i];
+			}
+		} else {
+#pragma omp simd
+			for (size_t i = 0; i < m; ++i) {
+				zi[2*i]   = m0*c[i];
+				zi[2*i+1] = m0*s[i];
+			}
+		}
+	}
+}
+
+/**
+ * @brief   exp of interleaved complex z
+ */
+template<class T> CODEARE_INLINE static void
+cexp_k (const T* z, T* r, const size_t n, const Accuracy a) {
+	const size_t b = 256;
+	T re[b], im[b];
+	for (size_t i0 = 0; i0 < n; i0 += b) {
+		const size_t m = std::min (b, n - i0);
+		const T* zi = z + 2*i0;
+#pragma omp simd
+		for (size_t i = 0; i < m; ++i) {
+			re[i] = zi[2*i];
+			im[i] = zi[2*i+1];
+		}
+		exp_k (re, re, m, a);
+		polar_k (re, T(0), im, r + 2*i0, m, a);
+	}
+}
+
+/**
+ * @brief   |z| and/or arg z of interleaved complex z; either output may be 0
+ */
+CODEARE_INLINE static void absarg_k (const double* z, double* m, double* p, const size_t n, const Accuracy a) {
+	if (m) {
+		if (a == FAST) {
+#pragma omp simd
+			for (size_t i = 0; i < n; ++i)
+				m[i] = sqrt (z[2*i]*z[2*i] + z[2*i+1]*z[2*i+1]);
+		} else {
+#pragma omp simd
+			for (size_t i = 0; i < n; ++i)
+				m[i] = hypot_e (z[2*i], z[2*i+1]);
+		}
+	}
+	if (p) {
+#pragma omp simd
+		for (size_t i = 0; i < n; ++i)
+			p[i] = atan2_e (z[2*i+1], z[2*i]);
+	}
+}
+CODEARE_INLINE static void absarg_k (const float* z, float* m, float* p, const size_t n, const Accuracy a) {
+	if (a == FAST) {
+		if (m) {
+#pragma omp simd
+			for (size_t i = 0; i < n; ++i)
+				m[i] = sqrtf (z[2*i]*z[2*i] + z[2*i+1]*z[2*i+1]);
+		}
+		if (p) {
+#pragma omp simd
+			for (size_t i = 0; i < n; ++i)
+				p[i] = atan2_e (z[2*i+1], z[2*i]);
+		}
+	} else {
+		if (m) {
+#pragma omp simd
+			for (size_t i = 0; i < n; ++i) {
+				const double re = z[2*i], im = z[2*i+1];
+				const bool inf = (fabs (re) == HUGE_VAL) | (fabs (im) == HUGE_VAL);
+				m[i] = inf ? HUGE_VALF : (float) sqrt (re*re + im*im);
+			}
+		}
+		if (p) {
+#pragma omp simd
+			for (size_t i = 0; i < n; ++i)
+				p[i] = (float) atan2_e ((double)z[2*i+1], (double)z[2*i]);
+		}
+	}
+}
+//@}
+
+
+#define VMATH_DISPATCH_T(T)                                             \
+	CODEARE_DISPATCH (exp, (const T* x, T* y, const size_t n, const Accuracy a), (x, y, n, a)) \
+	CODEARE_DISPATCH (log, (const T* x, T* y, const size_t n, const Accuracy a), (x, y, n, a)) \
+	CODEARE_DISPATCH (sincos, (const T* x, T* s, T* c, const size_t n, const Accuracy a), (x, s, c, n, a)) \
+	CODEARE_DISPATCH (atan2, (const T* y, const T* x, T* r, const size_t n, const Accuracy a), (y, x, r, n, a)) \
+	CODEARE_DISPATCH (polar, (const T* m, const T m0, const T* p, T* z, const size_t n, const Accuracy a), (m, m0, p, z, n, a)) \
+	CODEARE_DISPATCH (cexp, (const T* z, T* r, const size_t n, const Accuracy a), (z, r, n, a)) \
+	CODEARE_DISPATCH (absarg, (const T* z, T* m, T* p, const size_t n, const Accuracy a), (z, m, p, n, a))
+
+VMATH_DISPATCH_T (float)
+VMATH_DISPATCH_T (double)
+
+#if defined(__GNUC__) && !defined(__clang__)
+#  pragma GCC pop_options
+#endif
+
+#undef VMATH_DISPATCH_T
+
+
+/**
+ * @brief   Apply f(i0, i1) to chunks of [0,n), in parallel for large n
+ */
+template<class F> inline static void chunked (const size_t n, F f) {
+	const size_t c = 8192;
+	if (n <= 2*c) {
+		f (0, n);
+		return;
+	}
+#pragma omp parallel for schedule (static)
+	for (long b = 0; b < (long)((n + c - 1)/c); ++b)
+		f (b*c, std::min (n, (b+1)*c));
+}
+
+
+/**
+ * @name    Array functions. Generic types fall back to the standard library.
+ */
+//@{
+template<class T> inline static void exp (const T* x, T* y, const size_t n, const Accuracy = ACCURATE) {
+	chunked (n, [=](size_t i0, size_t i1) { for (size_t i = i0; i < i1; ++i) y[i] = std::exp (x[i]); });
+}
+template<class T> inline static void log (const T* x, T* y, const size_t n, const Accuracy = ACCURATE) {
+	chunked (n, [=](size_t i0, size_t i1) { for (size_t i = i0; i < i1; ++i) y[i] = std::log (x[i]); });
+}
+template<class T> inline static void sin (const T* x, T* y, const size_t n, const Accuracy = ACCURATE) {
+	chunked (n, [=](size_t i0, size_t i1) { for (size_t i = i0; i < i1; ++i) y[i] = std::sin (x[i]); });
+}
+template<class T> inline static void cos (const T* x, T* y, const size_t n, const Accuracy = ACCURATE) {
+	chunked (n, [=](size_t i0, size_t i1) { for (size_t i = i0; i < i1; ++i) y[i] = std::cos (x[i]); });
+}
+template<class T> inline static void polar (const T* mag, const T* phi, std::complex<T>* z, const size_t n,
+										  const Accuracy = ACCURATE) {
+	chunked (n, [=](size_t i0, size_t i1) { for (size_t i = i0; i < i1; ++i) z[i] = std::polar (mag[i], phi[i]); });
+}
+template<class T> inline static void polar (const T mag, const T* phi, std::complex<T>* z, const size_t n,
+										  const Accuracy = ACCURATE) {
+	chunked (n, [=](size_t i0, size_t i1) { for (size_t i = i0; i < i1; ++i) z[i] = std::polar (mag, phi[i]); });
+}
+
+#define VMATH_ARRAY_T(T)                                                \
+	inline static void exp (const T* x, T* y, const size_t n, const Accuracy a = ACCURATE) { \
+		chunked (n, [=](size_t i0, size_t i1) { exp_isa (x+i0, y+i0, i1-i0, a); }); \
+	}                                                                   \
+	inline static void log (const T* x, T* y, const size_t n, const Accuracy a = ACCURATE) { \
+		chunked (n, [=](size_t i0, size_t i1) { log_isa (x+i0, y+i0, i1-i0, a); }); \
+	}                                                                   \
+	inline static void sin (const T* x, T* y, const size_t n, const Accuracy a = ACCURATE) { \
+		chunked (n, [=](size_t i0, size_t i1) { sincos_isa (x+i0, y+i0, (T*)0, i1-i0, a); }); \
+	}                                                                   \
+	inline static void cos (const T* x, T* y, const size_t n, const Accuracy a = ACCURATE) { \
+		chunked (n, [=](size_t i0, size_t i1) { sincos_isa (x+i0, (T*)0, y+i0, i1-i0, a); }); \
+	}                                                                   \
+	inline static void sincos (const T* x, T* s, T* c, const size_t n, const Accuracy a = ACCURATE) { \
+		chunked (n, [=](size_t i0, size_t i1) { sincos_isa (x+i0, s+i0, c+i0, i1-i0, a); }); \
+	}                                                                   \
+	inline static void atan2 (const T* y, const T* x, T* r, const size_t n, const Accuracy a = ACCURATE) { \
+		chunked (n, [=](size_t i0, size_t i1) { atan2_isa (y+i0, x+i0, r+i0, i1-i0, a); }); \
+	}                                                                   \
+	/** @brief z = mag (cos phi + i sin phi) */                         \
+	inline static void polar (const T* mag, const T* phi, std::complex<T>* z, const size_t n, \
+							  const Accuracy a = ACCURATE) {            \
+		chunked (n, [=](size_t i0, size_t i1) {                         \
+				polar_isa (mag+i0, T(0), phi+i0, (T*)(z+i0), i1-i0, a); }); \
+	}                                                                   \
+	inline static void polar (const T mag, const T* phi, std::complex<T>* z, const size_t n, \
+							  const Accuracy a = ACCURATE) {            \
+		chunked (n, [=](size_t i0, size_t i1) {                         \
+				polar_isa ((const T*)0, mag, phi+i0, (T*)(z+i0), i1-i0, a); }); \
+	}                                                                   \
+	/** @brief z = cos phi + i sin phi */                               \
+	inline static void cis (const T* phi, std::complex<T>* z, const size_t n, const Accuracy a = ACCURATE) { \
+		polar (T(1), phi, z, n, a);                                     \
+	}                                                                   \
+	inline static void exp (const std::complex<T>* z, std::complex<T>* r, const size_t n, \
+							const Accuracy a = ACCURATE) {              \
+		chunked (n, [=](size_t i0, size_t i1) {                         \
+				cexp_isa ((const T*)(z+i0), (T*)(r+i0), i1-i0, a); });  \
+	}                                                                   \
+	/** @brief |z| and arg z in one sweep; either output may be 0 */    \
+	inline static void absarg (const std::complex<T>* z, T* m, T* p, const size_t n, \
+							   const Accuracy a = ACCURATE) {           \
+		chunked (n, [=](size_t i0, size_t i1) {                         \
+				absarg_isa ((const T*)(z+i0), m ? m+i0 : m, p ? p+i0 : p, i1-i0, a); }); \
+	}                                                                   \
+	inline static void abs (const std::complex<T>* z, T* m, const size_t n, const Accuracy a = ACCURATE) { \
+		absarg (z, m, (T*)0, n, a);                                     \
+	}                                                                   \
+	inline static void arg (const std::complex<T>* z, T* p, const size_t n, const Accuracy a = ACCURATE) { \
+		absarg (z, (T*)0, p, n, a);                                     \
+	}
+
+VMATH_ARRAY_T (float)
+VMATH_ARRAY_T (double)
+
+#undef VMATH_ARRAY_T
+//@}
+
+}}}
+
+#endif /* __VECMATH_HPP__ */
@@ -9,6 +9,7 @@
 #define __VECTOR_HPP__
 
 #include "Complex.hpp"
+#include "SIMDKernels.hpp"
 
 #include <iostream>
 #include <assert.h>
@@ -46,11 +47,9 @@ extern "C" inline long _ftol( double d) { return (long) d;}
 #        define VECTOR_CONSTR(A,B) std::valarray<A>(B)
 #    else
 #        include "Allocator.hpp"
-#        if defined __AVX__
-#            define ALIGNEMENT 32
-#        else
-#            define ALIGNEMENT 16
-#        endif
+/* Widest vector register (AVX-512) and cache line, independent of the
+   instruction set compiled for, as kernels are selected at run time */
+#        define ALIGNEMENT 64
 #        define VECTOR_TYPE(A) std::vector<A,Allocator<A,ALIGNEMENT> >
 #        define VECTOR_CONSTR(A,B) std::vector<A,Allocator<A,ALIGNEMENT> >(B)
 #        define VECTOR_CONSTR_VAL(A,B,C) std::vector<A,Allocator<A,ALIGNEMENT> >(B,C)
@@ -378,13 +377,13 @@ template<class T> inline static T prod (const Vector<T>& ct) NOEXCEPT {
 	return std::accumulate(ct.begin(), ct.end(), (T)1, multiply<T>);
 }
 template<class T> inline static T sum (const Vector<T>& ct) NOEXCEPT {
-	return std::accumulate(ct.begin(), ct.end(), (T)0);
+	return ct.size() ? codeare::matrix::simd::sum(ct.ptr(), ct.size()) : (T)0;
 }
 template<class T> inline static T max (const Vector<T>& ct) NOEXCEPT {
-	return *std::max_element(ct.begin(), ct.end());
+	return codeare::matrix::simd::max(ct.ptr(), ct.size());
 }
 template<class T> inline static T min (const Vector<T>& ct) NOEXCEPT {
-	return *std::max_element(ct.begin(), ct.end());
+	return codeare::matrix::simd::min(ct.ptr(), ct.size());
 }
 
 template<class T> inline static void swapd (T& x,T& y) NOEXCEPT {T temp=x; x=y; y=temp;}
@@ -1,6 +1,7 @@
 #ifndef __VIEW_HPP__
 #define __VIEW_HPP__
 
+#include <algorithm>
 #include <type_traits>
 #include <string>
 #include <vector>
@@ -46,16 +47,35 @@ private:
 	Vector<size_t> _dim;
 };
 
+/**
+ * @brief   View on a matrix.<br/>
+ *          Held as element offset plus extent and stride per non-singleton
+ *          range, i.e. constructed in O(ndims) without per-element tables.
+ *          Ranges adjacent in memory are fused, such that bulk operations
+ *          work on runs along the innermost range (memcpy for unit stride,
+ *          vectorised loops otherwise) threaded over the outer runs.
+ *          Index vector ranges (gather/scatter) keep per-range offset tables.
+ */
 template<class T, bool is_const = true> class View : public MatrixType<T> {
+
+    /**
+     * @brief Loop over one (fused) range
+     */
+    struct Loop {
+        size_t n;                 /**< @brief Extent */
+        long step;                /**< @brief Stride in elements */
+        std::vector<long> idx;    /**< @brief Element offsets (gather/scatter only) */
+    };
+
 public:
     
     typedef typename std::conditional<is_const, const Matrix<T>, Matrix<T> >::type MatrixTypeType;
     typedef typename std::conditional<is_const, const T, T>::type Type;
     
-    inline View () : _matrix(0) {}
+    inline View () : _matrix(0), _offset(0), _size(0) {}
 
     inline View (MatrixTypeType* matrix, Vector<Range<is_const> >& range) :
-        _matrix(matrix), _range(range) {
+        _matrix(matrix), _range(range), _offset(0), _size(1) {
         assert (_range.size());
         if (_range.size() == 1) {
         	if (!_range[0].IsSingleton()) {
@@ -72,74 +92,30 @@ public:
 				}
 			}
         }
-        if (_range.size() == 1)
-            for (size_t n0 = 0; n0 < _range[0].Size(); ++n0)
-                _pointers.push_back(matrix->Ptr()+_range[0][n0]);
-        else if (_range.size() == 2)
-            for (size_t n1 = 0; n1 < _range[1].Size(); ++n1)
-                for (size_t n0 = 0; n0 < _range[0].Size(); ++n0)
-                    _pointers.push_back(&((*_matrix)(_range[0][n0],_range[1][n1])));
-        else if (_range.size() == 3)
-            for (size_t n2 = 0; n2 < _range[2].Size(); ++n2)
-                for (size_t n1 = 0; n1 < _range[1].Size(); ++n1)
-                    for (size_t n0 = 0; n0 < _range[0].Size(); ++n0)
-                        _pointers.push_back(&((*_matrix)(_range[0][n0],_range[1][n1],_range[2][n2])));
-        else if (_range.size() == 4)
-            for (size_t n3 = 0; n3 < _range[3].Size(); ++n3)
-                for (size_t n2 = 0; n2 < _range[2].Size(); ++n2)
-                    for (size_t n1 = 0; n1 < _range[1].Size(); ++n1)
-                        for (size_t n0 = 0; n0 < _range[0].Size(); ++n0)
-                            _pointers.push_back(&((*_matrix)
-                                                  (_range[0][n0],_range[1][n1],
-                                                   _range[2][n2],_range[3][n3])));
-        else if (_range.size() == 5)
-            for (size_t n4 = 0; n4 < _range[4].Size(); ++n4)
-                for (size_t n3 = 0; n3 < _range[3].Size(); ++n3)
-                    for (size_t n2 = 0; n2 < _range[2].Size(); ++n2)
-                        for (size_t n1 = 0; n1 < _range[1].Size(); ++n1)
-                            for (size_t n0 = 0; n0 < _range[0].Size(); ++n0)
-                                _pointers.push_back(&((*_matrix)
-                                                      (_range[0][n0],_range[1][n1],
-                                                       _range[2][n2],_range[3][n3],
-                                                       _range[4][n4])));
-        else if (_range.size() == 6)
-            for (size_t n5 = 0; n5 < _range[5].Size(); ++n5)
-                for (size_t n4 = 0; n4 < _range[4].Size(); ++n4)
-                    for (size_t n3 = 0; n3 < _range[3].Size(); ++n3)
-                        for (size_t n2 = 0; n2 < _range[2].Size(); ++n2)
-                            for (size_t n1 = 0; n1 < _range[1].Size(); ++n1)
-                                for (size_t n0 = 0; n0 < _range[0].Size(); ++n0)
-                                    _pointers.push_back(&((*_matrix)
-                                                          (_range[0][n0],_range[1][n1],
-                                                           _range[2][n2],_range[3][n3],
-                                                           _range[4][n4],_range[5][n5])));
-        else if (_range.size() == 7)
-            for (size_t n6 = 0; n6 < _range[6].Size(); ++n6)
-                for (size_t n5 = 0; n5 < _range[5].Size(); ++n5)
-                    for (size_t n4 = 0; n4 < _range[4].Size(); ++n4)
-                        for (size_t n3 = 0; n3 < _range[3].Size(); ++n3)
-                            for (size_t n2 = 0; n2 < _range[2].Size(); ++n2)
-                                for (size_t n1 = 0; n1 < _range[1].Size(); ++n1)
-                                    for (size_t n0 = 0; n0 < _range[0].Size(); ++n0)
-                                        _pointers.push_back(&((*_matrix)
-                                                              (_range[0][n0],_range[1][n1],
-                                                               _range[2][n2],_range[3][n3],
-                                                               _range[4][n4],_range[5][n5],
-                                                               _range[6][n6])));
-        else if (_range.size() == 8)
-            for (size_t n7 = 0; n7 < _range[7].Size(); ++n7)
-                for (size_t n6 = 0; n6 < _range[6].Size(); ++n6)
-                    for (size_t n5 = 0; n5 < _range[5].Size(); ++n5)
-                        for (size_t n4 = 0; n4 < _range[4].Size(); ++n4)
-                            for (size_t n3 = 0; n3 < _range[3].Size(); ++n3)
-                                for (size_t n2 = 0; n2 < _range[2].Size(); ++n2)
-                                    for (size_t n1 = 0; n1 < _range[1].Size(); ++n1)
-                                        for (size_t n0 = 0; n0 < _range[0].Size(); ++n0)
-                                            _pointers.push_back(&((*_matrix)
-                                                                  (_range[0][n0],_range[1][n1],
-                                                                   _range[2][n2],_range[3][n3],
-                                                                   _range[4][n4],_range[5][n5],
-                                                                   _range[6][n6],_range[7][n7])));
+
+        // Offset, extents and strides; one range addresses linear indices
+        size_t ms = 1;
+        for (size_t i = 0; i < _range.size(); ++i) {
+            const Range<is_const>& r = _range[i];
+            const size_t ext = (_range.size() == 1) ? _matrix->Size() : _matrix->Dim(i);
+            assert (r[0] < ext && r[r.Size()-1] < ext);
+            if (r.IsSingleton())
+                _offset += r[0]*ms;
+            else if (r.IsStrided()) {
+                _offset += r.Begin()*ms;
+                Fuse (r.Size(), r.Stride()*(long)ms);
+            } else {
+                Loop l;
+                l.n = r.Size();
+                l.step = 0;
+                l.idx.resize(l.n);
+                for (size_t j = 0; j < l.n; ++j)
+                    l.idx[j] = r[j]*ms;
+                _loops.push_back(l);
+            }
+            _size *= r.Size();
+            ms *= ext;
+        }
         
         for (auto it = _range.begin(); it != _range.end();) {
             _dim.push_back(it->Size());
@@ -153,122 +129,312 @@ public:
     
     operator Matrix<T>() const {
         Matrix<T> res (_dim);
-        for (size_t i = 0; i < Size(); ++i)
-            res[i] = *(_pointers[i]);
-            return res;
+        T* r = res.Ptr();
+        Runs ([r](Type* p, const size_t pos, const size_t n, const long s) {
+                if (s == 1)
+                    std::copy (p, p+n, r+pos);
+                else
+                    for (size_t i = 0; i < n; ++i)
+                        r[pos+i] = p[(long)i*s];
+            });
+        return res;
     }
     
     template<class S> inline View& operator= (const Matrix<S>& M) {
         assert (Size() == M.Size());
-        for (size_t i = 0; i < Size(); ++i)
-            *(_pointers[i]) = M[i];
+        const S* m = M.Ptr();
+        Runs ([m](Type* p, const size_t pos, const size_t n, const long s) {
+                for (size_t i = 0; i < n; ++i)
+                    p[(long)i*s] = m[pos+i];
+            });
         return *this;
     }
         
     inline virtual const T& operator[] (const size_t& pos) const {
         assert(pos < Size());
-        return *(_pointers[pos]);
+        size_t q = pos;
+        long off = _offset;
+        for (size_t d = 0; d < _loops.size(); ++d) {
+            const Loop& l = _loops[d];
+            const size_t i = q % l.n;
+            q /= l.n;
+            off += l.idx.empty() ? (long)i*l.step : l.idx[i];
+        }
+        return _matrix->Ptr()[off];
     }
 
     template<class S> inline Matrix<T> operator* (const MatrixType<S>& d) const {
         assert (Size() == d.Size());
         Matrix<T> M(_dim);
-        for (size_t i = 0; i < Size(); ++i)
-            M[i] = *(_pointers[i])*d[i];
+        T* r = M.Ptr();
+        Runs ([r,&d](Type* p, const size_t pos, const size_t n, const long s) {
+                long t;
+                if (const S* q = Source (d, pos, n, t))
+                    for (size_t i = 0; i < n; ++i)
+                        r[pos+i] = p[(long)i*s]*q[(long)i*t];
+                else
+                    for (size_t i = 0; i < n; ++i)
+                        r[pos+i] = p[(long)i*s]*d[pos+i];
+            });
         return M;
     }
     template<class S> inline MatrixType<T>& operator*= (const MatrixType<S>& d)  {
         assert (Size() == d.Size());
-        for (size_t i = 0; i < Size(); ++i)
-            *(_pointers[i]) *= d[i];
+        Runs ([&d](Type* p, const size_t pos, const size_t n, const long s) {
+                long t;
+                if (const S* q = Source (d, pos, n, t))
+                    for (size_t i = 0; i < n; ++i)
+                        p[(long)i*s] *= q[(long)i*t];
+                else
+                    for (size_t i = 0; i < n; ++i)
+                        p[(long)i*s] *= d[pos+i];
+            });
         return *this;
     }
     
     inline virtual Matrix<T> operator/ (const MatrixTypeType& d) const {
+        assert (Size() == d.Size());
         Matrix<T> M(_dim);
-        for (size_t i = 0; i < Size(); ++i)
-            M[i] = *(_pointers[i])/d[i];
+        T* r = M.Ptr();
+        const T* q = d.Ptr();
+        Runs ([r,q](Type* p, const size_t pos, const size_t n, const long s) {
+                for (size_t i = 0; i < n; ++i)
+                    r[pos+i] = p[(long)i*s]/q[pos+i];
+            });
         return M;
     }
     inline virtual Matrix<T> operator/ (const T& t) const {
         Matrix<T> M(_dim);
-        for (size_t i = 0; i < Size(); ++i)
-            M[i] = *(_pointers[i])/t;
+        T* r = M.Ptr();
+        Runs ([r,&t](Type* p, const size_t pos, const size_t n, const long s) {
+                for (size_t i = 0; i < n; ++i)
+                    r[pos+i] = p[(long)i*s]/t;
+            });
         return M;
     }
     template<class S> inline MatrixType<T>& operator/= (const MatrixType<S>& d)  {
         assert (Size() == d.Size());
-        for (size_t i = 0; i < Size(); ++i)
-            *(_pointers[i]) /= d[i];
+        Runs ([&d](Type* p, const size_t pos, const size_t n, const long s) {
+                long t;
+                if (const S* q = Source (d, pos, n, t))
+                    for (size_t i = 0; i < n; ++i)
+                        p[(long)i*s] /= q[(long)i*t];
+                else
+                    for (size_t i = 0; i < n; ++i)
+                        p[(long)i*s] /= d[pos+i];
+            });
         return *this;
     }
     inline MatrixType<T>& operator/= (const T& t)  {
-        for (size_t i = 0; i < Size(); ++i)
-            *(_pointers[i]) /= t;
+        Runs ([&t](Type* p, const size_t pos, const size_t n, const long s) {
+                for (size_t i = 0; i < n; ++i)
+                    p[(long)i*s] /= t;
+            });
         return *this;
     }
     
     inline virtual Matrix<T> operator+ (const MatrixTypeType& d) const {
+        assert (Size() == d.Size());
         Matrix<T> M(_dim);
-        for (size_t i = 0; i < Size(); ++i)
-            M[i] = *(_pointers[i])+d[i];
+        T* r = M.Ptr();
+        const T* q = d.Ptr();
+        Runs ([r,q](Type* p, const size_t pos, const size_t n, const long s) {
+                for (size_t i = 0; i < n; ++i)
+                    r[pos+i] = p[(long)i*s]+q[pos+i];
+            });
         return M;
     }
     template<class S> inline MatrixType<T>& operator+= (const MatrixType<S>& d)  {
         assert (Size() == d.Size());
-        for (size_t i = 0; i < Size(); ++i)
-            *(_pointers[i]) += d[i];
+        Runs ([&d](Type* p, const size_t pos, const size_t n, const long s) {
+                long t;
+                if (const S* q = Source (d, pos, n, t))
+                    for (size_t i = 0; i < n; ++i)
+                        p[(long)i*s] += q[(long)i*t];
+                else
+                    for (size_t i = 0; i < n; ++i)
+                        p[(long)i*s] += d[pos+i];
+            });
         return *this;
     }
 
     inline virtual Matrix<T> operator- (const MatrixTypeType& d) const {
+        assert (Size() == d.Size());
         Matrix<T> M(_dim);
-        for (size_t i = 0; i < Size(); ++i)
-            M[i] = *(_pointers[i])-d[i];
+        T* r = M.Ptr();
+        const T* q = d.Ptr();
+        Runs ([r,q](Type* p, const size_t pos, const size_t n, const long s) {
+                for (size_t i = 0; i < n; ++i)
+                    r[pos+i] = p[(long)i*s]-q[pos+i];
+            });
         return M;
     }
     template<class S> inline MatrixType<T>& operator-= (const MatrixType<S>& d)  {
         assert (Size() == d.Size());
-        for (size_t i = 0; i < Size(); ++i)
-            *(_pointers[i]) -= d[i];
+        Runs ([&d](Type* p, const size_t pos, const size_t n, const long s) {
+                long t;
+                if (const S* q = Source (d, pos, n, t))
+                    for (size_t i = 0; i < n; ++i)
+                        p[(long)i*s] -= q[(long)i*t];
+                else
+                    for (size_t i = 0; i < n; ++i)
+                        p[(long)i*s] -= d[pos+i];
+            });
         return *this;
     }
 
     virtual ~View () { _matrix = 0; }
     
     inline View& operator= (const View<T,true>& v) {
-        Matrix<T>& lhs = *_matrix;
-        const Matrix<T>& rhs = *(v._matrix);
         assert (_nsdims.size() == v._nsdims.size());
         for (size_t i = 0; i < _nsdims.size(); ++i) {
         	if (_range[i].Size()!=v._range[i].Size())
         		std::cout << _range[i].Size() << " != " << v._range[i].Size() << std::endl;
             assert(_range[i].Size()==v._range[i].Size());
         }
-        for (size_t i = 0; i < _pointers.size(); ++i)
-            *_pointers[i] = *(v._pointers)[i];
+        if (Overlaps (v)) {                  // Aliased source: go through a copy
+            Matrix<T> tmp = v;
+            return *this = tmp;
+        }
+        Runs ([&v](Type* p, const size_t pos, const size_t n, const long s) {
+                long t;
+                if (const T* q = v.Run (pos, n, t)) {
+                    if (s == 1 && t == 1)
+                        std::copy (q, q+n, p);
+                    else
+                        for (size_t i = 0; i < n; ++i)
+                            p[(long)i*s] = q[(long)i*t];
+                } else
+                    for (size_t i = 0; i < n; ++i)
+                        p[(long)i*s] = v[pos+i];
+            });
         return *this;
     }
     inline View& operator= (const Type& t) {
         assert (_matrix);
-        for (size_t i = 0; i < _pointers.size(); ++i)
-            *_pointers[i] = t;
+        Runs ([&t](Type* p, const size_t pos, const size_t n, const long s) {
+                if (s == 1)
+                    std::fill (p, p+n, t);
+                else
+                    for (size_t i = 0; i < n; ++i)
+                        p[(long)i*s] = t;
+            });
         return *this;
     }
+
+    /**
+     * @brief  Apply f(p, pos, n, s) to all runs of the view, where p points
+     *         to the first element of a run of n elements with stride s, which
+     *         covers view positions pos to pos+n-1. Runs are disjoint and
+     *         processed in parallel for large views.
+     */
+    template<class F> inline void Runs (F f) const {
+        if (!_size)
+            return;
+        const bool strided = !_loops.empty() && _loops[0].idx.empty();
+        const size_t ni = strided ? _loops[0].n : 1, no = _size / ni, d0 = strided ? 1 : 0;
+        const long si = strided ? _loops[0].step : 1;
+        Type* base = _matrix->Ptr();
+#pragma omp parallel for schedule (static) if (_size > 32768 && no > 1)
+        for (long o = 0; o < (long)no; ++o) {
+            size_t q = o;
+            long off = _offset;
+            for (size_t d = d0; d < _loops.size(); ++d) {
+                const Loop& l = _loops[d];
+                const size_t i = q % l.n;
+                q /= l.n;
+                off += l.idx.empty() ? (long)i*l.step : l.idx[i];
+            }
+            f (base + off, o*ni, ni, si);
+        }
+    }
+
+    /**
+     * @brief  Pointer and stride to view positions pos to pos+n-1 if they lie
+     *         within one run, 0 otherwise
+     */
+    inline Type* Run (const size_t pos, const size_t n, long& s) const {
+        if (_loops.empty() || !_loops[0].idx.empty()) {
+            s = 1;
+            return (n == 1) ? const_cast<Type*>(&(*this)[pos]) : 0;
+        }
+        if (pos % _loops[0].n + n > _loops[0].n)
+            return 0;
+        s = _loops[0].step;
+        return const_cast<Type*>(&(*this)[pos]);
+    }
     
     inline Range<is_const>& Rng() { return _range; }
-    inline virtual size_t Size() const {return _pointers.size();}
+    inline virtual size_t Size() const {return _size;}
     inline virtual size_t Dim (const size_t& i) const { assert (i<_dim.size()); return _dim[i];}
     inline virtual const Vector<size_t>& Dim() const { return _dim; }
     virtual size_t NDim() const  { return _dim.size(); }
     
     MatrixTypeType* _matrix;
     Vector<Range<is_const> > _range;
-    Vector<Type*> _pointers;
     Vector<size_t> _nsdims;
     Vector<size_t> _dim;
     
 private:
+
+    /**
+     * @brief  Add strided loop, fused with the previous one if contiguous
+     */
+    inline void Fuse (const size_t n, const long step) {
+        if (!_loops.empty() && _loops.back().idx.empty() &&
+            _loops.back().step * (long)_loops.back().n == step)
+            _loops.back().n *= n;
+        else {
+            Loop l;
+            l.n = n;
+            l.step = step;
+            _loops.push_back(l);
+        }
+    }
+
+    /**
+     * @brief  Contiguous source for positions pos to pos+n-1 of a matrix or view
+     */
+    template<class S> inline static const S* Source (const MatrixType<S>& d, const size_t pos, const size_t n, long& s) {
+        if (const Matrix<S>* m = dynamic_cast<const Matrix<S>*>(&d)) {
+            s = 1;
+            return m->Ptr() + pos;
+        }
+        if (const View<S,true>* v = dynamic_cast<const View<S,true>*>(&d))
+            return v->Run (pos, n, s);
+        if (const View<S,false>* v = dynamic_cast<const View<S,false>*>(&d))
+            return v->Run (pos, n, s);
+        return 0;
+    }
+
+    /**
+     * @brief  Conservative check whether v reads memory this view writes
+     */
+    template<bool c> inline bool Overlaps (const View<T,c>& v) const {
+        return _size && v._size && (const void*)_matrix->Ptr() == (const void*)v._matrix->Ptr() &&
+            !(Last() < v.First() || v.Last() < First());
+    }
+    inline long First () const {
+        long f = _offset;
+        for (size_t d = 0; d < _loops.size(); ++d)
+            f += _loops[d].idx.empty() ? std::min (0L, ((long)_loops[d].n-1)*_loops[d].step) :
+                *std::min_element (_loops[d].idx.begin(), _loops[d].idx.end());
+        return f;
+    }
+    inline long Last () const {
+        long f = _offset;
+        for (size_t d = 0; d < _loops.size(); ++d)
+            f += _loops[d].idx.empty() ? std::max (0L, ((long)_loops[d].n-1)*_loops[d].step) :
+                *std::max_element (_loops[d].idx.begin(), _loops[d].idx.end());
+        return f;
+    }
+
+    template<class S, bool c> friend class View;
+
+    long _offset;                    /**< @brief Offset of the first element */
+    size_t _size;                    /**< @brief # elements */
+    std::vector<Loop> _loops;        /**< @brief Non-singleton ranges, innermost first */
+
     friend std::ostream& operator<< (std::ostream &os, const View& r) {
         os << "(";
         for (size_t i = 0; i < r._range.size(); ++i) {
@@ -9,27 +9,52 @@
 
 #include "Matrix.hpp"
 #include "OMP.hpp" 
+#include "VecMath.hpp"
 #include <math.h>
 
 namespace codeare {
     namespace matrix {
         namespace arithmetic {
 
+            /**
+             * @brief  Sine into preallocated ret (may be m), vectorised for
+             *         float and double (@see vmath)
+             */
+            template<class T> inline static void
+            sin (const Matrix<T>& m, Matrix<T>& ret, const vmath::Accuracy a = vmath::ACCURATE) {
+                assert (numel(ret) == numel(m));
+                if (numel(m))
+                    vmath::sin (m.Ptr(), ret.Ptr(), numel(m), a);
+            }
+
+            /**
+             * @brief  Sine
+             */
             template<class T> inline static Matrix<T>
-            sin (const Matrix<T>& m) {
+            sin (const Matrix<T>& m, const vmath::Accuracy a = vmath::ACCURATE) {
                 Matrix<T> ret (m.Dim(), m.Res());
-                #pragma omp parallel for
-                for (int i = 0; i < numel(m); i++)
-                    ret[i] = std::sin(m[i]);
+                sin (m, ret, a);
                 return ret;
             }
 
+            /**
+             * @brief  Cosine into preallocated ret (may be m), vectorised for
+             *         float and double (@see vmath)
+             */
+            template<class T> inline static void
+            cos (const Matrix<T>& m, Matrix<T>& ret, const vmath::Accuracy a = vmath::ACCURATE) {
+                assert (numel(ret) == numel(m));
+                if (numel(m))
+                    vmath::cos (m.Ptr(), ret.Ptr(), numel(m), a);
+            }
+
+            /**
+             * @brief  Cosine
+             */
             template<class T> inline static Matrix<T>
-            cos (const Matrix<T>& m) {
+            cos (const Matrix<T>& m, const vmath::Accuracy a = vmath::ACCURATE) {
                 Matrix<T> ret (m.Dim(), m.Res());
-                #pragma omp parallel for
-                for (int i = 0; i < numel(m); i++)
-                    ret[i] = std::cos(m[i]);
+                cos (m, ret, a);
                 return ret;
             }
             
@@ -96,21 +121,45 @@ namespace codeare {
                 return ret;
             }
 
+            /**
+             * @brief  Exponential into preallocated ret (may be m), vectorised for
+             *         float, double, cxfl and cxdb (@see vmath)
+             */
+            template<class T> inline static void
+            exp (const Matrix<T>& m, Matrix<T>& ret, const vmath::Accuracy a = vmath::ACCURATE) {
+                assert (numel(ret) == numel(m));
+                if (numel(m))
+                    vmath::exp (m.Ptr(), ret.Ptr(), numel(m), a);
+            }
+
+            /**
+             * @brief  Exponential
+             */
             template<class T> inline static Matrix<T>
-            exp (const Matrix<T>& m) {
+            exp (const Matrix<T>& m, const vmath::Accuracy a = vmath::ACCURATE) {
                 Matrix<T> ret (m.Dim(), m.Res());
-                #pragma omp parallel for
-                for (int i = 0; i < numel(m); i++)
-                    ret[i] = std::exp(m[i]);
+                exp (m, ret, a);
                 return ret;
             }
             
+            /**
+             * @brief  Natural logarithm into preallocated ret (may be m), vectorised for
+             *         float and double (@see vmath)
+             */
+            template<class T> inline static void
+            log (const Matrix<T>& m, Matrix<T>& ret, const vmath::Accuracy a = vmath::ACCURATE) {
+                assert (numel(ret) == numel(m));
+                if (numel(m))
+                    vmath::log (m.Ptr(), ret.Ptr(), numel(m), a);
+            }
+
+            /**
+             * @brief  Natural logarithm
+             */
             template<class T> inline static Matrix<T>
-            log (const Matrix<T>& m) {
+            log (const Matrix<T>& m, const vmath::Accuracy a = vmath::ACCURATE) {
                 Matrix<T> ret (m.Dim(), m.Res());
-                #pragma omp parallel for
-                for (int i = 0; i < numel(m); i++)
-                    ret[i] = std::log(m[i]);
+                log (m, ret, a);
                 return ret;
             }
             
@@ -27,9 +27,30 @@
 #include "Access.hpp"
 #include "Creators.hpp"
 #include "Lapack.hpp"
+#include "Batched.hpp"
 #include "Print.hpp"
 #include "Workspace.hpp"
 
+#include <list>
+
+/**
+ * @brief Precomputed SENSE unmixing for one set of sensitivities, acceleration
+ *        and regularisation. Shared between CSENSE operators.
+ */
+template <class T>
+struct CSENSEUnmixing {
+
+	typedef typename TypeTraits<T>::RT RT;
+
+	uint64_t   key;  /**< @brief Fingerprint of sensitivities */
+	Vector<size_t> af; /**< @brief Acceleration */
+	RT         treg; /**< @brief Tikhonov parameter */
+	bool       gfm;  /**< @brief g-factors computed */
+	Matrix<T>  w;    /**< @brief Unmixing weights (pixels, aliased, channels) */
+	Matrix<RT> g;    /**< @brief g-factors (pixels, aliased) */
+
+};
+
 /**
  * @brief SENSE: Sensitivity Encoding for Fast MRI<br/>
  *        MRM (1999): vol. 42 (5) pp. 952-962<br/>
@@ -92,6 +113,9 @@ public:
 			dims[2] = 1;
 		}
 
+		// Unmixing weights (cached per sensitivities)
+		unmix = Unmixing ();
+
 		// We're good
 		initialised = true;
 
@@ -113,109 +137,50 @@ public:
 	 */
 	Matrix<T> Adjoint (const Matrix<T>& m) const NOEXCEPT {
 
-		Matrix<T> res (dims[0]*af[0], dims[1]*af[1], (ndim == 3) ?
-				dims[2]*af[2] : 1, (compgfm) ? 2 : 1);
-		Matrix<T> tmp = m;
+		const size_t np = dims[0]*dims[1]*dims[2], fx = dims[0]*af[0],
+			fy = dims[1]*af[1], fz = (ndim == 3) ? dims[2]*af[2] : 1, nf = fx*fy*fz,
+			bs = 256, nb = (np + bs - 1) / bs;
+		Matrix<T> res (fx, fy, fz, (compgfm) ? 2 : 1);
+		const T* w = unmix->w.Ptr();
+		const RT* g = unmix->g.Ptr();
 
 		omp_set_num_threads(nthreads);
 
+		// Blocks of pixels: complex dot of weights and aliased pixels, then scatter
 #pragma omp parallel
 		{
-			
-			int tid = omp_get_thread_num ();
-			Matrix<T> s  (nc,  aaf);
-			Matrix<T> si (aaf, aaf);
-			Matrix<T> ra (nc,    1);
-			Matrix<T> rp (aaf,   1);
-			Matrix<T> gf (aaf,   1);
-			const DFT<T>& ft = m_dft[tid];
-
-			// FT individual channels
-//#pragma omp for
-/*			for (int i = 0; i < (int)nc; i++)
-				if (ndim == 2)
-					tmp(R(),R(),    R(i)) = ft ->* tmp(CR(),CR(),     CR(i));
-				else
-					tmp(R(),R(),R(),R(i)) = ft ->* tmp(CR(),CR(),CR(),CR(i));
-					*/
-			// Antialiasing
-#pragma omp for
-			for (int x = 0; x < (int)dims[0]; x++)
-				for (size_t y = 0; y < dims[1]; y++)
-					for (size_t z = 0; z < dims[2]; z++) {
-						for (size_t c = 0; c < nc; c++) {
-
-							ra[c] = (ndim == 3) ? tmp (x, y, z, c) : tmp (x, y, c);
-							
-							for (size_t zi = 0, i = 0; zi < af[2]; zi++)
-								for (size_t yi = 0; yi < af[1]; yi++)
-									for (size_t xi = 0; xi < af[0]; xi++, i++) 
-                                        s (c, i) = (ndim == 3) ?
-											sens (x + xi * dims[0], y + yi * dims[1],
-													z + zi * dims[2], c):
-											sens (x + xi * dims[0], y + yi * dims[1],                   c);
-                            
-						}
-
-						si = gemm (s, s, 'C', 'N') ;
-
-						if (treg > 0.)
-							si += reg;
-                        
-						if (compgfm)
-							gf = diag (si);
-                        
-						if (treg > 0.)
-							si = inv (si);
-						else
-							si = pinv (si);
-                        
-						if (compgfm)
-							gf = diag (si) * gf;
-                        
-						si = gemm (si,  s, 'N', 'C');
-							rp = gemm (si, ra, 'N', 'N');
-                        
-                        for (size_t zi = 0, i = 0; zi < af[2]; zi++)
-                            for (size_t yi = 0; yi < af[1]; yi++)
-                                for (size_t xi = 0; xi < af[0]; xi++, i++) {
-#if defined (_MSC_VER) && (_MSC_VER < 1600)
-									if (ndim == 3)
-										res (x + xi * dims[0], y + yi * dims[1],
-												z + zi * dims[2], 0) = rp [i];
-									else
-										res (x + xi * dims[0], y + yi * dims[1],
-												0) = rp [i];
-                                    if (compgfm) {
-										if (ndim == 3)
-											res (x + xi * dims[0], y + yi * dims[1],
-													z + zi * dims[2], 1) = sqrt(abs(gf [i]));
-										else
-											res (x + xi * dims[0], y + yi * dims[1],                   1) = sqrt(abs(gf [i]));
-                                    }
-#else
-									if (ndim == 3)
-										res (x + xi * dims[0], y + yi * dims[1],
-												z + zi * dims[2], 0) = rp [i];
-									else
-										res (x + xi * dims[0], y + yi * dims[1],
-												0, 0) = rp [i];
-                                    if (compgfm) {
-										if (ndim == 3)
-											res (x + xi * dims[0], y + yi * dims[1],
-													z + zi * dims[2], 1) = sqrt(abs(gf [i]));
-										else
-											res (x + xi * dims[0], y + yi * dims[1],
-													0, 1) = sqrt(abs(gf [i]));
-                                    }
-                                
-#endif
-								}
-                        
+			Vector<T> rp (bs*aaf);
+
+#pragma omp for schedule (static)
+			for (long b = 0; b < (long)nb; b++) {
+
+				const size_t p0 = b*bs, len = std::min (bs, np-p0);
+				std::fill (rp.begin(), rp.end(), T(0));
+
+				for (size_t i = 0; i < aaf; i++)
+					for (size_t c = 0; c < nc; c++) {
+						const T* wic = w + p0 + np*(i + aaf*c);
+						const T* mc  = m.Ptr() + p0 + np*c;
+						T* ri = &rp[i*bs];
+#pragma omp simd
+						for (size_t p = 0; p < len; p++)
+							ri[p] += wic[p] * mc[p];
 					}
 
+				for (size_t p = p0; p < p0+len; p++) {
+					const size_t x = p % dims[0], y = (p / dims[0]) % dims[1], z = p / (dims[0]*dims[1]);
+					for (size_t zi = 0, i = 0; zi < af[2]; zi++)
+						for (size_t yi = 0; yi < af[1]; yi++)
+							for (size_t xi = 0; xi < af[0]; xi++, i++) {
+								const size_t u = Unaliased(x, y, z, xi, yi, zi);
+								res[u] = rp[i*bs + p - p0];
+								if (compgfm)
+									res[u + nf] = g[p + np*i];
+							}
+				}
 
-        }
+			}
+		}
 
 		return res;
 		
@@ -257,6 +222,136 @@ public:
 
 private:
 
+	/**
+	 * @brief       Linear index of unaliased pixel in full FOV
+	 */
+	inline size_t Unaliased (const size_t& x, const size_t& y, const size_t& z,
+			const size_t& xi, const size_t& yi, const size_t& zi) const NOEXCEPT {
+		return (x + xi * dims[0]) + dims[0] * af[0] * ((y + yi * dims[1]) +
+				dims[1] * af[1] * (z + zi * dims[2]));
+	}
+
+	/**
+	 * @brief       Unmixing weights W = (S^H S + lambda I)^-1 S^H and g-factors of
+	 *              all aliased pixel groups. Looked up in a small cache of recently
+	 *              used sensitivities first, so that re-preparing with the same maps
+	 *              (dynamic imaging) skips the computation. Pixel groups, whose
+	 *              Gram matrix is singular, are unmixed with its pseudo-inverse.
+	 */
+	inline shrd_ptr<const CSENSEUnmixing<T> > Unmixing () const {
+
+		typedef std::list<shrd_ptr<const CSENSEUnmixing<T> > > cache_t;
+		static cache_t cache;
+		static const size_t capacity = 4;
+		const uint64_t key = fingerprint (sens);
+		shrd_ptr<const CSENSEUnmixing<T> > hit;
+
+#pragma omp critical (csense_unmixing)
+		for (typename cache_t::iterator it = cache.begin(); it != cache.end(); ++it)
+			if ((*it)->key == key && (*it)->treg == treg && (*it)->af == af &&
+					((*it)->gfm || !compgfm)) {
+				hit = *it;
+				cache.erase (it);
+				cache.push_front (hit);
+				break;
+			}
+
+		if (hit)
+			return hit;
+
+		const size_t np = dims[0]*dims[1]*dims[2], nf = numel(sens)/nc;
+		Matrix<T> s (np, nc, aaf), sh (np, aaf, nc);
+
+		// Gather sensitivities of aliased pixels (pixels fastest)
+#pragma omp parallel for
+		for (long p = 0; p < (long)np; p++) {
+			const size_t x = p % dims[0], y = (p / dims[0]) % dims[1], z = p / (dims[0]*dims[1]);
+			for (size_t c = 0; c < nc; c++)
+				for (size_t zi = 0, i = 0; zi < af[2]; zi++)
+					for (size_t yi = 0; yi < af[1]; yi++)
+						for (size_t xi = 0; xi < af[0]; xi++, i++) {
+							const T sv = sens[Unaliased(x, y, z, xi, yi, zi) + nf*c];
+							s [p + np*(c + nc*i)] = sv;
+							sh[p + np*(i + aaf*c)] = TypeTraits<T>::Conj(sv);
+						}
+		}
+
+		shrd_ptr<CSENSEUnmixing<T> > u = mk_shared<CSENSEUnmixing<T> >();
+		u->key  = key;
+		u->af   = af;
+		u->treg = treg;
+		u->gfm  = compgfm;
+
+		Vector<int> info;
+		Matrix<T> si = gram_batched (s, treg), sinv, su = chol_batched (si, &info);
+		u->w = posv_batched (si, sh, &info);
+		u->g = Matrix<RT> (np, aaf);
+		if (compgfm)
+			sinv = inv_batched (si, &info);
+
+		// Singular groups (e.g. no signal, treg = 0), i.e. a vanishing pivot relative
+		// to the diagonal: minimum norm least squares through the pseudo-inverse
+		// from the SVD (xGELS needs full rank)
+		std::vector<size_t> singular;
+		const RT eps = RT(aaf) * std::numeric_limits<RT>::epsilon();
+		for (size_t p = 0; p < np; p++) {
+			bool sing = (info[p] != 0);
+			for (size_t i = 0; i < aaf && !sing; i++) {
+				const RT d = TypeTraits<T>::Real(su[p + np*(i + aaf*i)]);
+				sing = (d*d <= eps * TypeTraits<T>::Real(si[p + np*(i + aaf*i)]));
+			}
+			if (sing)
+				singular.push_back (p);
+		}
+#pragma omp parallel for
+		for (long k = 0; k < (long)singular.size(); k++) {
+			const size_t p = singular[k];
+			Matrix<T> sp (aaf, aaf), shp (aaf, nc);
+			for (size_t j = 0; j < aaf; j++)
+				for (size_t i = 0; i < aaf; i++)
+					sp(i,j) = si[p + np*(i + aaf*j)];
+			for (size_t c = 0; c < nc; c++)
+				for (size_t i = 0; i < aaf; i++)
+					shp(i,c) = sh[p + np*(i + aaf*c)];
+			TUPLE<Matrix<T>,Matrix<RT>,Matrix<T> > usv = svd2 (sp, 'S');
+			const Matrix<T>& su = GET<0>(usv), svh = GET<2>(usv);
+			const Matrix<RT>& sv = GET<1>(usv);
+			const RT tol = RT(aaf) * sv[0] * std::numeric_limits<RT>::epsilon();
+			for (size_t j = 0; j < aaf; j++)
+				for (size_t i = 0; i < aaf; i++) {
+					T v = T(0);
+					for (size_t k = 0; k < aaf; k++)
+						if (sv[k] > tol)
+							v += TypeTraits<T>::Conj(svh(k,i)) * TypeTraits<T>::Conj(su(j,k)) / sv[k];
+					sp(i,j) = v;
+				}
+			shp = gemm (sp, shp, 'N', 'N');
+			for (size_t c = 0; c < nc; c++)
+				for (size_t i = 0; i < aaf; i++)
+					u->w[p + np*(i + aaf*c)] = shp(i,c);
+			if (compgfm)
+				for (size_t j = 0; j < aaf; j++)
+					for (size_t i = 0; i < aaf; i++)
+						sinv[p + np*(i + aaf*j)] = sp(i,j);
+		}
+
+		if (compgfm)
+			for (size_t i = 0; i < aaf; i++)
+				for (size_t p = 0; p < np; p++)
+					u->g[p + np*i] = sqrt(abs(sinv[p + np*(i + aaf*i)] * si[p + np*(i + aaf*i)]));
+
+#pragma omp critical (csense_unmixing)
+		{
+			cache.push_front (u);
+			if (cache.size() > capacity)
+				cache.pop_back ();
+		}
+
+		return u;
+
+	}
+
+
 	/**
 	 * @brief       Setup DFT operators
 	 *
@@ -294,8 +389,6 @@ private:
 		treg = (params.exists("lambda")) ? params.Get<RT>("lambda"): 0.0;
 		printf ("  Tikhonov lambda (%.2e)\n", treg);
 		assert (treg >= 0.0);
-		if (treg > 0.0)
-			reg = treg * eye<RT>(aaf);
 	}
 
 
@@ -309,7 +402,7 @@ private:
 	size_t               nc;
 	bool                 compgfm;
 	RT            		 treg;
-	Matrix<RT>            reg;
+	shrd_ptr<const CSENSEUnmixing<T> > unmix;
 	bool                 initialised;
 	size_t               aaf;
 
@@ -28,6 +28,7 @@
 #include "tinyxml.h"
 #include "IOContext.hpp"
 #include "CGLS.hpp"
+#include "Topology.hpp"
 
 #include "Workspace.hpp"
 
@@ -58,7 +59,7 @@ public:
 	 * @brief         Default constructor
 	 */
 	NCSENSE() NOEXCEPT : m_initialised (false), m_cgiter(30), m_cgeps (1.0e-6), m_lambda (1.0e-6),
-        m_verbose (false), m_np(0), m_3rd_dim_cart(false), m_nmany(1), m_dim4(1), m_dim5(1) {}
+        m_verbose (false), m_np(0), m_3rd_dim_cart(false), m_nmany(1), m_dim4(1), m_dim5(1), m_numa(false) {}
     
     
 	/**
@@ -68,7 +69,8 @@ public:
 	 */
 	NCSENSE        (const Params& params) NOEXCEPT
               : FT<T>::FT(params), m_cgiter(0), m_initialised(false), m_cgeps(1.0e-6),
-                m_lambda(1.0e-6), m_verbose (false), m_np(0), m_3rd_dim_cart(false), m_nmany(1), m_dim4(1), m_dim5(1)  {
+                m_lambda(1.0e-6), m_verbose (false), m_np(0), m_3rd_dim_cart(false), m_nmany(1), m_dim4(1), m_dim5(1),
+                m_numa(false) {
 
 		size_t cart_dim = 1;
 
@@ -153,6 +155,11 @@ public:
         try {
         	m_verbose = (params.Get<int>("verbose") > 0);
         } catch (const boost::bad_any_cast&) {}
+
+        try {
+            m_numa = (params.Get<int>("numa") > 0);
+        } catch (const PARAMETER_MAP_EXCEPTION&) {
+        } catch (const boost::bad_any_cast&) {}
         m_nx.push_back(m_np);
         
 		ft_params["imsz"] = ms;
@@ -166,6 +173,8 @@ public:
         }
 
         omp_set_num_threads(m_fts.size());
+        if (m_numa)
+            Topology::Instance().PinOpenMP(m_fts.size());
         
 		m_ic     = IntensityMap (m_sm);
 		m_initialised = true;
@@ -178,6 +187,7 @@ public:
         		tmp.push_back(m_dim5);
         }
 		m_bwd_out = Matrix<T> (tmp);               // size of sensitivity maps
+		Place();
 		
 		m_cgls = codeare::optimisation::CGLS<T>(m_cgiter, m_cgeps, m_lambda, m_verbose);
 
@@ -194,6 +204,7 @@ public:
         m_sm = sm;
         m_csm = conj(sm);
         m_ic = IntensityMap(sm);
+        Place();
     }
     
 	/**
@@ -450,9 +461,36 @@ public:
     inline size_t KSpaceSize () const {
         return m_fts[0].KSpaceSize();
     }
+
+	/**
+	 * @brief Approximate memory footprint (bytes)
+	 */
+	inline size_t Footprint () const {
+		size_t b = sizeof(T) * (numel(m_sm) + numel(m_csm) + numel(m_fwd_out) + numel(m_bwd_out)) +
+			sizeof(RT) * (numel(m_ic) + numel(m_k) + numel(m_w));
+		for (size_t i = 0; i < m_fts.size(); ++i)
+			b += m_fts[i].Footprint();
+		return b;
+	}
 	
 private:
 
+	/**
+	 * @brief Place channel data on the NUMA nodes of the threads processing
+	 *        them, interleave data shared by all threads (multiple volumes)
+	 */
+	inline void Place () const {
+		if (!m_numa)
+			return;
+		const Topology& topo = Topology::Instance();
+		Matrix<T>* m[4] = {&m_sm, &m_csm, &m_fwd_out, &m_bwd_out};
+		for (size_t i = 0; i < 4; ++i)
+			if (m_nmany == 1)
+				topo.Partition (m[i]->Ptr(), m[i]->Size()*sizeof(T), m_nx[1]);
+			else
+				topo.Interleave (m[i]->Ptr(), m[i]->Size()*sizeof(T));
+	}
+
 	mutable Vector<NFFT<T> > m_fts; /**< Non-Cartesian FT operators (Multi-Core?) */
 	bool       m_initialised; /**< All initialised? */
     bool       m_verbose;	  /**< Verbose binary output (keep all intermediate steps) */
@@ -476,6 +514,7 @@ private:
     size_t     m_nmany;          /**< Recounstruct multiple volumes with same k-space and maps */
 	size_t m_dim4, m_dim5;
 	int        m_np;
+	bool       m_numa;           /**< Pin threads and place channel data on NUMA nodes */
 
     
 
@@ -449,6 +449,18 @@ public:
     inline RT Sigma() const {return m_sigma;}
     inline RT Epsilon() const {return m_epsilon;}
 
+    /**
+     * @brief Approximate memory footprint of plan and solver (bytes)
+     */
+    inline size_t Footprint () const {
+        size_t psi = m_M;
+        for (size_t i = 0; i < m_N.size(); ++i)
+            psi *= 2*m_m+2;
+        return sizeof(NFFTRType) * (m_M*m_N.size() + 9*m_M + psi + 8*prod(m_N) + 4*prod(m_n) +
+            std::accumulate(m_N.begin(), m_N.end(), (size_t)0)) +
+            sizeof(RT) * (m_k.size() + m_kw.size());
+    }
+
     virtual std::ostream& Print (std::ostream& os) const {
 		Operator<T>::Print(os);
     	os << "    image size: rank(" << Rank() << ") side(" <<
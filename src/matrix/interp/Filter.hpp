@@ -0,0 +1,312 @@
+/*
+ *  codeare Copyright (C) 2010-2016
+ *                        Kaveh Vahedipour
+ *                        NYU School of Medicine, New York, USA
+ *
+ *  This program is free software; you can redistribute it and/or modify
+ *  it under the terms of the GNU General Public License as published by
+ *  the Free Software Foundation; either version 2 of the License, or
+ *  (at your option) any later version.
+ *
+ *  This program is distributed in the hope that it will be useful, but
+ *  WITHOUT ANY WARRANTY; without even the implied warranty of
+ *  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU
+ *  General Public License for more details.
+ *
+ *  You should have received a copy of the GNU General Public License
+ *  along with this program; if not, write to the Free Software
+ *  Foundation, Inc., 51 Franklin Street, Fifth Floor, Boston, MA
+ *  02110-1301  USA
+ */
+
+#ifndef __FILTER_HPP__
+#define __FILTER_HPP__
+
+#include "Matrix.hpp"
+#include "OMP.hpp"
+
+#include <algorithm>
+#include <cmath>
+#include <utility>
+#include <vector>
+
+/**
+ * @brief Interpolation methods
+ */
+enum InterpMethod {
+	LINEAR, BSPLINE, LANCZOS
+};
+
+
+/**
+ * @brief    Polyphase filter bank along one dimension.<br/>
+ *           Output sample j is the weighted sum of nt input samples
+ *           idx(j,0..nt-1). Out of range taps are mirrored (whole sample).
+ */
+struct Polyphase {
+
+	size_t ni;                  /**< @brief Input length */
+	size_t no;                  /**< @brief Output length */
+	size_t nt;                  /**< @brief Taps per output sample */
+	std::vector<size_t> idx;    /**< @brief Tap indices (no x nt) */
+	std::vector<double> w;      /**< @brief Tap weights (no x nt) */
+
+	Polyphase () : ni(0), no(0), nt(0) {}
+
+	/**
+	 * @brief    Resampling ni to no samples, sample centres aligned.
+	 *           Linear and Lanczos kernels are widened by ni/no when
+	 *           shrinking (antialiasing), B-splines are interpolated.
+	 */
+	inline static Polyphase Resampling (const size_t ni, const size_t no, const InterpMethod im) {
+		const double f = (double)no / (double)ni, s = (im == BSPLINE) ? 1. : std::min (f, 1.);
+		const double support = ((im == LINEAR) ? 1. : (im == BSPLINE) ? 2. : 3.) / s;
+		Polyphase p (ni, no, 2*(size_t)std::ceil(support) + 1);
+		for (size_t j = 0; j < no; ++j) {
+			const double u = (j + .5) / f - .5;
+			const long first = (long)std::floor (u) - (long)(p.nt/2) + 1;
+			for (size_t t = 0; t < p.nt; ++t)
+				p.Set (j, t, first + (long)t, Kernel (im, s * (u - (double)(first + (long)t))));
+		}
+		p.Normalise ();
+		return p;
+	}
+
+	/**
+	 * @brief    Gaussian smoothing, truncated at 3 sigma (voxels)
+	 */
+	inline static Polyphase Gaussian (const size_t n, const double sigma) {
+		const long r = std::max ((long)std::ceil (3. * sigma), 1L);
+		Polyphase p (n, n, 2*r+1);
+		for (size_t j = 0; j < n; ++j)
+			for (long t = -r; t <= r; ++t)
+				p.Set (j, t+r, (long)j + t, std::exp (-.5 * t * t / (sigma * sigma)));
+		p.Normalise ();
+		return p;
+	}
+
+	/**
+	 * @brief    Box (moving average) smoothing over w voxels (odd)
+	 */
+	inline static Polyphase Box (const size_t n, const size_t w) {
+		const long r = (long)w/2;
+		Polyphase p (n, n, 2*r+1);
+		for (size_t j = 0; j < n; ++j)
+			for (long t = -r; t <= r; ++t)
+				p.Set (j, t+r, (long)j + t, 1.);
+		p.Normalise ();
+		return p;
+	}
+
+	inline static double Kernel (const InterpMethod im, const double x) {
+		const double a = std::abs (x);
+		switch (im) {
+		case LINEAR:
+			return (a < 1.) ? 1. - a : 0.;
+		case BSPLINE:
+			return (a < 1.) ? 2./3. - a*a + .5*a*a*a : (a < 2.) ? (2.-a)*(2.-a)*(2.-a)/6. : 0.;
+		case LANCZOS:
+			return (a < 1.e-12) ? 1. : (a < 3.) ? 3. * std::sin (PI*a) * std::sin (PI*a/3.) / (PI*PI*a*a) : 0.;
+		}
+		return 0.;
+	}
+
+private:
+
+	Polyphase (const size_t i, const size_t o, const size_t t) : ni(i), no(o), nt(t), idx(o*t), w(o*t) {}
+
+	inline void Set (const size_t j, const size_t t, long k, const double wt) {
+		const long n = (long)ni;
+		if (n == 1)
+			k = 0;
+		else
+			while (k < 0 || k >= n)
+				k = (k < 0) ? -k : 2*(n-1) - k;
+		idx[j*nt+t] = (size_t)k;
+		w[j*nt+t]   = wt;
+	}
+
+	inline void Normalise () {
+		for (size_t j = 0; j < no; ++j) {
+			double s = 0.;
+			for (size_t t = 0; t < nt; ++t)
+				s += w[j*nt+t];
+			if (s != 0.)
+				for (size_t t = 0; t < nt; ++t)
+					w[j*nt+t] /= s;
+		}
+	}
+
+};
+
+
+/**
+ * @brief      Apply polyphase filter to data viewed as (inner x ni x outer).
+ *             Vectorised along the contiguous inner run, threaded over outer
+ *             lines and output samples.
+ */
+template<class RT> inline static void
+polyphase_pass (const RT* in, RT* out, const size_t inner, const size_t outer, const Polyphase& p) {
+
+	const size_t ni = p.ni, no = p.no, nt = p.nt;
+
+#pragma omp parallel for collapse(2) schedule (static)
+	for (long o = 0; o < (long)outer; ++o)
+		for (long j = 0; j < (long)no; ++j) {
+			RT* y = out + (o*no + j)*inner;
+			const size_t* ix = &p.idx[j*nt];
+			const double* wt = &p.w[j*nt];
+			if (inner == 1) {
+				double acc = 0.;
+				for (size_t t = 0; t < nt; ++t)
+					acc += wt[t] * in[o*ni + ix[t]];
+				y[0] = (RT)acc;
+			} else {
+				std::fill (y, y + inner, RT(0));
+				for (size_t t = 0; t < nt; ++t) {
+					if (wt[t] == 0.)
+						continue;
+					const RT* x = in + (o*ni + ix[t])*inner;
+					const RT wr = (RT)wt[t];
+#pragma omp simd
+					for (size_t i = 0; i < inner; ++i)
+						y[i] += wr * x[i];
+				}
+			}
+		}
+
+}
+
+
+/**
+ * @brief      Cubic B-spline prefilter (Unser 1991) in place along data
+ *             viewed as (inner x n x outer), mirror boundaries.
+ */
+template<class RT> inline static void
+bspline_prefilter (RT* c, const size_t inner, const size_t n, const size_t outer) {
+
+	if (n < 2)
+		return;
+
+	const double z = std::sqrt (3.) - 2., lambda = (1. - z) * (1. - 1. / z);
+	const size_t horizon = std::min (n, (size_t)std::ceil (std::log (1.e-10) / std::log (std::abs (z))));
+
+#pragma omp parallel for schedule (static)
+	for (long o = 0; o < (long)outer; ++o) {
+
+		RT* l = c + o*n*inner;
+
+		// Gain and causal initialisation
+		for (size_t k = 0; k < n; ++k)
+#pragma omp simd
+			for (size_t i = 0; i < inner; ++i)
+				l[k*inner+i] *= (RT)lambda;
+		std::vector<double> s (inner, 0.);
+		double zk = 1.;
+		for (size_t k = 0; k < horizon; ++k, zk *= z)
+			for (size_t i = 0; i < inner; ++i)
+				s[i] += zk * l[k*inner+i];
+		for (size_t i = 0; i < inner; ++i)
+			l[i] = (RT)s[i];
+
+		// Causal
+		for (size_t k = 1; k < n; ++k)
+#pragma omp simd
+			for (size_t i = 0; i < inner; ++i)
+				l[k*inner+i] += (RT)z * l[(k-1)*inner+i];
+
+		// Anticausal
+		for (size_t i = 0; i < inner; ++i)
+			l[(n-1)*inner+i] = (RT)((z / (z*z - 1.)) * (l[(n-1)*inner+i] + z * l[(n-2)*inner+i]));
+		for (size_t k = n-1; k-- > 0;)
+#pragma omp simd
+			for (size_t i = 0; i < inner; ++i)
+				l[k*inner+i] = (RT)z * (l[(k+1)*inner+i] - l[k*inner+i]);
+
+	}
+
+}
+
+
+/**
+ * @brief      Apply one filter bank per dimension (empty banks are skipped).
+ *             Shrinking dimensions are processed first.
+ *
+ * @param  M   Data
+ * @param  ph  Filter banks (one per leading dimension)
+ * @param  bs  Cubic B-spline prefilter dimensions with banks
+ * @return     Filtered data
+ */
+template<class T> inline static Matrix<T>
+separable (const Matrix<T>& M, const std::vector<Polyphase>& ph, const bool bs = false) {
+
+	typedef typename TypeTraits<T>::RT RT;
+	const size_t ncomp = sizeof(T)/sizeof(RT);
+
+	std::vector<size_t> order;
+	for (size_t d = 0; d < std::min (ph.size(), (size_t)M.NDim()); ++d)
+		if (ph[d].ni)
+			order.push_back (d);
+	std::stable_sort (order.begin(), order.end(), [&ph](size_t a, size_t b) {
+			return (double)ph[a].no/ph[a].ni < (double)ph[b].no/ph[b].ni; });
+
+	Matrix<T> cur = M;
+	Vector<size_t> dims = M.Dim();
+
+	for (size_t d : order) {
+		assert (ph[d].ni == dims[d]);
+		size_t inner = ncomp, outer = 1;
+		for (size_t e = 0; e < d; ++e)
+			inner *= dims[e];
+		for (size_t e = d+1; e < dims.size(); ++e)
+			outer *= dims[e];
+		if (bs)
+			bspline_prefilter ((RT*)cur.Ptr(), inner, dims[d], outer);
+		dims[d] = ph[d].no;
+		Matrix<T> next (dims);
+		polyphase_pass ((const RT*)cur.Ptr(), (RT*)next.Ptr(), inner, outer, ph[d]);
+		cur = std::move (next);
+	}
+
+	for (size_t d = 0; d < M.NDim(); ++d)
+		cur.Res(d) = M.Res(d) * (float)M.Dim(d) / (float)cur.Dim(d);
+
+	return cur;
+
+}
+
+
+/**
+ * @brief      Separable Gaussian smoothing
+ *
+ * @param  M      Data
+ * @param  sigma  Standard deviation per leading dimension (voxels, 0: skip)
+ * @return        Smoothed data
+ */
+template<class T> inline static Matrix<T>
+smooth_gaussian (const Matrix<T>& M, const Matrix<double>& sigma) {
+	std::vector<Polyphase> ph (std::min (sigma.Size(), (size_t)M.NDim()));
+	for (size_t d = 0; d < ph.size(); ++d)
+		if (sigma[d] > 0. && M.Dim(d) > 1)
+			ph[d] = Polyphase::Gaussian (M.Dim(d), sigma[d]);
+	return separable (M, ph);
+}
+
+
+/**
+ * @brief      Separable box (moving average) smoothing
+ *
+ * @param  M      Data
+ * @param  width  Width per leading dimension (voxels, odd, <2: skip)
+ * @return        Smoothed data
+ */
+template<class T> inline static Matrix<T>
+smooth_box (const Matrix<T>& M, const Matrix<size_t>& width) {
+	std::vector<Polyphase> ph (std::min (width.Size(), (size_t)M.NDim()));
+	for (size_t d = 0; d < ph.size(); ++d)
+		if (width[d] > 1 && M.Dim(d) > 1)
+			ph[d] = Polyphase::Box (M.Dim(d), width[d]);
+	return separable (M, ph);
+}
+
+#endif /* __FILTER_HPP__ */
@@ -0,0 +1,299 @@
+/*
+ *  codeare Copyright (C) 2010-2016
+ *                        Kaveh Vahedipour
+ *                        NYU School of Medicine, New York, USA
+ *
+ *  This program is free software; you can redistribute it and/or modify
+ *  it under the terms of the GNU General Public License as published by
+ *  the Free Software Foundation; either version 2 of the License, or
+ *  (at your option) any later version.
+ *
+ *  This program is distributed in the hope that it will be useful, but
+ *  WITHOUT ANY WARRANTY; without even the implied warranty of
+ *  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU
+ *  General Public License for more details.
+ *
+ *  You should have received a copy of the GNU General Public License
+ *  along with this program; if not, write to the Free Software
+ *  Foundation, Inc., 51 Franklin Street, Fifth Floor, Boston, MA
+ *  02110-1301  USA
+ */
+
+#ifndef __INTERP1_HPP__
+#define __INTERP1_HPP__
+
+#include "Matrix.hpp"
+#include "OMP.hpp"
+
+#include <algorithm>
+#include <limits>
+#include <vector>
+
+namespace INTERP {
+	enum Method {
+		LINEAR, POLYNOMIAL, CSPLINE, CSPLINE_PERIODIC, AKIMA, AKIMA_PERIODIC
+	};
+}
+
+
+/**
+ * @brief    Batched 1D interpolation of all columns of y on a common base x.<br/>
+ *
+ *           Linear, natural cubic spline and Akima, with GSL's coefficients.
+ *           Columns (real and imaginary parts separately) are stored
+ *           interleaved, row i of all columns contiguous. Coefficients are
+ *           hence built for all columns at once, the spline's tridiagonal
+ *           system is factorised once for x and swept across column blocks.
+ *           Lookup locates each query once for all columns, by a linear scan
+ *           for sorted queries and bisection otherwise. Queries outside of
+ *           [x(0),x(n-1)] evaluate to NaN.
+ */
+template <class T>
+class Interp1 {
+
+	typedef typename TypeTraits<T>::RT RT;
+	static const size_t ncomp = sizeof(T)/sizeof(RT);
+	static const size_t block = 256;
+
+public:
+
+	/**
+	 * @brief        Construct
+	 *
+	 * @param  x     Base (ascending, nx)
+	 * @param  y     Values (nx x ...)
+	 * @param  intm  Interpolation method (LINEAR, CSPLINE or AKIMA)
+	 */
+	Interp1 (const Matrix<double>& x, const Matrix<T>& y, const INTERP::Method intm = INTERP::CSPLINE) :
+		m_nx (size(y,0)), m_nd (numel(y)/size(y,0)), m_nc (ncomp*numel(y)/size(y,0)), m_intm (intm),
+		m_x (x.Begin(), x.Begin() + size(y,0)) {
+
+		assert (m_nx > 1);
+		assert (x.Size() >= m_nx);
+
+		if ((m_intm == INTERP::CSPLINE && m_nx < 3) || (m_intm == INTERP::AKIMA && m_nx < 5))
+			m_intm = INTERP::LINEAR;
+
+		const RT* yr = (const RT*) y.Ptr();
+		m_a.resize (m_nx*m_nc);
+#pragma omp parallel for
+		for (long i = 0; i < (long)m_nx; ++i)
+			for (size_t j = 0; j < m_nd; ++j)
+				for (size_t k = 0; k < ncomp; ++k)
+					m_a[i*m_nc + j*ncomp + k] = yr[(j*m_nx + i)*ncomp + k];
+
+		if (m_intm == INTERP::CSPLINE)
+			CSpline ();
+		else if (m_intm == INTERP::AKIMA)
+			Akima ();
+
+	}
+
+	virtual ~Interp1 () {}
+
+	/**
+	 * @brief        Batched methods
+	 */
+	inline static bool Supports (const INTERP::Method intm) {
+		return intm == INTERP::LINEAR || intm == INTERP::CSPLINE || intm == INTERP::AKIMA;
+	}
+
+	/**
+	 * @brief        Interpolate all columns
+	 *
+	 * @param  xi    Interpolation base (nxi)
+	 * @return       Interpolated values (nxi x ...)
+	 */
+	inline Matrix<T> Lookup (const Matrix<double>& xi) const {
+
+		const size_t nq = xi.Size();
+		std::vector<size_t> idx (nq);
+		std::vector<double> dx (nq);
+		Locate (&xi[0], nq, idx, dx);
+
+		Matrix<T> yi (nq, m_nd);
+		RT* o = (RT*) yi.Ptr();
+		const RT nan = std::numeric_limits<RT>::quiet_NaN();
+
+#pragma omp parallel for schedule (static)
+		for (long q = 0; q < (long)nq; ++q) {
+			const size_t i = idx[q];
+			const double h = dx[q];
+			if (i == npos) {
+				for (size_t c = 0; c < m_nc; ++c)
+					o[(c/ncomp*nq + q)*ncomp + c%ncomp] = nan;
+				continue;
+			}
+			const double* a = &m_a[i*m_nc];
+			if (m_intm == INTERP::LINEAR) {
+				const double w = h / (m_x[i+1] - m_x[i]);
+				for (size_t c = 0; c < m_nc; ++c)
+					o[(c/ncomp*nq + q)*ncomp + c%ncomp] = (RT) (a[c] + w * (a[m_nc+c] - a[c]));
+			} else {
+				const double *b = &m_b[i*m_nc], *cc = &m_c[i*m_nc], *d = &m_d[i*m_nc];
+				for (size_t c = 0; c < m_nc; ++c)
+					o[(c/ncomp*nq + q)*ncomp + c%ncomp] = (RT) (a[c] + h * (b[c] + h * (cc[c] + h * d[c])));
+			}
+		}
+
+		return yi;
+
+	}
+
+private:
+
+	static const size_t npos = (size_t)-1;
+
+	/**
+	 * @brief        Interval and offset of each query
+	 */
+	inline void Locate (const double* xi, const size_t nq, std::vector<size_t>& idx,
+						std::vector<double>& dx) const {
+
+		const double *x = &m_x[0], x0 = x[0], x1 = x[m_nx-1];
+		bool sorted = true;
+		for (size_t q = 1; q < nq && sorted; ++q)
+			sorted = !(xi[q] < xi[q-1]);
+
+#pragma omp parallel
+		{
+			size_t i = npos;
+#pragma omp for schedule (static)
+			for (long q = 0; q < (long)nq; ++q) {
+				const double xq = xi[q];
+				if (!(xq >= x0 && xq <= x1)) {
+					idx[q] = npos;
+					continue;
+				}
+				if (sorted && i != npos) {       // Continue scan from last hit
+					while (i < m_nx-2 && x[i+1] <= xq)
+						++i;
+				} else {
+					i = std::upper_bound (x, x + m_nx, xq) - x;
+					i = (i == 0) ? 0 : std::min (i-1, m_nx-2);
+				}
+				idx[q] = i;
+				dx[q]  = xq - x[i];
+			}
+		}
+
+	}
+
+	/**
+	 * @brief        Natural cubic spline (gsl_interp_cspline)
+	 */
+	inline void CSpline () {
+
+		const size_t n = m_nx, nc = m_nc, ns = n-2;
+		const double* x = &m_x[0];
+		const double* a = &m_a[0];
+		m_b.resize (n*nc); m_c.assign (n*nc, 0.); m_d.resize (n*nc);
+
+		// Factorise tridiagonal system once
+		std::vector<double> w (ns), l (ns);
+		for (size_t k = 0; k < ns; ++k) {
+			const double d = 2. * (x[k+2] - x[k]);
+			l[k] = (k == 0) ? 0. : (x[k+1] - x[k]) / w[k-1];
+			w[k] = d - l[k] * (x[k+1] - x[k]);
+		}
+
+#pragma omp parallel for schedule (dynamic)
+		for (long c0 = 0; c0 < (long)nc; c0 += block) {
+			const size_t c1 = std::min ((size_t)c0 + block, nc);
+			double* c = &m_c[0];
+			// Right hand side and forward sweep
+			for (size_t k = 0; k < ns; ++k) {
+				const double hi = x[k+1] - x[k], hn = x[k+2] - x[k+1];
+				double *g = c + (k+1)*nc, *gp = c + k*nc;
+				const double *ai = a + k*nc, *an = a + (k+1)*nc, *ann = a + (k+2)*nc;
+#pragma omp simd
+				for (size_t j = c0; j < c1; ++j)
+					g[j] = 3. * ((ann[j] - an[j]) / hn - (an[j] - ai[j]) / hi) - l[k] * gp[j];
+			}
+			// Back substitution
+			for (size_t k = ns; k-- > 0;) {
+				const double o = x[k+2] - x[k+1];
+				double *g = c + (k+1)*nc, *gn = c + (k+2)*nc;
+#pragma omp simd
+				for (size_t j = c0; j < c1; ++j)
+					g[j] = (g[j] - ((k+1 < ns) ? o * gn[j] : 0.)) / w[k];
+			}
+			// Polynomial coefficients
+			for (size_t i = 0; i < n-1; ++i) {
+				const double h = x[i+1] - x[i];
+				const double *ai = a + i*nc, *an = a + (i+1)*nc, *ci = c + i*nc, *cn = c + (i+1)*nc;
+				double *b = &m_b[i*nc], *d = &m_d[i*nc];
+#pragma omp simd
+				for (size_t j = c0; j < c1; ++j) {
+					b[j] = (an[j] - ai[j]) / h - h * (cn[j] + 2. * ci[j]) / 3.;
+					d[j] = (cn[j] - ci[j]) / (3. * h);
+				}
+			}
+		}
+
+	}
+
+	/**
+	 * @brief        Akima spline (gsl_interp_akima)
+	 */
+	inline void Akima () {
+
+		const size_t n = m_nx, nc = m_nc;
+		const double* x = &m_x[0];
+		const double* a = &m_a[0];
+		m_b.resize (n*nc); m_c.resize (n*nc); m_d.resize (n*nc);
+
+#pragma omp parallel for schedule (dynamic)
+		for (long c0 = 0; c0 < (long)nc; c0 += block) {
+
+			const size_t c1 = std::min ((size_t)c0 + block, nc), nb = c1 - c0;
+
+			// Secant slopes with two extrapolated on either end, m(i) at row i+2
+			std::vector<double> ms ((n+3)*nb);
+			for (size_t i = 0; i < n-1; ++i) {
+				const double h = x[i+1] - x[i];
+				double* m = &ms[(i+2)*nb];
+				for (size_t j = 0; j < nb; ++j)
+					m[j] = (a[(i+1)*nc + c0+j] - a[i*nc + c0+j]) / h;
+			}
+			for (size_t j = 0; j < nb; ++j) {
+				const double m0 = ms[2*nb+j], m1 = ms[3*nb+j], ml = ms[n*nb+j], mll = ms[(n-1)*nb+j];
+				ms[j]           = 3. * m0 - 2. * m1;
+				ms[nb+j]        = 2. * m0 - m1;
+				ms[(n+1)*nb+j]  = 2. * ml - mll;
+				ms[(n+2)*nb+j]  = 3. * ml - 2. * mll;
+			}
+
+			for (size_t i = 0; i < n-1; ++i) {
+				const double h = x[i+1] - x[i];
+				const double *mm2 = &ms[i*nb], *mm1 = &ms[(i+1)*nb], *m0 = &ms[(i+2)*nb],
+					*mp1 = &ms[(i+3)*nb], *mp2 = &ms[(i+4)*nb];
+				double *b = &m_b[i*nc + c0], *c = &m_c[i*nc + c0], *d = &m_d[i*nc + c0];
+#pragma omp simd
+				for (size_t j = 0; j < nb; ++j) {
+					const double ne = std::abs (mp1[j] - m0[j]) + std::abs (mm1[j] - mm2[j]);
+					const double nn = std::abs (mp2[j] - mp1[j]) + std::abs (m0[j] - mm1[j]);
+					const double ai = (ne == 0.) ? 0. : std::abs (mm1[j] - mm2[j]) / ne;
+					const double an = (nn == 0.) ? 0. : std::abs (m0[j] - mm1[j]) / nn;
+					const double tl = (nn == 0.) ? m0[j] : (1. - an) * m0[j] + an * mp1[j];
+					const double bi = (1. - ai) * mm1[j] + ai * m0[j];
+					b[j] = (ne == 0.) ? m0[j] : bi;
+					c[j] = (ne == 0.) ? 0. : (3. * m0[j] - 2. * bi - tl) / h;
+					d[j] = (ne == 0.) ? 0. : (bi + tl - 2. * m0[j]) / (h * h);
+				}
+			}
+
+		}
+
+	}
+
+	size_t m_nx;                  /**< @brief # base points */
+	size_t m_nd;                  /**< @brief # columns */
+	size_t m_nc;                  /**< @brief # real columns */
+	INTERP::Method m_intm;        /**< @brief Method */
+	std::vector<double> m_x;      /**< @brief Base */
+	std::vector<double> m_a, m_b, m_c, m_d; /**< @brief Coefficients (nx x nc, row major) */
+
+};
+
+#endif /* __INTERP1_HPP__ */
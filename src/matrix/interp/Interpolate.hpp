@@ -2,6 +2,7 @@
 #define __INTERPOLATE_HPP__
 
 #include "PolyVal.hpp"
+#include "Interp1.hpp"
 #include "Algos.hpp"
 #include "Access.hpp"
 
@@ -24,6 +25,9 @@ interp1 (const Matrix<double>& x, const Matrix<T>& y,
 	size_t  nd  = numel(y)/nx;
 	size_t  nxi  = size(xi,0);
 
+	if (Interp1<T>::Supports (intm))
+		return Interp1<T> (x, y, intm).Lookup (xi);
+
 	Matrix<T> yi (nxi,nd);
 	for (size_t j = 0; j < nd; j++) {
 
@@ -58,6 +62,9 @@ interp_1 (const Vector<double>& x, const Matrix<T>& y,
 	Matrix<double> xx(nx,1);
 	xx.Container() = x;
 
+	if (Interp1<T>::Supports (intm))
+		return Interp1<T> (xx, y, intm).Lookup (xi);
+
 	Matrix<T> yi (nxi,nd);
 	for (size_t j = 0; j < nd; j++) {
 
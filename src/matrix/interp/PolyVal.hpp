@@ -24,12 +24,7 @@
 #include <gsl/gsl_errno.h>
 #include <gsl/gsl_spline.h>
 #include "Algos.hpp"
-
-namespace INTERP {
-	enum Method {
-		LINEAR, POLYNOMIAL, CSPLINE, CSPLINE_PERIODIC, AKIMA, AKIMA_PERIODIC
-	};
-}
+#include "Interp1.hpp"
 
 
 template<class T> struct ITraits;
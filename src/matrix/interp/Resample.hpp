@@ -18,134 +18,69 @@
  *  02110-1301  USA
  */
 
-#ifndef __MITK_HPP__
-#define __MITK_HPP__
+#ifndef __RESAMPLE_HPP__
+#define __RESAMPLE_HPP__
 
 #include "Matrix.hpp"
+#include "Filter.hpp"
 
-#ifdef HAVE_INSIGHT
-    #include "itkImage.h"
-    #include "itkMinimumMaximumImageFilter.h"
-    #include "itkIdentityTransform.h"
-    #include "itkLinearInterpolateImageFunction.h"
-    #include "itkBSplineInterpolateImageFunction.h"
-    #include "itkResampleImageFilter.h"
-#endif
-
-	
-/**
- * @brief Interpolation methods
- */
-enum InterpMethod {
-	LINEAR, BSPLINE
-};
 
 /**
- * @brief      3D resample data to new grid size
+ * @brief      Resample data to new grid size.<br/>
+ *             Separable polyphase filtering along each leading dimension
+ *             (complex or real, any number of dimensions), sample centres
+ *             aligned. Linear and Lanczos kernels antialias when shrinking,
+ *             BSPLINE interpolates with cubic B-splines.
  *
  * @param  M   Incoming data
- * @param  f   Resampling factor in all 3 dimensions
- * @param  im  Interpolation method (LINEAR|BSPLINE)
+ * @param  f   Resampling factor per leading dimension
+ * @param  im  Interpolation method (LINEAR|BSPLINE|LANCZOS)
  *
  * @return     Resampled data
  */
 template<class T> static Matrix<T> 
 resample (const Matrix<T>& M, const Matrix<double>& f, const InterpMethod& im) {
-	
 
-	Matrix <T> res = M;
-	
-#ifdef HAVE_INSIGHT
-	
-	typedef typename itk::Image< T, 3 > ImageType;
-	typedef typename itk::IdentityTransform< double, 3 > TransformType;
-	typedef typename itk::LinearInterpolateImageFunction< ImageType, double > InterpolatorType;
-	typedef typename itk::ResampleImageFilter< ImageType, ImageType > ResampleFilterType;
-	
-	typename InterpolatorType::Pointer linterp = InterpolatorType::New();
-	
-	TransformType::Pointer trafo = TransformType::New();
-	trafo->SetIdentity();
-	
-	typename ImageType::SpacingType space;
-	space[0] = 1.0/f[0];
-	space[1] = 1.0/f[1];
-	space[2] = 1.0/f[2];
-	
-	typedef typename ImageType::SizeType::SizeValueType SizeValueType;
-	typename ImageType::SizeType size; 
-	size[0] = static_cast<SizeValueType>(res.Dim(0));
-	size[1] = static_cast<SizeValueType>(res.Dim(1));
-	size[2] = static_cast<SizeValueType>(res.Dim(2));
-	
-	typename ImageType::Pointer input = ImageType::New();
-	typename ImageType::Pointer output = ImageType::New();
-	
-	typename itk::Image< T, 3 >::IndexType ipos;
-	ipos[0] = 0; ipos[1] = 0; ipos[2] = 0;
-	typename itk::Image< T, 3 >::IndexType opos;
-	opos[0] = 0; opos[1] = 0; opos[2] = 0;
-	
-	typename itk::Image< T, 3 >::RegionType ireg;
-	ireg.SetSize(size);
-	ireg.SetIndex(ipos);
-	input->SetRegions(ireg);
-	input->Allocate();
-	
-	typename itk::Image< T, 3 >::RegionType oreg;
-	oreg.SetSize(size);
-	ireg.SetIndex(opos);
-	output->SetRegions(oreg);
-	output->Allocate();
-	
-	for (size_t z = 0; z < res.Dim(2); z++)
-		for (size_t y = 0; y < res.Dim(1); y++)
-			for (size_t x = 0; x < res.Dim(0); x++) {
-				ipos[0] = x; ipos[1] = y; ipos[2] = z;
-				input->SetPixel (ipos, res.At(x,y,z));
-			}
-	
-	typename ResampleFilterType::Pointer rs = ResampleFilterType::New();
-	rs->SetInput( input );
-	rs->SetTransform( trafo );
-	rs->SetInterpolator( linterp );
-	rs->SetOutputOrigin ( input->GetOrigin());
-	rs->SetOutputSpacing ( space );
-	rs->SetOutputDirection ( input->GetDirection());
-	rs->SetSize ( size );
-	rs->Update ();
-	
-	output = rs->GetOutput();
+	std::vector<Polyphase> ph (std::min (f.Size(), (size_t)M.NDim()));
+	for (size_t d = 0; d < ph.size(); ++d) {
+		const size_t ni = M.Dim(d), no = std::max ((size_t)std::floor (ni * f[d] + .5), (size_t)1);
+		if (no != ni)
+			ph[d] = Polyphase::Resampling (ni, no, im);
+	}
 	
-	res = Matrix<T> (res.Dim(0)*f[0], res.Dim(1)*f[1], res.Dim(2)*f[2]);
-	res.Res(0) = res.Res(0)/f[0];
-	res.Res(1) = res.Dim(1)/f[1];
-	res.Res(2) = res.Dim(2)/f[2];
-	
-	for (size_t z = 0; z < res.Dim(2); z++)
-		for (size_t y = 0; y < res.Dim(1); y++)
-			for (size_t x = 0; x < res.Dim(0); x++) {
-				opos[0] = x; opos[1] = y; opos[2] = z;
-				res.At(x,y,z) = output->GetPixel (opos);
-			}
-	
-#else 
-	
-	printf ("ITK ERROR - Resampling not performed without ITK!\n");
-	
-#endif
-	
-	return res;
+	return separable (M, ph, im == BSPLINE);
 	
 }
 
 
+/**
+ * @brief      Resample data to new grid
+ *
+ * @param  M   Incoming data
+ * @param  n   Grid size per leading dimension
+ * @param  im  Interpolation method (LINEAR|BSPLINE|LANCZOS)
+ *
+ * @return     Resampled data
+ */
+template<class T> static Matrix<T>
+resample (const Matrix<T>& M, const Vector<size_t>& n, const InterpMethod& im) {
+
+	std::vector<Polyphase> ph (std::min (n.size(), (size_t)M.NDim()));
+	for (size_t d = 0; d < ph.size(); ++d)
+		if (n[d] != M.Dim(d))
+			ph[d] = Polyphase::Resampling (M.Dim(d), n[d], im);
+
+	return separable (M, ph, im == BSPLINE);
+
+}
+
+
 /**
  * @brief      Isotropically 3D resample data to new grid size
  *
  * @param  M   Incoming data
  * @param  f   Resampling factor for all 3 dimensions
- * @param  im  Interpolation method (LINEAR|BSPLINE)
+ * @param  im  Interpolation method (LINEAR|BSPLINE|LANCZOS)
  *
  * @return     Resampled data
  */
@@ -11,6 +11,7 @@
 #include "TypeTraits.hpp"
 #include "Matrix.hpp"
 #include "PolyVal.hpp"
+#include "Filter.hpp"
 #include "loess.h"
 #include <algorithm>
 #include <cmath>
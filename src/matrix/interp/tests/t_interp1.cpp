@@ -30,6 +30,42 @@ check_interp1 () {
 }
 
 
+template<class T> bool
+check_batched () {
+
+	typedef typename TypeTraits<T>::RT RT;
+	size_t n = 12, m = 7, nd = 9;
+	INTERP::Method ms[3] = {INTERP::LINEAR, INTERP::CSPLINE, INTERP::AKIMA};
+
+	Matrix<double> x(n,1), xi ((n-1)*m+1,1), xr ((n-1)*m+1,1);
+	Matrix<T> y = randn<T>(n,nd);
+
+	for (size_t i = 0; i < n; ++i)
+		x[i] = (double)i + 0.25*sin((double)i);
+	for (size_t i = 0; i < numel(xi); ++i) {
+		xi[i] = x[0] + (x[n-1]-x[0])*i/(numel(xi)-1.);
+		xr[i] = xi[(i*5)%numel(xi)];
+	}
+
+	for (size_t k = 0; k < 3; ++k) {
+		Matrix<T> yb = Interp1<T>(x, y, ms[k]).Lookup(xi), yu = Interp1<T>(x, y, ms[k]).Lookup(xr);
+		for (size_t j = 0; j < nd; ++j) {
+			PolyVal<T> pv (x, (T*) y.Ptr(j*n), ms[k]);
+			for (size_t i = 0; i < numel(xi); ++i) {
+				T ref = pv.Lookup(xr[i]);
+				if (std::abs(yb(i,j) - pv.Lookup(xi[i])) > 1.0e-5 || std::abs(yu(i,j) - ref) > 1.0e-5) {
+					std::cerr << "batched interp1 (" << k << ") deviates from GSL at " << xi[i] << std::endl;
+					return false;
+				}
+			}
+		}
+	}
+
+	return true;
+
+}
+
+
 int main (int args, char** argv) {
 
     if (!check_interp1<float>())
@@ -41,6 +77,10 @@ int main (int args, char** argv) {
     if (!check_interp1<cxdb>())
         return 1;
 
+    if (!check_batched<float>() || !check_batched<double>() ||
+        !check_batched<cxfl>() || !check_batched<cxdb>())
+        return 1;
+
     return 0;
     
 }
@@ -0,0 +1,281 @@
+/*
+ *  codeare Copyright (C) 2010-2016
+ *                        Kaveh Vahedipour
+ *                        NYU School of Medicine, New York, USA
+ *
+ *  This program is free software; you can redistribute it and/or modify
+ *  it under the terms of the GNU General Public License as published by
+ *  the Free Software Foundation; either version 2 of the License, or
+ *  (at your option) any later version.
+ *
+ *  This program is distributed in the hope that it will be useful, but
+ *  WITHOUT ANY WARRANTY; without even the implied warranty of
+ *  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU
+ *  General Public License for more details.
+ *
+ *  You should have received a copy of the GNU General Public License
+ *  along with this program; if not, write to the Free Software
+ *  Foundation, Inc., 51 Franklin Street, Fifth Floor, Boston, MA
+ *  02110-1301  USA
+ */
+
+#ifndef __ASYNC_IOCONTEXT_HPP__
+#define __ASYNC_IOCONTEXT_HPP__
+
+#include <condition_variable>
+#include <deque>
+#include <functional>
+#include <future>
+#include <memory>
+#include <mutex>
+#include <thread>
+
+#include "IOContext.hpp"
+
+namespace codeare {
+namespace matrix {
+namespace io {
+
+	/**
+	 * @brief   Asynchronous file IO on top of IOContext.<br/>
+	 *
+	 *          Reads and writes are queued and executed by background workers. Each
+	 *          worker owns an IOContext on the same file. Reads return futures,
+	 *          which may be collected when the data are needed. Matrices read are
+	 *          long lived, i.e. allocated as LargeBuffers. Writes take over a
+	 *          copy of the matrix and are flushed while the caller carries on;
+	 *          queued but unwritten data are capped at a configurable number of
+	 *          bytes, beyond which Write blocks.
+	 *
+	 *          Backends whose reads are independent per handle (COD v2, NIfTI and
+	 *          HDF5 built thread-safe) use several readers. All others, as well as
+	 *          writing, use a single worker, i.e. IO on one file stays in order.
+	 */
+	class AsyncIOContext {
+
+		typedef std::function<void(IOContext&)> Task;
+
+	public:
+
+		/**
+		 * @brief  Open file
+		 *
+		 * @param  fname     File name
+		 * @param  mode      READ/WRITE
+		 * @param  nthreads  Maximum number of concurrent readers (0: hardware concurrency)
+		 * @param  max_bytes Maximum bytes of queued writes
+		 * @param  verbosity Verbose
+		 */
+		AsyncIOContext (const std::string& fname, const IOMode mode = READ, const size_t nthreads = 0,
+				const size_t max_bytes = ((size_t)1 << 30), const bool verbosity = false) {
+			Open (fname, mode, nthreads, max_bytes, verbosity);
+		}
+
+		/**
+		 * @brief  Open file named in XML element (attribute "fname")
+		 *
+		 * @param  txe       data-in/data-out element
+		 * @param  base      Base directory
+		 * @param  mode      READ/WRITE
+		 * @param  nthreads  Maximum number of concurrent readers (0: hardware concurrency)
+		 * @param  max_bytes Maximum bytes of queued writes
+		 * @param  verbosity Verbose
+		 */
+		AsyncIOContext (const TiXmlElement* txe, const std::string& base = ".", const IOMode mode = READ,
+				const size_t nthreads = 0, const size_t max_bytes = ((size_t)1 << 30),
+				const bool verbosity = false) {
+			Open (base + "/" + std::string(txe->Attribute("fname")), mode, nthreads, max_bytes, verbosity);
+		}
+
+		/**
+		 * @brief  Finish all queued IO and close
+		 */
+		~AsyncIOContext () {
+			Wait ();
+			{
+				std::lock_guard<std::mutex> lock (m_mutex);
+				m_stop = true;
+			}
+			m_work.notify_all();
+			for (size_t i = 0; i < m_threads.size(); ++i)
+				m_threads[i].join();
+		}
+
+		/**
+		 * @brief  Queue read of a matrix
+		 *
+		 * @param  uri  Name in file
+		 * @return      Future matrix
+		 */
+		template<class T> std::future<Matrix<T> > Read (const std::string& uri) {
+			return Submit<Matrix<T> > ([uri] (IOContext& ioc) {
+					LargeBuffers large;
+					return ioc.Read<T>(uri);
+				}, 0);
+		}
+
+		/**
+		 * @brief  Queue read of a matrix (XML element's "uri")
+		 *
+		 * @param  txe  Element (copied)
+		 * @return      Future matrix
+		 */
+		template<class T> std::future<Matrix<T> > Read (const TiXmlElement* txe) {
+			std::shared_ptr<TiXmlElement> e (new TiXmlElement(*txe));
+			return Submit<Matrix<T> > ([e] (IOContext& ioc) {
+					LargeBuffers large;
+					return ioc.Read<T>(e.get());
+				}, 0);
+		}
+
+		/**
+		 * @brief  Queue read of the whole file into the workspace (e.g. SYNGO raw data)
+		 *
+		 * @return      Future completion
+		 */
+		std::future<void> Read () {
+			return Submit<void> ([] (IOContext& ioc) { ioc.Read(); }, 0);
+		}
+
+		/**
+		 * @brief  Queue write of a matrix. Blocks while queued writes exceed the cap.
+		 *
+		 * @param  M    Matrix (moved from if rvalue)
+		 * @param  uri  Name in file
+		 * @return      Future success
+		 */
+		template<class T> std::future<bool> Write (Matrix<T> M, const std::string& uri) {
+			const size_t bytes = M.Size()*sizeof(T);
+			std::shared_ptr<Matrix<T> > pM (new Matrix<T>(std::move(M)));
+			return Submit<bool> ([pM,uri] (IOContext& ioc) { return ioc.Write(*pM, uri); }, bytes);
+		}
+
+		/**
+		 * @brief  Queue write of a matrix (XML element's "uri"). Blocks while queued
+		 *         writes exceed the cap.
+		 *
+		 * @param  M    Matrix (moved from if rvalue)
+		 * @param  txe  Element (copied)
+		 * @return      Future success
+		 */
+		template<class T> std::future<bool> Write (Matrix<T> M, const TiXmlElement* txe) {
+			const size_t bytes = M.Size()*sizeof(T);
+			std::shared_ptr<Matrix<T> > pM (new Matrix<T>(std::move(M)));
+			std::shared_ptr<TiXmlElement> e (new TiXmlElement(*txe));
+			return Submit<bool> ([pM,e] (IOContext& ioc) { return ioc.Write(*pM, e.get()); }, bytes);
+		}
+
+		/**
+		 * @brief  Block until all queued IO is done
+		 */
+		void Wait () {
+			std::unique_lock<std::mutex> lock (m_mutex);
+			m_idle.wait (lock, [this] { return m_queue.empty() && m_busy == 0; });
+		}
+
+		/**
+		 * @brief  Number of workers
+		 */
+		inline size_t Threads () const { return m_threads.size(); }
+
+		/**
+		 * @brief  Backend
+		 */
+		inline IOStrategy Strategy () const { return m_ios; }
+
+		/**
+		 * @brief  Whether backend supports concurrent reads through separate handles
+		 */
+		inline static bool Concurrent (const IOStrategy ios) {
+			switch (ios) {
+			case CODEARE: return true;
+			case NIFTI:   return true;
+#ifdef H5_HAVE_THREADSAFE
+			case HDF5:    return true;
+#endif
+			default:      return false;
+			}
+		}
+
+	private:
+
+		AsyncIOContext (const AsyncIOContext&);
+		AsyncIOContext& operator= (const AsyncIOContext&);
+
+		void Open (const std::string& fname, const IOMode mode, const size_t nthreads,
+				const size_t max_bytes, const bool verbosity) {
+
+			m_max = max_bytes; m_pending = 0; m_busy = 0; m_stop = false;
+
+			m_ctx.push_back (std::unique_ptr<IOContext>(new IOContext (fname, mode)));
+			m_ios = m_ctx[0]->Strategy();
+
+			size_t nw = 1;
+			if (mode == READ && Concurrent(m_ios))
+				nw = std::max ((nthreads) ? nthreads : (size_t)std::thread::hardware_concurrency(), (size_t)1);
+			for (size_t i = 1; i < nw; ++i)
+				m_ctx.push_back (std::unique_ptr<IOContext>(new IOContext (fname, mode)));
+
+			if (verbosity)
+				printf ("  %s: %zu asynchronous %s\n", fname.c_str(), nw, (nw > 1) ? "workers" : "worker");
+
+			for (size_t i = 0; i < nw; ++i)
+				m_threads.push_back (std::thread (&AsyncIOContext::Work, this, i));
+
+		}
+
+		template<class R, class F> std::future<R> Submit (const F& f, const size_t bytes) {
+			std::shared_ptr<std::packaged_task<R(IOContext&)> > task (new std::packaged_task<R(IOContext&)>(f));
+			std::future<R> result = task->get_future();
+			{
+				std::unique_lock<std::mutex> lock (m_mutex);
+				m_space.wait (lock, [this,bytes] { return m_pending == 0 || m_pending + bytes <= m_max; });
+				m_pending += bytes;
+				m_queue.push_back (std::make_pair ([task] (IOContext& ioc) { (*task)(ioc); }, bytes));
+			}
+			m_work.notify_one();
+			return result;
+		}
+
+		void Work (const size_t i) {
+			IOContext& ioc = *m_ctx[i];
+			while (true) {
+				std::pair<Task,size_t> job;
+				{
+					std::unique_lock<std::mutex> lock (m_mutex);
+					m_work.wait (lock, [this] { return m_stop || !m_queue.empty(); });
+					if (m_queue.empty())
+						return;
+					job = std::move (m_queue.front());
+					m_queue.pop_front();
+					++m_busy;
+				}
+				job.first (ioc);
+				{
+					std::lock_guard<std::mutex> lock (m_mutex);
+					m_pending -= job.second;
+					--m_busy;
+				}
+				m_space.notify_all();
+				m_idle.notify_all();
+			}
+		}
+
+		IOStrategy m_ios;                                 /**< @brief Backend */
+		std::vector<std::unique_ptr<IOContext> > m_ctx;   /**< @brief One handle per worker */
+		std::vector<std::thread> m_threads;               /**< @brief Workers */
+		std::deque<std::pair<Task,size_t> > m_queue;      /**< @brief Queued IO and bytes held */
+		std::mutex m_mutex;
+		std::condition_variable m_work;                   /**< @brief Work queued or stop */
+		std::condition_variable m_space;                  /**< @brief Write buffer released */
+		std::condition_variable m_idle;                   /**< @brief Work finished */
+		size_t m_max;                                     /**< @brief Cap of queued write bytes */
+		size_t m_pending;                                 /**< @brief Queued write bytes */
+		size_t m_busy;                                    /**< @brief Workers busy */
+		bool   m_stop;                                    /**< @brief Shut down workers */
+
+	};
+
+}}}
+
+#endif /* __ASYNC_IOCONTEXT_HPP__ */
@@ -11,9 +11,20 @@
 
 #include "Matrix.hpp"
 #include "IOFile.hpp"
+#include "Workspace.hpp"
 
 #include <fstream>
 #include <iostream>
+#include <map>
+#include <stdint.h>
+#include <string.h>
+
+#ifndef _MSC_VER
+#  include <fcntl.h>
+#  include <sys/mman.h>
+#  include <sys/stat.h>
+#  include <unistd.h>
+#endif
 
 
 namespace codeare {
@@ -44,11 +55,42 @@ namespace io{
 
 	static const std::string delim = "543f562189f1e82beb9c177f89f67822";
 
+	static const char     cod_magic[8] = {'C','O','D','E','A','R','E','2'}; /**< @brief v2 file start */
+	static const char     cod_index[8] = {'C','O','D','I','N','D','E','X'}; /**< @brief v2 index trailer */
+	static const uint64_t cod_align    = 64;                                /**< @brief Payload alignment */
+	static const uint64_t cod_page     = 4096;                              /**< @brief Alignment of payloads >= 1 page */
+
+
+	/**
+	 * @brief    Index entry of a .cod v2 file
+	 */
+	struct CODEntry {
+		std::string    name;   /**< @brief Name */
+		int            dt;     /**< @brief Data type */
+		Vector<size_t> dims;   /**< @brief Dimensions */
+		Vector<float>  res;    /**< @brief Resolutions */
+		uint64_t       offset; /**< @brief Payload offset in file (64 byte aligned) */
+		uint64_t       nbytes; /**< @brief Payload size */
+	};
+
 
 	/**
 	 * @brief    codeare .cod file io class
 	 *
+	 *           Version 1 is a sequence of (type, dims, resolutions, name, data,
+	 *           delimiter) records. Version 2 (default for writing) starts with a
+	 *           64 byte header, stores 64 byte aligned payloads and appends an index
+	 *           of all matrices on close:
+	 *
+	 *           [header][payload 0]...[payload n-1][index][index offset, count, "CODINDEX"]
+	 *
+	 *           Opening a v2 file for reading maps it into memory and parses only the
+	 *           index. Matrices are looked up by name and copied straight out of the
+	 *           mapping, or accessed without copy through View().
 	 *
+	 *           Payloads of one page or more are page aligned. With "direct" set, they
+	 *           are read with O_DIRECT into page aligned Matrix buffers (see
+	 *           AllocatorPolicy), bypassing the page cache.
 	 */
 	class CODFile : public IOFile {
 
@@ -59,12 +101,14 @@ namespace io{
 		 *
 		 * @param  fname   File name
 		 * @param  mode    READ(default)/WRITE
-		 * @param  params  Optional parameter set (not used yet)
+		 * @param  params  Optional parameter set ("version" (int): 1 or 2 (default) for writing,
+		 *                 "direct" (bool): O_DIRECT reads of v2 payloads)
 		 * @param  verbose Verbose output true/false
 		 */
 		CODFile (const std::string& fname, const IOMode mode = READ,
 				const Params& params = Params(), const bool verbose = false) :
-					IOFile (fname, mode, params, verbose) {
+					IOFile (fname, mode, params, verbose), m_version(2), m_map(0),
+					m_size(0), m_next(0), m_writing(mode == WRITE), m_direct(false) {
 
 			const char* R = "rb";
 			const char* W = "wb";
@@ -74,24 +118,104 @@ namespace io{
 			if (reading)
 				assert (fexists(fname));
 
-			if ((m_file = fopen(this->m_fname.c_str(), reading ? R : W))==NULL)
+			if ((m_file = fopen(this->m_fname.c_str(), reading ? R : W))==NULL) {
 				printf("Cannot open %s file (%s).\n", this->m_fname.c_str(), reading ? R : W);
+				return;
+			}
+
+			if (reading) {
+				if (params.exists("direct"))
+					m_direct = params.Get<bool>("direct");
+				char magic[sizeof(cod_magic)];
+				m_version = (fread (magic, 1, sizeof(magic), m_file) == sizeof(magic) &&
+						!memcmp (magic, cod_magic, sizeof(magic))) ? 2 : 1;
+				if (m_version == 2)
+					OpenIndex ();
+				else
+					rewind (m_file);
+			} else {
+				if (params.exists("version"))
+					m_version = params.Get<int>("version");
+				if (m_version == 2) {
+					char header[cod_align] = {0};
+					uint32_t version = 2;
+					memcpy (header, cod_magic, sizeof(cod_magic));
+					memcpy (header + sizeof(cod_magic), &version, sizeof(version));
+					mwrite (header, cod_align, m_file, "header");
+				}
+			}
 
 		}
 
 
 		/**
-		 * @brief  Close file handle
+		 * @brief  Close file handle (writes index of v2 files)
 		 */
 		~CODFile () {
+			if (m_file && m_writing && m_version == 2)
+				WriteIndex ();
+#ifndef _MSC_VER
+			if (m_map)
+				munmap (m_map, m_size);
+#endif
 			if (m_file)
 				fclose(m_file);
 		};
 
 
+		/**
+		 * @brief  File format version
+		 */
+		inline int Version () const {
+			return m_version;
+		}
+
+
+		/**
+		 * @brief  Names of all matrices in order of writing (v2)
+		 */
+		inline std::vector<std::string> Names () const {
+			std::vector<std::string> names;
+			for (size_t i = 0; i < m_entries.size(); ++i)
+				names.push_back (m_entries[i].name);
+			return names;
+		}
+
+
+		/**
+		 * @brief  Index entry of a matrix (v2)
+		 *
+		 * @param  uri  Name
+		 * @return      Entry or NULL if not found
+		 */
+		inline const CODEntry* Entry (const std::string& uri) const {
+			std::map<std::string,size_t>::const_iterator it = m_lookup.find(uri);
+			return (it == m_lookup.end()) ? 0 : &m_entries[it->second];
+		}
+
+
+		/**
+		 * @brief  Zero copy read only access to the payload of a matrix in the
+		 *         mapping (v2). Valid as long as the file is open.
+		 *
+		 * @param  uri  Name
+		 * @return      Data or NULL if not found / type mismatch / not mapped
+		 */
+		template <class T> inline const T*
+		View (const std::string& uri) const {
+			const CODEntry* e = Entry (uri);
+			if (!e || !m_map || CODTraits<T>::dt != e->dt)
+				return 0;
+			return (const T*) ((const char*) m_map + e->offset);
+		}
+
+
 		template <class T> Matrix<T>
 		Read (const std::string& uri = "") const {
 
+			if (m_version == 2)
+				return ReadIndexed<T> (uri);
+
 			int dt;
 			size_t n;
 			Vector<size_t> dim;
@@ -151,6 +275,9 @@ namespace io{
 
 			assert (m_file != NULL);
 
+			if (m_version == 2)
+				return WriteIndexed (M, uri);
+
 			dtype dt = CODTraits<T>::dt;
 			size_t n = M.NDim();
 
@@ -189,13 +316,338 @@ namespace io{
 
 		}
 
+
+		/**
+		 * @brief  Read matrix by name from XML entry's "uri" attribute
+		 */
+		template <class T> Matrix<T>
+		Read (const TiXmlElement* txe) const {
+			const char* uri = txe->Attribute("uri");
+			return this->Read<T> (uri ? std::string(uri) : std::string());
+		}
+
+
+		/**
+		 * @brief  Write matrix named after XML entry's "uri" attribute
+		 */
+		template <class T> bool
+		Write (const Matrix<T>& M, const TiXmlElement* txe) {
+			const char* uri = txe->Attribute("uri");
+			return this->Write (M, uri ? std::string(uri) : std::string());
+		}
+
+
+		/**
+		 * @brief  Read all matrices of a v2 file into workspace
+		 */
+		void Read () const {
+			for (size_t i = 0; i < m_entries.size(); ++i) {
+				const CODEntry& e = m_entries[i];
+				switch (e.dt) {
+				case RLFL: { Matrix<float>  M = Read<float>(e.name);  wspace.Add (e.name, M); } break;
+				case RLDB: { Matrix<double> M = Read<double>(e.name); wspace.Add (e.name, M); } break;
+				case CXFL: { Matrix<cxfl>   M = Read<cxfl>(e.name);   wspace.Add (e.name, M); } break;
+				case CXDB: { Matrix<cxdb>   M = Read<cxdb>(e.name);   wspace.Add (e.name, M); } break;
+				default:   printf ("  Skipping %s of unsupported type\n", e.name.c_str()); break;
+				}
+			}
+		}
+
 	private:
 
 
-		CODFile () : m_file (0) {};
-		CODFile (const CODFile&) : m_file(0) {};
+		/**
+		 * @brief  v2: Look up by name (empty: next in order) and copy from mapping
+		 */
+		template <class T> Matrix<T>
+		ReadIndexed (const std::string& uri) const {
+
+			Matrix<T> M;
+			const CODEntry* e = (uri.empty()) ?
+					((m_next < m_entries.size()) ? &m_entries[m_next++] : 0) : Entry (uri);
+
+			if (!e) {
+				printf ("  %s not found in %s\n", uri.c_str(), this->m_fname.c_str());
+				return M;
+			}
+			if (CODTraits<T>::dt != e->dt)
+				return M;
+
+			{
+				LargeBuffers large; // long lived, page aligned for O_DIRECT
+				M = Matrix<T>(e->dims, e->res);
+			}
+			M.SetClassName(e->name.c_str());
+			assert (M.Size()*sizeof(T) == e->nbytes);
+
+			if (m_direct && Direct ((char*) M.Ptr(), *e))
+				return M;
+
+			if (m_map) {
+				const char* src = (const char*) m_map + e->offset;
+				char* dst = (char*) M.Ptr();
+				const size_t bs = 1<<22, nb = (e->nbytes + bs - 1) / bs;
+#pragma omp parallel for schedule (static)
+				for (long b = 0; b < (long)nb; ++b)
+					memcpy (dst + b*bs, src + b*bs, std::min ((size_t)bs, (size_t)(e->nbytes - b*bs)));
+			} else {
+				fseek (m_file, e->offset, SEEK_SET);
+				mread (M.Ptr(), M.Size(), m_file, "data");
+			}
+
+			return M;
+
+		}
+
+
+		/**
+		 * @brief  v2: Write aligned payload and remember index entry
+		 */
+		template <class T> bool
+		WriteIndexed (const Matrix<T>& M, const std::string& uri) {
+
+			CODEntry e;
+			e.name   = uri;
+			e.dt     = CODTraits<T>::dt;
+			e.dims   = M.Dim();
+			e.res    = M.Res();
+			e.nbytes = M.Size() * sizeof(T);
+
+			// Pad to alignment
+			const uint64_t align = (e.nbytes >= cod_page) ? cod_page : cod_align;
+			uint64_t pos = ftell (m_file), pad = (align - pos % align) % align;
+			char zeros[cod_page] = {0};
+			if (pad && !mwrite (zeros, pad, m_file, "padding"))
+				return false;
+			e.offset = pos + pad;
+
+			if (!mwrite (M.Ptr(), M.Size(), m_file, "data"))
+				return false;
+
+			m_lookup[uri] = m_entries.size();
+			m_entries.push_back (e);
+
+			return true;
+
+		}
+
+
+		/**
+		 * @brief  v2: Append index and trailer
+		 */
+		void WriteIndex () {
+
+			std::vector<char> buf;
+			for (size_t i = 0; i < m_entries.size(); ++i) {
+				const CODEntry& e = m_entries[i];
+				uint64_t nl = e.name.size(), nd = e.dims.size();
+				Put (buf, nl);
+				buf.insert (buf.end(), e.name.begin(), e.name.end());
+				Put (buf, (int32_t) e.dt);
+				Put (buf, nd);
+				for (size_t d = 0; d < nd; ++d)
+					Put (buf, (uint64_t) e.dims[d]);
+				for (size_t d = 0; d < nd; ++d)
+					Put (buf, e.res[d]);
+				Put (buf, e.offset);
+				Put (buf, e.nbytes);
+			}
+
+			uint64_t offset = ftell (m_file), count = m_entries.size();
+			Put (buf, offset);
+			Put (buf, count);
+			buf.insert (buf.end(), cod_index, cod_index + sizeof(cod_index));
+
+			mwrite (&buf[0], buf.size(), m_file, "index");
+
+		}
+
+
+		/**
+		 * @brief  v2: Read page aligned payload with O_DIRECT in parallel chunks,
+		 *         remainder of last page through the page cache
+		 *
+		 * @return  Success (false: not applicable, use buffered read)
+		 */
+		bool Direct (char* dst, const CODEntry& e) const {
+#if defined (O_DIRECT)
+			if (e.offset % cod_page || (uintptr_t)dst % cod_page || e.nbytes < cod_page)
+				return false;
+			int fd = open (this->m_fname.c_str(), O_RDONLY | O_DIRECT);
+			if (fd < 0)
+				return false;
+			const size_t body = e.nbytes / cod_page * cod_page, bs = 1<<26, nb = (body + bs - 1) / bs;
+			bool ok = true;
+#pragma omp parallel for schedule (dynamic) reduction (&&:ok)
+			for (long b = 0; b < (long)nb; ++b) {
+				const size_t len = std::min (bs, body - b*bs);
+				ok = ok && (pread (fd, dst + b*bs, len, e.offset + b*bs) == (ssize_t)len);
+			}
+			close (fd);
+			if (ok && body < e.nbytes) {
+				if (m_map)
+					memcpy (dst + body, (const char*) m_map + e.offset + body, e.nbytes - body);
+				else {
+					fseek (m_file, e.offset + body, SEEK_SET);
+					ok = mread (dst + body, e.nbytes - body, m_file, "data");
+				}
+			}
+			return ok;
+#else
+			return false;
+#endif
+		}
+
+
+		/**
+		 * @brief  v2: Map file and parse index
+		 */
+		void OpenIndex () {
+
+			fseek (m_file, 0, SEEK_END);
+			m_size = ftell (m_file);
+			const size_t tsize = 2*sizeof(uint64_t) + sizeof(cod_index);
+			if (m_size < cod_align + tsize) {
+				Corrupt ("truncated");
+				return;
+			}
+
+#ifndef _MSC_VER
+			int fd = open (this->m_fname.c_str(), O_RDONLY);
+			if (fd >= 0) {
+				void* map = mmap (0, m_size, PROT_READ, MAP_PRIVATE, fd, 0);
+				close (fd);
+				if (map != MAP_FAILED)
+					m_map = map;
+			}
+#endif
+
+			// Trailer
+			std::vector<char> trailer (tsize);
+			fseek (m_file, m_size - tsize, SEEK_SET);
+			if (!mread (&trailer[0], tsize, m_file, "index trailer") ||
+					memcmp (&trailer[2*sizeof(uint64_t)], cod_index, sizeof(cod_index))) {
+				Corrupt ("no index, file not closed?");
+				return;
+			}
+			const char* t = &trailer[0];
+			uint64_t offset = 0, count = 0;
+			Take (t, t + tsize, offset);
+			Take (t, t + tsize, count);
+
+			// Index between last payload and trailer, entries of >= 36 bytes each
+			const uint64_t end = m_size - tsize,
+				min_entry = 4*sizeof(uint64_t) + sizeof(int32_t);
+			if (offset < cod_align || offset > end || count > (end - offset) / min_entry) {
+				Corrupt ("index out of file bounds");
+				return;
+			}
+			std::vector<char> index (end - offset + 1);
+			fseek (m_file, offset, SEEK_SET);
+			if (end > offset && !mread (&index[0], end - offset, m_file, "index")) {
+				Corrupt ("index not readable");
+				return;
+			}
+			const char* p = &index[0];
+			const char* const pe = p + (end - offset);
+			m_entries.resize (count);
+			for (size_t i = 0; i < count; ++i) {
+				CODEntry& e = m_entries[i];
+				uint64_t nl = 0, nd = 0, n = 1;
+				int32_t dt = 0;
+				if (!Take (p, pe, nl) || nl > (uint64_t)(pe - p)) {
+					Corrupt ("name beyond index");
+					return;
+				}
+				e.name = std::string (p, nl); p += nl;
+				if (!Take (p, pe, dt) || !Take (p, pe, nd) ||
+						nd > (uint64_t)(pe - p) / (sizeof(uint64_t) + sizeof(float))) {
+					Corrupt ("dimensions beyond index");
+					return;
+				}
+				e.dt   = dt;
+				e.dims = Vector<size_t>(nd);
+				e.res  = Vector<float>(nd);
+				for (size_t d = 0; d < nd; ++d) {
+					uint64_t dim = 0;
+					Take (p, pe, dim);
+					e.dims[d] = dim;
+					n = (dim && n > ~(uint64_t)0 / dim) ? ~(uint64_t)0 : n * dim;
+				}
+				for (size_t d = 0; d < nd; ++d)
+					Take (p, pe, e.res[d]);
+				if (!Take (p, pe, e.offset) || !Take (p, pe, e.nbytes)) {
+					Corrupt ("entry beyond index");
+					return;
+				}
+				// Payload between header and index, and of matching size
+				const uint64_t es = ElementSize (e.dt);
+				if (e.offset < cod_align || e.offset > offset || e.nbytes > offset - e.offset ||
+						!es || n > e.nbytes / es || n * es != e.nbytes) {
+					Corrupt ("payload out of file bounds or of wrong size");
+					return;
+				}
+				m_lookup[e.name] = i;
+			}
+
+			if (this->m_verb)
+				printf ("  %s: %zu matrices indexed\n", this->m_fname.c_str(), m_entries.size());
+
+		}
+
+		template <class S> inline static void Put (std::vector<char>& buf, const S& s) {
+			const char* c = (const char*) &s;
+			buf.insert (buf.end(), c, c + sizeof(S));
+		}
+
+		/**
+		 * @brief  Read s from p, if before end, and advance
+		 */
+		template <class S> inline static bool Take (const char*& p, const char* end, S& s) {
+			if ((size_t)(end - p) < sizeof(S))
+				return false;
+			memcpy (&s, p, sizeof(S));
+			p += sizeof(S);
+			return true;
+		}
+
+		/**
+		 * @brief  Bytes per element of dtype (0: unknown)
+		 */
+		inline static size_t ElementSize (const int dt) {
+			switch (dt) {
+			case RLFL: return sizeof(float);
+			case RLDB: return sizeof(double);
+			case CXFL: return sizeof(cxfl);
+			case CXDB: return sizeof(cxdb);
+			case LONG: return sizeof(long);
+			case SHRT: return sizeof(short);
+			default:   return 0;
+			}
+		}
+
+		/**
+		 * @brief  v2: Reject corrupt index, i.e. read nothing
+		 */
+		void Corrupt (const char* what) {
+			printf ("  %s: corrupt .cod v2 file (%s)\n", this->m_fname.c_str(), what);
+			m_entries.clear ();
+			m_lookup.clear ();
+			this->m_status = GENERAL_IO_ERROR;
+		}
+
+		CODFile () : m_file (0), m_version(2), m_map(0), m_size(0), m_next(0), m_writing(false), m_direct(false) {};
+		CODFile (const CODFile&) : m_file(0), m_version(2), m_map(0), m_size(0), m_next(0), m_writing(false), m_direct(false) {};
 
 		FILE* m_file;
+		int   m_version;                        /**< @brief Format version */
+		void* m_map;                            /**< @brief Read only mapping (v2) */
+		size_t m_size;                          /**< @brief File size */
+		mutable size_t m_next;                  /**< @brief Next entry for sequential reads */
+		bool  m_writing;                        /**< @brief Opened for writing */
+		bool  m_direct;                         /**< @brief O_DIRECT reads */
+		std::vector<CODEntry> m_entries;        /**< @brief Index (v2) */
+		std::map<std::string,size_t> m_lookup;  /**< @brief Name to index entry */
 
 	};
 
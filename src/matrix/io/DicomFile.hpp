@@ -9,6 +9,9 @@
 #define SRC_MATRIX_IO_DICOM_HPP_
 
 #include "IOFile.hpp"
+#include "OMP.hpp"
+
+#include <limits>
 
 #include "itkVersion.h"
 
@@ -21,6 +24,9 @@
 
 #include "itkImageSeriesReader.h"
 #include "itkImageSeriesWriter.h"
+#include "itkImageFileWriter.h"
+#include "itkImportImageFilter.h"
+#include "itkMetaDataObject.h"
 
 #include <itksys/SystemTools.hxx>
 
@@ -39,7 +45,6 @@ class DicomFile : public IOFile {
 public:
 
     typedef uint16_t PixelType;
-	typedef itk::NumericSeriesFileNames OutputNamesGeneratorType;
     typedef itk::GDCMImageIO ImageIOType;
 
 	DicomFile  (const std::string& fname, const IOMode mode = READ,
@@ -55,10 +60,6 @@ public:
 			throw OPEN_RW_FAILED;
 		std::remove(testfilestr.str().c_str());
 
-		// Create outputfile generator
-        if (mode == WRITE) {
-            _ofnames = OutputNamesGeneratorType::New();
-        }
         _gdcmIO = ImageIOType::New();
         
 		this->m_status = OK;
@@ -69,39 +70,88 @@ public:
 		return Matrix<T>();
 	}
 
+	/**
+	 * @brief  Write images (first two dimensions) of a matrix as one DICOM series
+	 *         into directory uri (IM1.dcm, IM2.dcm, ...). Images are written
+	 *         concurrently, each by its own GDCM IO. uint16 data are handed to ITK
+	 *         in place, other types are converted (magnitude) image by image.
+	 *
+	 * @param  M    Matrix
+	 * @param  uri  Output directory
+	 * @return      Success
+	 */
 	template<class T> bool Write (const Matrix<T>& M, const std::string& uri) throw () {
-        
-        typedef itk::Image<PixelType, 2> InputImageType;
-        typedef itk::Image<PixelType, 2> OutputImageType;
-        typedef itk::ImageSeriesWriter< InputImageType, OutputImageType > SeriesWriterType;
-        
-        // Make the output directory and generate the file names.
+
+        typedef itk::Image<PixelType, 2> ImageType;
+        typedef itk::ImportImageFilter<PixelType, 2> ImportType;
+        typedef itk::ImageFileWriter<ImageType> WriterType;
+
+        // Make the output directory
         itksys::SystemTools::MakeDirectory(uri);
-        size_t n_images = numel(M)/(size(M,0)*size(M,1));
-
-        // Generate the file names
-        std::string seriesFormat("");
-        seriesFormat = seriesFormat + "/" + "IM%d.dcm";
-        _ofnames->SetSeriesFormat (seriesFormat.c_str());
-        _ofnames->SetStartIndex (1);
-        _ofnames->SetEndIndex (numel(M)/(size(M,0)*size(M,1)));
-
-        // Prepare writer for this series
-
-        SeriesWriterType::Pointer _writer = SeriesWriterType::New();
-        _writer->SetImageIO( _gdcmIO );
-        _writer->SetFileNames( _ofnames->GetFileNames() );
-
-        // Write
-        try {
-            _writer->Update();
-        } catch (const itk::ExceptionObject & excp ) {
-            std::cerr << "Exception thrown while writing the series " << std::endl;
-            std::cerr << excp.what() << std::endl;
-            return false;
+        const size_t nx = size(M,0), ny = size(M,1), n_pixels = nx*ny,
+            n_images = numel(M)/n_pixels;
+
+        // One series for all images
+        const std::string study_uid = UID(), series_uid = UID();
+        int failed = 0;
+
+#pragma omp parallel for schedule (dynamic) reduction (+:failed)
+        for (long i = 0; i < (long)n_images; ++i) {
+
+            std::vector<PixelType> buffer;
+            const PixelType* pixels = Pixels (M.Ptr() + i*n_pixels, n_pixels, buffer);
+
+            typename ImportType::Pointer import = ImportType::New();
+            typename ImportType::SizeType sz;
+            sz[0] = nx; sz[1] = ny;
+            typename ImportType::IndexType start;
+            start.Fill (0);
+            typename ImportType::RegionType region;
+            region.SetIndex (start);
+            region.SetSize (sz);
+            import->SetRegion (region);
+            double spacing[2] = {M.Res(0), M.Res(1)};
+            for (size_t d = 0; d < 2; ++d)
+                if (spacing[d] <= 0.)
+                    spacing[d] = 1.;
+            import->SetSpacing (spacing);
+            import->SetImportPointer (const_cast<PixelType*>(pixels), n_pixels, false);
+            import->Update();
+
+            std::stringstream instance, fname;
+            instance << i+1;
+            fname << uri << "/IM" << i+1 << ".dcm";
+
+            typename ImageType::Pointer image = import->GetOutput();
+            itk::MetaDataDictionary& dict = image->GetMetaDataDictionary();
+            itk::EncapsulateMetaData<std::string>(dict, "0020|000d", study_uid);
+            itk::EncapsulateMetaData<std::string>(dict, "0020|000e", series_uid);
+            itk::EncapsulateMetaData<std::string>(dict, "0020|0013", instance.str());
+
+            ImageIOType::Pointer gdcm_io = ImageIOType::New();
+            gdcm_io->KeepOriginalUIDOn();
+            typename WriterType::Pointer writer = WriterType::New();
+            writer->SetImageIO (gdcm_io);
+            writer->SetFileName (fname.str());
+            writer->SetInput (image);
+
+            try {
+                writer->Update();
+            } catch (const itk::ExceptionObject & excp ) {
+#pragma omp critical
+                {
+                    std::cerr << "Exception thrown while writing " << fname.str() << std::endl;
+                    std::cerr << excp.what() << std::endl;
+                }
+                ++failed;
+            }
+
         }
-        
-        std::cout << "  Wrote " << n_images << "dicom images to " << uri.c_str();
+
+        if (failed)
+            return false;
+
+        std::cout << "  Wrote " << n_images << " dicom images to " << uri.c_str() << std::endl;
         return true;
         
     }
@@ -113,7 +163,41 @@ public:
 	virtual ~DicomFile () {}
 
 private:
-	OutputNamesGeneratorType::Pointer _ofnames;
+
+    /**
+     * @brief  New DICOM UID
+     */
+    std::string UID () const {
+#if ITK_VERSION_MAJOR >= 4
+        gdcm::UIDGenerator generator;
+        return std::string (generator.Generate());
+#else
+        return gdcm::Util::CreateUniqueUID (_gdcmIO->GetUIDPrefix());
+#endif
+    }
+
+    /**
+     * @brief  Pixels in place (native type)
+     */
+    inline static const PixelType* Pixels (const PixelType* in, const size_t, std::vector<PixelType>&) {
+        return in;
+    }
+
+    /**
+     * @brief  Pixels converted into buffer (magnitude, clamped to pixel range)
+     */
+    template<class T> inline static const PixelType* Pixels (const T* in, const size_t n,
+            std::vector<PixelType>& buffer) {
+        buffer.resize (n);
+        for (size_t i = 0; i < n; ++i)
+            buffer[i] = (PixelType) std::min (Magnitude(in[i]),
+                (double) std::numeric_limits<PixelType>::max());
+        return &buffer[0];
+    }
+
+    template<class T> inline static double Magnitude (const T& v) { return std::fabs ((double)v); }
+    template<class T> inline static double Magnitude (const std::complex<T>& v) { return std::abs (v); }
+
     ImageIOType::Pointer _gdcmIO;
 };
 
@@ -0,0 +1,138 @@
+/*
+ *  codeare Copyright (C) 2010-2016
+ *                        Kaveh Vahedipour
+ *                        NYU School of Medicine, New York, USA
+ *
+ *  This program is free software; you can redistribute it and/or modify
+ *  it under the terms of the GNU General Public License as published by
+ *  the Free Software Foundation; either version 2 of the License, or
+ *  (at your option) any later version.
+ *
+ *  This program is distributed in the hope that it will be useful, but
+ *  WITHOUT ANY WARRANTY; without even the implied warranty of
+ *  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU
+ *  General Public License for more details.
+ *
+ *  You should have received a copy of the GNU General Public License
+ *  along with this program; if not, write to the Free Software
+ *  Foundation, Inc., 51 Franklin Street, Fifth Floor, Boston, MA
+ *  02110-1301  USA
+ */
+
+#ifndef __GZIP_HPP__
+#define __GZIP_HPP__
+
+#include "OMP.hpp"
+
+#include <algorithm>
+#include <cstdio>
+#include <limits>
+#include <vector>
+
+#include <zlib.h>
+
+namespace codeare {
+namespace matrix {
+namespace io {
+
+	/**
+	 * @brief   Default bytes per compressed chunk
+	 */
+	static const size_t gzip_chunk = 1 << 20;
+
+	/**
+	 * @brief   Compress a buffer as one gzip member
+	 *
+	 * @param  in     Data
+	 * @param  bytes  Size
+	 * @param  out    Compressed member (resized)
+	 * @param  level  Compression level (0-9)
+	 * @return        Success
+	 */
+	inline static bool
+	gzip_member (const void* in, const size_t bytes, std::vector<unsigned char>& out, const int level) {
+
+		z_stream zs;
+		zs.zalloc = Z_NULL; zs.zfree = Z_NULL; zs.opaque = Z_NULL;
+		if (deflateInit2 (&zs, level, Z_DEFLATED, 15+16, 8, Z_DEFAULT_STRATEGY) != Z_OK)
+			return false;
+
+		// z_stream counts in uInt, feed buffers of 4GB and more piecewise
+		const size_t max_avail = std::numeric_limits<uInt>::max();
+		out.resize (deflateBound (&zs, bytes));
+		zs.next_in  = (Bytef*) in;
+		zs.next_out = &out[0];
+		size_t left_in = bytes, left_out = out.size();
+		int ret;
+		do {
+			const uInt ai = (uInt) std::min (left_in, max_avail);
+			const uInt ao = (uInt) std::min (left_out, max_avail);
+			zs.avail_in  = ai;
+			zs.avail_out = ao;
+			ret = deflate (&zs, (left_in > ai) ? Z_NO_FLUSH : Z_FINISH);
+			left_in  -= ai - zs.avail_in;
+			left_out -= ao - zs.avail_out;
+		} while (ret == Z_OK);
+		out.resize (out.size() - left_out);
+		deflateEnd (&zs);
+
+		return ret == Z_STREAM_END;
+
+	}
+
+	/**
+	 * @brief   Append a buffer to a gzip file, compressing chunks in parallel.<br/>
+	 *          Like pigz, the buffer is cut into independently deflated chunks.
+	 *          Each chunk becomes a gzip member of its own; concatenated members
+	 *          are a valid gzip stream (RFC 1952), which gunzip, zlib's gzread
+	 *          and hence znzlib decompress as one. Chunks are compressed by
+	 *          OpenMP threads one wave at a time and written in order, i.e. at
+	 *          most one wave of compressed data is held in memory. Called from
+	 *          within a parallel region, chunks are compressed by the caller.
+	 *
+	 * @param  f      Open file (binary, write)
+	 * @param  in     Data
+	 * @param  bytes  Size
+	 * @param  level  Compression level (0-9)
+	 * @param  chunk  Bytes per chunk
+	 * @return        Success
+	 */
+	inline static bool
+	gzwrite_parallel (FILE* f, const void* in, const size_t bytes, const int level = Z_DEFAULT_COMPRESSION,
+			const size_t chunk = gzip_chunk) {
+
+		const unsigned char* p = (const unsigned char*) in;
+		const size_t nc = std::max ((bytes + chunk - 1) / chunk, (size_t)1);
+#if defined (_OPENMP)
+		const size_t wave = omp_in_parallel() ? 1 : (size_t) omp_get_max_threads();
+#else
+		const size_t wave = 1;
+#endif
+		std::vector<std::vector<unsigned char> > out (std::min (wave, nc));
+		bool ok = true;
+
+		for (size_t c0 = 0; c0 < nc && ok; c0 += out.size()) {
+
+			const size_t c1 = std::min (c0 + out.size(), nc);
+			int failed = 0;
+
+#pragma omp parallel for schedule (dynamic) reduction (+:failed) if (c1-c0 > 1)
+			for (long c = (long)c0; c < (long)c1; ++c) {
+				const size_t a = c*chunk, n = std::min (chunk, bytes - std::min (a, bytes));
+				if (!gzip_member (p + a, n, out[c-c0], level))
+					++failed;
+			}
+
+			ok = (failed == 0);
+			for (size_t c = c0; c < c1 && ok; ++c)
+				ok = fwrite (&out[c-c0][0], 1, out[c-c0].size(), f) == out[c-c0].size();
+
+		}
+
+		return ok;
+
+	}
+
+}}}
+
+#endif /* __GZIP_HPP__ */
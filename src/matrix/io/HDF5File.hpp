@@ -15,6 +15,8 @@
 
 #include <boost/tokenizer.hpp>
 
+#include <mutex>
+
 #include <H5Cpp.h>
 using namespace H5;
 
@@ -50,13 +52,30 @@ namespace io {
         }
     };
 
+    /**
+     * @brief   HDF5 file IO.<br/>
+     *
+     *          Several threads may write (and read) distinct datasets through
+     *          one or several HDF5File objects concurrently, e.g. one writer per
+     *          slice or coil. Library calls are serialised by a process-wide
+     *          lock, as a non thread-safe HDF5 requires, and group creation and
+     *          dataset writes are atomic. Compression filters run within the
+     *          lock, i.e. parallel writers do not compress in parallel.
+     */
     class HDF5File : public IOFile {
 
+        typedef std::lock_guard<std::recursive_mutex> Lock;
+
     public:
 
         /**
          * @brief   Open HDF5 file
          *
+         * Optional params for writing:
+         * - "chunk"   (Vector<size_t>) chunk shape in matrix dimension order
+         * - "deflate" (int) gzip level 1-9 (default 0: uncompressed)
+         * - "shuffle" (bool) byte shuffle before compression (default true)
+         *
          * @param  fname   File name
          * @param  mode    IO mode (R/RW)
          * @param  params  Optional params
@@ -64,7 +83,15 @@ namespace io {
          */
         HDF5File  (const std::string& fname, const IOMode mode = READ,
                 Params params = Params(), const bool verbose = false) :
-                    IOFile(fname, mode, params, verbose), _depth(0) {
+                    IOFile(fname, mode, params, verbose), _depth(0), m_deflate(0),
+                    m_shuffle(true) {
+            if (params.exists("chunk"))
+                m_chunk = params.Get<Vector<size_t> >("chunk");
+            if (params.exists("deflate"))
+                m_deflate = params.Get<int>("deflate");
+            if (params.exists("shuffle"))
+                m_shuffle = params.Get<bool>("shuffle");
+            Lock lock (Mutex());
             Exception::dontPrint();
             try {
                 m_file = H5File (fname, (mode == READ) ? H5F_ACC_RDONLY :H5F_ACC_TRUNC);
@@ -92,6 +119,7 @@ namespace io {
          * @brief   Clean up and close file
          */
         virtual void Close () {
+            Lock lock (Mutex());
             try {
                 m_file.flush(H5F_SCOPE_LOCAL);
             } catch (const Exception& e) {
@@ -110,8 +138,131 @@ namespace io {
 
 
 
+        /**
+         * @brief   Set chunk shape of subsequently written datasets
+         *
+         * @param  chunk   Chunk shape in matrix dimension order (empty: contiguous
+         *                 unless compressed)
+         */
+        inline void Chunking (const Vector<size_t>& chunk) {
+            m_chunk = chunk;
+        }
+
+
+        /**
+         * @brief   Set compression of subsequently written datasets (chunked)
+         *
+         * @param  deflate gzip level 1-9 (0: off)
+         * @param  shuffle Byte shuffle before compression
+         */
+        inline void Compression (const int& deflate, const bool& shuffle = true) {
+            m_deflate = deflate;
+            m_shuffle = shuffle;
+        }
+
+
+        /**
+         * @brief   Dimensions of a dataset in matrix order without reading it
+         *
+         * @param  uri     Dataset
+         * @return         Dimensions
+         */
+        template<class T> Vector<size_t> Dims (const std::string& uri) const {
+            Lock lock (Mutex());
+            DataSet   dataset = m_file.openDataSet(uri);
+            DataSpace space   = dataset.getSpace();
+            Vector<hsize_t> dims (space.getSimpleExtentNdims());
+            size_t    ndim    = space.getSimpleExtentDims(&dims[0], NULL);
+            if (is_complex(T(0)))
+                --ndim;
+            Vector<size_t> mdims (ndim,1);
+            for (size_t i = 0; i < ndim; ++i)
+                mdims[i] = dims[ndim-i-1];
+            space.close();
+            dataset.close();
+            return mdims;
+        }
+
+
+        /**
+         * @brief   Read hyperslab of a dataset
+         *
+         * Usage:
+         * @code{.cpp}
+         *   // Coil 3 of (nx,ny,nz,nc) data
+         *   Vector<size_t> off (4,0), cnt = h5f.Dims<cxfl>("meas");
+         *   off[3] = 3; cnt[3] = 1;
+         *   Matrix<cxfl> c3 = h5f.Read<cxfl>("meas", off, cnt);
+         * @endcode
+         *
+         * @param  uri     Dataset
+         * @param  offset  Start in matrix dimension order (missing: 0)
+         * @param  count   Extent in matrix dimension order (missing: to end)
+         * @return         Hyperslab
+         */
+        template<class T> Matrix<T> Read (const std::string& uri, const Vector<size_t>& offset,
+                                          const Vector<size_t>& count) const {
+
+            Lock lock (Mutex());
+            Vector<size_t> mdims = Dims<T>(uri), mcount (mdims.size());
+            const size_t ndim = mdims.size(), rank = ndim + (is_complex(T(0)) ? 1 : 0);
+            Vector<hsize_t> hoff (rank, 0), hcnt (rank, 2);
+
+            for (size_t i = 0; i < ndim; ++i) {
+                const size_t o = (i < offset.size()) ? offset[i] : 0;
+                mcount[i] = (i < count.size()) ? count[i] : mdims[i] - o;
+                assert (o + mcount[i] <= mdims[i]);
+                hoff[ndim-i-1] = o;
+                hcnt[ndim-i-1] = mcount[i];
+            }
+
+            if (this->m_verb) {
+                printf ("Reading hyperslab of dataset %s ... ", uri.c_str());
+                fflush(stdout);
+            }
+
+            DataSet   dataset = m_file.openDataSet(uri);
+            DataSpace space   = dataset.getSpace();
+            space.selectHyperslab (H5S_SELECT_SET, &hcnt[0], &hoff[0]);
+            DataSpace mspace (rank, &hcnt[0]);
+            PredType* type = HDF5Traits<T>::PType();
+            Matrix<T> M (mcount);
+            dataset.read (&M[0], *type, mspace, space);
+            delete type;
+
+            if (this->m_verb)
+                printf ("O(%s) done\n", DimsToCString(M));
+
+            mspace.close();
+            space.close();
+            dataset.close();
+
+            return M;
+
+        }
+
+
+        /**
+         * @brief   Read one index along one dimension (e.g. one slice, coil or repetition)
+         *
+         * @param  uri     Dataset
+         * @param  dim     Dimension
+         * @param  index   Index along dim
+         * @return         Slice (dimension dim of extent 1)
+         */
+        template<class T> Matrix<T> ReadSlice (const std::string& uri, const size_t& dim,
+                                               const size_t& index) const {
+            Vector<size_t> count = Dims<T>(uri), offset (count.size(), 0);
+            assert (dim < count.size() && index < count[dim]);
+            offset[dim] = index;
+            count[dim]  = 1;
+            return Read<T> (uri, offset, count);
+        }
+
+
         template<class T> Matrix<T> Read (const std::string& uri) const throw () {
 
+            Lock lock (Mutex());
             T         t       = (T) 0;
             DataSet   dataset = m_file.openDataSet(uri);
             DataSpace space   = dataset.getSpace();
@@ -149,6 +300,8 @@ namespace io {
 
         template<class T> bool Write (const Matrix<T>& M, const std::string& uri) throw () {
 
+            Lock lock (Mutex()); // before any HDF5 object, which must close within
+            Exception::dontPrint(); // error stacks are per thread
             T t = (T)0;
             Group group, *tmp;
             std::string path;
@@ -203,7 +356,20 @@ namespace io {
             
             DataSpace space (tmpdim, &dims[0]), attr_space(one, &hone);
             PredType*  type = HDF5Traits<T>::PType();
-            DataSet set = group.createDataSet(name, (*type), space);
+            DSetCreatPropList plist;
+            if (!m_chunk.empty() || m_deflate > 0) {
+                Vector<size_t> chunk = ChunkDims (M);
+                Vector<hsize_t> cdims (tmpdim, 2);
+                for (size_t i = 0; i < chunk.size(); i++)
+                    cdims[chunk.size()-1-i] = chunk[i];
+                plist.setChunk (tmpdim, &cdims[0]);
+                if (m_deflate > 0) {
+                    if (m_shuffle)
+                        plist.setShuffle ();
+                    plist.setDeflate (m_deflate);
+                }
+            }
+            DataSet set = group.createDataSet(name, (*type), space, plist);
             if (is_complex(t))
                 set.createAttribute("complex", H5::PredType::NATIVE_INT, attr_space).write(H5::PredType::NATIVE_INT, &one);
 
@@ -245,6 +411,7 @@ namespace io {
         }
 
         inline void Read () const {
+            Lock lock (Mutex());
         	_depth = 4;
             std::cout << std::string(_depth, ' ') << "File name: " << m_file.getFileName() << std::endl;
             H5std_string root_str = "/";
@@ -361,10 +528,43 @@ namespace io {
 
     private:
 
-        HDF5File (const HDF5File&) : _depth(0) {}
-        HDF5File  () : _depth(0) {}
+        /**
+         * @brief   Process-wide lock of HDF5 library calls
+         */
+        inline static std::recursive_mutex& Mutex () {
+            static std::recursive_mutex mutex;
+            return mutex;
+        }
+
+        /**
+         * @brief   Chunk shape for M: configured shape clipped to M, or else
+         *          leading dimensions up to ~1MB per chunk
+         */
+        template<class T> Vector<size_t> ChunkDims (const Matrix<T>& M) const {
+            const size_t nd = ndims(M);
+            Vector<size_t> chunk (nd, 1);
+            if (!m_chunk.empty()) {
+                for (size_t i = 0; i < nd && i < m_chunk.size(); i++)
+                    chunk[i] = std::max (std::min (m_chunk[i], M.Dim(i)), (size_t)1);
+            } else {
+                size_t bytes = sizeof(T);
+                for (size_t i = 0; i < nd; i++) {
+                    chunk[i] = std::min (M.Dim(i), std::max ((size_t)1, ((size_t)1<<20) / bytes));
+                    bytes *= chunk[i];
+                    if (chunk[i] < M.Dim(i))
+                        break;
+                }
+            }
+            return chunk;
+        }
+
+        HDF5File (const HDF5File&) : _depth(0), m_deflate(0), m_shuffle(true) {}
+        HDF5File  () : _depth(0), m_deflate(0), m_shuffle(true) {}
         H5File m_file; /// @brief My file
         mutable size_t _depth;
+        Vector<size_t> m_chunk; /// @brief Chunk shape (matrix order)
+        int m_deflate; /// @brief gzip level (0: off)
+        bool m_shuffle; /// @brief Shuffle filter with compression
 
     };
 
@@ -54,7 +54,7 @@ namespace io{
 	/**
 	 * @brief Supported data formats
 	 */
-	enum IOStrategy {HDF5 = 0, MATLAB, ISMRM, NIFTI, SYNGO, GE, PHILIPS, NO_STRATEGY};
+	enum IOStrategy {HDF5 = 0, MATLAB, ISMRM, NIFTI, SYNGO, GE, PHILIPS, CODEARE, NO_STRATEGY};
 
 	template<IOStrategy T> struct IOTraits;
 	
@@ -89,7 +89,6 @@ namespace io{
     
 	template<>
 	struct IOTraits<ISMRM> {
-		typedef HDF5File IOClass;
 		static const std::string Suffix () {
 			return ".ird";
 		}
@@ -97,6 +96,7 @@ namespace io{
 			return "ismrm";
 		}
 #ifdef HAVE_ISMRMRD_HDF5_H        
+		typedef IRDFile IOClass;
 		inline static IOFile* Open (const std::string& fname, const IOMode mode,
               const Params& params, const bool verbosity) {
 			return (IOFile*) new IOClass (fname, mode, params, verbosity);
@@ -191,6 +191,37 @@ namespace io{
 #endif
 	};
 
+	template<>
+	struct IOTraits<CODEARE> {
+		typedef CODFile IOClass;
+
+		static const std::string Suffix () {
+			return ".cod";
+		}
+		static const std::string CName () {
+			return "codeare";
+		}
+		inline static IOFile*
+		Open (const std::string& fname, const IOMode mode, const Params& params, const bool verbosity) {
+			return (IOFile*) new IOClass (fname, mode, params, verbosity);
+		}
+		inline static void Read (const IOFile* iof) {
+			((IOClass*)iof)->Read();
+		}
+		template <class T> inline static Matrix<T> Read (const IOFile* iof, const std::string& uri) {
+			return ((IOClass*)iof)->Read<T>(uri);
+		}
+		template <class T> inline static Matrix<T> Read (const IOFile* iof, const TiXmlElement* txe) {
+			return ((IOClass*)iof)->Read<T>(txe);
+		}
+		template <class T> inline static bool Write (IOFile* iof, const Matrix<T>& M, const std::string& uri) {
+			return ((IOClass*)iof)->Write(M,uri);
+		}
+		template <class T> inline static bool Write (IOFile* iof, const Matrix<T>& M, const TiXmlElement* txe) {
+			return ((IOClass*)iof)->Write(M,txe);
+		}
+	};
+
 	
 /*	template<>
 	struct IOTraits<SYNGO> {
@@ -326,6 +357,7 @@ namespace io{
 #ifdef HAVE_NIFTI1_IO_H
 				case NIFTI:  return IOTraits< NIFTI>::Read<T>(m_iof, uri);
 #endif
+				case CODEARE: return IOTraits<CODEARE>::Read<T>(m_iof, uri);
 //				case SYNGO:  return IOTraits< SYNGO>::Read<T>(m_iof, uri);
 				case GE:     break;
 				case PHILIPS: break;
@@ -351,6 +383,7 @@ namespace io{
 #ifdef HAVE_NIFTI1_IO_H
 				case NIFTI:  return IOTraits< NIFTI>::Write<T>(m_iof, M, uri);
 #endif
+				case CODEARE: return IOTraits<CODEARE>::Write<T>(m_iof, M, uri);
 //				case SYNGO:  return IOTraits< SYNGO>::Write<T>(m_iof, M, uri);
 				case GE:     break;
 				case PHILIPS: break;
@@ -376,6 +409,7 @@ namespace io{
 #ifdef HAVE_NIFTI1_IO_H
 				case NIFTI:  return IOTraits< NIFTI>::Read<T>(m_iof, txe);
 #endif
+				case CODEARE: return IOTraits<CODEARE>::Read<T>(m_iof, txe);
 //				case SYNGO:  return IOTraits< SYNGO>::Read<T>(m_iof, txe);
 				case GE:     break;
 				case PHILIPS: break;
@@ -401,6 +435,7 @@ namespace io{
 #ifdef HAVE_NIFTI1_IO_H
 				case NIFTI:  return IOTraits< NIFTI>::Read(m_iof);
 #endif
+				case CODEARE: return IOTraits<CODEARE>::Read(m_iof);
 //				case SYNGO:  return IOTraits< SYNGO>::Read(m_iof);
 				case GE:     break;
 				case PHILIPS: break;
@@ -426,6 +461,7 @@ namespace io{
 #ifdef HAVE_NIFTI1_IO_H
 				case NIFTI:  return IOTraits< NIFTI>::Write<T>(m_iof, M, txe);
 #endif
+				case CODEARE: return IOTraits<CODEARE>::Write<T>(m_iof, M, txe);
 //				case SYNGO:  return IOTraits< SYNGO>::Write<T>(m_iof, M, txe);
 				case GE:     break;
 				case PHILIPS: break;
@@ -468,6 +504,8 @@ namespace io{
 				return MATLAB;
 			else if (HasSuffix (lfname, IOTraits<NIFTI>::Suffix()))
 				return NIFTI;
+			else if (HasSuffix (lfname, IOTraits<CODEARE>::Suffix()))
+				return CODEARE;
 //			else if (HasSuffix (lfname, IOTraits<SYNGO>::Suffix()))
 //				return SYNGO;
 			else
@@ -483,6 +521,8 @@ namespace io{
 				return MATLAB;
 			else if (lname.compare(IOTraits<NIFTI>::CName()) == 0)
 				return NIFTI;
+			else if (lname.compare(IOTraits<CODEARE>::CName()) == 0)
+				return CODEARE;
 //			else if (lname.compare(IOTraits<SYNGO>::CName()) == 0)
 //				return SYNGO;
 			else
@@ -503,6 +543,7 @@ namespace io{
 #ifdef HAVE_NIFTI1_IO_H
 				case NIFTI:  m_iof = IOTraits< NIFTI>::Open(fname, mode, params, verbosity); break;
 #endif
+				case CODEARE: m_iof = IOTraits<CODEARE>::Open(fname, mode, params, verbosity); break;
 //				case SYNGO:  m_iof = IOTraits< SYNGO>::Open(fname, mode, params, verbosity); break;
 				case GE:      break;
 				case PHILIPS: break;
@@ -11,6 +11,9 @@
 #include "ismrmrd_hdf5.h"
 #include "ismrmrd.hxx"
 #include "IOFile.hpp"
+#include "Workspace.hpp"
+
+#include <sstream>
 
 namespace codeare {
 
@@ -18,6 +21,18 @@ namespace codeare {
 
 		namespace io {
 
+			/**
+			 * @brief  Dimensions of ISMRMRD data in codeare
+			 *         (RO, E1, E2, CH, SLC, CON, REP), i.e. channels follow the spatial
+			 *         dimensions as for sensitivity maps
+			 */
+			enum IRDDim {IRD_RO = 0, IRD_E1, IRD_E2, IRD_CH, IRD_SLC, IRD_CON, IRD_REP, IRD_NDIM};
+
+			/**
+			 * @brief  Position of acquisitions outside the encoding limits
+			 */
+			static const size_t IRD_NPOS = ~size_t(0);
+
 			class IRDFile : public IOFile {
 
 			public:
@@ -25,6 +40,12 @@ namespace codeare {
 				/**
 				 * @brief  Construct with file name
 				 *
+				 * Optional params:
+				 * - "scheme"  (std::string) XML schema location
+				 * - "noise"   (std::string) workspace name for noise scans (default "noise")
+				 * - "calib"   (std::string) workspace name for calibration lines (default "acs")
+				 * - "batch"   (size_t) acquisitions per read batch (default 1024)
+				 *
 				 * @param  fname    File name
 				 * @param  verbose  Verbose (default: false)?
 				 */
@@ -32,10 +53,18 @@ namespace codeare {
 						const IOMode& mode = READ,
 						Params params = Params(),
 						const bool verbose = false) :
-						IOFile(fname, mode, params, verbose) {
-
-					const char* sl = m_params.Get<std::string>("scheme").c_str();
-					m_props.schema_location ("http://www.ismrm.org/ISMRMRD", sl);
+						IOFile(fname, mode, params, verbose), m_noise("noise"), m_calib("acs"),
+						m_batch(1024) {
+
+					if (m_params.exists("scheme"))
+						m_scheme = m_params.Get<std::string>("scheme");
+					m_props.schema_location ("http://www.ismrm.org/ISMRMRD", m_scheme);
+					if (m_params.exists("noise"))
+						m_noise = m_params.Get<std::string>("noise");
+					if (m_params.exists("calib"))
+						m_calib = m_params.Get<std::string>("calib");
+					if (m_params.exists("batch"))
+						m_batch = std::max (m_params.Get<size_t>("batch"), (size_t)1);
 
 				}
 
@@ -44,81 +73,389 @@ namespace codeare {
 				 */
 				~IRDFile () {}
 
+
+				/**
+				 * @brief  Read all acquisitions of a dataset
+				 *
+				 *         Acquisitions are read in batches and scattered in parallel by
+				 *         their encoding counters into (RO, E1, E2, CH, SLC, CON, REP).
+				 *         Noise scans are stacked into (RO, #scans, CH) and calibration
+				 *         lines are sorted into their own matrix, both are added to the
+				 *         workspace. Parallel calibration lines which are also imaging
+				 *         lines go to both.
+				 *
+				 * @param  dname    Dataset (group) name
+				 * @return          Imaging data
+				 */
 				template<class T> Matrix<T> Read (const std::string& dname) const {
+					return Acquisitions (dname, (const T*)0);
+				}
 
-					Matrix<T> M;
 
-					ISMRMRD::IsmrmrdDataset ds (m_fname.c_str(),dname.c_str());
+				/**
+				 * @brief  Read default dataset into workspace ("meas")
+				 */
+				inline void Read () const {
+					Matrix<cxfl> M = Read<cxfl>("dataset");
+					wspace.Add ("meas", M);
+				}
 
-					size_t i = 0, na = ds.getNumberOfAcquisitions();
 
-					boost::shared_ptr<std::string> xml = ds.readHeader();
-					std::istringstream str_stream(*xml, std::stringstream::in);
+				/**
+				 * @brief  Write Cartesian data (RO, E1, E2, CH, SLC, CON, REP) as one
+				 *         acquisition per readout with a minimal XML header
+				 *
+				 * @param  M        Data
+				 * @param  uri      Dataset (group) name
+				 * @return          Success
+				 */
+				template<class T> bool
+				Write (const Matrix<T>& M, const std::string& uri) {
 
-					//Let's print some information from the header
-					boost::shared_ptr<ISMRMRD::ismrmrdHeader> cfg;
+					ISMRMRD::IsmrmrdDataset ds (m_fname.c_str(), uri.c_str(), true);
+					Vector<size_t> dims (IRD_NDIM, 1);
+					for (size_t i = 0; i < std::min (ndims(M), (size_t)IRD_NDIM); ++i)
+						dims[i] = size(M,i);
+
+					std::string xml = Header (M, dims);
+					if (ds.writeHeader (xml) < 0)
+						return false;
+
+					const size_t ns = dims[IRD_RO], nc = dims[IRD_CH],
+						nl = numel(M) / (ns*nc);
+					for (size_t l = 0; l < nl; ++l) {
+
+						size_t r = l, e1, e2, slc, con, rep;
+						e1  = r % dims[IRD_E1];  r /= dims[IRD_E1];
+						e2  = r % dims[IRD_E2];  r /= dims[IRD_E2];
+						slc = r % dims[IRD_SLC]; r /= dims[IRD_SLC];
+						con = r % dims[IRD_CON]; r /= dims[IRD_CON];
+						rep = r;
+
+						ISMRMRD::Acquisition acq;
+						acq.head_.number_of_samples = ns;
+						acq.head_.active_channels = nc;
+						acq.head_.available_channels = nc;
+						acq.head_.center_sample = ns/2;
+						acq.head_.scan_counter = l;
+						acq.head_.idx.kspace_encode_step_1 = e1;
+						acq.head_.idx.kspace_encode_step_2 = e2;
+						acq.head_.idx.slice = slc;
+						acq.head_.idx.contrast = con;
+						acq.head_.idx.repetition = rep;
+						for (size_t c = 0; c < nc; ++c)
+							acq.head_.channel_mask[c/64] |= ((uint64_t)1 << (c%64));
+						acq.data_ = new float[2*ns*nc];
+
+						const size_t pos = Offset (dims, 0, e1, e2, slc, con, rep);
+						for (size_t c = 0; c < nc; ++c)
+							for (size_t s = 0; s < ns; ++s) {
+								const T& v = M[pos + s + c*dims[IRD_RO]*dims[IRD_E1]*dims[IRD_E2]];
+								acq.data_[2*(c*ns+s)]   = TypeTraits<T>::Real(v);
+								acq.data_[2*(c*ns+s)+1] = TypeTraits<T>::Imag(v);
+							}
+
+						if (ds.appendAcquisition (&acq) < 0)
+							return false;
 
-					try {
-						cfg = boost::shared_ptr<ISMRMRD::ismrmrdHeader>(ISMRMRD::ismrmrdHeader_ (str_stream,0,m_props));
-					}  catch (const xml_schema::exception& e) {
-						std::cout << "Failed to parse XML Parameters: " << e.what() << std::endl;
-					}
-
-					ISMRMRD::ismrmrdHeader::encoding_sequence e_seq = cfg->encoding();
-					if (e_seq.size() != 1) {
-						std::cout << "Number of encoding spaces: " << e_seq.size() << std::endl;
-						std::cout << "This simple reconstruction application only supports one encoding space" << std::endl;
 					}
 
-					ISMRMRD::encodingSpaceType e_space = (*e_seq.begin()).encodedSpace();
-					ISMRMRD::encodingSpaceType r_space = (*e_seq.begin()).reconSpace();
-					ISMRMRD::encodingLimitsType e_limits = (*e_seq.begin()).encodingLimits();
+					return true;
 
-					std::cout << "Encoding Matrix Size        : [" << e_space.matrixSize().x() << ", " << e_space.matrixSize().y() << ", " << e_space.matrixSize().z() << "]" << std::endl;
-					std::cout << "Reconstruction Matrix Size  : [" << r_space.matrixSize().x() << ", " << r_space.matrixSize().y() << ", " << r_space.matrixSize().z() << "]" << std::endl;
-					std::cout << "Number of acquisitions      : " << ds.getNumberOfAcquisitions() << std::endl;
+				}
 
-					if (e_space.matrixSize().z() != 1) {
-						std::cout << "This simple reconstruction application only supports 2D encoding spaces" << std::endl;
-					}
+				template<class T> Matrix<T>
+				Read (const TiXmlElement* txe) const {
+					std::string uri (txe->Attribute("uri"));
+					return this->Read<T>(uri);
+				}
 
+				template<class T> bool
+				Write (const Matrix<T>& M, const TiXmlElement* txe) {
+					std::string uri (txe->Attribute("uri"));
+					return this->Write (M, uri);
+				}
 
-					// Loop over acquisitions
-					for (; i < na; i++) {
+				xml_schema::properties m_props; /**< @brief Properties */
 
-						boost::shared_ptr<ISMRMRD::Acquisition> acq = ds.readAcquisition(i);
+			private:
 
-						//acq->head_.idx.kspace_encode_step_1
-						//size_t offset = acq->head_.idx.kspace_encode_step_1*buffer.dimensions_[0];
-						//memcpy(&buffer.data_[offset],acq->data_,sizeof(float)*2*buffer.dimensions_[0]);
+				/**
+				 * @brief  Read acquisitions, see Read(dname). Raw data are complex.
+				 */
+				template<class S> Matrix<std::complex<S> >
+				Acquisitions (const std::string& dname, const std::complex<S>*) const {
+
+					typedef std::complex<S> T;
+					ISMRMRD::IsmrmrdDataset ds (m_fname.c_str(), dname.c_str(), false);
+					const size_t na = ds.getNumberOfAcquisitions();
+
+					Vector<size_t> dims = Dims (ds);
+					Matrix<T> M, C;
+					std::vector<T> noise;
+					size_t nnoise = 0, nsamples = 0, nchannels = 0, skipped = 0, mismatched = 0;
+					std::vector<unsigned> mcount, ccount; // acquisitions per readout
+
+					if (this->m_verb)
+						printf ("Reading %zu acquisitions of %s ...\n", na, dname.c_str());
+
+					for (size_t a0 = 0; a0 < na; a0 += m_batch) {
+
+						const size_t nb = std::min (m_batch, na-a0);
+						std::vector<boost::shared_ptr<ISMRMRD::Acquisition> > batch (nb);
+
+						// HDF5 reads are serial
+						for (size_t i = 0; i < nb; ++i)
+							batch[i] = ds.readAcquisition(a0+i);
+
+						// Shape from first imaging acquisition
+						for (size_t i = 0; i < nb && M.Size() <= 1; ++i) {
+							const ISMRMRD::AcquisitionHeader& h = batch[i]->head_;
+							if (IsSet (h.flags, ISMRMRD::ACQ_IS_NOISE_MEASUREMENT))
+								continue;
+							dims[IRD_RO] = h.number_of_samples;
+							dims[IRD_CH] = h.active_channels;
+							M = Matrix<T>(dims);
+							if (this->m_verb)
+								std::cout << "  Imaging data: " << dims << std::endl;
+						}
+
+						// Noise scans keep their order, calibration buffer on first use
+						for (size_t i = 0; i < nb; ++i) {
+							const ISMRMRD::AcquisitionHeader& h = batch[i]->head_;
+							if (C.Size() <= 1 && M.Size() > 1 &&
+									(IsSet (h.flags, ISMRMRD::ACQ_IS_PARALLEL_CALIBRATION) ||
+									 IsSet (h.flags, ISMRMRD::ACQ_IS_PARALLEL_CALIBRATION_AND_IMAGING)))
+								C = Matrix<T>(M.Dim());
+							if (!IsSet (h.flags, ISMRMRD::ACQ_IS_NOISE_MEASUREMENT))
+								continue;
+							if (!nnoise) {
+								nsamples  = h.number_of_samples;
+								nchannels = h.active_channels;
+							} else if (h.number_of_samples != nsamples || h.active_channels != nchannels) {
+								++mismatched;
+								continue;
+							}
+							for (size_t k = 0; k < nsamples*nchannels; ++k)
+								noise.push_back (T(batch[i]->data_[2*k], batch[i]->data_[2*k+1]));
+							++nnoise;
+						}
+
+						// Target positions in acquisition order
+						std::vector<size_t> img (nb, IRD_NPOS), cal (nb, IRD_NPOS);
+						for (size_t i = 0; i < nb; ++i) {
+							const uint64_t f = batch[i]->head_.flags;
+							if (IsSet (f, ISMRMRD::ACQ_IS_NOISE_MEASUREMENT))
+								continue;
+							const bool calib = IsSet (f, ISMRMRD::ACQ_IS_PARALLEL_CALIBRATION) ||
+									IsSet (f, ISMRMRD::ACQ_IS_PARALLEL_CALIBRATION_AND_IMAGING),
+								imaging = !IsSet (f, ISMRMRD::ACQ_IS_PARALLEL_CALIBRATION);
+							if (imaging && (img[i] = Position (batch[i]->head_, M, mcount)) == IRD_NPOS)
+								++skipped;
+							if (calib)
+								cal[i] = Position (batch[i]->head_, C, ccount);
+						}
+
+						// Parallel over channels: repeated positions (averages, segments)
+						// are summed in acquisition order
+#pragma omp parallel for schedule (dynamic)
+						for (long c = 0; c < (long)dims[IRD_CH]; ++c)
+							for (size_t i = 0; i < nb; ++i) {
+								if (img[i] != IRD_NPOS)
+									Scatter (*batch[i], c, img[i], M);
+								if (cal[i] != IRD_NPOS)
+									Scatter (*batch[i], c, cal[i], C);
+							}
 
 					}
 
-					printf ("" JL_SIZE_T_SPECIFIER "\n", i);
+					Average (M, mcount);
+					Average (C, ccount);
+
+					if (skipped)
+						printf ("  %zu acquisitions outside encoding limits skipped\n", skipped);
+					if (mismatched)
+						printf ("  %zu noise scans not of size %zux%zu of the first skipped\n",
+								mismatched, nsamples, nchannels);
+
+					if (nnoise && nsamples*nchannels) {
+						Matrix<T> N (nsamples, nnoise, nchannels);
+						for (size_t n = 0; n < nnoise; ++n)
+							for (size_t c = 0; c < nchannels; ++c)
+								std::copy (&noise[(n*nchannels + c)*nsamples],
+										&noise[(n*nchannels + c + 1)*nsamples], &N(0,n,c));
+						wspace.Add (m_noise, N);
+					}
+					if (C.Size() > 1)
+						wspace.Add (m_calib, C);
 
 					return M;
 
 				}
 
+				template<class T> Matrix<T>
+				Acquisitions (const std::string& dname, const T*) const {
+					printf ("  ERROR - ISMRMRD raw data are complex and can not be read into real matrices\n");
+					return Matrix<T>();
+				}
 
-				template<class T> bool
-				Write (const Matrix<T>& M, const std::string& uri) {
-					return false;
+				/**
+				 * @brief  Flag bit (1-based as in ISMRMRD::FlagBit)
+				 */
+				inline static bool IsSet (const uint64_t& flags, const size_t& bit) {
+					return (flags >> (bit-1)) & 1;
 				}
 
-				template<class T> Matrix<T>
-				Read (const TiXmlElement* txe) const {
-					Matrix<T> M;
-					return M;
+				/**
+				 * @brief  Linear index of (sample, e1, e2, channel 0, slc, con, rep)
+				 */
+				inline static size_t Offset (const Vector<size_t>& d, const size_t& s, const size_t& e1,
+						const size_t& e2, const size_t& slc, const size_t& con, const size_t& rep) {
+					return s + d[IRD_RO] * (e1 + d[IRD_E1] * (e2 + d[IRD_E2] * d[IRD_CH] *
+							(slc + d[IRD_SLC] * (con + d[IRD_CON] * rep))));
 				}
 
-				template<class T> bool
-				Write (const Matrix<T>& M, const TiXmlElement* txe) {
-					return false;
+				/**
+				 * @brief  Offset of channel 0 of an acquisition's readout in M and count
+				 *         it, IRD_NPOS if outside encoding limits
+				 */
+				template<class T> inline static size_t
+				Position (const ISMRMRD::AcquisitionHeader& h, const Matrix<T>& M,
+						std::vector<unsigned>& count) {
+					const ISMRMRD::EncodingCounters& i = h.idx;
+					const Vector<size_t>& d = M.Dim();
+					if (d.size() < IRD_NDIM || i.kspace_encode_step_1 >= d[IRD_E1] ||
+							i.kspace_encode_step_2 >= d[IRD_E2] || i.slice >= d[IRD_SLC] ||
+							i.contrast >= d[IRD_CON] || i.repetition >= d[IRD_REP] ||
+							h.active_channels > d[IRD_CH])
+						return IRD_NPOS;
+					const size_t pos = Offset (d, 0, i.kspace_encode_step_1, i.kspace_encode_step_2,
+							i.slice, i.contrast, i.repetition);
+					if (count.empty())
+						count.resize (numel(M)/d[IRD_RO], 0);
+					++count[pos/d[IRD_RO]];
+					return pos;
 				}
 
-				xml_schema::properties m_props; /**< @brief Properties */
+				/**
+				 * @brief  Add channel c of one acquisition at its position
+				 */
+				template<class T> inline static void
+				Scatter (const ISMRMRD::Acquisition& acq, const size_t& c, const size_t& pos,
+						Matrix<T>& M) {
+					const ISMRMRD::AcquisitionHeader& h = acq.head_;
+					const Vector<size_t>& d = M.Dim();
+					if (c >= h.active_channels)
+						return;
+					const size_t ns = std::min ((size_t)h.number_of_samples, d[IRD_RO]);
+					const float* src = acq.data_ + 2*c*h.number_of_samples;
+					T* dst = &M[pos + c*d[IRD_RO]*d[IRD_E1]*d[IRD_E2]];
+					for (size_t s = 0; s < ns; ++s)
+						dst[s] += T(src[2*s], src[2*s+1]);
+				}
+
+				/**
+				 * @brief  Mean of repeatedly acquired readouts
+				 */
+				template<class T> inline static void
+				Average (Matrix<T>& M, const std::vector<unsigned>& count) {
+					if (count.empty())
+						return;
+					const Vector<size_t>& d = M.Dim();
+					const size_t cs = d[IRD_RO]*d[IRD_E1]*d[IRD_E2];
+#pragma omp parallel for schedule (static)
+					for (long l = 0; l < (long)count.size(); ++l)
+						if (count[l] > 1)
+							for (size_t c = 0; c < d[IRD_CH]; ++c) {
+								T* dst = &M[l*d[IRD_RO] + c*cs];
+								for (size_t s = 0; s < d[IRD_RO]; ++s)
+									dst[s] /= (typename T::value_type) count[l];
+							}
+				}
+
+				/**
+				 * @brief  Encoding dimensions from XML header (RO, CH from first acquisition)
+				 */
+				inline Vector<size_t> Dims (ISMRMRD::IsmrmrdDataset& ds) const {
+
+					Vector<size_t> dims (IRD_NDIM, 1);
+					boost::shared_ptr<std::string> xml = ds.readHeader();
+					std::istringstream str_stream(*xml, std::stringstream::in);
+					boost::shared_ptr<ISMRMRD::ismrmrdHeader> cfg;
+
+					try {
+						cfg = boost::shared_ptr<ISMRMRD::ismrmrdHeader>(ISMRMRD::ismrmrdHeader_ (str_stream,0,m_props));
+					}  catch (const xml_schema::exception& e) {
+						std::cout << "Failed to parse XML Parameters: " << e.what() << std::endl;
+						return dims;
+					}
+
+					ISMRMRD::ismrmrdHeader::encoding_sequence e_seq = cfg->encoding();
+					if (e_seq.size() != 1)
+						std::cout << "Only first of " << e_seq.size() << " encoding spaces is read" << std::endl;
+
+					ISMRMRD::encodingSpaceType e_space = (*e_seq.begin()).encodedSpace();
+					ISMRMRD::encodingLimitsType e_limits = (*e_seq.begin()).encodingLimits();
+
+					dims[IRD_E1] = e_space.matrixSize().y();
+					dims[IRD_E2] = e_space.matrixSize().z();
+					if (e_limits.kspace_encoding_step_1().present())
+						dims[IRD_E1] = std::max (dims[IRD_E1], (size_t)e_limits.kspace_encoding_step_1().get().maximum()+1);
+					if (e_limits.kspace_encoding_step_2().present())
+						dims[IRD_E2] = std::max (dims[IRD_E2], (size_t)e_limits.kspace_encoding_step_2().get().maximum()+1);
+					if (e_limits.slice().present())
+						dims[IRD_SLC] = e_limits.slice().get().maximum()+1;
+					if (e_limits.contrast().present())
+						dims[IRD_CON] = e_limits.contrast().get().maximum()+1;
+					if (e_limits.repetition().present())
+						dims[IRD_REP] = e_limits.repetition().get().maximum()+1;
+
+					return dims;
+
+				}
+
+				/**
+				 * @brief  Minimal XML header describing Cartesian data
+				 */
+				template<class T> inline static std::string
+				Header (const Matrix<T>& M, const Vector<size_t>& d) {
+
+					std::stringstream xml;
+					const Vector<float>& res = M.Res();
+					xml << "<?xml version=\"1.0\"?>\n"
+						<< "<ismrmrdHeader xmlns=\"http://www.ismrm.org/ISMRMRD\">\n"
+						<< "<experimentalConditions><H1resonanceFrequency_Hz>63500000</H1resonanceFrequency_Hz></experimentalConditions>\n"
+						<< "<encoding>\n";
+					for (size_t s = 0; s < 2; ++s)
+						xml << ((s) ? "<reconSpace>" : "<encodedSpace>")
+							<< "<matrixSize><x>" << d[IRD_RO] << "</x><y>" << d[IRD_E1] << "</y><z>" << d[IRD_E2] << "</z></matrixSize>"
+							<< "<fieldOfView_mm><x>" << d[IRD_RO]*res[0] << "</x><y>" << d[IRD_E1]*(res.size()>1 ? res[1] : 1.0f)
+							<< "</y><z>" << d[IRD_E2]*(res.size()>2 ? res[2] : 1.0f) << "</z></fieldOfView_mm>"
+							<< ((s) ? "</reconSpace>\n" : "</encodedSpace>\n");
+					xml << "<encodingLimits>\n"
+						<< Limit ("kspace_encoding_step_1", d[IRD_E1]) << Limit ("kspace_encoding_step_2", d[IRD_E2])
+						<< Limit ("slice", d[IRD_SLC]) << Limit ("contrast", d[IRD_CON]) << Limit ("repetition", d[IRD_REP])
+						<< "</encodingLimits>\n"
+						<< "<trajectory>cartesian</trajectory>\n"
+						<< "</encoding>\n"
+						<< "<acquisitionSystemInformation><receiverChannels>" << d[IRD_CH]
+						<< "</receiverChannels></acquisitionSystemInformation>\n"
+						<< "</ismrmrdHeader>\n";
+					return xml.str();
+
+				}
+
+				inline static std::string Limit (const std::string& name, const size_t& n) {
+					std::stringstream l;
+					l << "<" << name << "><minimum>0</minimum><maximum>" << n-1 << "</maximum><center>"
+					  << n/2 << "</center></" << name << ">\n";
+					return l.str();
+				}
 
+				std::string m_scheme; /**< @brief XML schema location */
+				std::string m_noise;  /**< @brief Workspace name of noise scans */
+				std::string m_calib;  /**< @brief Workspace name of calibration data */
+				size_t      m_batch;  /**< @brief Acquisitions per read batch */
 
 			};
 
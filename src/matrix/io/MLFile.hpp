@@ -10,6 +10,7 @@
 
 #include "Workspace.hpp"
 #include "IOFile.hpp"
+#include "Interleave.hpp"
 #include "mat.h"
 
 #include "Demangle.hpp"
@@ -53,20 +54,11 @@ template <class T> static void read_real (Matrix<T>& M, const mxArray* mxa) {
 }
 
 template <class T> static void write_complex (mxArray* mxa, const Matrix<std::complex<T> >& M) {
-	T* re = (T*)mxGetPr(mxa);
-	T* im = (T*)mxGetPi(mxa);
-	for (size_t i = 0; i < numel(M); ++i) {
-		re[i] = real(M[i]);
-		im[i] = imag(M[i]);
-	}
+	deinterleave (M.Ptr(), (T*)mxGetPr(mxa), (T*)mxGetPi(mxa), numel(M));
 }
 
 template <class T> static void read_complex (Matrix<std::complex<T> >& M, const mxArray* mxa) {
-	T* re = (T*)mxGetPr(mxa);
-	T* im = (T*)mxGetPi(mxa);
-	bool cplx = (im != NULL);
-	for (size_t i = 0; i < numel(M); ++i)
-		M[i] = std::complex<T>(re[i], (cplx) ? im[i] : 0.0);
+	interleave ((const T*)mxGetPr(mxa), (const T*)mxGetPi(mxa), M.Ptr(), numel(M));
 }
 
 template <> struct MXTraits<float> {
@@ -11,6 +11,10 @@
 #include "Matrix.hpp"
 #include "IOFile.hpp"
 #include "Algos.hpp"
+#include "GZip.hpp"
+
+#include <functional>
+#include <numeric>
 
 #include <nifti1_io.h>
 
@@ -54,14 +58,24 @@ public:
 	 *
 	 * @param  fname   File name
 	 * @param  mode    READ(default)/WRITE
-	 * @param  params  Optional parameter set (not used yet)
+	 * @param  params  Optional parameter set:<br/>
+	 *                 "split" (bool): Write 4D/5D data as one file per 3D volume (concurrently)<br/>
+	 *                 "gzip_level" (int): Compression level of .nii.gz files<br/>
+	 *                 "gzip_chunk" (size_t): Bytes per parallel compressed chunk
 	 * @param  verbose Verbose output true/false
 	 */
 	NIFile (const std::string& fname, const IOMode mode = READ,
 			const Params& params = Params(), const bool verbose = false) :
-			IOFile (fname, mode, params, verbose) {
+			IOFile (fname, mode, params, verbose), m_split(false),
+			m_level(Z_DEFAULT_COMPRESSION), m_chunk(gzip_chunk) {
 		if (mode == READ)
 			assert(fexists(fname));
+		if (params.exists("split"))
+			m_split = params.Get<bool>("split");
+		if (params.exists("gzip_level"))
+			m_level = params.Get<int>("gzip_level");
+		if (params.exists("gzip_chunk"))
+			m_chunk = params.Get<size_t>("gzip_chunk");
 	}
 
 
@@ -80,45 +94,54 @@ public:
 	template <class T> bool
 	Write (const Matrix<T>& M, const std::string& uri = "") {
 
-		Matrix<T> tmp = M;
-		tmp = squeeze(tmp);
-		size_t l = this->m_fname.length();
-		nifti_1_header header;
-		header.sizeof_hdr = 348;
-		header.dim[0] = ndims(tmp);
-		header.pixdim[0] = ndims(tmp);
-		size_t nd = ndims(tmp);
-
-		if (nd > 7) {
-			printf ("Cannot dump more than 8 dimensions to NIFTI file\n.");
-			return false;
-		}
-
-		for (size_t i = 0; i < nd; ++i) {
-			header.dim   [i+1] = tmp.Dim(i);
-			header.pixdim[i+1] = tmp.Res(i);
-		}
-
-		header.datatype = NITraits<T>::native;
+		std::vector<size_t> dims;
+		std::vector<float>  ress;
+		for (size_t i = 0; i < ndims(M); ++i)
+			if (M.Dim(i) > 1) {
+				dims.push_back(M.Dim(i));
+				ress.push_back(M.Res(i));
+			}
 
-		nifti_image* ni = nifti_convert_nhdr2nim (header, NULL);
+		if (m_split && dims.size() > 3)
+			return WriteVolumes (M.Ptr(), dims, ress);
 
-		ni->nifti_type = 1;
+		return Stream (this->m_fname, M.Ptr(), dims, ress);
 
-		// Single nii.gz file
-		ni->fname = (char*) calloc(1,l);
-		strcpy(ni->fname,this->m_fname.c_str());
-		ni->iname = (char*) calloc(1,l);
-		strcpy(ni->iname,this->m_fname.c_str());
+	}
 
-		ni->data = (void*) malloc (numel(M) * sizeof (T));
-		memcpy (ni->data, M.Ptr(), numel(M) * sizeof (T));
 
-		nifti_image_write (ni);
-		nifti_image_free (ni);
+	/**
+	 * @brief          Number of volumes written to separate files by Write, if "split"
+	 *                 is set: All but the first three non-singleton dimensions.
+	 *
+	 * @param  M       Matrix
+	 * @return         Number of volumes
+	 */
+	template <class T> static size_t
+	Volumes (const Matrix<T>& M) {
+		size_t n = 1, nd = 0;
+		for (size_t i = 0; i < ndims(M); ++i)
+			if (M.Dim(i) > 1 && ++nd > 3)
+				n *= M.Dim(i);
+		return n;
+	}
 
-		return true;
 
+	/**
+	 * @brief          Name of the file holding volume v, if "split" is set: The volume
+	 *                 index is inserted before the extension (test.nii.gz -> test_0003.nii.gz).
+	 *
+	 * @param  v       Volume
+	 * @return         File name
+	 */
+	std::string VolumeName (const size_t v) const {
+		const std::string& f = this->m_fname;
+		size_t dot = f.rfind (".nii");
+		if (dot == std::string::npos || f.find ('/', dot) != std::string::npos)
+			dot = f.size();
+		char idx[16];
+		snprintf (idx, sizeof(idx), "_%04zu", v);
+		return f.substr (0, dot) + idx + f.substr (dot);
 	}
 
 
@@ -199,6 +222,95 @@ private:
 	NIFile ();
 	NIFile (const NIFile&);
 
+	/**
+	 * @brief          Write volumes to separate files. Volumes are written concurrently,
+	 *                 unless there are fewer volumes than threads, in which case they
+	 *                 are written one after the other with parallel compression.
+	 */
+	template <class T> bool
+	WriteVolumes (const T* data, const std::vector<size_t>& dims, const std::vector<float>& ress) const {
+
+		const std::vector<size_t> vdims (dims.begin(), dims.begin()+3);
+		const std::vector<float>  vress (ress.begin(), ress.begin()+3);
+		const size_t nv = std::accumulate (dims.begin()+3, dims.end(), (size_t)1, std::multiplies<size_t>()),
+			vol = vdims[0]*vdims[1]*vdims[2];
+		int failed = 0;
+
+#pragma omp parallel for schedule (dynamic) reduction (+:failed) if (nv >= (size_t)omp_get_max_threads())
+		for (long v = 0; v < (long)nv; ++v)
+			if (!Stream (VolumeName(v), data + v*vol, vdims, vress))
+				++failed;
+
+		return failed == 0;
+
+	}
+
+	/**
+	 * @brief          Write one NIFTI-1 file straight from memory. Uncompressed files
+	 *                 are written by nifticlib on top of the matrix storage. Gzipped
+	 *                 ones (.nii.gz) are compressed in parallel chunks.
+	 */
+	template <class T> bool
+	Stream (const std::string& fname, const T* data, const std::vector<size_t>& dims,
+			const std::vector<float>& ress) const {
+
+		const size_t nd = dims.size(), l = fname.length();
+
+		if (nd > 7) {
+			printf ("Cannot dump more than 7 dimensions to NIFTI file\n.");
+			return false;
+		}
+
+		nifti_1_header header;
+		memset (&header, 0, sizeof(header));
+		header.sizeof_hdr = 348;
+		header.dim[0] = nd;
+		header.pixdim[0] = nd;
+		size_t n = 1;
+		for (size_t i = 0; i < nd; ++i) {
+			header.dim   [i+1] = dims[i];
+			header.pixdim[i+1] = ress[i];
+			n *= dims[i];
+		}
+		header.datatype = NITraits<T>::native;
+
+		nifti_image* ni = nifti_convert_nhdr2nim (header, NULL);
+		ni->nifti_type = 1;
+
+		// Single nii(.gz) file
+		ni->fname = (char*) calloc(1,l+1);
+		strcpy(ni->fname,fname.c_str());
+		ni->iname = (char*) calloc(1,l+1);
+		strcpy(ni->iname,fname.c_str());
+
+		bool ok = true;
+		if (l > 3 && fname.compare (l-3, 3, ".gz") == 0) {
+			nifti_set_iname_offset (ni);
+			nifti_1_header hdr = nifti_convert_nim2nhdr (ni);
+			unsigned char stream[352] = {0}; // header + empty extender
+			memcpy (stream, &hdr, sizeof(hdr));
+			if (FILE* f = fopen (fname.c_str(), "wb")) {
+				ok = gzwrite_parallel (f, stream, sizeof(stream), m_level, m_chunk) &&
+					gzwrite_parallel (f, data, n*sizeof(T), m_level, m_chunk);
+				ok = (fclose (f) == 0) && ok;
+			} else
+				ok = false;
+		} else {
+			ni->data = (void*) data;
+			nifti_image_write (ni);
+			ni->data = NULL;
+		}
+
+		nifti_image_free (ni);
+
+		return ok;
+
+	}
+
+	bool   m_split; /**< @brief One file per volume */
+	int    m_level; /**< @brief Compression level */
+	size_t m_chunk; /**< @brief Bytes per compressed chunk */
+
 
 };
 
@@ -23,6 +23,7 @@
 
 #include "SyngoFile.hpp"
 #include "Workspace.hpp"
+#include "Interleave.hpp"
 #ifdef USE_IN_MATLAB
   #include "waitmex.h"
 #endif
@@ -279,10 +280,7 @@ namespace VB {
 #else
                 std::vector<std::complex<float> >buf (mh.ushSamplesInScan);
                 _file.read((char*)&buf[0], mh.ushSamplesInScan*sizeof(std::complex<float>));
-                for (size_t i = 0; i < _measdims[0]; ++i) {
-                    _meas_r[i+_nmeas*_measdims[0]] = std::real(buf[i]);
-                    _meas_i[i+_nmeas*_measdims[0]] = std::imag(buf[i]);
-                }
+                deinterleave (&buf[0], _meas_r+_nmeas*_measdims[0], _meas_i+_nmeas*_measdims[0], _measdims[0]);
 #endif
             }
             _nmeas++;
@@ -299,10 +297,7 @@ namespace VB {
 #else
                 std::vector<std::complex<float> >buf (mh.ushSamplesInScan);
                 _file.read((char*)&buf[0], mh.ushSamplesInScan*sizeof(std::complex<float>));
-                for (size_t i = 0; i < _rtfbdims[0]; ++i) {
-                    _rtfb_r[i+_nrtfb*_rtfbdims[0]] = std::real(buf[i]);
-                    _rtfb_i[i+_nrtfb*_rtfbdims[0]] = std::imag(buf[i]);
-                }
+                deinterleave (&buf[0], _rtfb_r+_nrtfb*_rtfbdims[0], _rtfb_i+_nrtfb*_rtfbdims[0], _rtfbdims[0]);
 #endif
             }
             _nrtfb++;
@@ -0,0 +1,68 @@
+/*
+ * t_asyncio.cpp
+ *
+ *  Asynchronous, parallel reads and bounded queued writes through AsyncIOContext
+ */
+
+#include "AsyncIOContext.hpp"
+#include "Algos.hpp"
+#include "Creators.hpp"
+
+using namespace codeare::matrix::io;
+
+std::string fname = "test_async.cod";
+
+template<class T>
+inline static bool check () {
+
+	const size_t n = 8;
+	std::vector<Matrix<T> > A;
+	bool ok = true;
+
+	for (size_t i = 0; i < n; ++i)
+		A.push_back (rand<T>(64+i,33,5));
+
+	{   // Small cap: writes queue up and block
+		AsyncIOContext out (fname, WRITE, 0, 64*33*5*sizeof(T));
+		std::vector<std::future<bool> > written;
+		for (size_t i = 0; i < n; ++i) {
+			std::stringstream name; name << "A" << i;
+			written.push_back (out.Write (A[i], name.str()));
+		}
+		for (size_t i = 0; i < n; ++i)
+			ok &= written[i].get();
+	}
+
+	AsyncIOContext in (fname, READ, 4);
+	ok &= (in.Strategy() == CODEARE && in.Threads() == 4);
+
+	std::vector<std::future<Matrix<T> > > read;
+	for (size_t i = n; i-- > 0;) {
+		std::stringstream name; name << "A" << i;
+		read.push_back (in.Read<T> (name.str()));
+	}
+	for (size_t i = 0; i < n; ++i)
+		ok &= (issame (read[i].get(), A[n-1-i]) == 2);
+
+	// Whole file into the workspace through the same handle
+	in.Read().get();
+	for (size_t i = 0; i < n; ++i) {
+		std::stringstream name; name << "A" << i;
+		ok &= (issame (wspace.Get<T>(name.str()), A[i]) == 2);
+		wspace.Free (name.str());
+	}
+
+	return ok;
+
+}
+
+int main (int args, char** argv) {
+
+	if (!check<float>() || !check<double>() || !check<cxfl>() || !check<cxdb>()) {
+		printf ("Asynchronous IO failed\n");
+		return 1;
+	}
+	printf ("passed\n");
+	return 0;
+
+}
@@ -47,9 +47,103 @@ inline static bool check () {
 
 }
 
+template<class T>
+inline static bool check_indexed () {
+
+	Matrix<T> A = rand<T>(3,4), B = rand<T>(17,5,3), C;
+	bool ok = true;
+
+	{
+		CODFile mfw (fname, WRITE);
+		mfw.Write (A, "A");
+		mfw.Write (B, "B");
+	}
+
+	CODFile mfr (fname, READ);
+	ok &= (mfr.Version() == 2 && mfr.Names().size() == 2);
+
+	// Out of order, by name
+	C = mfr.Read<T>("B");
+	ok &= (issame (B, C) == 2);
+	C = mfr.Read<T>("A");
+	ok &= (issame (A, C) == 2);
+
+	// Zero copy
+	const T* b = mfr.View<T>("B");
+	ok &= (b != 0 && ((size_t)b % 64) == 0);
+	for (size_t i = 0; b && i < numel(B); ++i)
+		ok &= (b[i] == B[i]);
+
+	return ok;
+
+}
+
+template<class T>
+inline static bool check_direct () {
+
+	// > 1 page, not a multiple of it
+	Matrix<T> A = rand<T>(1001,301), B;
+	Params p;
+	p.Set ("direct", true);
+
+	{
+		CODFile mfw (fname, WRITE);
+		mfw.Write (rand<T>(3,3), "S");
+		mfw.Write (A, "A");
+	}
+
+	CODFile mfr (fname, READ, p);
+	const CODEntry* e = mfr.Entry("A");
+	B = mfr.Read<T>("A");
+
+	return (e && e->offset % 4096 == 0 && issame (A, B) == 2);
+
+}
+
+// Overwrite 8 bytes at pos from end of file
+inline static void patch (const long pos, const uint64_t val) {
+	FILE* f = fopen (fname.c_str(), "r+b");
+	fseek (f, -pos, SEEK_END);
+	fwrite (&val, sizeof(val), 1, f);
+	fclose (f);
+}
+
+template<class T>
+inline static bool check_corrupt () {
+
+	const long tsize = 2*sizeof(uint64_t) + 8;
+	const uint64_t big = (uint64_t)1 << 40;
+	bool ok = true;
+
+	for (int c = 0; c < 5; ++c) {
+		{
+			CODFile mfw (fname, WRITE);
+			mfw.Write (rand<T>(3,4), "A");
+			mfw.Write (rand<T>(5,6), "B");
+		}
+		switch (c) {
+		case 0: patch (tsize, big); break;                        // index offset beyond EOF
+		case 1: patch (tsize-8, big); break;                      // entry count
+		case 2: patch (tsize+8, big); break;                      // payload size of B
+		case 3: patch (tsize+16, big); break;                     // payload offset of B
+		case 4: if (truncate (fname.c_str(), 200)) ok = false; break; // no trailer
+		}
+		CODFile mfr (fname, READ);
+		Matrix<T> B = mfr.Read<T>("B");
+		ok &= (mfr.Status() != codeare::OK && mfr.Names().empty() &&
+				mfr.Entry("B") == 0 && mfr.View<T>("A") == 0);
+	}
+
+	return ok;
+
+}
+
 int main (int args, char** argv) {
 
-	if (check<float>() && check<double>() && check<cxfl>() && check<cxdb>())
+	if (check<float>() && check<double>() && check<cxfl>() && check<cxdb>() &&
+		check_indexed<float>() && check_indexed<cxdb>() &&
+		check_direct<float>() && check_direct<cxdb>() &&
+		check_corrupt<float>() && check_corrupt<cxdb>())
         return 0;
 
 	return 1;
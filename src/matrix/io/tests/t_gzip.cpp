@@ -0,0 +1,51 @@
+/*
+ * t_gzip.cpp
+ *
+ *  Parallel chunked gzip: output is one gzip stream to zlib's gzread
+ */
+
+#include "GZip.hpp"
+#include "Algos.hpp"
+#include "Creators.hpp"
+
+using namespace codeare::matrix::io;
+
+std::string fname = "test.gz";
+
+template<class T>
+inline static bool check (const size_t chunk) {
+
+	Matrix<T> A = rand<T>(127,33,7), B (size(A));
+	const size_t bytes = numel(A)*sizeof(T);
+	unsigned char head[5] = {1,2,3,4,5}, back[5];
+
+	FILE* f = fopen (fname.c_str(), "wb");
+	if (!f)
+		return false;
+	bool ok = gzwrite_parallel (f, head, sizeof(head), 6, chunk) &&
+		gzwrite_parallel (f, A.Ptr(), bytes, 6, chunk);
+	fclose (f);
+
+	gzFile gz = gzopen (fname.c_str(), "rb");
+	ok = ok && gzread (gz, back, sizeof(back)) == (int)sizeof(back) &&
+		gzread (gz, B.Ptr(), bytes) == (int)bytes && gzread (gz, back, 1) == 0;
+	gzclose (gz);
+
+	ok = ok && memcmp (head, back, sizeof(head)) == 0 && issame (A, B) == 2;
+	printf ("  %zu byte elements, chunk %zu: %s\n", sizeof(T), chunk, ok ? "ok" : "failed");
+	return ok;
+
+}
+
+int main (int args, char** argv) {
+
+	if (!check<float>(gzip_chunk))
+		return 1;
+	if (!check<float>(1000))
+		return 1;
+	if (!check<cxdb>(4096))
+		return 1;
+
+	return 0;
+
+}
@@ -50,10 +50,83 @@ template<class T> inline static bool check () {
 
 }
 
+template<class T> inline static bool check_chunked () {
+
+	Matrix<T> A = rand<T>(16,12,5,4), B;
+
+	// Chunked, shuffled and deflated
+	{
+		HDF5File nf (fname, WRITE);
+		Vector<size_t> chunk (3,1); chunk[0] = 16; chunk[1] = 12;
+		nf.Chunking (chunk);
+		nf.Compression (4);
+		nf.Write (A, mname);
+	}
+
+	HDF5File nf (fname, READ);
+	B = nf.Read<T>(mname);
+	bool ok = (issame (A, B) == 2);
+
+	// Coil 2
+	Matrix<T> C = nf.ReadSlice<T>(mname, 3, 2);
+	ok &= (size(C,3) == 1 && numel(C) == 16*12*5);
+	for (size_t i = 0; i < numel(C); ++i)
+		ok &= (C[i] == A[2*16*12*5+i]);
+
+	// Sub-block
+	Vector<size_t> off (4,0), cnt (2);
+	off[0] = 3; off[1] = 5; off[2] = 1; off[3] = 3; cnt[0] = 4; cnt[1] = 2;
+	Matrix<T> D = nf.Read<T>(mname, off, cnt);
+	ok &= (size(D,0) == 4 && size(D,1) == 2 && size(D,2) == 4 && size(D,3) == 1);
+	for (size_t z = 0; z < 4; ++z)
+		for (size_t y = 0; y < 2; ++y)
+			for (size_t x = 0; x < 4; ++x)
+				ok &= (D(x,y,z,0) == A(x+3,y+5,z+1,3));
+
+	std::cout << ok << std::endl;
+	return ok;
+
+}
+
+template<class T> inline static bool check_parallel () {
+
+	const long n = 8;
+	std::vector<Matrix<T> > A (n);
+	for (long i = 0; i < n; ++i)
+		A[i] = rand<T>(32,16,i+1);
+
+	// One writer per dataset, into one file
+	{
+		HDF5File nf (fname, WRITE);
+		nf.Compression (1);
+#pragma omp parallel for schedule (dynamic)
+		for (long i = 0; i < n; ++i) {
+			std::stringstream uri;
+			uri << "/par/" << (i%2 ? "odd/" : "even/") << "A" << i;
+			nf.Write (A[i], uri.str());
+		}
+	}
+
+	HDF5File nf (fname, READ);
+	bool ok = true;
+#pragma omp parallel for reduction (&&:ok)
+	for (long i = 0; i < n; ++i) {
+		std::stringstream uri;
+		uri << "/par/" << (i%2 ? "odd/" : "even/") << "A" << i;
+		ok = ok && (issame (A[i], nf.Read<T>(uri.str())) == 2);
+	}
+
+	std::cout << ok << std::endl;
+	return ok;
+
+}
+
 int main (int args, char** argv) {
 
     if (args == 1) {
-        if (check<float>() && check<double>() && check<cxfl>() && check<cxdb>())
+        if (check<float>() && check<double>() && check<cxfl>() && check<cxdb>() &&
+            check_chunked<float>() && check_chunked<cxdb>() &&
+            check_parallel<float>() && check_parallel<cxfl>())
             return 0;
     } else {
         HDF5File h5f (argv[1]);
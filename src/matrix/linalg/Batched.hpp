@@ -0,0 +1,519 @@
+/*
+ *  codeare Copyright (C) 2010-2016
+ *                        Kaveh Vahedipour
+ *                        NYU School of Medicine, New York, USA
+ *
+ *  This program is free software; you can redistribute it and/or modify
+ *  it under the terms of the GNU General Public License as published by
+ *  the Free Software Foundation; either version 2 of the License, or
+ *  (at your option) any later version.
+ *
+ *  This program is distributed in the hope that it will be useful, but
+ *  WITHOUT ANY WARRANTY; without even the implied warranty of
+ *  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU
+ *  General Public License for more details.
+ *
+ *  You should have received a copy of the GNU General Public License
+ *  along with this program; if not, write to the Free Software
+ *  Foundation, Inc., 51 Franklin Street, Fifth Floor, Boston, MA
+ *  02110-1301  USA
+ */
+
+#ifndef __BATCHED_HPP__
+#define __BATCHED_HPP__
+
+#include "Matrix.hpp"
+#include "OMP.hpp"
+
+/**
+ * @brief   Batched small matrix kernels.<br/>
+ *          A batch of nv m x n matrices is a Matrix<T> of size (nv, m, n), i.e. the
+ *          batch index runs fastest (SoA). Blocks of Lanes matrices are split into
+ *          real and imaginary arrays and all operations vectorise across the block.
+ *          Sizes up to 16 are unrolled at compile time, larger ones fall back to
+ *          runtime loops. Systems must be Hermitian positive definite; like xPOTRF,
+ *          factorisations report per matrix info = j > 0 if the leading minor of
+ *          order j is not positive definite, in which case factors and solutions
+ *          of that matrix are not meaningful.
+ */
+template<class T> struct Batched {
+
+	typedef typename TypeTraits<T>::RT RT;
+
+	static const size_t Lanes = 16; /**< @brief Matrices per block */
+
+	/**
+	 * @brief        Gather element (i,j) of block b into split arrays
+	 */
+	inline static void Load (const Matrix<T>& A, const size_t& b, RT* re, RT* im) {
+		const size_t nv = size(A,0), nb = numel(A)/nv, v0 = b*Lanes,
+			len = std::min (Lanes, nv-v0);
+		for (size_t e = 0; e < nb; ++e) {
+			const T* a = A.Ptr() + e*nv + v0;
+			for (size_t l = 0; l < len; ++l) {
+				re[e*Lanes+l] = TypeTraits<T>::Real(a[l]);
+				im[e*Lanes+l] = TypeTraits<T>::Imag(a[l]);
+			}
+			for (size_t l = len; l < Lanes; ++l) {   // Pad with last matrix of batch
+				re[e*Lanes+l] = re[e*Lanes+len-1];
+				im[e*Lanes+l] = im[e*Lanes+len-1];
+			}
+		}
+	}
+
+	/**
+	 * @brief        Scatter split arrays into block b
+	 */
+	inline static void Store (const RT* re, const RT* im, const size_t& b, Matrix<T>& A) {
+		const size_t nv = size(A,0), nb = numel(A)/nv, v0 = b*Lanes,
+			len = std::min (Lanes, nv-v0);
+		for (size_t e = 0; e < nb; ++e) {
+			T* a = A.Ptr() + e*nv + v0;
+			for (size_t l = 0; l < len; ++l)
+				Make (re[e*Lanes+l], im[e*Lanes+l], a[l]);
+		}
+	}
+
+	/**
+	 * @brief        In place upper Cholesky factor A = U^H U of n x n block
+	 *               (element (i,j) at (i+n*j)*Lanes)
+	 *
+	 * @param  info  Per lane: 0 or order of first not positive definite leading minor
+	 */
+	template<size_t N> inline static void
+	Potrf (RT* re, RT* im, const size_t& nrt, int* info) {
+		const size_t n = N ? N : nrt;
+		std::fill (info, info+Lanes, 0);
+		for (size_t j = 0; j < n; ++j) {
+			RT* djr = re + (j+n*j)*Lanes; RT* dji = im + (j+n*j)*Lanes;
+			for (size_t k = 0; k < j; ++k) {
+				const RT* ur = re + (k+n*j)*Lanes; const RT* ui = im + (k+n*j)*Lanes;
+#pragma omp simd
+				for (size_t l = 0; l < Lanes; ++l)
+					djr[l] -= ur[l]*ur[l] + ui[l]*ui[l];
+			}
+#pragma omp simd
+			for (size_t l = 0; l < Lanes; ++l) {
+				if (!(djr[l] > RT(0)) && !info[l])
+					info[l] = (int)j+1;
+				djr[l] = std::sqrt (djr[l]);
+				dji[l] = RT(0);
+			}
+			for (size_t i = j+1; i < n; ++i) {
+				RT* ar = re + (j+n*i)*Lanes; RT* ai = im + (j+n*i)*Lanes;
+				for (size_t k = 0; k < j; ++k) {
+					const RT* pr = re + (k+n*j)*Lanes; const RT* pi = im + (k+n*j)*Lanes;
+					const RT* qr = re + (k+n*i)*Lanes; const RT* qi = im + (k+n*i)*Lanes;
+#pragma omp simd
+					for (size_t l = 0; l < Lanes; ++l) {   // conj(U(k,j)) U(k,i)
+						ar[l] -= pr[l]*qr[l] + pi[l]*qi[l];
+						ai[l] -= pr[l]*qi[l] - pi[l]*qr[l];
+					}
+				}
+#pragma omp simd
+				for (size_t l = 0; l < Lanes; ++l) {
+					ar[l] /= djr[l];
+					ai[l] /= djr[l];
+				}
+			}
+			for (size_t i = j+1; i < n; ++i)
+				std::fill (re + (i+n*j)*Lanes, re + (i+n*j+1)*Lanes, RT(0));
+			for (size_t i = j+1; i < n; ++i)
+				std::fill (im + (i+n*j)*Lanes, im + (i+n*j+1)*Lanes, RT(0));
+		}
+	}
+
+	/**
+	 * @brief        Solve U^H U X = B in place with n x n factor U and n x k right hand sides
+	 */
+	template<size_t N> inline static void
+	Potrs (const RT* ur, const RT* ui, RT* br, RT* bi, const size_t& nrt, const size_t& k) {
+		const size_t n = N ? N : nrt;
+		for (size_t c = 0; c < k; ++c) {
+			RT* xr = br + c*n*Lanes; RT* xi = bi + c*n*Lanes;
+			for (size_t i = 0; i < n; ++i) {        // U^H y = b
+				RT* yr = xr + i*Lanes; RT* yi = xi + i*Lanes;
+				for (size_t j = 0; j < i; ++j) {
+					const RT* pr = ur + (j+n*i)*Lanes; const RT* pi = ui + (j+n*i)*Lanes;
+					const RT* qr = xr + j*Lanes; const RT* qi = xi + j*Lanes;
+#pragma omp simd
+					for (size_t l = 0; l < Lanes; ++l) {
+						yr[l] -= pr[l]*qr[l] + pi[l]*qi[l];
+						yi[l] -= pr[l]*qi[l] - pi[l]*qr[l];
+					}
+				}
+				const RT* d = ur + (i+n*i)*Lanes;
+#pragma omp simd
+				for (size_t l = 0; l < Lanes; ++l) {
+					yr[l] /= d[l];
+					yi[l] /= d[l];
+				}
+			}
+			for (size_t ii = n; ii-- > 0;) {       // U x = y
+				RT* yr = xr + ii*Lanes; RT* yi = xi + ii*Lanes;
+				for (size_t j = ii+1; j < n; ++j) {
+					const RT* pr = ur + (ii+n*j)*Lanes; const RT* pi = ui + (ii+n*j)*Lanes;
+					const RT* qr = xr + j*Lanes; const RT* qi = xi + j*Lanes;
+#pragma omp simd
+					for (size_t l = 0; l < Lanes; ++l) {
+						yr[l] -= pr[l]*qr[l] - pi[l]*qi[l];
+						yi[l] -= pr[l]*qi[l] + pi[l]*qr[l];
+					}
+				}
+				const RT* d = ur + (ii+n*ii)*Lanes;
+#pragma omp simd
+				for (size_t l = 0; l < Lanes; ++l) {
+					yr[l] /= d[l];
+					yi[l] /= d[l];
+				}
+			}
+		}
+	}
+
+	/**
+	 * @brief        G = A^H A + lambda I (n x n, upper triangle) and R = A^H B (n x k)
+	 *               for m x n block A
+	 */
+	inline static void
+	Normal (const RT* ar, const RT* ai, const RT* br, const RT* bi, const size_t& m,
+			const size_t& n, const size_t& k, const RT& lambda, RT* gr, RT* gi, RT* rr, RT* ri) {
+		for (size_t j = 0; j < n; ++j)
+			for (size_t i = 0; i < n; ++i) {
+				RT* pr = gr + (i+n*j)*Lanes; RT* pi = gi + (i+n*j)*Lanes;
+				std::fill (pr, pr+Lanes, (i==j) ? lambda : RT(0));
+				std::fill (pi, pi+Lanes, RT(0));
+				if (i > j)
+					continue;
+				for (size_t r = 0; r < m; ++r)
+					Dotc (ar + (r+m*i)*Lanes, ai + (r+m*i)*Lanes, ar + (r+m*j)*Lanes,
+							ai + (r+m*j)*Lanes, pr, pi);
+			}
+		for (size_t c = 0; c < k; ++c)
+			for (size_t i = 0; i < n; ++i) {
+				RT* pr = rr + (i+n*c)*Lanes; RT* pi = ri + (i+n*c)*Lanes;
+				std::fill (pr, pr+Lanes, RT(0));
+				std::fill (pi, pi+Lanes, RT(0));
+				for (size_t r = 0; r < m; ++r)
+					Dotc (ar + (r+m*i)*Lanes, ai + (r+m*i)*Lanes, br + (r+m*c)*Lanes,
+							bi + (r+m*c)*Lanes, pr, pi);
+			}
+	}
+
+	/**
+	 * @brief        Runtime to compile time size dispatch
+	 */
+	template<class F> inline static void Dispatch (const size_t& n, F& f) {
+		switch (n) {
+		case  1: f.template run< 1>(); break; case  2: f.template run< 2>(); break;
+		case  3: f.template run< 3>(); break; case  4: f.template run< 4>(); break;
+		case  5: f.template run< 5>(); break; case  6: f.template run< 6>(); break;
+		case  7: f.template run< 7>(); break; case  8: f.template run< 8>(); break;
+		case  9: f.template run< 9>(); break; case 10: f.template run<10>(); break;
+		case 11: f.template run<11>(); break; case 12: f.template run<12>(); break;
+		case 13: f.template run<13>(); break; case 14: f.template run<14>(); break;
+		case 15: f.template run<15>(); break; case 16: f.template run<16>(); break;
+		default: f.template run< 0>(); break;
+		}
+	}
+
+private:
+
+	inline static void Dotc (const RT* ar, const RT* ai, const RT* br, const RT* bi, RT* cr, RT* ci) {
+#pragma omp simd
+		for (size_t l = 0; l < Lanes; ++l) {
+			cr[l] += ar[l]*br[l] + ai[l]*bi[l];
+			ci[l] += ar[l]*bi[l] - ai[l]*br[l];
+		}
+	}
+
+	inline static void Make (const RT& re, const RT& im, std::complex<RT>& o) { o = std::complex<RT>(re,im); }
+	inline static void Make (const RT& re, const RT&,    RT& o) { o = re; }
+
+};
+
+
+/**
+ * @brief        Batched kernels bound to one operation for Batched<T>::Dispatch
+ */
+template<class T> struct BatchedPosv {
+
+	typedef typename TypeTraits<T>::RT RT;
+	typedef Batched<T> B;
+
+	BatchedPosv (const Matrix<T>* a, const Matrix<T>* b, Matrix<T>* x, Matrix<T>* u,
+			Vector<int>* info = 0, const bool& normal = false, const RT& lambda = 0) :
+		A(a), Bm(b), X(x), U(u), Info(info), normal(normal), lambda(lambda) {}
+
+	template<size_t N> void run () {
+
+		const size_t nv = size(*A,0), m = size(*A,1), n = size(*A,2),
+			k = Bm ? size(*Bm,2) : 1, nb = (nv + B::Lanes - 1) / B::Lanes, L = B::Lanes;
+		Vector<int> info (nv);
+		size_t failed = 0;
+
+#pragma omp parallel reduction (+:failed)
+		{
+			Vector<RT> ar (m*n*L), ai (m*n*L), br (m*k*L), bi (m*k*L),
+				gr (n*n*L), gi (n*n*L), rr (n*k*L), ri (n*k*L);
+			Vector<int> li (L);
+
+#pragma omp for schedule (static)
+			for (long b = 0; b < (long)nb; ++b) {
+				B::Load (*A, b, &ar[0], &ai[0]);
+				if (Bm)
+					B::Load (*Bm, b, &br[0], &bi[0]);
+				if (normal) {
+					B::Normal (&ar[0], &ai[0], &br[0], &bi[0], m, n, k, lambda,
+							&gr[0], &gi[0], &rr[0], &ri[0]);
+				} else {
+					std::copy (ar.begin(), ar.end(), gr.begin());
+					std::copy (ai.begin(), ai.end(), gi.begin());
+					std::copy (br.begin(), br.end(), rr.begin());
+					std::copy (bi.begin(), bi.end(), ri.begin());
+				}
+				B::template Potrf<N> (&gr[0], &gi[0], n, &li[0]);
+				for (size_t l = 0; l < std::min (L, nv-b*L); ++l) {
+					info[b*L+l] = li[l];
+					failed += (li[l] != 0);
+				}
+				if (U)
+					B::Store (&gr[0], &gi[0], b, *U);
+				if (X) {
+					B::template Potrs<N> (&gr[0], &gi[0], &rr[0], &ri[0], n, k);
+					B::Store (&rr[0], &ri[0], b, *X);
+				}
+			}
+		}
+
+		if (Info)
+			*Info = info;
+		else if (failed)
+			printf ("\nERROR - XPOTRF (batched): " JL_SIZE_T_SPECIFIER " of " JL_SIZE_T_SPECIFIER
+					" matrices are not positive definite, and their factorization could not be\n completed!\n\n",
+					failed, nv);
+
+	}
+
+	const Matrix<T>* A;
+	const Matrix<T>* Bm;
+	Matrix<T>* X;
+	Matrix<T>* U;
+	Vector<int>* Info;
+	bool normal;
+	RT lambda;
+
+};
+
+
+/**
+ * @brief        Batched Cholesky decomposition
+ *
+ * Usage:
+ * @code{.cpp}
+ *   Matrix<cxfl> A (nvoxels, 4, 4); // nvoxels HPD 4x4 matrices
+ *   Matrix<cxfl> U = chol_batched (A);
+ * @endcode
+ *
+ * @param  A     Batch of HPD matrices (nv x n x n)
+ * @param  info  If given, per matrix info of xPOTRF (nv), else failures are reported
+ * @return       Upper factors U with A = U^H U (nv x n x n)
+ */
+template<class T> inline Matrix<T>
+chol_batched (const Matrix<T>& A, Vector<int>* info = 0) {
+	assert (size(A,1) == size(A,2));
+	Matrix<T> U (size(A));
+	BatchedPosv<T> f (&A, 0, 0, &U, info);
+	Batched<T>::Dispatch (size(A,1), f);
+	return U;
+}
+
+
+/**
+ * @brief        Batched solution of HPD systems A X = B
+ *
+ * @param  A     Batch of HPD matrices (nv x n x n)
+ * @param  B     Right hand sides (nv x n x k)
+ * @param  info  If given, per matrix info of xPOTRF (nv), else failures are reported
+ * @return       Solutions X (nv x n x k)
+ */
+template<class T> inline Matrix<T>
+posv_batched (const Matrix<T>& A, const Matrix<T>& B, Vector<int>* info = 0) {
+	assert (size(A,1) == size(A,2) && size(A,0) == size(B,0) && size(B,1) == size(A,1));
+	Matrix<T> X (size(B,0), size(B,1), size(B,2));
+	BatchedPosv<T> f (&A, &B, &X, 0, info);
+	Batched<T>::Dispatch (size(A,1), f);
+	return X;
+}
+
+
+/**
+ * @brief        Batched Gram matrices A^H A + lambda I
+ *
+ * @param  A     Batch of matrices (nv x m x n)
+ * @param  lambda Tikhonov parameter
+ * @return       Gram matrices (nv x n x n)
+ */
+template<class T> inline Matrix<T>
+gram_batched (const Matrix<T>& A, const typename TypeTraits<T>::RT& lambda = 0) {
+	typedef typename TypeTraits<T>::RT RT;
+	typedef Batched<T> B;
+	const size_t nv = size(A,0), m = size(A,1), n = size(A,2), L = B::Lanes,
+		nb = (nv + L - 1) / L;
+	Matrix<T> G (nv, n, n);
+#pragma omp parallel
+	{
+		Vector<RT> ar (m*n*L), ai (m*n*L), gr (n*n*L), gi (n*n*L);
+#pragma omp for schedule (static)
+		for (long b = 0; b < (long)nb; ++b) {
+			B::Load (A, b, &ar[0], &ai[0]);
+			B::Normal (&ar[0], &ai[0], 0, 0, m, n, 0, lambda, &gr[0], &gi[0], 0, 0);
+			for (size_t j = 0; j < n; ++j)
+				for (size_t i = j+1; i < n; ++i)
+					for (size_t l = 0; l < L; ++l) {
+						gr[(i+n*j)*L+l] =  gr[(j+n*i)*L+l];
+						gi[(i+n*j)*L+l] = -gi[(j+n*i)*L+l];
+					}
+			B::Store (&gr[0], &gi[0], b, G);
+		}
+	}
+	return G;
+}
+
+
+/**
+ * @brief        Batched inverse of HPD matrices
+ *
+ * @param  A     Batch of HPD matrices (nv x n x n)
+ * @param  info  If given, per matrix info of xPOTRF (nv), else failures are reported
+ * @return       Inverses (nv x n x n)
+ */
+template<class T> inline Matrix<T>
+inv_batched (const Matrix<T>& A, Vector<int>* info = 0) {
+	const size_t nv = size(A,0), n = size(A,1);
+	Matrix<T> I (nv, n, n);
+	for (size_t j = 0; j < n; ++j)
+		std::fill (I.Ptr() + (j+n*j)*nv, I.Ptr() + (j+n*j+1)*nv, T(1));
+	return posv_batched (A, I, info);
+}
+
+
+/**
+ * @brief        Batched (Tikhonov regularised) least squares min |A x - b|^2 + lambda |x|^2
+ *               through Cholesky factorisation of the normal equations
+ *
+ * @param  A     Batch of system matrices (nv x m x n, m >= n)
+ * @param  B     Right hand sides (nv x m x k)
+ * @param  lambda Tikhonov parameter
+ * @param  info  If given, per matrix info of xPOTRF (nv), else failures are reported
+ * @return       Solutions X (nv x n x k)
+ */
+template<class T> inline Matrix<T>
+lsq_batched (const Matrix<T>& A, const Matrix<T>& B, const typename TypeTraits<T>::RT& lambda = 0,
+		Vector<int>* info = 0) {
+	assert (size(A,0) == size(B,0) && size(A,1) == size(B,1));
+	Matrix<T> X (size(B,0), size(A,2), size(B,2));
+	BatchedPosv<T> f (&A, &B, &X, 0, info, true, lambda);
+	Batched<T>::Dispatch (size(A,2), f);
+	return X;
+}
+
+/**
+ * @brief        Batched dominant singular triplet A v = s u by power iteration on A^H A
+ *
+ * @param  A     Batch of matrices (nv x m x n)
+ * @param  u     Left singular vectors (nv x m)
+ * @param  s     Largest singular values (nv)
+ * @param  v     Right singular vectors (nv x n)
+ * @param  iters Power iterations
+ */
+template<class T> inline void
+svd1_batched (const Matrix<T>& A, Matrix<T>& u, Matrix<typename TypeTraits<T>::RT>& s,
+		Matrix<T>& v, const size_t& iters = 32) {
+	typedef typename TypeTraits<T>::RT RT;
+	typedef Batched<T> B;
+	const size_t nv = size(A,0), m = size(A,1), n = size(A,2), L = B::Lanes,
+		nb = (nv + L - 1) / L;
+	u = Matrix<T> (nv, m);
+	v = Matrix<T> (nv, n);
+	s = Matrix<RT> (nv, 1);
+#pragma omp parallel
+	{
+		Vector<RT> ar (m*n*L), ai (m*n*L), gr (n*n*L), gi (n*n*L), vr (n*L), vi (n*L),
+			wr (n*L), wi (n*L), ur (m*L), ui (m*L), nrm (L), sv (L);
+#pragma omp for schedule (static)
+		for (long b = 0; b < (long)nb; ++b) {
+			B::Load (A, b, &ar[0], &ai[0]);
+			B::Normal (&ar[0], &ai[0], 0, 0, m, n, 0, RT(0), &gr[0], &gi[0], 0, 0);
+			for (size_t j = 0; j < n; ++j)
+				for (size_t i = j+1; i < n; ++i)
+					for (size_t l = 0; l < L; ++l) {
+						gr[(i+n*j)*L+l] =  gr[(j+n*i)*L+l];
+						gi[(i+n*j)*L+l] = -gi[(j+n*i)*L+l];
+					}
+			for (size_t i = 0; i < n; ++i)       // Start with column norms
+				for (size_t l = 0; l < L; ++l) {
+					vr[i*L+l] = std::sqrt (gr[(i+n*i)*L+l]) + std::numeric_limits<RT>::epsilon();
+					vi[i*L+l] = RT(0);
+				}
+			for (size_t it = 0; it <= iters; ++it) {
+				std::fill (wr.begin(), wr.end(), RT(0));
+				std::fill (wi.begin(), wi.end(), RT(0));
+				for (size_t j = 0; j < n; ++j)
+					for (size_t i = 0; i < n; ++i) {
+						const RT* pr = &gr[(i+n*j)*L]; const RT* pi = &gi[(i+n*j)*L];
+						const RT* qr = &vr[j*L]; const RT* qi = &vi[j*L];
+						RT* yr = &wr[i*L]; RT* yi = &wi[i*L];
+#pragma omp simd
+						for (size_t l = 0; l < L; ++l) {
+							yr[l] += pr[l]*qr[l] - pi[l]*qi[l];
+							yi[l] += pr[l]*qi[l] + pi[l]*qr[l];
+						}
+					}
+				std::fill (nrm.begin(), nrm.end(), RT(0));
+				for (size_t i = 0; i < n; ++i)
+#pragma omp simd
+					for (size_t l = 0; l < L; ++l)
+						nrm[l] += wr[i*L+l]*wr[i*L+l] + wi[i*L+l]*wi[i*L+l];
+				if (it == iters) {               // Rayleigh quotient |G v| = s^2
+					for (size_t l = 0; l < L; ++l)
+						sv[l] = std::sqrt (std::sqrt (nrm[l]));
+					break;
+				}
+				for (size_t l = 0; l < L; ++l)
+					nrm[l] = (nrm[l] > RT(0)) ? RT(1)/std::sqrt(nrm[l]) : RT(0);
+				for (size_t i = 0; i < n; ++i)
+#pragma omp simd
+					for (size_t l = 0; l < L; ++l) {
+						vr[i*L+l] = wr[i*L+l]*nrm[l];
+						vi[i*L+l] = wi[i*L+l]*nrm[l];
+					}
+			}
+			for (size_t r = 0; r < m; ++r) {      // u = A v / s
+				RT* yr = &ur[r*L]; RT* yi = &ui[r*L];
+				std::fill (yr, yr+L, RT(0));
+				std::fill (yi, yi+L, RT(0));
+				for (size_t j = 0; j < n; ++j) {
+					const RT* pr = &ar[(r+m*j)*L]; const RT* pi = &ai[(r+m*j)*L];
+					const RT* qr = &vr[j*L]; const RT* qi = &vi[j*L];
+#pragma omp simd
+					for (size_t l = 0; l < L; ++l) {
+						yr[l] += pr[l]*qr[l] - pi[l]*qi[l];
+						yi[l] += pr[l]*qi[l] + pi[l]*qr[l];
+					}
+				}
+#pragma omp simd
+				for (size_t l = 0; l < L; ++l) {
+					const RT f = (sv[l] > RT(0)) ? RT(1)/sv[l] : RT(0);
+					yr[l] *= f;
+					yi[l] *= f;
+				}
+			}
+			B::Store (&ur[0], &ui[0], b, u);
+			B::Store (&vr[0], &vi[0], b, v);
+			for (size_t l = 0; l < std::min (L, nv-b*L); ++l)
+				s[b*L+l] = sv[l];
+		}
+	}
+}
+
+#endif /* __BATCHED_HPP__ */
@@ -0,0 +1,74 @@
+#include "Matrix.hpp"
+#include "Algos.hpp"
+#include "Creators.hpp"
+#include "Lapack.hpp"
+#include "Batched.hpp"
+#include "Print.hpp"
+
+template<class T> Matrix<T> slice (const Matrix<T>& A, const size_t& v) {
+    Matrix<T> a (size(A,1), size(A,2));
+    for (size_t j = 0; j < size(A,2); ++j)
+        for (size_t i = 0; i < size(A,1); ++i)
+            a(i,j) = A(v,i,j);
+    return a;
+}
+
+template<class T> bool batched_check (const size_t& nv, const size_t& m, const size_t& n) {
+
+    typedef typename TypeTraits<T>::RT RT;
+
+    Matrix<T> A = randn<T> (nv, m, n), B = randn<T> (nv, m, 2);
+    Matrix<T> X = lsq_batched (A, B, RT(0.1)), G = gram_batched (A, RT(0.1)),
+        U = chol_batched (G), Gi = inv_batched (G);
+    RT err = 0;
+
+    for (size_t v = 0; v < nv; ++v) {
+        Matrix<T> a = slice (A, v), g = gemm (a, a, 'C', 'N') + RT(0.1) * eye<T>(n);
+        Matrix<T> x = gemm (inv(g), gemm (a, slice (B, v), 'C', 'N'));
+        err = std::max (err, norm (slice(X,v) - x) / norm (x));
+        err = std::max (err, norm (slice(G,v) - g) / norm (g));
+        err = std::max (err, norm (slice(U,v) - chol(g)) / norm (g));
+        err = std::max (err, norm (gemm (slice(Gi,v), g) - eye<T>(n)) / RT(n));
+    }
+
+    std::cout << nv << " x " << m << "x" << n << ": " << err << std::endl;
+    return err < RT(1.0e-3);
+
+}
+
+// Not positive definite matrices are reported, not factorised
+template<class T> bool info_check (const size_t& nv, const size_t& n) {
+
+    typedef typename TypeTraits<T>::RT RT;
+
+    Matrix<T> A = randn<T> (nv, n+2, n), G = gram_batched (A, RT(0.1));
+    for (size_t v = 3; v < nv; v += 7)           // rank deficient
+        for (size_t i = 0; i < n; ++i)
+            for (size_t j = 0; j < n; ++j)
+                G(v,i,j) = (i < 2 && j < 2) ? T(1) : (i == j) ? T(1) : T(0);
+    G(0,n-1,n-1) = T(-1);                        // indefinite
+
+    Vector<int> info;
+    Matrix<T> U = chol_batched (G, &info);
+    bool ok = (info.size() == nv);
+    for (size_t v = 0; ok && v < nv; ++v)
+        ok &= (info[v] == ((v == 0) ? (int)n : (v%7 == 3) ? 2 : 0));
+
+    std::cout << nv << " x " << n << "x" << n << " info: " << (ok ? "ok" : "wrong") << std::endl;
+    return ok;
+
+}
+
+int main (int args, char** argv) {
+
+    bool ok = true;
+    ok &= batched_check<cxfl>(37, 8, 4);
+    ok &= batched_check<cxdb>(100, 32, 16);
+    ok &= batched_check<cxfl>(20, 24, 20);
+    ok &= batched_check<double>(19, 5, 3);
+    ok &= info_check<cxfl>(37, 4);
+    ok &= info_check<double>(20, 2);
+    
+    return ok ? 0 : 1;
+    
+}
@@ -0,0 +1,321 @@
+/*
+ *  codeare Copyright (C) 2010-2016
+ *                        Kaveh Vahedipour
+ *                        NYU School of Medicine, New York, USA
+ *
+ *  This program is free software; you can redistribute it and/or modify
+ *  it under the terms of the GNU General Public License as published by
+ *  the Free Software Foundation; either version 2 of the License, or
+ *  (at your option) any later version.
+ *
+ *  This program is distributed in the hope that it will be useful, but
+ *  WITHOUT ANY WARRANTY; without even the implied warranty of
+ *  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU
+ *  General Public License for more details.
+ *
+ *  You should have received a copy of the GNU General Public License
+ *  along with this program; if not, write to the Free Software
+ *  Foundation, Inc., 51 Franklin Street, Fifth Floor, Boston, MA
+ *  02110-1301  USA
+ */
+
+#ifndef __PREWHITENING_HPP__
+#define __PREWHITENING_HPP__
+
+#include "Algos.hpp"
+#include "Lapack.hpp"
+#include "OMP.hpp"
+
+/**
+ * @brief   Samples per block such that a block of nc coils (split real/imaginary)
+ *          stays within ~32kB of L1 cache.
+ */
+template<class RT> inline static size_t
+whitening_block (const size_t& nc) {
+	size_t b = (32768 / (2*sizeof(RT)*nc)) & ~size_t(15);
+	return std::max (b, size_t(16));
+}
+
+
+/**
+ * @brief   Streaming coil noise covariance.<br/>
+ *          Accumulates X^H X and column sums over any number of noise scans
+ *          (samples x channels, channels along last dimension). Convention
+ *          is that of cov() in Statistics.hpp.
+ */
+template<class T> class NoiseCovariance {
+
+	typedef typename TypeTraits<T>::RT RT;
+
+public:
+
+	/**
+	 * @brief         Construct
+	 *
+	 * @param  demean Subtract channel means (default: true as cov())
+	 */
+	NoiseCovariance (const bool demean = true) : _n(0), _demean(demean) {}
+
+	virtual ~NoiseCovariance () {}
+
+	/**
+	 * @brief         Accumulate noise samples
+	 *
+	 * @param  noise  Noise scan (channels along last dimension)
+	 */
+	void Add (const Matrix<T>& noise) {
+
+		const size_t nc = size(noise, ndims(noise)-1), ns = numel(noise)/nc,
+			bs = whitening_block<RT>(nc), nb = (ns + bs - 1) / bs;
+
+		if (_n == 0) {
+			_gram = zeros<T>(nc);
+			_sum  = Vector<T>(nc, T(0));
+		}
+		assert (size(_gram,0) == nc);
+
+#pragma omp parallel
+		{
+			Vector<RT> re (bs*nc), im (bs*nc);
+			Matrix<T>  gram = zeros<T>(nc);
+			Vector<T>  sum (nc, T(0));
+
+#pragma omp for schedule (static)
+			for (long b = 0; b < (long)nb; ++b) {
+				const size_t s0 = b*bs, len = std::min (bs, ns-s0);
+				Split (noise.Ptr(), ns, s0, len, nc, bs, re, im);
+				for (size_t j = 0; j < nc; ++j) {
+					const RT* rj = &re[j*bs]; const RT* ij = &im[j*bs];
+					for (size_t i = 0; i <= j; ++i) {
+						const RT* ri = &re[i*bs]; const RT* ii = &im[i*bs];
+						RT sr = 0, si = 0;
+#pragma omp simd reduction(+:sr,si)
+						for (size_t s = 0; s < bs; ++s) {
+							sr += ri[s]*rj[s] + ii[s]*ij[s];
+							si += ri[s]*ij[s] - ii[s]*rj[s];
+						}
+						gram(i,j) += Make(sr, si);
+					}
+					RT mr = 0, mi = 0;
+#pragma omp simd reduction(+:mr,mi)
+					for (size_t s = 0; s < bs; ++s) {
+						mr += rj[s];
+						mi += ij[s];
+					}
+					sum[j] += Make(mr, mi);
+				}
+			}
+
+#pragma omp critical
+			{
+				_gram += gram;
+				for (size_t j = 0; j < nc; ++j)
+					_sum[j] += sum[j];
+			}
+		}
+
+		_n += ns;
+
+	}
+
+	/**
+	 * @brief         Hermitian Gram matrix X^H X of all samples
+	 */
+	inline Matrix<T> Gram () const {
+		Matrix<T> g = _gram;
+		for (size_t j = 0; j < size(g,1); ++j)
+			for (size_t i = j+1; i < size(g,0); ++i)
+				g(i,j) = TypeTraits<T>::Conj(g(j,i));
+		return g;
+	}
+
+	/**
+	 * @brief         Noise covariance
+	 */
+	inline Matrix<T> Covariance () const {
+		assert (_n > 1);
+		Matrix<T> psi = Gram();
+		if (_demean)
+			for (size_t j = 0; j < size(psi,1); ++j)
+				for (size_t i = 0; i < size(psi,0); ++i)
+					psi(i,j) -= TypeTraits<T>::Conj(_sum[i]) * _sum[j] / RT(_n);
+		return psi / RT(_demean ? _n-1 : _n);
+	}
+
+	/**
+	 * @brief         Number of accumulated samples
+	 */
+	inline size_t Samples () const { return _n; }
+
+	/**
+	 * @brief         Split block of channels into real and imaginary arrays (zero padded)
+	 */
+	inline static void Split (const T* x, const size_t& ns, const size_t& s0, const size_t& len,
+			const size_t& nc, const size_t& bs, Vector<RT>& re, Vector<RT>& im) {
+		for (size_t c = 0; c < nc; ++c) {
+			const T* xc = x + c*ns + s0;
+			for (size_t s = 0; s < len; ++s) {
+				re[c*bs+s] = TypeTraits<T>::Real(xc[s]);
+				im[c*bs+s] = TypeTraits<T>::Imag(xc[s]);
+			}
+			for (size_t s = len; s < bs; ++s)
+				re[c*bs+s] = im[c*bs+s] = RT(0);
+		}
+	}
+
+	/**
+	 * @brief         Assemble complex number
+	 */
+	inline static T Make (const RT& re, const RT& im) { return T(re, im); }
+
+private:
+
+	Matrix<T> _gram;   /**< @brief Upper triangle of X^H X */
+	Vector<T> _sum;    /**< @brief Channel sums */
+	size_t    _n;      /**< @brief # samples */
+	bool      _demean; /**< @brief Subtract channel means */
+
+};
+
+
+/**
+ * @brief   Noise prewhitening with optional fused coil compression.<br/>
+ *          Pruessmann et al. MRM (2001): vol. 46 (4) pp. 638-651<br/>
+ *          Buehrer et al. MRM (2007): vol. 57 (6) pp. 1131-1139
+ *
+ *          With Psi = U^H U (chol), data X (samples x channels) is replaced by
+ *          X U^-1, whose noise covariance is identity. If coil compression is
+ *          configured, the compression matrix V is obtained from the whitened
+ *          Gram matrix and both are applied in a single pass X (U^-1 V).
+ */
+template<class T> class Prewhitener {
+
+	typedef typename TypeTraits<T>::RT RT;
+
+public:
+
+	Prewhitener () {}
+
+	/**
+	 * @brief         Construct with noise covariance
+	 *
+	 * @param  psi    Noise covariance (channels x channels)
+	 */
+	Prewhitener (const Matrix<T>& psi) {
+		Covariance (psi);
+	}
+
+	virtual ~Prewhitener () {}
+
+	/**
+	 * @brief         Set noise covariance and compute whitening matrix
+	 *
+	 * @param  psi    Noise covariance (channels x channels)
+	 */
+	inline void Covariance (const Matrix<T>& psi) {
+		assert (issquare(psi));
+		_w = inv (chol (psi));
+		_m = _w;
+	}
+
+	/**
+	 * @brief         Fuse coil compression into whitening
+	 *
+	 * @param  gram   Gram matrix X^H X of raw data (see NoiseCovariance::Gram)
+	 * @param  nv     Number of virtual coils
+	 */
+	inline void Compress (const Matrix<T>& gram, const size_t& nv) {
+		assert (nv > 0 && nv <= size(_w,0));
+		Matrix<T> gw = gemm (gemm (_w, gram, 'C', 'N'), _w, 'N', 'N');
+		Matrix<T> u  = GET<0>(svd2 (gw, 'S')); // gw Hermitian: left singular vectors
+		_m = gemm (_w, Matrix<T>(u(CR(),CR(0,nv-1))), 'N', 'N');
+	}
+
+	/**
+	 * @brief         Whitening matrix U^-1
+	 */
+	inline const Matrix<T>& Whitening () const { return _w; }
+
+	/**
+	 * @brief         Applied mixing matrix (U^-1 or U^-1 V)
+	 */
+	inline const Matrix<T>& Mixing () const { return _m; }
+
+	/**
+	 * @brief         Apply to data, in place if no compression
+	 *
+	 * @param  data   Data (channels along last dimension)
+	 */
+	void Apply (Matrix<T>& data) const {
+
+		Vector<size_t> dims = size(data);
+		const size_t nc = size(_m,0), nv = size(_m,1);
+		assert (dims.back() == nc);
+
+		if (nv == nc) {
+			Apply (data.Ptr(), data.Ptr(), numel(data)/nc);
+		} else {
+			dims.back() = nv;
+			Matrix<T> out (dims);
+			Apply (data.Ptr(), out.Ptr(), numel(data)/nc);
+			data = std::move(out);
+		}
+
+	}
+
+private:
+
+	/**
+	 * @brief         Blocked complex GEMM out(ns x nv) = in(ns x nc) * M
+	 *                Blocks are copied to split real/imaginary arrays first, hence
+	 *                in and out may alias.
+	 */
+	void Apply (const T* in, T* out, const size_t& ns) const {
+
+		const size_t nc = size(_m,0), nv = size(_m,1), bs = whitening_block<RT>(nc),
+			nb = (ns + bs - 1) / bs;
+		Vector<RT> mre (nc*nv), mim (nc*nv);
+		for (size_t i = 0; i < nc*nv; ++i) {
+			mre[i] = TypeTraits<T>::Real(_m[i]);
+			mim[i] = TypeTraits<T>::Imag(_m[i]);
+		}
+
+#pragma omp parallel
+		{
+			Vector<RT> re (bs*nc), im (bs*nc), ore (bs), oim (bs);
+
+#pragma omp for schedule (static)
+			for (long b = 0; b < (long)nb; ++b) {
+
+				const size_t s0 = b*bs, len = std::min (bs, ns-s0);
+				NoiseCovariance<T>::Split (in, ns, s0, len, nc, bs, re, im);
+
+				for (size_t k = 0; k < nv; ++k) {
+					RT* pr = &ore[0]; RT* pi = &oim[0];
+					std::fill (ore.begin(), ore.end(), RT(0));
+					std::fill (oim.begin(), oim.end(), RT(0));
+					for (size_t c = 0; c < nc; ++c) {
+						const RT mr = mre[k*nc+c], mi = mim[k*nc+c];
+						const RT* ar = &re[c*bs]; const RT* ai = &im[c*bs];
+#pragma omp simd
+						for (size_t s = 0; s < bs; ++s) {
+							pr[s] += ar[s]*mr - ai[s]*mi;
+							pi[s] += ar[s]*mi + ai[s]*mr;
+						}
+					}
+					T* o = out + k*ns + s0;
+					for (size_t s = 0; s < len; ++s)
+						o[s] = T(pr[s], pi[s]);
+				}
+
+			}
+		}
+
+	}
+
+	Matrix<T> _w; /**< @brief Whitening matrix */
+	Matrix<T> _m; /**< @brief Mixing matrix (whitening and compression) */
+
+};
+
+#endif /* __PREWHITENING_HPP__ */
@@ -0,0 +1,234 @@
+/*
+ *  codeare Copyright (C) 2010-2016
+ *                        Kaveh Vahedipour
+ *                        NYU School of Medicine, New York, USA
+ *
+ *  This program is free software; you can redistribute it and/or modify
+ *  it under the terms of the GNU General Public License as published by
+ *  the Free Software Foundation; either version 2 of the License, or
+ *  (at your option) any later version.
+ *
+ *  This program is distributed in the hope that it will be useful, but
+ *  WITHOUT ANY WARRANTY; without even the implied warranty of
+ *  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU
+ *  General Public License for more details.
+ *
+ *  You should have received a copy of the GNU General Public License
+ *  along with this program; if not, write to the Free Software
+ *  Foundation, Inc., 51 Franklin Street, Fifth Floor, Boston, MA
+ *  02110-1301  USA
+ */
+
+#ifndef __PSEUDO_REPLICA_HPP__
+#define __PSEUDO_REPLICA_HPP__
+
+#include "Operator.hpp"
+#include "Creators.hpp"
+#include "Philox.hpp"
+#include "Lapack.hpp"
+
+/**
+ * @brief   Pseudo-replica SNR and g-factor maps<br/>
+ *          Robson et al. MRM (2008): vol. 60 (4) pp. 895-907
+ *
+ *          Reuses one initialised reconstruction operator (e.g. NCSENSE, CSENSE)
+ *          for all replicas. Correlated noise is synthesised from the
+ *          Cholesky factor of the measured noise covariance. Image statistics are
+ *          accumulated with Welford updates, so memory stays at the size of one
+ *          (batch of) image(s) independent of the number of replicas.
+ *
+ *          With batch > 1, replicas are stacked along an additional trailing
+ *          dimension and reconstructed in a single operator call. The operator
+ *          must support this (e.g. NCSENSE constructed with "dim4" = batch).
+ *          If batch does not divide the number of replicas, the last call
+ *          is padded with zero replicas whose images are discarded. The SENSE
+ *          and CGSENSE modules reconstruct one replica per call.
+ */
+template<class T> class PseudoReplica {
+
+    typedef typename TypeTraits<T>::RT RT;
+
+public:
+
+    /**
+     * @brief          Construct with initialised operator
+     *
+     * @param  E       Reconstruction operator (E->*data yields image)
+     * @param  nreps   Number of replicas
+     * @param  seed    Noise seed (replica r uses stream r)
+     * @param  batch   Replicas per operator call
+     */
+    PseudoReplica (const Operator<T>& E, const size_t& nreps = 100,
+                   const uint64_t& seed = 0, const size_t& batch = 1) :
+        _E(E), _nreps(nreps), _batch(std::max(batch,(size_t)1)), _n(0), _rng(seed), _u(eye<T>(1)) {}
+
+    virtual ~PseudoReplica () {}
+
+    /**
+     * @brief          Noise covariance (channels x channels)
+     *
+     * @param  psi     Hermitian positive definite noise covariance
+     *                 (default: identity, 1x1: same variance in all channels)
+     */
+    inline void NoiseCovariance (const Matrix<T>& psi) {
+        assert (issquare(psi) || numel(psi) == 1);
+        if (numel(psi) == 1) {
+            _u = eye<T>(1);
+            _u[0] = std::sqrt (psi[0]);
+        } else
+            _u = chol (psi);
+    }
+
+    /**
+     * @brief          Reconstruct replicas of data and accumulate statistics
+     *
+     * @param  data    Measured data (channels along last dimension)
+     */
+    void Run (const Matrix<T>& data) {
+
+        Vector<size_t> sz = size(data);
+        if (_batch > 1)
+            sz.push_back(_batch);
+
+        // Unit variance per channel sample, i.e. 1/2 per real and imaginary part
+        const RT sigma = TypeTraits<T>::IsComplex() ? std::sqrt(RT(0.5)) : RT(1);
+        Matrix<T> noisy (sz), z (size(data));
+
+        _n = 0;
+        for (size_t r = 0; r < _nreps; r += _batch) {
+
+            const size_t nb = std::min(_batch, _nreps-r);
+            for (size_t b = 0; b < nb; ++b) {
+                Random<T,Philox>::Normal (z, _rng.Split(r+b), RT(0), sigma);
+                Colour (z, data, noisy.Ptr(b*numel(data)));
+            }
+            if (nb < _batch) // last, partial batch: zero padded
+                std::fill (noisy.Ptr(nb*numel(data)), noisy.Ptr() + numel(noisy), T(0));
+
+            Matrix<T> img = _E ->* noisy;
+            Vector<size_t> isz = size(img);
+            if (_batch > 1)
+                isz.pop_back();
+            if (_n == 0) {
+                _mean = Matrix<T>(isz);
+                _m2   = Matrix<RT>(isz);
+            }
+
+            for (size_t b = 0; b < nb; ++b)
+                Accumulate (img.Ptr(b*numel(_mean)));
+
+        }
+
+    }
+
+    /**
+     * @brief          Mean image over replicas
+     */
+    inline const Matrix<T>& Mean () const { return _mean; }
+
+    /**
+     * @brief          Variance E|x-mean|^2 over replicas
+     */
+    inline Matrix<RT> Variance () const {
+        Matrix<RT> var = _m2;
+        if (_n > 1)
+            var /= RT(_n-1);
+        return var;
+    }
+
+    /**
+     * @brief          Standard deviation over replicas
+     */
+    inline Matrix<RT> StdDev () const {
+        Matrix<RT> sd = Variance();
+        for (size_t i = 0; i < numel(sd); ++i)
+            sd[i] = std::sqrt(sd[i]);
+        return sd;
+    }
+
+    /**
+     * @brief          SNR map |mean|/std
+     */
+    inline Matrix<RT> SNR () const {
+        Matrix<RT> snr = StdDev();
+#pragma omp parallel for
+        for (long i = 0; i < (long)numel(snr); ++i)
+            snr[i] = (snr[i] > RT(0)) ? std::abs(_mean[i])/snr[i] : RT(0);
+        return snr;
+    }
+
+    /**
+     * @brief          g-factor map std_acc / (std_ref * sqrt(R))
+     *
+     * @param  ref     Standard deviation map of fully sampled reconstruction
+     * @param  af      Acceleration factor
+     */
+    inline Matrix<RT> GFactor (const Matrix<RT>& ref, const RT& af) const {
+        Matrix<RT> g = StdDev();
+        assert (numel(g) == numel(ref));
+        const RT saf = std::sqrt(af);
+#pragma omp parallel for
+        for (long i = 0; i < (long)numel(g); ++i)
+            g[i] = (ref[i] > RT(0)) ? g[i]/(ref[i]*saf) : RT(0);
+        return g;
+    }
+
+    /**
+     * @brief          Number of accumulated replicas
+     */
+    inline size_t Replicas () const { return _n; }
+
+private:
+
+    /**
+     * @brief          Replica = data + z * U across channels (covariance U^H U as cov())
+     */
+    void Colour (const Matrix<T>& z, const Matrix<T>& data, T* noisy) const {
+
+        const size_t nc = size(_u,0), ns = numel(data)/nc;
+        if (nc > 1)
+            assert (size(data, ndims(data)-1) == nc);
+
+#pragma omp parallel for
+        for (long k = 0; k < (long)ns; ++k)
+            for (size_t c = 0; c < nc; ++c) {
+                T n = T(0);
+                if (nc > 1)
+                    for (size_t j = 0; j <= c; ++j)
+                        n += z[j*ns+k] * _u(j,c);
+                else
+                    n = z[k] * _u[0];
+                noisy[c*ns+k] = data[c*ns+k] + n;
+            }
+
+    }
+
+    /**
+     * @brief          Welford update of mean and sum of squared deviations
+     */
+    void Accumulate (const T* x) {
+
+        const size_t n = numel(_mean);
+        const RT rn = RT(1)/RT(++_n);
+
+#pragma omp parallel for
+        for (long i = 0; i < (long)n; ++i) {
+            T delta = x[i] - _mean[i];
+            _mean[i] += delta * rn;
+            _m2[i]   += TypeTraits<T>::Real(TypeTraits<T>::Conj(delta) * (x[i] - _mean[i]));
+        }
+
+    }
+
+    const Operator<T>& _E;  /**< @brief Reconstruction operator */
+    size_t     _nreps;      /**< @brief # replicas */
+    size_t     _batch;      /**< @brief Replicas per operator call */
+    size_t     _n;          /**< @brief Accumulated replicas */
+    Philox     _rng;        /**< @brief Noise generator */
+    Matrix<T>  _u;          /**< @brief Cholesky factor of noise covariance */
+    Matrix<T>  _mean;       /**< @brief Running mean */
+    Matrix<RT> _m2;         /**< @brief Running sum of squared deviations */
+
+};
+
+#endif /* __PSEUDO_REPLICA_HPP__ */
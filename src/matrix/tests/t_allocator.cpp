@@ -0,0 +1,56 @@
+#include <Matrix.hpp>
+#include <Creators.hpp>
+
+template<class T> inline static int check () {
+
+    AllocatorPolicy& policy = AllocatorPolicy::Instance();
+    AllocatorStats& stats = AllocatorStats::Instance();
+    const size_t small = stats.allocations[AllocatorStats::SMALL],
+        paged = stats.allocations[AllocatorStats::PAGED],
+        huge = stats.allocations[AllocatorStats::HUGE_PAGED];
+
+    policy.mode = AllocatorPolicy::TIERED;
+    policy.page_threshold = 1<<16;
+    policy.huge_threshold = 1<<22;
+
+    // Huge pages only for buffers that opt in
+    Matrix<T> A (8,8), B (128,128), T2 (1024,1024), C, E;
+    {
+        LargeBuffers large;
+        C = Matrix<T>(1024,1024);
+        E = Matrix<T>(32,32);
+    }
+    A(7,7) = T(1); B(127,127) = T(2); C(1023,1023) = T(3);
+
+#ifdef HAVE_TIERED_ALLOCATION
+    if ((size_t)B.Ptr() % 4096 || (size_t)C.Ptr() % (2<<20) || (size_t)E.Ptr() % 4096) {
+        std::cerr << "Tiered buffers not page aligned" << std::endl;
+        return 1;
+    }
+    if (stats.allocations[AllocatorStats::PAGED] != paged + 3 ||
+        stats.allocations[AllocatorStats::HUGE_PAGED] != huge + 1) {
+        std::cerr << "Tiered allocations not counted" << std::endl;
+        return 1;
+    }
+#endif
+    if (stats.allocations[AllocatorStats::SMALL] == small)
+        return 1;
+    if (C[0] != T(0) || C(1023,1023) != T(3) || B[0] != T(0))
+        return 1;
+
+    // Switch at runtime, buffers are freed by the tier they came from
+    policy.mode = AllocatorPolicy::ALIGNED;
+    Matrix<T> D = C;
+    if (issame (C, D) != 2)
+        return 1;
+    policy.mode = AllocatorPolicy::TIERED;
+
+    return 0;
+
+}
+
+int main (int args, char** argv) {
+    int ret = check<float>() + check<cxdb>();
+    AllocatorStats::Instance().Report();
+    return ret;
+}
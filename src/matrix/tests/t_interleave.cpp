@@ -0,0 +1,39 @@
+#include <Matrix.hpp>
+#include <Creators.hpp>
+#include <Interleave.hpp>
+
+template<class T> inline static int check (const size_t n) {
+
+    Matrix<std::complex<T> > A = randn<std::complex<T> >(n,1), B (n,1);
+    std::vector<T> re (n), im (n);
+
+    deinterleave (A.Ptr(), &re[0], &im[0], n);
+    for (size_t i = 0; i < n; ++i)
+        if (re[i] != A[i].real() || im[i] != A[i].imag()) {
+            std::cerr << "deinterleave failed at " << i << " of " << n << std::endl;
+            return 1;
+        }
+
+    interleave (&re[0], &im[0], B.Ptr(), n);
+    if (!std::equal(A.Begin(), A.End(), B.Begin())) {
+        std::cerr << "interleave failed for " << n << std::endl;
+        return 1;
+    }
+
+    interleave (&re[0], (const T*)0, B.Ptr(), n);
+    for (size_t i = 0; i < n; ++i)
+        if (B[i] != std::complex<T>(re[i], T(0)))
+            return 1;
+
+    return 0;
+
+}
+
+int main (int args, char** argv) {
+    int ret = 0;
+    for (size_t n = 1; n < 40; n += 3)
+        ret += check<float>(n) + check<double>(n);
+    ret += check<float>(100003) + check<double>(100003);
+    std::cout << ((ret) ? "failed" : "passed") << std::endl;
+    return ret;
+}
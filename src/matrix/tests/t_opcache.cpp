@@ -0,0 +1,69 @@
+#include <Matrix.hpp>
+#include <OperatorCache.hpp>
+
+static int alive = 0;
+
+struct Plan {
+    Plan () { ++alive; }
+    ~Plan () { --alive; }
+};
+struct OtherPlan : public Plan {};
+
+int main (int args, char** argv) {
+
+    int ret = 0;
+
+    // Hash: same set up, same value; any change, different value
+    Matrix<float> k (128,2), k2;
+    for (size_t i = 0; i < k.Size(); ++i)
+        k[i] = (float)i / k.Size() - .5f;
+    k2 = k;
+    OperatorHash h1, h2, h3, h4;
+    h1 << k << (size_t)2 << 1.5f;
+    h2 << k2 << (size_t)2 << 1.5f;
+    ret += (h1.Value() != h2.Value());
+    k2[17] = .25f;
+    h3 << k2 << (size_t)2 << 1.5f;
+    ret += (h1.Value() == h3.Value());
+    Matrix<float> k3 (2,128);
+    std::copy (k.Begin(), k.End(), k3.Begin());
+    h4 << k3 << (size_t)2 << 1.5f;
+    ret += (h1.Value() == h4.Value());
+    OperatorHash h5;                               // matrices enter by fingerprint
+    h5 << fingerprint (k) << (size_t)2 << 1.5f;
+    ret += (h1.Value() != h5.Value());
+
+    // Cache: exclusive hand out, LRU eviction, operator types kept apart
+    OperatorCache cache;
+    cache.Capacity (300);
+    ret += (cache.Take<Plan>(1) != 0);
+    cache.Put (1, std::make_shared<Plan>(), 100);
+    cache.Put (2, std::make_shared<Plan>(), 100);
+    cache.Put (3, std::make_shared<OtherPlan>(), 100);
+    ret += (cache.Entries() != 3 || cache.Bytes() != 300 || alive != 3);
+    ret += (cache.Take<Plan>(3) != 0);
+
+    std::shared_ptr<Plan> p = cache.Take<Plan>(1);
+    ret += (!p || cache.Take<Plan>(1) != 0);
+    cache.Put (1, p, 100);                         // 1 most recently used
+    p.reset();
+    cache.Put (4, std::make_shared<Plan>(), 100);  // evicts 2
+    ret += (cache.Take<Plan>(2) != 0 || alive != 3);
+    ret += (cache.Entries() != 3 || cache.Bytes() != 300);
+
+    cache.Put (5, std::make_shared<Plan>(), 1000); // beyond cap: not kept
+    ret += (cache.Entries() != 3 || alive != 3);
+
+    cache.Capacity (100);                          // evicts 3 and 1
+    ret += (cache.Entries() != 1 || alive != 1 || !(p = cache.Take<Plan>(4)));
+    p.reset();
+    ret += (alive != 0);
+
+    cache.Put (6, std::make_shared<Plan>(), 10);
+    cache.Clear ();
+    ret += (cache.Entries() != 0 || cache.Bytes() != 0 || alive != 0);
+
+    std::cout << ((ret) ? "failed" : "passed") << std::endl;
+    return ret;
+
+}
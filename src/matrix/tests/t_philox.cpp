@@ -0,0 +1,52 @@
+#include <Matrix.hpp>
+#include <Creators.hpp>
+#include <Print.hpp>
+
+template<class T> inline static int check () {
+
+    typedef typename TypeTraits<T>::RT RT;
+    Vector<size_t> sz (2);
+    sz[0] = 1023; sz[1] = 17;
+
+    omp_set_num_threads(1);
+    Matrix<T> A = randn<T>(sz, Philox(42,7));
+    omp_set_num_threads(4);
+    Matrix<T> B = randn<T>(sz, Philox(42,7));
+    Matrix<T> C = randn<T>(sz, Philox(42,8));
+    Matrix<T> U = rand<T>(sz, Philox(42));
+
+    std::cout << "A(1:4) = [" << A[0] << " " << A[1] << " " << A[2] << " " << A[3] << "];" << std::endl;
+
+    if (!std::equal(A.Begin(), A.End(), B.Begin())) {
+        std::cerr << "Philox fill depends on # threads" << std::endl;
+        return 1;
+    }
+    if (std::equal(A.Begin(), A.End(), C.Begin())) {
+        std::cerr << "Philox streams are not independent" << std::endl;
+        return 1;
+    }
+
+    RT m = 0, v = 0;
+    const RT* p = (const RT*) A.Ptr();
+    const size_t n = A.Size()*sizeof(T)/sizeof(RT);
+    for (size_t i = 0; i < n; ++i) {
+        m += p[i];
+        v += p[i]*p[i];
+    }
+    m /= n; v = v/n - m*m;
+    std::cout << "mean " << m << " var " << v << std::endl;
+    if (std::abs(m) > 0.05 || std::abs(v-1.0) > 0.05)
+        return 1;
+
+    p = (const RT*) U.Ptr();
+    for (size_t i = 0; i < n; ++i)
+        if (p[i] < -1.0 || p[i] > 1.0)
+            return 1;
+
+    return 0;
+
+}
+
+int main (int args, char** argv) {
+    return check<float>() + check<double>() + check<cxfl>() + check<cxdb>();
+}
@@ -0,0 +1,66 @@
+#include <Matrix.hpp>
+#include <Creators.hpp>
+#include <mri/Prewhitening.hpp>
+
+#include <functional>
+
+using namespace codeare::matrix;
+
+// Compressed energy against the sum of the nv largest eigenvalues of the whitened Gram matrix
+template<class T> inline static int check (const size_t ns, const size_t nc, const size_t nv) {
+
+    typedef typename TypeTraits<T>::RT RT;
+    int ret = 0;
+
+    // Correlated noise and data of decaying coil spectrum
+    Matrix<T> mix = randn<T>(nc,nc) + T(2) * eye<T>(nc), spec = zeros<T>(nc);
+    for (size_t c = 0; c < nc; ++c)
+        spec(c,c) = T(RT(nc-c)*RT(nc-c));
+    Matrix<T> noise = gemm (randn<T>(ns,nc), mix), data = gemm (gemm (randn<T>(ns,nc), spec), mix);
+
+    NoiseCovariance<T> nco, gram (false);
+    nco.Add (noise);
+    gram.Add (data);
+
+    Prewhitener<T> pw (nco.Covariance());
+    const Matrix<T>& w = pw.Whitening();
+    Matrix<T> gw = gemm (gemm (w, gram.Gram(), 'C', 'N'), w, 'N', 'N');
+    Matrix<typename TypeTraits<T>::CT> ev = eig (gw);
+    std::vector<RT> l (nc);
+    for (size_t c = 0; c < nc; ++c)
+        l[c] = TypeTraits<T>::Real(ev[c]);
+    std::sort (l.begin(), l.end(), std::greater<RT>());
+    const RT all = std::accumulate (l.begin(), l.end(), RT(0)),
+        top = std::accumulate (l.begin(), l.begin()+nv, RT(0));
+
+    pw.Compress (gram.Gram(), nv);
+    Matrix<T> out = data;
+    pw.Apply (out);
+    ret += (size(out,1) != nv);
+    RT kept = 0;
+    for (size_t i = 0; i < numel(out); ++i)
+        kept += std::norm (out[i]);
+    if (std::abs (kept - top) > RT(1e-3) * all) {
+        std::cerr << "retained " << kept << " of " << all << ", expected " << top << std::endl;
+        ++ret;
+    }
+
+    // Whitened noise has identity covariance
+    pw.Covariance (nco.Covariance());
+    Matrix<T> wn = noise;
+    pw.Apply (wn);
+    NoiseCovariance<T> wc;
+    wc.Add (wn);
+    Matrix<T> id = wc.Covariance() - eye<T>(nc);
+    for (size_t i = 0; i < numel(id); ++i)
+        ret += (std::abs (id[i]) > RT(1e-3));
+
+    return ret;
+
+}
+
+int main (int args, char** argv) {
+    int ret = check<cxfl>(4096, 8, 3) + check<cxdb>(4096, 12, 4) + check<cxdb>(1000, 6, 6);
+    std::cout << ((ret) ? "failed" : "passed") << std::endl;
+    return ret;
+}
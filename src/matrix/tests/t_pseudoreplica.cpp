@@ -0,0 +1,57 @@
+#include <Matrix.hpp>
+#include <mri/PseudoReplica.hpp>
+
+using namespace codeare::matrix;
+
+// Identity reconstruction, records the size of every call
+template<class T> class Id : public Operator<T> {
+public:
+    virtual Matrix<T> operator->* (const Matrix<T>& m) const {
+        calls.push_back (numel(m));
+        return m;
+    }
+    mutable std::vector<size_t> calls;
+};
+
+template<class T> inline static int check () {
+
+    typedef typename TypeTraits<T>::RT RT;
+    int ret = 0;
+
+    // Single channel: variance from 1x1 covariance
+    Id<T> E1;
+    Matrix<T> d1 = ones<T>(128,1), psi1 = T(4) * eye<T>(1);
+    PseudoReplica<T> p1 (E1, 2000, 7);
+    p1.NoiseCovariance (psi1);
+    p1.Run (d1);
+    ret += (std::abs (mean(p1.Variance())[0] - RT(4)) > RT(.2));
+    ret += (std::abs (mean(p1.Mean())[0] - T(1)) > RT(.05));
+
+    // Partial last batch: constant operator input size, same statistics as batch 1
+    Id<T> E, F;
+    Matrix<T> data = ones<T>(64,4), psi = eye<T>(4);
+    psi(1,1) = T(4); psi(0,1) = T(.5); psi(1,0) = T(.5);
+    PseudoReplica<T> pb (E, 1002, 3, 4), ps (F, 1002, 3);
+    pb.NoiseCovariance (psi); ps.NoiseCovariance (psi);
+    pb.Run (data); ps.Run (data);
+    ret += (E.calls.size() != 251 || F.calls.size() != 1002 || pb.Replicas() != 1002);
+    for (size_t i = 0; i < E.calls.size(); ++i)
+        ret += (E.calls[i] != 4*numel(data));
+    Matrix<RT> vb = pb.Variance(), vs = ps.Variance();
+    for (size_t i = 0; i < numel(vb); ++i)
+        ret += (std::abs (vb[i]-vs[i]) > RT(1e-4) * vs[i]);
+    ret += (std::abs (vs[64] - RT(4)) > RT(.8));
+
+    // g-factor against itself is 1/sqrt(R)
+    Matrix<RT> g = pb.GFactor (pb.StdDev(), RT(4));
+    ret += (std::abs (g[0] - RT(.5)) > RT(1e-5));
+
+    return ret;
+
+}
+
+int main (int args, char** argv) {
+    int ret = check<float>() + check<cxfl>() + check<cxdb>();
+    std::cout << ((ret) ? "failed" : "passed") << std::endl;
+    return ret;
+}
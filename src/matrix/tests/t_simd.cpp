@@ -0,0 +1,125 @@
+#include <Matrix.hpp>
+#include <Algos.hpp>
+#include <SIMDKernels.hpp>
+
+#include <cmath>
+#include <vector>
+
+using namespace codeare::matrix;
+
+template<class T> inline static bool near (const T a, const T b, const double tol) {
+    const double d = std::abs (a-b), r = std::abs (b);
+    return d <= tol * std::max (r, 1.);
+}
+
+// Kernels of all instruction sets this CPU supports against scalar results
+template<class T> inline static int check (const size_t n) {
+
+    typedef std::complex<T> C;
+    const double tol = 8. * std::numeric_limits<T>::epsilon();
+    std::vector<T> a (2*n), b (2*n), c (2*n);
+    for (size_t i = 0; i < 2*n; ++i) {
+        a[i] = T(std::cos (.1*i) * (i+1));
+        b[i] = T(std::sin (.37*i) + 1.5);
+    }
+    const T s = T(1.25), sr = T(.5), si = T(-2.);
+    const C* za = (const C*)&a[0], *zb = (const C*)&b[0];
+    const C zs (sr, si);
+
+    int ret = 0;
+    const ISA detected = CPUFeatures::Instance().detected;
+    for (int v = ISA_SSE2; v <= detected; ++v) {
+
+#if CODEARE_MULTIVERSION
+#  define VARIANT(name, args)                                         \
+        switch (v) {                                                  \
+        case ISA_AVX512: simd::name##_avx512 args; break;             \
+        case ISA_AVX2:   simd::name##_avx2   args; break;             \
+        default:         simd::name##_sse2   args; break;             \
+        }
+#else
+#  define VARIANT(name, args) simd::name##_sse2 args;
+#endif
+#define CHECK(name, cond)                                                       \
+        for (size_t i = 0; i < n; ++i)                                          \
+            if (!(cond)) {                                                      \
+                std::cerr << #name " (" << CPUFeatures::Name((ISA)v) << ") failed at "  \
+                          << i << " of " << n << std::endl;                     \
+                ++ret; break;                                                   \
+            }
+
+        VARIANT(add, (&a[0], &b[0], &c[0], n))  CHECK(add, c[i] == a[i] + b[i])
+        VARIANT(sub, (&a[0], &b[0], &c[0], n))  CHECK(sub, c[i] == a[i] - b[i])
+        VARIANT(mul, (&a[0], &b[0], &c[0], n))  CHECK(mul, c[i] == a[i] * b[i])
+        VARIANT(div, (&a[0], &b[0], &c[0], n))  CHECK(div, c[i] == a[i] / b[i])
+        VARIANT(adds, (&a[0], s, &c[0], n))     CHECK(adds, c[i] == a[i] + s)
+        VARIANT(subs, (&a[0], s, &c[0], n))     CHECK(subs, c[i] == a[i] - s)
+        VARIANT(muls, (&a[0], s, &c[0], n))     CHECK(muls, c[i] == a[i] * s)
+        VARIANT(divs, (&a[0], s, &c[0], n))     CHECK(divs, c[i] == a[i] / s)
+
+        const C* zc = (const C*)&c[0];
+        VARIANT(cmul, (&a[0], &b[0], &c[0], n))  CHECK(cmul, near (zc[i], za[i] * zb[i], tol))
+        VARIANT(cdiv, (&a[0], &b[0], &c[0], n))  CHECK(cdiv, near (zc[i], za[i] / zb[i], tol))
+        VARIANT(cadds, (&a[0], sr, si, &c[0], n)) CHECK(cadds, zc[i] == za[i] + zs)
+        VARIANT(csubs, (&a[0], sr, si, &c[0], n)) CHECK(csubs, zc[i] == za[i] - zs)
+        VARIANT(cmuls, (&a[0], sr, si, &c[0], n)) CHECK(cmuls, near (zc[i], za[i] * zs, tol))
+        VARIANT(cdivs, (&a[0], sr, si, &c[0], n)) CHECK(cdivs, near (zc[i], za[i] / zs, tol))
+        VARIANT(conj, (&a[0], &c[0], n))          CHECK(conj, zc[i] == std::conj(za[i]))
+
+        T r, ri;
+        VARIANT(sum, (&a[0], n, r))
+        if (!near (r, std::accumulate (a.begin(), a.begin()+n, T(0)), n*tol))
+            ++ret;
+        VARIANT(csum, (&a[0], n, r, ri))
+        if (!near (C(r,ri), std::accumulate (za, za+n, C(0)), n*tol))
+            ++ret;
+        VARIANT(max, (&a[0], n, r))
+        if (r != *std::max_element (a.begin(), a.begin()+n))
+            ++ret;
+        VARIANT(min, (&a[0], n, r))
+        if (r != *std::min_element (a.begin(), a.begin()+n))
+            ++ret;
+
+#undef CHECK
+#undef VARIANT
+    }
+
+    // Matrix arithmetic in place through the dispatched kernels
+    Matrix<C> A (n,1), B (n,1), R;
+    for (size_t i = 0; i < n; ++i) {
+        A[i] = za[i];
+        B[i] = zb[i];
+    }
+    R = A; R *= B;
+    for (size_t i = 0; i < n; ++i)
+        ret += !near (R[i], A[i]*B[i], tol);
+    R = A; R /= zs;
+    for (size_t i = 0; i < n; ++i)
+        ret += !near (R[i], A[i]/zs, tol);
+    R = A; R -= B;
+    for (size_t i = 0; i < n; ++i)
+        ret += (R[i] != A[i]-B[i]);
+    R = !A;
+    for (size_t i = 0; i < n; ++i)
+        ret += (R[i] != std::conj(A[i]));
+
+    Matrix<T> X (n,1);
+    std::copy (a.begin(), a.begin()+n, X.Begin());
+    ret += (mmax(X) != *std::max_element (X.Begin(), X.End()));
+    ret += (mmin(X) != *std::min_element (X.Begin(), X.End()));
+
+    return ret;
+
+}
+
+int main (int args, char** argv) {
+    int ret = 0;
+    std::cout << "instruction set: " << CPUFeatures::Name (CPUFeatures::Instance().isa)
+              << " (detected " << CPUFeatures::Name (CPUFeatures::Instance().detected) << ")"
+              << std::endl;
+    for (size_t n = 1; n < 70; n += 3)
+        ret += check<float>(n) + check<double>(n);
+    ret += check<float>(100003) + check<double>(100003);
+    std::cout << ((ret) ? "failed" : "passed") << std::endl;
+    return ret;
+}
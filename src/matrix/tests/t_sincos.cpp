@@ -0,0 +1,31 @@
+#include <Matrix.hpp>
+#include <SinCos.hpp>
+
+#include <vector>
+
+inline static int check () {
+
+    const size_t n = 100003;
+    std::vector<float> x (n), s (n), c (n);
+
+    // Dense sweep through the reduced range, plus some large arguments
+    for (size_t i = 0; i < n; ++i)
+        x[i] = -400.f + 800.f * (float)i / (float)(n-1);
+    x[17] = 0.f; x[18] = 1.e4f; x[19] = -3.e5f; x[20] = sincos_range;
+
+    sincos (&x[0], &s[0], &c[0], n);
+
+    double es = 0., ec = 0.;
+    for (size_t i = 0; i < n; ++i) {
+        es = std::max (es, std::abs ((double)s[i] - ::sin ((double)x[i])));
+        ec = std::max (ec, std::abs ((double)c[i] - ::cos ((double)x[i])));
+    }
+    std::cout << "max |sin err| " << es << " max |cos err| " << ec << std::endl;
+
+    return (es < 1.e-6 && ec < 1.e-6) ? 0 : 1;
+
+}
+
+int main (int args, char** argv) {
+    return check();
+}
@@ -0,0 +1,42 @@
+#include <Matrix.hpp>
+#include <Algos.hpp>
+#include <Topology.hpp>
+
+int main (int args, char** argv) {
+
+    const Topology& topo = Topology::Instance();
+    topo.Report();
+
+    std::vector<int> l = Topology::ParseList ("0-3,8,10-11\n");
+    if (l.size() != 7 || l[3] != 3 || l[4] != 8 || l[6] != 11)
+        return 1;
+
+    if (topo.Nodes() < 1 || topo.CPUs() < 1 || topo.Sockets() < 1)
+        return 1;
+
+    // Compact layout: nodes ascending with thread number, CPUs in their node
+    const size_t nt = 2*topo.CPUs();
+    for (size_t t = 0; t < nt; ++t) {
+        const size_t n = topo.NodeOfThread (t, nt);
+        if (n >= topo.Nodes() || (t > 0 && n < topo.NodeOfThread (t-1, nt)))
+            return 1;
+        const std::vector<int>& cpus = topo.CPUs(n);
+        if (std::find (cpus.begin(), cpus.end(), topo.CPUOfThread (t, nt)) == cpus.end())
+            return 1;
+    }
+
+    topo.PinOpenMP (4);
+
+    // Placement is advisory, data must be unaffected
+    Matrix<cxfl> A (256,256,8);
+    for (size_t i = 0; i < numel(A); ++i)
+        A[i] = cxfl(i,-(float)i);
+    topo.Partition (A.Ptr(), A.Size()*sizeof(cxfl), 8);
+    topo.Interleave (A.Ptr(), A.Size()*sizeof(cxfl));
+    for (size_t i = 0; i < numel(A); ++i)
+        if (A[i] != cxfl(i,-(float)i))
+            return 1;
+
+    return 0;
+
+}
@@ -0,0 +1,98 @@
+#include <Matrix.hpp>
+#include <CX.hpp>
+#include <Trigonometry.hpp>
+
+#include <cmath>
+#include <limits>
+#include <vector>
+
+using namespace codeare::matrix;
+
+// Distance in units in the last place of the (double) reference
+template<class T> inline static double ulp (const T v, const double ref) {
+    if (v == ref || (v != v && ref != ref))
+        return 0.;
+    const double r = std::abs (ref), m = std::numeric_limits<T>::min();
+    const double u = std::ldexp ((double)std::numeric_limits<T>::epsilon(),
+                                 std::ilogb (std::max (r, m)));
+    return std::abs ((double)v - ref) / u;
+}
+
+template<class T> inline static bool
+check (const vmath::Accuracy a, const double tol) {
+
+    const size_t n = 100003;
+    Matrix<T> x (n,1), p (n,1), y, s (n,1), c (n,1);
+    Matrix<std::complex<T> > z (n,1);
+    for (size_t i = 0; i < n; ++i) {
+        x[i] = T(-80. + 160. * (double)i / (double)(n-1));
+        p[i] = T(1.e-20 * std::pow (1.e40, (double)i / (double)(n-1)));
+        z[i] = std::complex<T> (T(std::cos (.1*i) * i), T(std::sin (.37*i) * (n-i)));
+    }
+
+    double e[6] = {0., 0., 0., 0., 0., 0.};
+    y = arithmetic::exp (x, a);
+    for (size_t i = 0; i < n; ++i)
+        e[0] = std::max (e[0], ulp (y[i], std::exp ((double)x[i])));
+    y = arithmetic::log (p, a);
+    for (size_t i = 0; i < n; ++i)
+        e[1] = std::max (e[1], ulp (y[i], std::log ((double)p[i])));
+    arithmetic::sin (x, s, a);
+    arithmetic::cos (x, c, a);
+    for (size_t i = 0; i < n; ++i) {
+        e[2] = std::max (e[2], ulp (s[i], std::sin ((double)x[i])));
+        e[2] = std::max (e[2], ulp (c[i], std::cos ((double)x[i])));
+    }
+    Matrix<T> m, ph;
+    absarg (z, m, ph, a);
+    for (size_t i = 0; i < n; ++i) {
+        const std::complex<double> zd (z[i].real(), z[i].imag());
+        e[3] = std::max (e[3], ulp (m[i], std::abs (zd)));
+        e[4] = std::max (e[4], ulp (ph[i], std::arg (zd)));
+    }
+    Matrix<std::complex<T> > w = complex2 (m, ph, a);
+    for (size_t i = 0; i < n; ++i)
+        e[5] = std::max (e[5], (double)std::abs (w[i] - z[i]) / (double)std::abs (z[i]));
+
+    std::cout << "exp " << e[0] << " log " << e[1] << " sin/cos " << e[2] << " abs " << e[3]
+              << " arg " << e[4] << " ulp, polar rel. " << e[5] << std::endl;
+    for (size_t i = 0; i < 5; ++i)
+        if (e[i] > tol)
+            return false;
+    if (e[5] > 8*std::numeric_limits<T>::epsilon())
+        return false;
+
+    // In-place, special values
+    const T inf = std::numeric_limits<T>::infinity(), nan = std::numeric_limits<T>::quiet_NaN();
+    Matrix<T> sv (6,1);
+    sv[0] = inf; sv[1] = -inf; sv[2] = nan; sv[3] = T(0); sv[4] = T(1000); sv[5] = T(-1000);
+    arithmetic::exp (sv, sv, a);
+    if (sv[0] != inf || sv[1] != T(0) || sv[2] == sv[2] || sv[3] != T(1) || sv[4] != inf || sv[5] != T(0))
+        return false;
+    sv[0] = inf; sv[1] = T(-1); sv[2] = nan; sv[3] = T(0); sv[4] = T(1); sv[5] = T(-0.);
+    arithmetic::log (sv, sv, a);
+    if (sv[0] != inf || sv[1] == sv[1] || sv[2] == sv[2] || sv[3] != -inf || sv[4] != T(0) || sv[5] != -inf)
+        return false;
+    Matrix<std::complex<T> > sz (4,1);
+    sz[0] = std::complex<T> (T(-1), T(-0.)); sz[1] = std::complex<T> (T(0), T(0));
+    sz[2] = std::complex<T> (-inf, nan);     sz[3] = std::complex<T> (T(-0.), T(1));
+    Matrix<T> sa = abs (sz, a), sp = arg (sz, a);
+    for (size_t i = 0; i < 4; ++i)
+        if (ulp (sp[i], std::arg (std::complex<double> (sz[i].real(), sz[i].imag()))) > tol)
+            return false;
+    if (sa[0] != T(1) || sa[1] != T(0) || (a == vmath::ACCURATE && sa[2] != inf) || sa[3] != T(1))
+        return false;
+
+    return true;
+
+}
+
+int main (int args, char** argv) {
+    if (!check<float> (vmath::ACCURATE, 1.))
+        return 1;
+    if (!check<float> (vmath::FAST, 4.))
+        return 1;
+    if (!check<double> (vmath::ACCURATE, 3.))
+        return 1;
+    return 0;
+}
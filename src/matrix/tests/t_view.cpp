@@ -37,6 +37,22 @@ int main (int narg, const char** argv) {
     std::cout << M9 << std::endl<< std::endl;
     std::cout << M10 << std::endl<< std::endl;
     std::cout << M11 << std::endl<< std::endl;
+
+    // Strided, reversed and gather views against element access
+    Matrix<float> A(7, 6, 5);
+    for (size_t i = 0; i < A.Size(); ++i)
+        A[i] = i;
+    Vector<size_t> g;
+    g.push_back(4); g.push_back(0); g.push_back(4);
+    Matrix<float> B = A(CR(1,2,5),CR(g),CR(4,-1,1));
+    for (size_t k = 0; k < 4; ++k)
+        for (size_t j = 0; j < 3; ++j)
+            for (size_t i = 0; i < 3; ++i)
+                if (B(i,j,k) != A(1+2*i,g[j],4-k))
+                    return 1;
+    A(R(1,2,5),R(g),R(4,-1,1)) = 0.f;
+    if (A(3,4,2) != 0.f || A(3,3,2) == 0.f)
+        return 1;
     return 0;
 }
 
@@ -1,8 +1,8 @@
 /*
   3D Unwrapping algorithm
   Rhodri Cusack 2000-2006
-  Algorithm described in 
-  Cusack, R. & Papadakis, N. (2002) 
+  Algorithm described in
+  Cusack, R. & Papadakis, N. (2002)
   "New robust 3-D phase unwrapping algorithms: application to magnetic field mapping and undistorting echoplanar images."
   Neuroimage. 2002 Jul;16(3 Pt 1):754-64.
   Distributed under GNU public license http://www.gnu.org/copyleft/gpl.html
@@ -10,306 +10,544 @@
   Version 3.00 Oct 2006 adapted for matlab
 */
 
+#ifndef __UNWRAP_HPP__
+#define __UNWRAP_HPP__
+
 #include "Matrix.hpp"
 #include "Algos.hpp"
 #include "Creators.hpp"
+#include "CX.hpp"
+#include "OMP.hpp"
+#include "FFTWTraits.hpp"
 
 #include <stdio.h>
 #include <string.h>
 #include <string>
 #include <iostream>
+#include <map>
+#include <vector>
 #include <math.h>
 
 
-size_t m_bsx,m_bsy,m_bsz;
-container<unsigned short> flag;
+const static size_t NUMQUEUES = 10000;
+const static size_t DEFAULT_NB = NUMQUEUES;
+
 
-struct FIELD {
-    double d;	/* value of field */
-    size_t p[3];  /* at this offset */
-    int x,y,z;
+/**
+ * @brief   Unwrapping method
+ */
+enum UnwrapMethod {
+    QUALITY_GUIDED, /**< @brief Cusack & Papadakis quality guided region growing */
+    LAPLACIAN       /**< @brief FFT based Laplacian unwrapping (Schofield & Zhu 2003) */
 };
 
+
+/**
+ * @brief   Unwrapping front entry
+ */
 struct QUEUEENTRY {
     int x,y,z;
     size_t p;
     double v;
 };
 
-struct FIELD_2 {
-    double d;	/*value of field*/
-    size_t p;		/*at this offset*/
-    int x,y,z;
-};
 
+/**
+ * @brief   FIFO of front entries. Storage is kept when drained, such that a
+ *          bucket is reused without reallocation by subsequent volumes.
+ */
+class UnwrapBucket {
 
+public:
 
-const static size_t NUMQUEUES = 10000;
-const static size_t DEFAULT_NB = NUMQUEUES;
-const static size_t DEFAULTBLOCK = 100;
-const static size_t BLOCKINCREMENT = 500;
-
-size_t m_bot[NUMQUEUES], m_top[NUMQUEUES];
-size_t m_size[NUMQUEUES], m_chunk[NUMQUEUES], m_sizeb[NUMQUEUES];
-char *m_q[NUMQUEUES];
-
-inline static void
-InitQueue (const int queuenum, const int chunk) {
-    
-    m_chunk[queuenum] = chunk;
-    m_bot[queuenum]   = 0;
-    m_top[queuenum]   = 0;
-    m_size[queuenum]  = DEFAULTBLOCK;
-    m_sizeb[queuenum] = m_size[queuenum]*m_chunk[queuenum];
-    
-    m_q[queuenum]=0;
+    UnwrapBucket () : m_head(0) {}
 
-}
+    inline void Push (const QUEUEENTRY& qe) {
+        m_q.push_back (qe);
+    }
 
-inline static void
-TerminateQueue(const int queuenum) {
-    
-    if (m_q[queuenum])
-    	delete m_q[queuenum];
+    inline bool Pop (QUEUEENTRY& qe) {
+        if (m_head == m_q.size())
+            return false;
+        qe = m_q[m_head++];
+        if (m_head == m_q.size()) {
+            m_q.clear();
+            m_head = 0;
+        } else if (m_head > 4096 && 2*m_head > m_q.size()) {
+            m_q.erase (m_q.begin(), m_q.begin() + m_head);
+            m_head = 0;
+        }
+        return true;
+    }
 
-    m_q[queuenum]=0;
+    inline void Clear () {
+        m_q.clear();
+        m_head = 0;
+    }
 
-}
+private:
+
+    std::vector<QUEUEENTRY> m_q;
+    size_t m_head;
+
+};
+
+
+/**
+ * @brief   Re-entrant phase unwrapping.<br/>
+ *
+ *          All state (flags, priority buckets) belongs to the instance. Buckets
+ *          are pooled, i.e. an unwrapper reused for many volumes (echoes,
+ *          coils, dynamics) does not allocate again. Separate instances may
+ *          run concurrently, as unwrap_volumes() does.
+ *
+ *          Quality guided growing may be split into blocks (slabs along the
+ *          last non-singleton dimension), which grow in parallel from their
+ *          best voxel each. Blocks are then merged outward from the seed's
+ *          block by the 2pi offset most voxel pairs (weighted by magnitude)
+ *          across each interface agree on.
+ *
+ *          The Laplacian method solves the Poisson equation of the wrapped
+ *          phase with FFTs on the mirrored volume (Neumann boundaries) and
+ *          rounds the result to the nearest congruent phase. It is much faster
+ *          on large volumes, but less robust at phase singularities.
+ */
+template<class T>
+class Unwrapper {
+
+    typedef std::complex<T> CT;
+    typedef FTTraits<CT> FTT;
+
+public:
+
+    /**
+     * @brief         Construct
+     *
+     * @param  nb     Number of quality buckets (>= 2)
+     * @param  method Quality guided (default) or Laplacian
+     * @param  blocks Blocks grown in parallel (quality guided, 0: one per thread)
+     */
+    Unwrapper (const size_t nb = DEFAULT_NB, const UnwrapMethod method = QUALITY_GUIDED,
+               const size_t blocks = 0) :
+        m_nb ((nb < 2) ? 2 : nb), m_method (method), m_blocks (blocks) {}
+
+    /**
+     * @brief         Copy settings (not the pools)
+     */
+    Unwrapper (const Unwrapper<T>& u) :
+        m_nb (u.m_nb), m_method (u.m_method), m_blocks (u.m_blocks) {}
+
+    /**
+     * @brief         Unwrap 3D volume
+     *
+     * @param  in     Complex data (magnitude is quality)
+     * @param  s      Seed (3 indices). Unwrapped phase equals wrapped phase there.
+     * @return        Unwrapped phase
+     */
+    Matrix<T> Unwrap (const Matrix<CT>& in, const Matrix<size_t>& s) {
+
+        assert (is3d(in) || is2d(in));
+        assert (s[0] < size(in,0) && s[1] < size(in,1) && s[2] < size(in,2));
+
+        Matrix<T> unwrapped (size(in));
+        if (m_method == LAPLACIAN)
+            Laplacian (in, s, unwrapped);
+        else
+            QualityGuided (in, s, unwrapped);
+        return unwrapped;
 
+    }
 
-inline static int
-Push(const int queuenum, const void *x) {
-    
-    if (!m_q[queuenum])
-    	m_q[queuenum] = new char[m_sizeb[queuenum]];
+    /**
+     * @brief         Unwrap 3D volume seeded in its centre
+     *
+     * @param  in     Complex data (magnitude is quality)
+     * @return        Unwrapped phase
+     */
+    Matrix<T> Unwrap (const Matrix<CT>& in) {
+        return Unwrap (in, Centre (in));
+    }
 
-    if (!m_q[queuenum]) {
-        printf("Out of memory - could not generate new point queue.\n");
-        return(-1);
+    /**
+     * @brief         Centre of a volume
+     */
+    static Matrix<size_t> Centre (const Matrix<CT>& in) {
+        Matrix<size_t> seed (3,1);
+        for (size_t i = 0; i < 3; i++)
+            seed[i] = (size(in,i) > 1) ? size(in,i)/2 - 1 : 0;
+        return seed;
     }
-    
-    int stacksize = m_top[queuenum]-m_bot[queuenum];
-    if (stacksize<0)
-    	stacksize+=m_size[queuenum];
-
-    memcpy(m_q[queuenum]+m_top[queuenum]*m_chunk[queuenum],x,m_chunk[queuenum]);
-    m_top[queuenum]++;
-    
-    if (m_top[queuenum]==m_size[queuenum])
-    	m_top[queuenum]=0;
-    
-    if (m_top[queuenum]==m_bot[queuenum]) {
-        
-        char *newq;
-        size_t newsize, newsizeb, abovebot_b;
-
-        newsize=m_size[queuenum]+BLOCKINCREMENT;
-        newsizeb=newsize*m_chunk[queuenum];
-        newq=new char[newsizeb];
-        if (!newq) {
-            printf("Out of memory - point queue full.\n");
-            return(-1);
+
+private:
+
+    /**
+     * @brief   Axis aligned box [x0,x1) x [y0,y1) x [z0,z1)
+     */
+    struct Box {
+        int x0, x1, y0, y1, z0, z1;
+        inline bool Inside (const int x, const int y, const int z) const {
+            return x >= x0 && x < x1 && y >= y0 && y < y1 && z >= z0 && z < z1;
         }
-        
-        abovebot_b=(m_size[queuenum]-m_bot[queuenum])*m_chunk[queuenum];
-        if (abovebot_b>0)
-        	memcpy(newq,(char *)m_q[queuenum]+m_bot[queuenum]*m_chunk[queuenum],abovebot_b);
-        // then, do m_top downwards
-        if (m_top[queuenum]!=0)
-        	memcpy((char *) newq+abovebot_b,m_q[queuenum],m_top[queuenum]*m_chunk[queuenum]);
-        m_bot[queuenum] =0;
-        m_top[queuenum] = m_size[queuenum];
-        m_size[queuenum] = newsize;
-        m_sizeb[queuenum] = newsizeb;
-        delete m_q[queuenum]; // recover old memory
-        m_q[queuenum]=newq;
+    };
+
+    inline size_t Bucket (const double q, const size_t i) const {
+        if (m_diff <= 0.)
+            return i;
+        size_t k = (size_t) std::max (ceil ((q - m_min) / m_diff * (m_nb-1)), 0.);
+        k = std::min (std::max (k, i+1), m_nb-1);
+        while (k < m_nb-1 && q > Threshold(k))
+            ++k;
+        while (k > i+1 && q <= Threshold(k-1))
+            --k;
+        return k;
+    }
 
+    inline double Threshold (const size_t i) const {
+        return m_min + m_diff * i / (m_nb-1);
     }
-    
-    return 0;
-    
-}
 
-static inline int
-Pop (const int queuenum, void *x) {
-    
-    if (m_bot[queuenum]==m_top[queuenum])
-    	return(1);
-    
-    memcpy(x,m_q[queuenum]+m_bot[queuenum]*m_chunk[queuenum],m_chunk[queuenum]);
-    m_bot[queuenum]++;
-
-    if (m_bot[queuenum]==m_size[queuenum])
-    	m_bot[queuenum]=0;
-    
-    return 0;
-}
+    inline void Check (std::vector<UnwrapBucket>& q, const size_t i, const QUEUEENTRY& qe,
+                       const long offp, const int offx, const int offy, const int offz,
+                       const Box& box, const T* phase, T* unwrapped) {
 
+        QUEUEENTRY nqe;
+        nqe.x = qe.x + offx;
+        nqe.y = qe.y + offy;
+        nqe.z = qe.z + offz;
+        if (!box.Inside (nqe.x, nqe.y, nqe.z))
+            return;
 
-template<class T> static inline void
-Check(int primaryqueuenum, QUEUEENTRY* qe, size_t offp, int offx, int offy, int offz,
-	  const container<size_t>& dim, const Matrix<T>& phase, Matrix<T>& unwrapped) {
+        nqe.p = qe.p + offp;
+        if (m_flag[nqe.p])
+            return; // Already been here
 
-    // first check bounds
-    QUEUEENTRY nqe;
+        // Actually do unwrap
+        int wholepis = int((phase[nqe.p]-qe.v)/PI);
 
-    nqe.x=qe->x+offx;
-    if ((nqe.x<0)||(nqe.x>=dim[0]))
-    	return;
+        if (wholepis>=1)
+            nqe.v = (double) phase[nqe.p] - TWOPI * int((wholepis+1)/2);
+        else if (wholepis<=-1)
+            nqe.v = (double) phase[nqe.p] + TWOPI * int((1-wholepis)/2);
+        else
+            nqe.v = phase[nqe.p];
 
-    nqe.y=qe->y+offy;
-    if ((nqe.y<0)||(nqe.y>=dim[1]))
-    	return;
+        unwrapped[nqe.p] = nqe.v;
+        m_flag[nqe.p] = 1;
 
-    nqe.z=qe->z+offz;
-    if ((nqe.z<0)||(nqe.z>=dim[2]))
-    	return;
+        q[i].Push (nqe);
 
-    nqe.p=qe->p+offp;
+    }
 
-    if (flag[nqe.p])
-    	return; // Already been here
+    /**
+     * @brief   Grow region from seed sp within box using bucket set q
+     */
+    void Grow (const size_t sp, const Box& box, std::vector<UnwrapBucket>& q,
+               const T* wrapped, const T* inamp, T* unwrapped) {
+
+        const long bsy = m_dim[0], bsz = m_dim[0]*m_dim[1];
+
+        QUEUEENTRY qe;
+        qe.p = sp;
+        qe.x = sp % m_dim[0];
+        qe.y = (sp / m_dim[0]) % m_dim[1];
+        qe.z = sp / bsz;
+        unwrapped[sp] = qe.v = wrapped[sp];
+        m_flag[sp] = 1;
+
+        q[0].Push (qe);
+
+        for (size_t i = 0; i < m_nb; i++)
+            while (q[i].Pop (qe))
+                if (inamp[qe.p] > Threshold(i)) // too close to a scary pole, so just defer by pushing to other stack
+                    q[Bucket (inamp[qe.p], i)].Push (qe);
+                else {
+                    Check (q, i, qe,  bsz,  0,  0,  1, box, wrapped, unwrapped);
+                    Check (q, i, qe, -bsz,  0,  0, -1, box, wrapped, unwrapped);
+                    Check (q, i, qe,  bsy,  0,  1,  0, box, wrapped, unwrapped);
+                    Check (q, i, qe, -bsy,  0, -1,  0, box, wrapped, unwrapped);
+                    Check (q, i, qe,    1,  1,  0,  0, box, wrapped, unwrapped);
+                    Check (q, i, qe,   -1, -1,  0,  0, box, wrapped, unwrapped);
+                }
 
-    // Actually do unwrap
-    int wholepis = int((phase[nqe.p]-qe->v)/PI);
-    
-    if (wholepis>=1)
-        nqe.v = (double) phase[nqe.p] - TWOPI * int((wholepis+1)/2);
-    else if (wholepis<=-1)
-        nqe.v = (double) phase[nqe.p] + TWOPI * int((1-wholepis)/2);
-    else
-    	nqe.v = phase[nqe.p];
-    
-    unwrapped[nqe.p] = nqe.v;
-    flag[nqe.p] = true;
-    
-    if (Push(primaryqueuenum,&nqe))
-        std::cerr << "Out of memory!" << std::endl;
+    }
 
-}
+    void QualityGuided (const Matrix<CT>& in, const Matrix<size_t>& s, Matrix<T>& unwrapped) {
+
+        Matrix<T> inamp = - abs(in);
+        Matrix<T> wrapped = arg(in);
+        const size_t sze = numel(wrapped);
+
+        for (size_t i = 0; i < 3; ++i)
+            m_dim[i] = size(wrapped,i);
+        m_flag.assign (sze, 0);
+
+        // Pole field thresholds
+        m_min  = mmin(inamp);
+        m_diff = 1.00001 * (mmax(inamp) - m_min);
+
+        // Slabs along last non-singleton dimension
+        const size_t ax = (m_dim[2] > 1) ? 2 : 1;
+        size_t nblocks = m_blocks;
+        if (nblocks == 0) {
+#if defined (_OPENMP)
+            nblocks = omp_in_parallel() ? 1 : omp_get_max_threads();
+#else
+            nblocks = 1;
+#endif
+        }
+        nblocks = std::max (std::min (nblocks, m_dim[ax] / 4), (size_t)1);
+
+        std::vector<Box> boxes (nblocks);
+        std::vector<size_t> seeds (nblocks);
+        const size_t sp = s[0] + m_dim[0] * (s[1] + m_dim[1] * s[2]);
+        for (size_t b = 0; b < nblocks; ++b) {
+            Box& box = boxes[b];
+            box.x0 = 0; box.x1 = m_dim[0]; box.y0 = 0; box.y1 = m_dim[1]; box.z0 = 0; box.z1 = m_dim[2];
+            int& lo = (ax == 2) ? box.z0 : box.y0;
+            int& hi = (ax == 2) ? box.z1 : box.y1;
+            lo = b * m_dim[ax] / nblocks;
+            hi = (b+1) * m_dim[ax] / nblocks;
+        }
 
-template <class T> void 
-unwrap (const Matrix<size_t>& s, const size_t unb,
-        const Matrix<std::complex<T> >& in, Matrix<T>& unwrapped) {
-    
-    Matrix<T> inamp = - abs(in);
-    Matrix<T> wrapped = arg(in);
-    unwrapped = Matrix<T> (in.Dims());
-
-    size_t sze = numel(wrapped), i, sp, nb;
-    container<size_t> dim = size(wrapped);
-
-    // Minimum number of unwrapping bins is 2
-    nb = (unb<2) ? 2 : unb;
-    
-    // Find min and max
-    double minin, maxin, diff;
-    minin    = min(inamp);
-    maxin    = max(inamp);
-    diff     = 1.00001 * (maxin - minin);
-    
-    sp = sub2ind(wrapped,s.Container());
-    
-    flag.resize(sze);
-    
-    for (i = 0; i < sze; i++)
-        flag[i] = false;
-    
-    for (i = 0; i < nb; i++)
-        InitQueue (i, sizeof(QUEUEENTRY));
-
-    QUEUEENTRY qe;
-    
-    qe.p  = sp;
-    qe.x  = s[0];
-    qe.y  = s[1];
-    qe.z  = s[2];
-    unwrapped[85]  = wrapped[85];
-    unwrapped[sp]  = qe.v = wrapped[sp];
-    flag[sp] = true;
-    
-    // push s
-    Push(0, &qe);
-    
-    // First, work out pole field threshold that we're going to use
-    container<double> polefieldthresholds (nb);
-    int ind  = 0;
-
-    for (i = 0; i < nb; ++i)
-        polefieldthresholds[ind++] = minin + diff * i / (nb-1);
-    
-    for (i=0; i < nb; i++) {
-
-        while (!Pop(i,&qe)) {
-
-            if (inamp[qe.p] > polefieldthresholds[i]) { // too close to a scary pole, so just defer by pushing to other stack
-                ind = i;
-                while (inamp[qe.p] > polefieldthresholds[++ind]);
-                Push(ind,&qe);  // just defer by pushing to relevant stack
-            } else { 
-                Check (i, &qe,  m_bsz,  0,  0,  1, dim, wrapped, unwrapped);
-                Check (i, &qe, -m_bsz,  0,  0, -1, dim, wrapped, unwrapped);
-                Check (i, &qe,  m_bsy,  0,  1,  0, dim, wrapped, unwrapped);
-                Check (i, &qe, -m_bsy,  0, -1,  0, dim, wrapped, unwrapped);
-                Check (i, &qe,  m_bsx,  1,  0,  0, dim, wrapped, unwrapped);
-                Check (i, &qe, -m_bsx, -1,  0,  0, dim, wrapped, unwrapped);
+        // Each block is seeded in its best voxel, the seed's block in the seed
+        size_t sb = 0;
+        for (size_t b = 0; b < nblocks; ++b) {
+            if (boxes[b].Inside (s[0], s[1], s[2])) {
+                sb = b;
+                seeds[b] = sp;
+                continue;
             }
+            const Box& box = boxes[b];
+            size_t best = box.x0 + m_dim[0] * (box.y0 + m_dim[1] * box.z0);
+            for (int z = box.z0; z < box.z1; ++z)
+                for (int y = box.y0; y < box.y1; ++y)
+                    for (int x = box.x0; x < box.x1; ++x) {
+                        const size_t p = x + m_dim[0] * (y + m_dim[1] * z);
+                        if (inamp[p] < inamp[best])
+                            best = p;
+                    }
+            seeds[b] = best;
+        }
+
+        m_pool.resize (nblocks);
+        for (size_t b = 0; b < nblocks; ++b)
+            m_pool[b].resize (m_nb);
+
+#pragma omp parallel for schedule (dynamic) if (nblocks > 1)
+        for (long b = 0; b < (long)nblocks; ++b) {
+            Grow (seeds[b], boxes[b], m_pool[b], wrapped.Ptr(), inamp.Ptr(), unwrapped.Ptr());
+            for (size_t i = 0; i < m_nb; ++i)
+                m_pool[b][i].Clear();
         }
 
-        TerminateQueue(i);	// done with this Queue so free up memory
-        
+        // Merge outward from seed's block
+        const size_t stride = (ax == 2) ? m_dim[0]*m_dim[1] : m_dim[0];
+        for (size_t b = sb; b + 1 < nblocks; ++b)
+            Shift (unwrapped, boxes[b+1], Offset (unwrapped, inamp, boxes[b], stride));
+        for (size_t b = sb; b > 0; --b)
+            Shift (unwrapped, boxes[b-1], Offset (unwrapped, inamp, boxes[b-1], stride) * -1.);
+
     }
-    
-}
 
+    /**
+     * @brief   2pi multiple to add to the block following box, voted by magnitude
+     */
+    double Offset (const Matrix<T>& unwrapped, const Matrix<T>& inamp, const Box& box,
+                   const size_t stride) const {
+        std::map<long,double> votes;
+        const bool z = (m_dim[2] > 1);
+        const int last = (z ? box.z1 : box.y1) - 1;
+        for (int k = z ? 0 : last; k < (z ? (int)m_dim[1] : last+1); ++k)
+            for (int x = 0; x < (int)m_dim[0]; ++x) {
+                const size_t p = z ? x + m_dim[0] * (k + m_dim[1] * last) : x + m_dim[0] * last;
+                const long r = lround ((unwrapped[p] - unwrapped[p+stride]) / TWOPI);
+                votes[r] += std::max (-(double)inamp[p], -(double)inamp[p+stride]) + 1.e-12;
+            }
+        long best = 0; double w = -1.;
+        for (std::map<long,double>::const_iterator it = votes.begin(); it != votes.end(); ++it)
+            if (it->second > w) {
+                w = it->second;
+                best = it->first;
+            }
+        return TWOPI * best;
+    }
 
-template<class T> Matrix<T>
-unwrap3d (const Matrix<T>& M, const Matrix<size_t>& seed, const size_t nub = DEFAULT_NB) {
+    void Shift (Matrix<T>& unwrapped, const Box& box, const double off) const {
+        if (off == 0.)
+            return;
+        for (int z = box.z0; z < box.z1; ++z)
+            for (int y = box.y0; y < box.y1; ++y)
+                for (int x = box.x0; x < box.x1; ++x)
+                    unwrapped[x + m_dim[0] * (y + m_dim[1] * z)] += off;
+    }
 
-    assert (is3d(M));
-    assert (seed[0] < size(M,0) && seed[1] < size(M,1) && seed[2] < size(M,2));
+    /**
+     * @brief   Laplacian unwrapping: phi = L^-1 (cos w L sin w - sin w L cos w)
+     */
+    void Laplacian (const Matrix<CT>& in, const Matrix<size_t>& s, Matrix<T>& unwrapped) {
 
-    Matrix<T> ret (size(M));
-    m_bsx = M.Dszs()[0]; m_bsy = M.Dszs()[1]; m_bsz = M.Dszs()[2];
-    unwrap (seed, nub, complex2(ones<T>(size(M)),M), ret);
+        const Matrix<T> wrapped = arg(in);
 
-    return ret;
+        // Mirrored grid (even extension of non-singleton dimensions)
+        size_t n[3], m[3];
+        for (size_t i = 0; i < 3; ++i) {
+            n[i] = size(in,i);
+            m[i] = (n[i] > 1) ? 2*n[i] : 1;
+        }
+        const size_t nm = m[0]*m[1]*m[2];
+        Matrix<CT> e (m[0], m[1], m[2]);
+
+#pragma omp parallel for
+        for (long z = 0; z < (long)m[2]; ++z)
+            for (size_t y = 0; y < m[1]; ++y)
+                for (size_t x = 0; x < m[0]; ++x) {
+                    const size_t sx = (x < n[0]) ? x : m[0]-1-x, sy = (y < n[1]) ? y : m[1]-1-y,
+                        sz = ((size_t)z < n[2]) ? z : m[2]-1-z;
+                    const T w = wrapped[sx + n[0] * (sy + n[1] * sz)];
+                    e[x + m[0] * (y + m[1] * z)] = CT(cos(w), sin(w));
+                }
+
+        // Eigenvalues of periodic discrete Laplacian
+        Matrix<T> k (m[0], m[1], m[2]);
+#pragma omp parallel for
+        for (long z = 0; z < (long)m[2]; ++z)
+            for (size_t y = 0; y < m[1]; ++y)
+                for (size_t x = 0; x < m[0]; ++x)
+                    k[x + m[0] * (y + m[1] * z)] =
+                        2. * (cos (TWOPI * x / m[0]) + cos (TWOPI * y / m[1]) + cos (TWOPI * z / m[2]) - 3.);
+
+        // FFTW planner is not thread-safe
+        typename FTT::Plan fwd, bwd;
+        int rn[3], rank = 0;
+        for (int i = 2; i >= 0; --i)
+            if (m[i] > 1)
+                rn[rank++] = m[i];
+#pragma omp critical (fftw_planner)
+        {
+            fwd = FTT::DFTPlan (rank, rn, (typename FTT::T*)e.Ptr(), (typename FTT::T*)e.Ptr(),
+                                FFTW_FORWARD, FFTW_ESTIMATE);
+            bwd = FTT::DFTPlan (rank, rn, (typename FTT::T*)e.Ptr(), (typename FTT::T*)e.Ptr(),
+                                FFTW_BACKWARD, FFTW_ESTIMATE);
+        }
+
+        // L cos w + i L sin w
+        Matrix<CT> l = e;
+        FTT::Execute (fwd, (typename FTT::T*)l.Ptr(), (typename FTT::T*)l.Ptr());
+        for (size_t i = 0; i < nm; ++i)
+            l[i] *= k[i] / (T)nm;
+        FTT::Execute (bwd, (typename FTT::T*)l.Ptr(), (typename FTT::T*)l.Ptr());
+
+        // Right hand side and Poisson solve
+        for (size_t i = 0; i < nm; ++i)
+            l[i] = CT(e[i].real() * l[i].imag() - e[i].imag() * l[i].real(), 0.);
+        FTT::Execute (fwd, (typename FTT::T*)l.Ptr(), (typename FTT::T*)l.Ptr());
+        l[0] = CT(0.);
+        for (size_t i = 1; i < nm; ++i)
+            l[i] /= k[i] * (T)nm;
+        FTT::Execute (bwd, (typename FTT::T*)l.Ptr(), (typename FTT::T*)l.Ptr());
+
+#pragma omp critical (fftw_planner)
+        {
+            FTT::Destroy (fwd);
+            FTT::Destroy (bwd);
+        }
+
+        // Congruence with wrapped phase, seed keeps its wrapped value
+        const size_t sp = s[0] + n[0] * (s[1] + n[1] * s[2]);
+        const T off = TWOPI * round ((l[s[0] + m[0] * (s[1] + m[1] * s[2])].real() - wrapped[sp]) / TWOPI);
+#pragma omp parallel for
+        for (long z = 0; z < (long)n[2]; ++z)
+            for (size_t y = 0; y < n[1]; ++y)
+                for (size_t x = 0; x < n[0]; ++x) {
+                    const size_t p = x + n[0] * (y + n[1] * z);
+                    const T phi = l[x + m[0] * (y + m[1] * z)].real() - off;
+                    unwrapped[p] = wrapped[p] + TWOPI * round ((phi - wrapped[p]) / TWOPI);
+                }
+        const T soff = TWOPI * round ((unwrapped[sp] - wrapped[sp]) / TWOPI);
+        if (soff != 0.)
+            for (size_t p = 0; p < numel(unwrapped); ++p)
+                unwrapped[p] -= soff;
 
+    }
+
+    size_t m_nb;                                      /**< @brief # quality buckets */
+    UnwrapMethod m_method;                            /**< @brief Method */
+    size_t m_blocks;                                  /**< @brief # parallel blocks */
+    size_t m_dim[3];                                  /**< @brief Volume dimensions */
+    double m_min, m_diff;                             /**< @brief Quality range */
+    std::vector<unsigned char> m_flag;                /**< @brief Unwrapped voxels */
+    std::vector<std::vector<UnwrapBucket> > m_pool;   /**< @brief Bucket sets per block */
+
+};
+
+
+template <class T> void
+unwrap (const Matrix<size_t>& s, const size_t unb,
+        const Matrix<std::complex<T> >& in, Matrix<T>& unwrapped) {
+    Unwrapper<T> u (unb, QUALITY_GUIDED, 1);
+    unwrapped = u.Unwrap (in, s);
 }
 
 
-template <class T> Matrix<T>
-unwrap3d (const Matrix<T>& M, const size_t nub = DEFAULT_NB) {
+template<class T> Matrix<T>
+unwrap3d (const Matrix<T>& M, const Matrix<size_t>& seed, const size_t nub = DEFAULT_NB) {
+    Unwrapper<T> u (nub, QUALITY_GUIDED, 1);
+    return u.Unwrap (complex2(ones<T>(size(M)),M), seed);
+}
 
-    Matrix<size_t> seed (3,1);
-    for (size_t i = 0; i < 3; i++)
-        seed[i] = floor (.5 * (float)size(M,i)) -1;
-    return unwrap3d (complex2(ones<T>(size(M)),M), seed, nub);
 
+template <class T> Matrix<T>
+unwrap3d (const Matrix<T>& M, const size_t nub = DEFAULT_NB) {
+    Unwrapper<T> u (nub, QUALITY_GUIDED, 1);
+    return u.Unwrap (complex2(ones<T>(size(M)),M));
 }
 
 
 template <class T> Matrix<T>
 unwrap3d (const Matrix<std::complex<T> >& M, const Matrix<size_t>& seed, const size_t nub = DEFAULT_NB) {
-    
-    assert (is3d(M));
-    assert (seed[0] < size(M,0) && seed[1] < size(M,1) && seed[2] < size(M,2));
-
-    Matrix<T> ret (size(M));
-    m_bsx = M.Dszs()[0]; m_bsy = M.Dszs()[1]; m_bsz = M.Dszs()[2];
-    unwrap (seed, nub, M, ret);
-    
-    return ret;
-    
+    Unwrapper<T> u (nub, QUALITY_GUIDED, 1);
+    return u.Unwrap (M, seed);
 }
 
 
 template <class T> Matrix<T>
 unwrap3d (const Matrix<std::complex<T> >& M, const size_t nub = DEFAULT_NB) {
+    Unwrapper<T> u (nub, QUALITY_GUIDED, 1);
+    return u.Unwrap (M);
+}
+
+
+/**
+ * @brief         Unwrap all 3D volumes of a 4D/5D matrix (echoes, coils, ...) concurrently.
+ *                Each thread uses its own unwrapper with pooled buckets.
+ *
+ * @param  M      Complex data (X x Y x Z x ...)
+ * @param  nub    Number of quality buckets
+ * @param  method Quality guided (default) or Laplacian
+ * @return        Unwrapped phase, each volume seeded in its centre
+ */
+template <class T> Matrix<T>
+unwrap_volumes (const Matrix<std::complex<T> >& M, const size_t nub = DEFAULT_NB,
+                const UnwrapMethod method = QUALITY_GUIDED) {
+
+    const size_t nx = size(M,0), ny = size(M,1), nz = size(M,2), vol = nx*ny*nz,
+        nv = numel(M) / vol;
+    Matrix<T> ret (size(M));
+
+#pragma omp parallel
+    {
+        Unwrapper<T> u (nub, method, 1);
+        Matrix<std::complex<T> > v (nx, ny, nz);
+#pragma omp for schedule (dynamic)
+        for (long i = 0; i < (long)nv; ++i) {
+            std::copy (M.Begin() + i*vol, M.Begin() + (i+1)*vol, v.Begin());
+            const Matrix<T> w = u.Unwrap (v);
+            std::copy (w.Begin(), w.End(), ret.Begin() + i*vol);
+        }
+    }
+
+    return ret;
 
-    Matrix<size_t> seed (3,1);
-    for (size_t i = 0; i < 3; i++)
-        seed[i] = floor (.5 * (float)size(M,i)) -1;
-    return unwrap3d (M, seed, nub);
-   
 }
+
+#endif /* __UNWRAP_HPP__ */
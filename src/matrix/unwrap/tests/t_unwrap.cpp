@@ -1,8 +1,70 @@
 #include "Unwrap.hpp"
-#include "IOContext.hpp"
+
+/**
+ * Smooth phase well beyond +/-pi, wrapped. Unwrapped must equal the original
+ * up to the 2pi multiple fixed by the seed.
+ */
+template<class T> static Matrix<T> truth (const size_t n, const size_t nz) {
+    Matrix<T> phi (n, n, nz);
+    for (size_t z = 0; z < nz; ++z)
+        for (size_t y = 0; y < n; ++y)
+            for (size_t x = 0; x < n; ++x)
+                phi(x,y,z) = .35*x - .2*y + .3*z + .02*(x-n/2.)*(y-n/2.);
+    return phi;
+}
+
+template<class T> static bool check (const Matrix<T>& phi, const Matrix<T>& u, const char* what) {
+    const Matrix<std::complex<T> > in = complex2 (ones<T>(size(phi)), phi);
+    const Matrix<size_t> s = Unwrapper<T>::Centre(in);
+    const size_t sp = s[0] + size(phi,0) * (s[1] + size(phi,1) * s[2]);
+    const T off = phi[sp] - u[sp];
+    T err = 0.;
+    for (size_t i = 0; i < numel(phi); ++i)
+        err = std::max (err, (T)fabs (phi[i] - off - u[i]));
+    printf ("  %s: max error %.3g\n", what, err);
+    return err < 1.e-4;
+}
 
 int main (int args, char** argv) {
 
+    const Matrix<double> phi = truth<double>(32, 24);
+    const Matrix<std::complex<double> > in = complex2 (ones<double>(size(phi)), phi);
+
+    Unwrapper<double> serial (DEFAULT_NB, QUALITY_GUIDED, 1), blocked (DEFAULT_NB, QUALITY_GUIDED, 4),
+        laplacian (DEFAULT_NB, LAPLACIAN);
+
+    if (!check (phi, serial.Unwrap(in), "quality guided"))
+        return 1;
+    if (!check (phi, serial.Unwrap(in), "quality guided (pooled)"))
+        return 1;
+    if (!check (phi, blocked.Unwrap(in), "quality guided, 4 blocks"))
+        return 1;
+    if (!check (phi, laplacian.Unwrap(in), "laplacian"))
+        return 1;
+
+    // Legacy interface grows serially, i.e. as before
+    const Matrix<double> legacy = unwrap3d (in), reference = serial.Unwrap(in);
+    if (!std::equal (legacy.Begin(), legacy.End(), reference.Begin())) {
+        printf ("  unwrap3d differs from serial quality guided growing\n");
+        return 1;
+    }
+
+    // Echoes concurrently
+    Matrix<std::complex<double> > echoes (32, 32, 24, 3);
+    for (size_t e = 0; e < 3; ++e)
+        for (size_t i = 0; i < numel(phi); ++i)
+            echoes[e*numel(phi)+i] = std::polar (1., (e+1.)*.5*phi[i]);
+    const Matrix<double> u = unwrap_volumes (echoes);
+    for (size_t e = 0; e < 3; ++e) {
+        Matrix<double> pe (32, 32, 24), ue (32, 32, 24);
+        for (size_t i = 0; i < numel(phi); ++i) {
+            pe[i] = (e+1.)*.5*phi[i];
+            ue[i] = u[e*numel(phi)+i];
+        }
+        if (!check (pe, ue, "echo"))
+            return 1;
+    }
+
     return 0;
     
 }
@@ -24,6 +24,7 @@
 
 #include "ReconStrategy.hpp"
 #include "Algos.hpp"
+#include "mri/Prewhitening.hpp"
 
 /**
  * @brief Reconstruction startegies
@@ -86,12 +87,21 @@ namespace RRStrategy {
 	 * 
 	 * @param  in      Data
 	 * @param  ncov    Noise covariance matrix
-	 * @param  od      Out data
-	 * @param  out     size
+	 * @param  od      Out data (channels along last dimension)
+	 * @param  out     Virtual channels retained (0: all)
 	 */
 	void PreWhite (const Matrix<cxfl>& in, const Matrix<cxfl>& ncov, Matrix<cxfl>& od, const size_t& out = 0) {
 
-		//assert (idx <= in.HDim());
+		Prewhitener<cxfl> pw (ncov);
+		od = in;
+
+		if (out > 0 && out < size(ncov,0)) {
+			NoiseCovariance<cxfl> gram (false);
+			gram.Add (od);
+			pw.Compress (gram.Gram(), out);
+		}
+
+		pw.Apply (od);
 
 	} 
 
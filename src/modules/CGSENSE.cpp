@@ -24,6 +24,7 @@
 #include "SimpleTimer.hpp"
 #include "Algos.hpp"
 #include "Creators.hpp"
+#include "mri/PseudoReplica.hpp"
 
 #include "Print.hpp"
 
@@ -44,6 +45,10 @@ CGSENSE::~CGSENSE () {
 
 codeare::error_code 
 CGSENSE::Finalise () {
+	if (m_ncs) {
+		Operators().Put (m_ncs_key, m_ncs, m_ncs->Footprint());
+		m_ncs.reset();
+	}
 	return codeare::OK;
 }
 
@@ -107,6 +112,13 @@ CGSENSE::Init() {
 	printf ("  gaussian white noise (normalised): %.9f \n", m_noise);
 	// --------------------------------------
 
+	// Pseudo-replicas --------------------
+
+	Attribute ("replicas", &m_replicas);
+	printf ("  pseudo-replicas: %i \n", m_replicas);
+	Attribute ("af", &m_af);
+	// --------------------------------------
+
 	// CG convergence and break criteria ----
 
 	Attribute ("cgeps",   &m_cgeps);
@@ -133,22 +145,42 @@ CGSENSE::Prepare () {
 
 	codeare::error_code error = codeare::OK;
 
-	Params cgp;
-	cgp["sensitivities"] = Get<cxfl>("sensitivities");
-    cgp["nk"]            = (size_t) m_nk;
-    cgp["verbose"]       = m_verbose;
-    cgp["ftiter"]        = (size_t) m_ftmaxit;
-    cgp["cgiter"]        = (size_t) m_cgmaxit;
-    cgp["cgeps"]         = m_cgeps;
-    cgp["lambda"]        = m_lambda;
-    cgp["threads"]       = m_nthreads;
-    cgp["m"]             = m_m;
-    cgp["3rd_dim_cart"]  = m_3rd_dim_cart;
+	const Matrix<cxfl>& sens = Get<cxfl>("sensitivities");
+	const Matrix<float>& k = Get<float>("kspace"), & w = Get<float>("weights");
+
+	// Same trajectory, weights, geometry and parameters: reuse operator
+	OperatorHash h;
+	h << size(sens) << m_nk << m_verbose << m_ftmaxit << m_cgmaxit << m_cgeps << m_lambda
+	  << m_nthreads << m_m << m_3rd_dim_cart << k << w;
+	Finalise();
+	m_ncs_key = h.Value();
+	m_ncs = Operators().Take<NCSENSE<cxfl> > (m_ncs_key);
+
+	if (m_ncs) {
+
+		printf ("  NCSENSE operator from cache\n");
+		m_ncs->Sensitivities (sens);
 
-	m_ncs = NCSENSE<cxfl>(cgp);
+	} else {
 
-	m_ncs.KSpace (Get<float>("kspace"));
-	m_ncs.Weights (Get<float>("weights"));
+		Params cgp;
+		cgp["sensitivities"] = sens;
+		cgp["nk"]            = (size_t) m_nk;
+		cgp["verbose"]       = m_verbose;
+		cgp["ftiter"]        = (size_t) m_ftmaxit;
+		cgp["cgiter"]        = (size_t) m_cgmaxit;
+		cgp["cgeps"]         = m_cgeps;
+		cgp["lambda"]        = m_lambda;
+		cgp["threads"]       = m_nthreads;
+		cgp["m"]             = m_m;
+		cgp["3rd_dim_cart"]  = m_3rd_dim_cart;
+
+		m_ncs = std::make_shared<NCSENSE<cxfl> >(cgp);
+
+		m_ncs->KSpace (k);
+		m_ncs->Weights (w);
+
+	}
 
 	Free ("weights");
 	Free("kspace");
@@ -169,13 +201,28 @@ CGSENSE::Process () {
     Matrix<cxfl> data;
 
     data = (!m_testcase) ? Get<cxfl>("signals") :
-        m_ncs.Trafo (phantom<cxfl>(size(sens,0)), sens);
+        m_ncs->Trafo (phantom<cxfl>(size(sens,0)), sens);
     if (m_noise)
         data += m_noise * randn<cxfl>(size(data));
 
-    Matrix<cxfl> img = m_ncs ->* data;
+    Matrix<cxfl> img = (*m_ncs) ->* data;
     
     Add("image", img);
+
+    if (m_replicas > 0) {
+        PseudoReplica<cxfl> pr (*m_ncs, m_replicas);
+        if (Exists<cxfl>("noise_cov") == codeare::OK)
+            pr.NoiseCovariance (Get<cxfl>("noise_cov"));
+        pr.Run (data);
+        Matrix<float> snr = pr.SNR(), sd = pr.StdDev();
+        Add("snr", snr);
+        Add("noise_std", sd);
+        if (Exists<float>("noise_std_ref") == codeare::OK) { // fully sampled
+            Matrix<float> g = pr.GFactor (Get<float>("noise_std_ref"), m_af);
+            Add("gfactor", g);
+        }
+    }
+
 	return error;
 
 }
@@ -43,9 +43,9 @@ namespace RRStrategy {
 		/**
 		 * @brief Default constructor
 		 */
-		CGSENSE () : m_cgeps(1.0e-7), m_fteps(1.0e-3), m_cgmaxit(10),
+		CGSENSE () : m_ncs_key(0), m_cgeps(1.0e-7), m_fteps(1.0e-3), m_cgmaxit(10),
 					 m_ftmaxit(3), m_noise(0.0), m_lambda(1.0e-6), m_testcase(0),
-					 m_verbose(0), m_nthreads (0), m_m(1), m_nk(1),
+					 m_verbose(0), m_nthreads (0), m_m(1), m_nk(1), m_replicas(0), m_af(1.0),
 					 m_test_case(false), m_3rd_dim_cart(false) {}
 		
 		/**
@@ -73,14 +73,15 @@ namespace RRStrategy {
 		Init ();
 		
 		/**
-		 * @brief Clean up
+		 * @brief Clean up, i.e. return operator to the cache
 		 */
 		virtual codeare::error_code
 		Finalise ();
 		
 	private:
 
-		NCSENSE<cxfl>  m_ncs;
+		std::shared_ptr<NCSENSE<cxfl> > m_ncs; /**< Operator, from/to the operator cache */
+		uint64_t        m_ncs_key;   /**< Operator cache key                                  */
 		
 		int             m_verbose;   /**< Verbose should give back the reconstruction series? */
 		int             m_testcase;  /**< Test case. Generate forward data first.             */
@@ -89,6 +90,8 @@ namespace RRStrategy {
 		int             m_nthreads;  /**< Number of threads                                   */
 		int             m_nk;        /**< Number of kspace samples                            */
         int             m_m;
+		int             m_replicas;  /**< # Pseudo-replicas for SNR maps (0: off)         */
+		float           m_af;        /**< Acceleration factor for g-factor maps           */
 
         bool            m_3rd_dim_cart; /**< 3rd NUFFT direction is Cartesian (stack(spirals/stars)) */
 		
@@ -22,9 +22,9 @@
 #include "Algos.hpp"
 #include "Lapack.hpp"
 #include "Print.hpp"
+#include "mri/Prewhitening.hpp"
 
 using namespace RRStrategy;
-static const char ECON = 'S';
 
 codeare::error_code CoilCompression::Init () {
 
@@ -35,6 +35,9 @@ codeare::error_code CoilCompression::Init () {
 	try {
         _coils_left = GetAttr<size_t>("coils_remaining");
 	} catch (const TinyXMLQueryException&) {}
+
+	if (Attribute("noise"))
+		_noise = Attribute("noise");
         
 	return codeare::OK;
 }
@@ -45,10 +48,7 @@ codeare::error_code CoilCompression::Prepare () {
 
 codeare::error_code CoilCompression::Process () {
 
-	typedef TUPLE<Matrix<cxfl>,Matrix<float>,Matrix<cxfl> > svd_t;
-
-	Matrix<cxfl>& meas = Get<cxfl> ("meas"), V;
-	Matrix<float> S;
+	Matrix<cxfl>& meas = Get<cxfl> ("meas");
 	meas = squeeze(meas);
 
 	// Permute coils to outermost dimension
@@ -63,19 +63,36 @@ codeare::error_code CoilCompression::Process () {
 	std::cout << "  Permuted: " << dims << std::endl;
 	std::cout << "  #Coils: " << ncoils << std::endl;
 
-	// SVD measurement data
-	std::cout << "  Performing SVD ..." << std::endl;
-	meas = resize(meas, numel(meas)/ncoils, ncoils);
-	svd_t usv = svd2 (meas, ECON); V = GET<2>(usv);
-	std::cout << "  Recombining virtual coils ..." << std::endl;
+	// Noise covariance (coils last as in data)
+	Matrix<cxfl> psi = eye<cxfl>(ncoils);
+	if (!_noise.empty() && Exists<cxfl>(_noise) == codeare::OK) {
+		Matrix<cxfl> noise = squeeze(Get<cxfl>(_noise));
+		Vector<size_t> ndims = size(noise), norder(ndims.size());
+		if (ndims.size() > 1 && _coil_dimension != ndims.size()-1) {
+			std::iota(norder.begin(), norder.end(), 0);
+			norder.erase(norder.begin()+_coil_dimension);
+			norder.push_back(_coil_dimension);
+			noise = permute(noise,norder);
+		}
+		NoiseCovariance<cxfl> nc;
+		nc.Add (noise);
+		psi = nc.Covariance();
+		std::cout << "  Noise covariance from " << nc.Samples() << " samples" << std::endl;
+		Add ("noise_cov", psi);
+	}
+	Prewhitener<cxfl> pw (psi);
 
-	// Recombine compressed data
-	V = V(CR(),CR(0,_coils_left-1));
-	meas = meas->*V;
+	// Compression on (whitened) Gram matrix instead of SVD of full data
+	if (_coils_left > 0 && _coils_left < ncoils) {
+		std::cout << "  Performing SVD ..." << std::endl;
+		NoiseCovariance<cxfl> gram (false);
+		gram.Add (meas);
+		pw.Compress (gram.Gram(), _coils_left);
+	}
 
-	// Resize data
-	dims.back() = _coils_left;
-	meas = resize(meas,dims);
+	// Whiten and recombine virtual coils in one pass
+	std::cout << "  Recombining virtual coils ..." << std::endl;
+	pw.Apply (meas);
 	std::cout << "  Outgoing: " << size(meas) << std::endl;
 
 	return codeare::OK;
@@ -29,7 +29,11 @@
 namespace RRStrategy {
 
 	/**
-	 * @brief Empty recon for test purposes
+	 * @brief Noise prewhitening and SVD coil compression<br/>
+	 *        If a noise scan is named in "noise", data is whitened with the
+	 *        Cholesky factor of the streamed noise covariance. Compression is
+	 *        computed on the whitened Gram matrix and fused into one pass.
+	 *        "coils_remaining" = 0 only whitens.
 	 */
 	class CoilCompression : public ReconStrategy {
 		
@@ -39,7 +43,7 @@ namespace RRStrategy {
 		/**
 		 * @brief Default constructor
 		 */
-		CoilCompression () : _coil_dimension(1), _coils_left(10) {}
+		CoilCompression () : _coil_dimension(1), _coils_left(10), _noise("") {}
 		
 		/**
 		 * @brief Default destructor
@@ -72,6 +76,7 @@ namespace RRStrategy {
 	private:
 		size_t _coil_dimension;
 		size_t _coils_left;
+		std::string _noise;
 
 	};
 
@@ -27,6 +27,10 @@
 #include "Math.hpp"
 #include "Interpolate.hpp"
 #include "IOContext.hpp"
+#include "OMP.hpp"
+
+#include <algorithm>
+#include <vector>
 
 using namespace codeare::matrix::io;
 
@@ -61,150 +65,305 @@ struct GradientParams {
 };
 
 
+/**
+ * @brief       One Runge-Kutta step of the slew rate limited ODE for the
+ *              velocity st along arc length with curvatures k1 (at start),
+ *              k2 (half step) and k3 (end)
+ */
+#pragma omp declare simd
 inline static double
-RungeKutta (const double s, const double   ds, const double st, 
-			const double* k, const double smax, const double  L, 
-			const bool  fw) {
-
-	double k1, k2, k3, k4;
-	size_t l = (fw) ? 0 : 2, m = 1,  n = (fw) ? 2 : 0;
-	double pgs = pow (GAMMA / 10.0 * smax, 2);
-
-	k1 = ds * sqrt (pgs - pow(k[l],2) * pow (st       ,3));
-	k2 = ds * sqrt (pgs - pow(k[m],2) * pow (st + k1/2,3));
-	k3 = ds * sqrt (pgs - pow(k[m],2) * pow (st + k2/2,3));
-	k4 = ds * sqrt (pgs - pow(k[n],2) * pow (st + k3/2,3));
-	
-	return k1/6 + k2/3 + k3/3 + k4/6;
-	
-}
-
-
-struct SDIn {
-
-	PolyVal<double> *pkx, *pky, *pkz;
-	Matrix<double> posh, sh;
-	double mgr, msr;
-
-	~SDIn () {
-		
-		delete pkx;
-		delete pky;
-		delete pkz;
-		
-	}
-
-};
-
-
-struct SDOut {
-
-	Matrix<double> k;
-	Matrix<double> phi;
-
-    void dump (IOContext& f) {
-        fwrite (f,k);
-        fwrite (f,phi);
-    }
-
-};
+RungeKutta (const double ds, const double st, const double k1, const double k2, const double k3,
+			const double pgs) {
 
+	const double s1 = st, r1 = ds * sqrt (pgs - k1*k1 * s1*s1*s1);
+	const double s2 = st + r1/2, r2 = ds * sqrt (pgs - k2*k2 * s2*s2*s2);
+	const double s3 = st + r2/2, r3 = ds * sqrt (pgs - k2*k2 * s3*s3*s3);
+	const double s4 = st + r3/2, r4 = ds * sqrt (pgs - k3*k3 * s4*s4*s4);
 
+	return r1/6 + r2/3 + r3/3 + r4/6;
 
-SDOut SDMax (SDIn& si) {
-
-	SDOut so;
-
-	Matrix<double>& posh = si.posh;
-	Matrix<double>& sh   = si.sh;
-
-	PolyVal<double>& pkx = *(si.pkx);
-	PolyVal<double>& pky = *(si.pky);
-	PolyVal<double>& pkz = *(si.pkz);
-
-	size_t ssp = size(posh,0);
-	size_t sss = size(sh  ,0);
-
-	Matrix<double>  dpp (ssp,1);
-	Matrix<double>  dsp (sss,1);
-	Matrix<double>  csp (ssp,3);
+}
 
-	for (size_t i = 0; i < ssp-1; i++)
-		dpp[i] = posh[i+1] - posh[i]; 
-	dpp[ssp-1] = dpp[ssp-2];
 
-	for (size_t i = 0; i < sss-1; i++)
-		dsp[i] = sh[i+1] - sh[i]; 
-	dsp[ssp-1] = dsp[ssp-2];
-	
-	printf ("."); fflush (stdout);
+/**
+ * @brief       Time-optimal gradient waveform design (Lustig et al, IEEE TMI
+ *              27:866-873, 2008) for batches of trajectories.<br/>
+ *
+ *              Each trajectory is reparametrised by arc length and its
+ *              curvature limited velocity is computed (threaded over
+ *              trajectories). The forward and backward slew rate ODE passes
+ *              then run for blocks of trajectories in lockstep: the arc length
+ *              step only depends on the hardware limits, so row i of all
+ *              trajectories in a block is contiguous and the Runge-Kutta
+ *              steps vectorise across the block. The backward pass works on
+ *              reversed copies such that it, too, runs on contiguous rows.
+ *              Work buffers are kept per thread and reused across calls.<br/>
+ *
+ *              Where the curvature limited velocity rises steeply, e.g. in
+ *              the centre of a spiral, following it exceeds the slew rate
+ *              limit, as in the reference implementation.
+ */
+class GradientDesign {
+
+	struct Geometry {
+		Matrix<double> np;                 /**< @brief Upsampled parameter */
+		Matrix<double> ks;                 /**< @brief k on np */
+		std::vector<double> pos;           /**< @brief Parameter at arc length samples */
+		std::vector<double> kap;           /**< @brief Curvature at half samples (2ts+3) */
+		std::vector<double> phi;           /**< @brief Velocity limit at half samples (2ts) */
+		std::vector<double> st;            /**< @brief Time optimal velocity (ts) */
+		double L;                          /**< @brief Arc length */
+		size_t ts;                         /**< @brief # arc length samples */
+	};
+
+public:
+
+	/**
+	 * @brief       Construct
+	 *
+	 * @param  mgr  Maximum gradient
+	 * @param  msr  Maximum slew rate
+	 * @param  dt   Sampling interval
+	 * @param  ups  Upsampling of the input trajectory
+	 * @param  blk  Trajectories integrated in lockstep
+	 */
+	GradientDesign (const double mgr, const double msr, const double dt, const size_t ups = 25,
+					const size_t blk = 8) :
+		m_mgr (mgr), m_msr (msr), m_dt (dt), m_ups (ups), m_blk (std::max (blk, (size_t)1)) {}
+
+	virtual ~GradientDesign () {}
+
+	/**
+	 * @brief       Design gradients for a batch of trajectories
+	 *
+	 * @param  k    K-space trajectories [1/cm] (n x 3 each), replaced by the
+	 *              time-optimally sampled trajectories
+	 * @return      Solutions
+	 */
+	std::vector<Solution> Compute (std::vector<Matrix<double> >& k) {
+
+		const size_t nt = k.size(), nb = (nt + m_blk - 1) / m_blk;
+		std::vector<Geometry> geo (nt);
+		std::vector<Solution> sol (nt);
+
+#pragma omp parallel for schedule (dynamic)
+		for (long j = 0; j < (long)nt; ++j)
+			Geometrise (k[j], geo[j]);
+
+		m_work.resize (omp_get_max_threads());
+
+#pragma omp parallel for schedule (dynamic)
+		for (long b = 0; b < (long)nb; ++b)
+			Integrate (geo, b*m_blk, std::min ((b+1)*m_blk, nt), m_work[omp_get_thread_num()]);
+
+#pragma omp parallel for schedule (dynamic)
+		for (long j = 0; j < (long)nt; ++j)
+			sol[j] = Finalise (geo[j], k[j]);
+
+		return sol;
 
-	for (size_t i = 1; i < ssp-1; i++) {
-		csp(i,0) = (pkx.Lookup (posh[i] + dpp[i]) - pkx.Lookup (posh[i])) / dsp[i];
-		csp(i,1) = (pky.Lookup (posh[i] + dpp[i]) - pky.Lookup (posh[i])) / dsp[i];
-		csp(i,2) = (pkz.Lookup (posh[i] + dpp[i]) - pkz.Lookup (posh[i])) / dsp[i];
 	}
 
-	printf ("."); fflush (stdout);
-
-	dpp.Clear();
-
-	Matrix<double>  dpm (ssp,1);
-	Matrix<double>  dsm (sss,1);
-	Matrix<double>  csm (ssp,3);
-
-	for (size_t i = 1; i < ssp;   i++) 
-		dpm[i] = posh[i] - posh[i-1]; 
-	dpm[0] = dpm[1];
-
-	for (size_t i = 1; i < sss;   i++) 
-		dsm[i] = sh[i] - sh[i-1]; 
-	dsm[0] = dsm[1];
-
-	for (size_t i = 1; i < ssp-1; i++) {
-		csm(i,0) = (pkx.Lookup (posh[i]) - pkx.Lookup (posh[i] - dpm[i])) / dsm[i];
-		csm(i,1) = (pky.Lookup (posh[i]) - pky.Lookup (posh[i] - dpm[i])) / dsm[i];
-		csm(i,2) = (pkz.Lookup (posh[i]) - pkz.Lookup (posh[i] - dpm[i])) / dsm[i];
+	/**
+	 * @brief       Design gradients for a single trajectory
+	 */
+	Solution Compute (Matrix<double>& k) {
+		std::vector<Matrix<double> > kv (1, k);
+		Solution s = Compute (kv)[0];
+		k = kv[0];
+		return s;
 	}
 
-	dpm.Clear();
-	
-	Matrix<double>  css (ssp,3);
+private:
+
+	/**
+	 * @brief       Arc length parametrisation and geometry dependent velocity limit
+	 */
+	void Geometrise (const Matrix<double>& k, Geometry& g) const {
+
+		const size_t sgpk = size(k,0), ssk = (sgpk-1)*m_ups+1, nd = size(k,1);
+		Matrix<double> op = linspace<double> (0.0, (double)(sgpk-1), sgpk);
+		g.np = linspace<double> (0.0, (double)(sgpk-1), ssk);
+		g.ks = Interp1<double> (op, k).Lookup (g.np);
+
+		// Arc length
+		Matrix<double> sop (ssk,1);
+		for (size_t i = 0; i < ssk-1; i++) {
+			double d = 0.;
+			for (size_t c = 0; c < nd; ++c)
+				d += (g.ks(i+1,c) - g.ks(i,c)) * (g.ks(i+1,c) - g.ks(i,c));
+			sop[i+1] = sop[i] + sqrt (d) * m_ups;
+		}
+		sop /= (double)m_ups;
+
+		const double ds = Step ();
+		g.L  = sop[ssk-1];
+		g.ts = (size_t) ceil (g.L/ds);
+
+		// Parameter at twice the arc length sampling
+		const size_t sss = 2*g.ts;
+		Matrix<double> sh = linspace<double> (0.0, g.L, sss);
+		for (size_t i = 0; i < sss; i++)
+			sh[i] = std::min (sh[i], g.L);
+		Matrix<double> posh = Interp1<double> (sop, g.np).Lookup (sh);
+		g.pos.resize (g.ts);
+		for (size_t i = 0; i < g.ts; i++)
+			g.pos[i] = posh[i*2];
+
+		// Curvature by central differences of k over arc length
+		Matrix<double> kh = Interp1<double> (g.np, g.ks).Lookup (posh);
+		g.kap.assign (sss+3, 0.);
+		for (size_t i = 1; i < sss-1; i++) {
+			const double dsp = sh[i+1] - sh[i], dsm = sh[i] - sh[i-1];
+			double css = 0.;
+			for (size_t c = 0; c < nd; ++c) {
+				const double cs = ((kh(i+1,c) - kh(i,c)) / dsp - (kh(i,c) - kh(i-1,c)) / dsm) / ((dsm + dsp) * 0.5);
+				css += cs*cs;
+			}
+			g.kap[i] = sqrt (css);
+		}
+		g.kap[0] = g.kap[1];
+		for (size_t i = sss-1; i < sss+3; i++)
+			g.kap[i] = g.kap[sss-2];
+
+		const double mgr = GAMMA / 10.0 * m_mgr, msr = GAMMA / 10.0 * m_msr;
+		g.phi.resize (sss);
+		for (size_t i = 0; i < sss; i++)
+			g.phi[i] = std::min (mgr, sqrt (msr/g.kap[i]));
 
-	for (size_t i = 1; i < ssp-1; i++) {
-		css(i,0) = (csp(i,0) - csm(i,0)) / ((dsm[i] + dsp[i]) * 0.5);
-		css(i,1) = (csp(i,1) - csm(i,1)) / ((dsm[i] + dsp[i]) * 0.5);
-		css(i,2) = (csp(i,2) - csm(i,2)) / ((dsm[i] + dsp[i]) * 0.5);
 	}
 
-	csp.Clear();
-	csm.Clear();
-	dsp.Clear();
-	dsm.Clear();
-	
-	printf (". "); fflush (stdout);
+	/**
+	 * @brief       Forward and backward ODE for trajectories j0..j1 in lockstep
+	 */
+	void Integrate (std::vector<Geometry>& geo, const size_t j0, const size_t j1,
+					std::vector<double>& w) const {
+
+		const size_t nb = j1 - j0;
+		size_t tsm = 0;
+		for (size_t j = j0; j < j1; ++j)
+			tsm = std::max (tsm, geo[j].ts);
+		const size_t nk = 2*tsm+3, np = 2*tsm;
+
+		w.resize (nb * (2*nk + 2*np + 2*tsm));
+		double *K = &w[0], *Kr = K + nk*nb, *P = Kr + nk*nb, *Pr = P + np*nb, *A = Pr + np*nb, *B = A + tsm*nb;
+		std::fill (w.begin(), w.end(), 0.);
+
+		std::vector<size_t> ts (nb);
+		for (size_t b = 0; b < nb; ++b) {
+			const Geometry& g = geo[j0+b];
+			const size_t n = g.ts;
+			ts[b] = n;
+			for (size_t i = 0; i < 2*n+3; ++i) {
+				K[i*nb+b]  = g.kap[i];
+				Kr[i*nb+b] = g.kap[2*n+2-i];
+			}
+			for (size_t i = 0; i < 2*n; ++i) {
+				P[i*nb+b]  = g.phi[i];
+				Pr[i*nb+b] = g.phi[2*n-1-i];
+			}
+		}
+
+		const double ds = Step (), pgs = pow (GAMMA / 10.0 * m_msr, 2);
+		const size_t* tsp = &ts[0];
+
+		// Forward (infeasible steps yield NaN and fall back to the limit)
+		for (size_t i = 1; i < tsm; ++i) {
+			const double *a = A + (i-1)*nb, *k = K + 2*(i-1)*nb, *p = P + (2*i-1)*nb;
+			double* an = A + i*nb;
+#pragma omp simd
+			for (size_t b = 0; b < nb; ++b) {
+				const double v = a[b] + RungeKutta (ds, a[b], k[b], k[nb+b], k[2*nb+b], pgs);
+				an[b] = (i < tsp[b]) ? ((v < p[b]) ? v : p[b]) : a[b];
+			}
+		}
+
+		// Backward, row j is i = ts-1-j of each trajectory
+		for (size_t b = 0; b < nb; ++b)
+			B[b] = A[(ts[b]-1)*nb+b];
+		for (size_t j = 1; j + 1 < tsm; ++j) {
+			const double *s = B + (j-1)*nb, *k = Kr + (2*j-2)*nb, *p = Pr + (2*j+2)*nb;
+			double* sn = B + j*nb;
+#pragma omp simd
+			for (size_t b = 0; b < nb; ++b) {
+				const double v = s[b] + RungeKutta (ds, s[b], k[b], k[nb+b], k[2*nb+b], pgs);
+				sn[b] = (j + 1 < tsp[b]) ? ((v < p[b]) ? v : p[b]) : s[b];
+			}
+		}
+
+		for (size_t b = 0; b < nb; ++b) {
+			Geometry& g = geo[j0+b];
+			g.st.resize (g.ts);
+			g.st[0] = 0.;
+			for (size_t i = 1; i < g.ts; ++i) {
+				const double fa = A[i*nb+b], fb = B[(g.ts-1-i)*nb+b];
+				g.st[i] = (fa <= fb) ? fa : fb;
+			}
+		}
 
-	so.k   = Matrix<double> (ssp,1);
-	so.phi = Matrix<double> (ssp,1);
+	}
 
-	for (size_t i = 1; i < ssp-1; i++) 
-		so.k[i]  = sqrt (pow(css(i,0),2) + pow(css(i,1),2) + pow(css(i,2),2));
-	
-	so.k[0]     = so.k[1]; 
-	so.k[sss-1] = so.k[sss-2];
-	
-	css.Clear();
+	/**
+	 * @brief       Time parametrisation and waveforms
+	 */
+	Solution Finalise (Geometry& g, Matrix<double>& kout) const {
+
+		Solution s;
+		const double ds = Step (), gdt = GAMMA / 10.0 * m_dt;
+		const size_t ts = g.ts, nd = size(g.ks,1);
+
+		Matrix<double> tos (ts,1), sf = linspace<double> (0.0, g.L, ts), pos (ts,1);
+		for (size_t i = 1; i < ts; i++)
+			tos[i] = tos[i-1] + ds/g.st[i];
+		std::copy (g.pos.begin(), g.pos.end(), pos.Begin());
+
+		const double T = tos[ts-1];
+		const size_t Nt = std::floor (T/m_dt + 0.5);
+
+		Matrix<double> t = linspace<double> (0.0, T, Nt);
+		for (size_t i = 0; i < Nt; i++)
+			t[i] = std::min (t[i], T);
+		Matrix<double> sot = Interp1<double> (tos, sf).Lookup (t);
+		for (size_t i = 0; i < Nt; i++)
+			sot[i] = std::min (sot[i], g.L);
+		Matrix<double> pot = Interp1<double> (sf, pos).Lookup (sot);
+		for (size_t i = 0; i < Nt; i++)
+			pot[i] = std::min (pot[i], g.np[numel(g.np)-1]);
+		kout = Interp1<double> (g.np, g.ks).Lookup (pot);
+
+		s.g = Matrix<double> (Nt-1,nd);
+		s.k = Matrix<double> (Nt-1,nd);
+		s.s = Matrix<double> (Nt-1,nd);
+
+		for (size_t c = 0; c < nd; c++) {
+			for (size_t i = 0; i < Nt-1; i++)
+				s.g(i,c) = (kout(i+1,c) - kout(i,c)) / gdt;
+			for (size_t i = 1; i < Nt-1; i++)
+				s.k(i,c) = s.k(i-1,c) + s.g(i,c) * gdt;
+			for (size_t i = 0; i < Nt-2; i++)
+				s.s(i,c) = (s.g(i+1,c) - s.g(i,c)) / m_dt;
+			s.s(Nt-2,c) = s.s(Nt-3,c);
+		}
+
+		s.t = Matrix<double> (Nt-1,1);
+		std::copy (t.Begin(), t.Begin() + (Nt-1), s.t.Begin());
+
+		// Release per trajectory geometry
+		g = Geometry ();
+
+		return s;
 
-	double mgr = GAMMA / 10.0 * si.mgr;
-	double msr = GAMMA / 10.0 * si.msr;
+	}
 
-	for (size_t i = 0; i < ssp; i++) 
-		so.phi[i] = MIN (mgr, sqrt(msr/so.k[i]));
-	
-	return so;
+	inline double Step () const {
+		return GAMMA / 10.0 * m_msr * m_dt * m_dt / 3.0;
+	}
 
-}
+	double m_mgr, m_msr, m_dt;
+	size_t m_ups, m_blk;
+	std::vector<std::vector<double> > m_work;  /**< @brief Per thread ODE buffers */
 
+};
 
 
 /**
@@ -213,191 +372,18 @@ SDOut SDMax (SDIn& si) {
  * @param  gp   Parameters
  * @return      Solution
  */
-Solution ComputeGradient (GradientParams& gp) {
-
-	Solution s;
-	size_t ups = 25, ts = 0;
-
-	printf ("  Const arc-length parametrization "); fflush(stdout);
-	ticks start = getticks();
-
-	Matrix<double> op, np, sop;
-
-	size_t sgpk = size(gp.k,0);
-	size_t ssk  = (sgpk-1)*ups+1;
-
-	op = linspace<double> (0.0, (double)(size(gp.k,0)-1), sgpk);
-	np = linspace<double> (0.0, (double)(size(gp.k,0)-1),  ssk);
-
-	printf ("..."); fflush (stdout);
-
-	s.k = interp1 (op, gp.k, np);
-
-	op.Clear();
+inline Solution ComputeGradient (GradientParams& gp) {
 
-	size_t snp = size(s.k,0);
-	s.g = Matrix<double>(snp,3);
-	sop = Matrix<double>(snp,1);
+	printf ("  Computing time optimal gradients ... "); fflush(stdout);
+	double start = omp_get_wtime();
 
-	SDIn sdin;
+	GradientDesign gd (gp.mgr, gp.msr, gp.dt);
+	Solution s = gd.Compute (gp.k);
 
-	sdin.pkx = new PolyVal<double> (np, (double*)&(s.k)[0]);
-	sdin.pky = new PolyVal<double> (np, (double*)&(s.k)[1*snp]);
-	sdin.pkz = new PolyVal<double> (np, (double*)&(s.k)[2*snp]);
-
-	printf ("..."); fflush (stdout);
-
-	sdin.mgr = gp.mgr;
-	sdin.msr = gp.msr;
-
-	for (size_t i = 0, j = snp, l = 2*snp; i < snp-1; i++) {
-		s.g[i  ] = s.k[i+1  ] - s.k[i  ];
-		s.g[i+j] = s.k[i+1+j] - s.k[i+j];
-		s.g[i+l] = s.k[i+1+l] - s.k[i+l];
-	}
-
-	printf (".."); fflush (stdout);
-
-	s.g *= (double)ups;
-	
-	sop [0] = 0.0;
-	
-	for (size_t i = 0; i < snp-1; i++)
-		sop [i+1] = sop[i] + sqrt (pow(s.g(i,0),2) + pow(s.g(i,1),2) + pow(s.g(i,2),2));
-
-	sop /= (double)ups;
-
-	printf ("."); fflush (stdout);
-	
-	double st0 = GAMMA / 10.0 * gp.msr * gp.dt;
-	double ds  = st0 * gp.dt / 3.0;
-	
-	double L   = sop(numel(sop)-1);
-	ts = ceil(L/ds);
-
-	Matrix<double> sf, sta, stb, pos;
-	
-	printf ("."); fflush (stdout);
-	
-	sf         = linspace<double> (0.0, L,   ts);
-	sdin.sh    = linspace<double> (0.0, L, 2*ts);
-	sta        = zeros<double> (size(sf,0), 1);
-	stb        = zeros<double> (size(sf,0), 1);
-
-	sdin.posh  = interp1 (sop, np, sdin.sh);
-	
-	np.Clear();
-	sop.Clear();
-
-	printf ("."); fflush (stdout);
-
-	pos        = Matrix<double> (size(sdin.posh,0)/2,1);
-
-	for (size_t i = 0; i < size(pos,0); i++)
-		pos[i] = sdin.posh[i*2];
-
-	printf (" done: (%.3f)\n  Computing geometry dependent constraints ", elapsed(getticks(), start) / Toolbox::Instance()->ClockRate()); 
-	fflush(stdout);
-	start = getticks();
-
-	SDOut sdout = SDMax (sdin);
-	size_t sk = size(sdout.k,0);
-	size_t ss = size(sf,0);
-
-	sdout.k = resize (sdout.k,sk+2,1);
-	sdout.k[sk]   = sdout.k[sk-1];
-	sdout.k[sk+1] = sdout.k[sk-1];
-
-	sta[0] = 0.0;
-
-    //OK
-
-	printf ("done: (%.3f)\n  Solving ODE forward ........................ ", elapsed(getticks(), start) / Toolbox::Instance()->ClockRate());
-	fflush(stdout);
-	start = getticks();
-
-	for (size_t i = 1; i < ss; i++)
-		sta[i] = MIN (sta[i-1] + RungeKutta (sf[i], ds, sta[i-1], &sdout.k[(i-1)*2], gp.msr, L,  true), sdout.phi[i*2-1]);
-
-	stb[ss-1] = sta[ss-1];
-
-	printf ("done: (%.3f)\n  Solving ODE backward ....................... ", elapsed(getticks(), start) / Toolbox::Instance()->ClockRate()); 
-	fflush(stdout);
-	start = getticks();
-
-	for (size_t i = ss-2; i > 0; i--)
-		stb[i] = MIN (stb[i+1] + RungeKutta (sf[i], ds, stb[i+1], &sdout.k[(i+2)*2], gp.msr, L, false), sdout.phi[i*2-1]);
-
-	printf ("done: (%.3f)\n  Final interpolations ....................... ", elapsed(getticks(), start) / Toolbox::Instance()->ClockRate());
-	fflush(stdout);
-
-	start = getticks();
-
-	for (size_t i = 0; i < ss; i++)
-		sta[i] = (sta[i] <= stb[i]) ? sta[i] : stb[i];
-
-	Matrix<double> tos, sot, t, pot;
-	double T;
-	size_t Nt;
-    
-	tos  = ds/sta;
-    tos[0] = 0;
-    tos = cumsum (tos);
-
-	T      = tos [numel(tos)-1];
-	Nt     = ROUND (T/gp.dt); 
-
-	t      = linspace<double> (0.0, T, Nt);
-
-	sot    = interp1 (tos,  sf,   t);
-	pot    = interp1 ( sf, pos, sot);
-
-	pos.Clear();
-	
-	gp.k   = Matrix<double> (Nt,3);
-
-	for (size_t i = 0; i < Nt; i++) {
-		gp.k(i,0) = (sdin.pkx->Lookup (pot[i]));
-		gp.k(i,1) = (sdin.pky->Lookup (pot[i]));
-		gp.k(i,2) = (sdin.pkz->Lookup (pot[i]));
-	}
-
-	s.g    = Matrix<double> (Nt-1,3);
-	s.k    = Matrix<double> (Nt-1,3);
-	s.s    = Matrix<double> (Nt-1,3);
-	
-	for (size_t i = 0; i < Nt-1; i++) {
-		s.g(i,0) = (gp.k(i+1,0) - gp.k(i,0)) / (GAMMA / 10.0 * gp.dt);
-		s.g(i,1) = (gp.k(i+1,1) - gp.k(i,1)) / (GAMMA / 10.0 * gp.dt);
-		s.g(i,2) = (gp.k(i+1,2) - gp.k(i,2)) / (GAMMA / 10.0 * gp.dt);
-	}
-
-	for (size_t i = 1; i < Nt-1; i++) {
-		s.k(i,0) =  s.k(i-1,0) + s.g(i,0) * (GAMMA / 10.0 * gp.dt);
-		s.k(i,1) =  s.k(i-1,1) + s.g(i,1) * (GAMMA / 10.0 * gp.dt);
-		s.k(i,2) =  s.k(i-1,2) + s.g(i,2) * (GAMMA / 10.0 * gp.dt);
-	}
-
-	for (size_t i = 0; i < 3; i++)
-		s.k(0,i) = 0.0;
-
-	for (size_t i = 0; i < Nt-2; i++) {
-		s.s(i,0) = (s.g(i+1,0) - s.g(i,0)) / gp.dt;
-		s.s(i,1) = (s.g(i+1,1) - s.g(i,1)) / gp.dt;
-		s.s(i,2) = (s.g(i+1,2) - s.g(i,2)) / gp.dt;
-	}
-
-	for (size_t i = 0; i < 3; i++)
-		s.s(Nt-2,i) = s.s(Nt-3,i);  
-
-	t = resize (t, Nt-1, 1);
-	s.t = t;
-
-	printf ("done: (%.3f)\n", elapsed(getticks(), start) / Toolbox::Instance()->ClockRate());
+	printf ("done: (%.3f)\n", omp_get_wtime() - start);
 
 	return s;
-	
-}
 
+}
 
 #endif /* __GRADIENT_TIMING_H__ */
@@ -20,6 +20,8 @@
 
 #include "KTPoints.hpp"
 #include "PTXINIFile.hpp"
+#include "STA.hpp"
+#include "CGLS.hpp"
 
 #ifdef _MSC_VER
 std::string ofstr = "    %04Iu %.6f";
@@ -89,60 +91,6 @@ inline static void PhaseCorrection (Matrix<cxfl>& target, const Matrix<cxfl>& re
 }
 
 
-/**
- * @brief           STA integral
- *
- * @param  ks       k
- * @param  r        r
- * @param  b1       b1 map
- * @param  b0       b0 map
- * @param  nc       # of transmit channels
- * @param  nk       # of kspace positions
- * @param  ns       # of spatial positions
- * @param  gd       Gradient duration
- * @param  pd       Pulse durations
- *
- * @return          STA matrix
- */
-inline static Matrix<cxfl>
-STA (const Matrix<float>& ks, const Matrix<float>& r, const Matrix<cxfl>& b1, const Matrix<float>& b0, 
-     const size_t nc, const size_t nk, const size_t ns, const size_t gd, const Matrix<float>& pd, const size_t n) {
-
-    Vector<float> d (nk);
-	Matrix<cxfl>  m (ns,nc*nk);
-
-    printf ("  Computing STA encoding matrix ..."); 
-    fflush (stdout);
-    
-    for (size_t i = 0; i< nk; i++)
-        d[i] = (i==0) ? pd[i] + gd : d[i-1] + pd[i] + gd;
-
-    std::reverse (d.begin(), d.end());
-
-    for (size_t i = 0; i < nk-1; i++)
-        d[i] = 1.0e-5 * d[i+1] + 1.0e-5 * pd[i]/2;
-
-    d[nk-1] = 1.0e-5 * pd[nk-1] / 2;
-
-    cxfl pgd (0.f, 10.f*TWOPI*GAMMA);
-
-#pragma omp parallel for default (shared)
-    for (int k = 0; k < (int)nk; k++) {
-        float tpdk = TWOPI * d[k];
-        for (size_t s = 0; s < ns; s++) {
-            cxfl eikr = pgd * std::polar (1.f, ks(0,k)*r(0,s) + ks(1,k)*r(1,s) + ks(2,k)*r(2,s) + tpdk * b0(s));
-            for (size_t c = 0; c < nc; c++)
-                m(s,c*nk+k) =  b1(s,c) * eikr;
-        }
-    }
-    
-	printf ("  ... done.\n");
-
-	return m;
-
-}
-
-
 /**
  * @brief Construct actual pulses
  *
@@ -233,21 +181,52 @@ static inline void PTXTiming (const Matrix<cxfl>& solution, const Matrix<float>&
 
 
 
-static inline void KTPSolve (const Matrix<cxfl>& m, Matrix<cxfl>& target, Matrix<cxfl>& final,
-     Matrix<cxfl>& solution, const double& lambda, const size_t& mxit,  const float& conv,
-	 const bool& breakearly, size_t& gc, Matrix<float>& res) {
+/**
+ * @brief           RF energy weights of the unknowns.
+ *                  Sub-pulse k of channel c plays x(c,k)/pd(k) for pd(k),
+ *                  i.e. deposits |x(c,k)|^2/pd(k).
+ *
+ * @param  pd       Pulse durations
+ * @param  nc       # of transmit channels
+ * @param  sar      Weight of power regularisation
+ * @return          Diagonal weights (nc*nk) or empty
+ */
+static inline Matrix<float> SARWeights (const Matrix<float>& pd, const size_t nc, const double sar) {
+    const size_t nk = numel(pd);
+    Matrix<float> w;
+    if (sar <= 0.)
+        return w;
+    w = Matrix<float> (nk*nc,1);
+    for (size_t c = 0; c < nc; c++)
+        for (size_t k = 0; k < nk; k++)
+            w[c*nk+k] = sar / pd[k];
+    return w;
+}
+
+
+static inline void KTPSolve (const STA& m, Matrix<cxfl>& target, Matrix<cxfl>& final,
+     Matrix<cxfl>& solution, const double& lambda, const Matrix<float>& w, const size_t& cgiter,
+     const size_t& mxit, const float& conv, const bool& breakearly, size_t& gc, Matrix<float>& res) {
 
     Matrix<cxfl> minv;
-
-    // Regularised inverse (E^H*E)^-1*E^H
-    minv  = pinv(m.mult(m) + lambda*eye<cxfl>(size(m,1))).mul(m, 'N', 'C');
+    codeare::optimisation::CGLS<cxfl> cgls (cgiter, 1.0e-6, lambda);
+
+    // Regularised inverse (E^H*E + lambda + W)^-1, E^H and E are applied by the operator
+    if (cgiter == 0) {
+        minv  = m.Gram() + lambda*eye<cxfl>(m.Unknowns());
+        for (size_t i = 0; i < w.Size(); i++)
+            minv(i,i) += w[i];
+        minv  = pinv(minv);
+    } else
+        cgls.Weights (w);
     
     size_t j = 0;
 
     // Variable exchange method --------------
     while (gc < mxit) {
-        solution = gemm(minv,target);
-        final    = gemm(m,solution);
+        // Iterative: warm started with previous solution (also across pulse durations)
+        solution = (cgiter == 0) ? gemm(minv,m/target) : cgls.Solve (m, target, solution);
+        final    = m*solution;
         
         res[gc]  = NRMSE (target, final);
         PhaseCorrection  (target, final);
@@ -319,7 +298,8 @@ inline static bool CheckAmps (const Matrix<cxfl>& solution, Matrix<float>& pd, c
 
 
 KTPoints::KTPoints  () : m_verbose(false), m_rflim(1.0), m_conv(1.0e-6), m_lambda(1.0e-6),
-        m_breakearly(true), m_gd(10), m_max_rf(0), m_maxiter(1000), ns(0), nk(0), nc(0) {}
+        m_breakearly(true), m_gd(10), m_max_rf(0), m_maxiter(1000), ns(0), nk(0), nc(0),
+        m_matrixfree(0), m_tile(1024), m_cgiter(0), m_sar(0.) {}
 
 
 KTPoints::~KTPoints () {}
@@ -374,6 +354,24 @@ codeare::error_code KTPoints::Init () {
     Attribute ("breakearly", &m_breakearly);
     printf ("  break early: %i \n", m_breakearly);
 
+    // Never materialise STA matrix -----------
+    Attribute ("matrixfree", &m_matrixfree);
+    printf ("  matrix free: %i \n", m_matrixfree);
+
+    // Spatial positions per STA tile ---------
+    Attribute ("tile", &m_tile);
+    if (m_tile < 16)
+        m_tile = 1024;
+    printf ("  STA tile: %i \n", m_tile);
+
+    // CGLS iterations per exchange step (0: pseudo-inverse)
+    Attribute ("cgiter", &m_cgiter);
+    printf ("  CGLS iterations: %i \n", m_cgiter);
+
+    // RF power regularisation ----------------
+    Attribute ("sar", &m_sar);
+    printf ("  SAR regularisation: %.4f \n", m_sar);
+
     // ----------------------------------------
     
     printf ("... done.\n\n");
@@ -430,8 +428,6 @@ codeare::error_code KTPoints::Process () {
     Matrix<cxfl>&   rf    = AddMatrix<cxfl> ("rf"); 
     Matrix<float>&  grad  = AddMatrix<float> ("grad");
 
-    Matrix<cxfl> m;// (ns, nk*nc); // STA system encoding matrix
-
     bool        amps_ok = false;
     size_t      gc    = 0;      // Global counter for VE iterations
 
@@ -440,11 +436,15 @@ codeare::error_code KTPoints::Process () {
 
     while (!amps_ok) {
         
-		// Compute SEM
-        m = STA (k, r, b1, b0, nc, nk, ns, m_gd, pd, gc);
+		// Compute SEM (or set up matrix free operator)
+        printf ("  Computing STA encoding %s ...", (m_matrixfree) ? "operator" : "matrix");
+        fflush (stdout);
+        STA m (k, r, b1, b0, m_gd, pd, (m_matrixfree == 0), m_tile);
+        printf ("  ... done.\n");
 
 		// Solve KTPoints
-        KTPSolve (m, target, final, solution, m_lambda, m_maxiter, m_conv, (m_breakearly>0), gc, res);
+        KTPSolve (m, target, final, solution, m_lambda, SARWeights (pd, nc, m_sar), m_cgiter,
+                  m_maxiter, m_conv, (m_breakearly>0), gc, res);
 		if (is_nan(res(gc)))
 			break;
     
@@ -52,10 +52,14 @@ namespace RRStrategy {
         int           m_maxiter;  /**< @brief # Variable exchange method iterations */
         int           m_verbose;  /**< @brief Verbose output. All intermediate results. */
         int           m_breakearly;  /**< @brief Break search with first diverging step */
+        int           m_matrixfree;  /**< @brief Apply STA encoding without storing it */
+        int           m_tile;     /**< @brief Spatial positions per STA tile */
+        int           m_cgiter;   /**< @brief CGLS iterations (0: pseudo-inverse) */
 
         double        m_lambda;   /**< @brief Tikhonov parameter      */
         double        m_rflim;    /**< @brief Maximum rf amplitude    */
         double        m_conv;     /**< @brief Convergence criterium   */
+        double        m_sar;      /**< @brief RF power regularisation */
         
         float*        m_max_rf;   /**< @brief Maximum reached RF amps */
 
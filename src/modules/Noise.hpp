@@ -18,79 +18,31 @@
  *  02110-1301  USA
  */
 
-#define IA 1366
-#define IC 150889
-#define LM 2147483647
-#define LAM (1.0/LM)
-#define LA 16807
-#define LR 2836
-#define LQ 127773
-
-long idum;
-
-void 
-SetSeed (double i=1349555.0) { 
-
-	idum = (long)i;
-
-}
-
-
-double 
-Uniform () {
-	
-	double  r1;
-	long    hi;
-
-	hi      = idum/LQ;
-	idum    = LA*(idum-hi*LQ) - LR*hi;
-	
-	if (idum < 0) 
-		idum += LM;
-	
-	r1  = LAM*idum;
-
-	return(r1);
-
-}
-
-
-std::complex<float> 
-WhiteNoise () {
-
-	float fac, r, v1, v2;
-
-	do {
-
-		v1 = (2.0 * Uniform()) - 1.0;
-		v2 = (2.0 * Uniform()) - 1.0;
-		r  = (v1*v1) + (v2*v2);
-
-	} while (r >= 1.0);
-
-	fac = sqrt(-2.0 * log(r) / r);
-
-	return ( raw( v2*fac, v1*fac ) );
-
-}
-
+#include "Philox.hpp"
 
+/**
+ * @brief       Add complex white gaussian noise
+ *
+ *              Noise is drawn from a counter-based generator with fixed seed.
+ *              Result is hence reproducible and independent of # threads.
+ *
+ * @param  m    Data
+ * @param  max  Standard deviation per real/imaginary part
+ * @param  seed Seed
+ * @param  stream Stream (e.g. pseudo-replica index)
+ * @return      Success
+ */
 codeare::error_code
-AddPseudoRandomNoise (Matrix<raw>& m, const float& max) {
+AddPseudoRandomNoise (Matrix<raw>& m, const float& max,
+                      const uint64_t seed = 1349555, const uint64_t stream = 0) {
 
-	SetSeed();
+	Matrix<raw> noise (m.Dim());
+	Random<raw,Philox>::Normal (noise, Philox(seed, stream), 0.0, max);
 
-#pragma omp parallel default (shared)
-	{
-
-#pragma omp for schedule (guided)
-	for (int i = 0; i < (int)m.Size(); i++)
-		m[i] = m[i] + max * WhiteNoise();
-	
-	}
+#pragma omp parallel for schedule (static)
+	for (long i = 0; i < (long)m.Size(); i++)
+		m[i] += noise[i];
 
 	return codeare::OK;
 
 }
-
-
@@ -26,6 +26,7 @@
 #include "Statistics.hpp"
 #include "Toolbox.hpp"
 #include "linalg/Lapack.hpp"
+#include "linalg/Batched.hpp"
 #include "DFT.hpp"
 #include "arithmetic/Trigonometry.hpp"
 #include "Print.hpp"
@@ -111,55 +112,29 @@ SVDCalibrate (const Matrix<cxfl>& imgs, Matrix<cxfl>& rxm, Matrix<cxfl>& txm, Ma
 	
 	printf ("  SVDing " JL_SIZE_T_SPECIFIER " matrices of " JL_SIZE_T_SPECIFIER "x" JL_SIZE_T_SPECIFIER " ... ", rtms, nrxc, ntxc); fflush(stdout);
 	
-	// Permute dimensions on imgs for contiguous RAM access
-	Matrix<cxfl> vxlm (nrxc, ntxc, imgs.Dim(0), imgs.Dim(1), imgs.Dim(2));
+	// Permute dimensions on imgs to one batch of rx x tx matrices (voxels fastest)
+	Matrix<cxfl> vxlm (volsize, nrxc, ntxc);
 	
-	for (size_t s = 0; s < imgs.Dim(2); s++)
-		for (size_t l = 0; l < imgs.Dim(1); l++)
-			for (size_t c = 0; c < imgs.Dim(0); c++)
-				for (size_t t = 0; t < ntxc; t++)
-					for (size_t r = 0; r < nrxc; r++)
-						// multiplication with 2 (Need only 1st echo)
-						vxlm(r, t, c, l, s) = imgs(c, l, s, 0, t, r); 
+	for (size_t t = 0; t < ntxc; t++)
+		for (size_t r = 0; r < nrxc; r++)
+			for (size_t s = 0; s < imgs.Dim(2); s++)
+				for (size_t l = 0; l < imgs.Dim(1); l++)
+					for (size_t c = 0; c < imgs.Dim(0); c++)
+						// Need only 1st echo
+						vxlm(c + imgs.Dim(0) * (l + imgs.Dim(1) * s), r, t) = imgs(c, l, s, 0, t, r); 
 	
-	int         threads = 1;
+	// Dominant singular triplets of all voxels at once
+	Matrix<cxfl>  u, v;
+	Matrix<float> s;
+	svd1_batched (vxlm, u, s, v);
 	
-#pragma omp parallel default (shared) 
-	{
-		threads  = omp_get_num_threads();
-	}
-	
-	std::vector<Matrix<cxfl> >m(threads); // Combination
-	std::vector<Matrix<cxfl> >u(threads); // Left-side and  O(NRX x NRX)
-	std::vector<Matrix<cxfl> >v(threads); // Right-side singular vectors O(NTX, NTX)
-	std::vector<Matrix<float> > s(threads); // Sorted singular values (i.e. first biggest) O (MIN(NRX,NTX));
-	
-	for (int i = 0; i < threads; i++) {
-		m[i] = Matrix<cxfl>     (nrxc, ntxc);
-		u[i] = Matrix<cxfl>     (nrxc, ntxc);
-		v[i] = Matrix<cxfl>     (ntxc, ntxc);
-		s[i] = Matrix<float> (std::min(ntxc, nrxc), 1);
-	}
-	
-#pragma omp parallel default (shared) 
-	{
+#pragma omp parallel for
+	for (int i = 0; i < (int)volsize; i++) {
 		
-		int tid = omp_get_thread_num();
-		
-#pragma omp for schedule (guided, 96)
+		for (size_t r = 0; r < nrxc; r++) rxm[r*volsize + i] = u(i,r) * exp(cxfl(0.0,1.0)*arg(u(i,0))); // U 
+		for (size_t t = 0; t < ntxc; t++) txm[t*volsize + i] = v(i,t) * exp(cxfl(0.0,1.0)*arg(v(i,0))); // V 
 		
-		for (int i = 0; i < rtms; i++) {
-			
-			memcpy (&m[tid][0], &vxlm[i*rtmsiz], rtmsiz * sizeof(cxfl));
-			
-			//svd (m[tid], s[tid], u[tid], v[tid], 'S');
-			
-			for (size_t r = 0; r < nrxc; r++) rxm[r*volsize + i] = u[tid][r] * exp(cxfl(0.0,1.0)*arg(u[tid][0])); // U 
-			for (size_t t = 0; t < ntxc; t++) txm[t*volsize + i] = v[tid][t] * exp(cxfl(0.0,1.0)*arg(v[tid][0])); // V 
-
-			snro[i] = s[tid][0];
-			
-		}
+		snro[i] = s[i];
 		
 	}
 	
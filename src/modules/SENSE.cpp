@@ -1,6 +1,7 @@
 #include "SENSE.hpp"
 #include "Algos.hpp"
 #include "Creators.hpp"
+#include "mri/PseudoReplica.hpp"
 
 using namespace RRStrategy;
 
@@ -12,6 +13,8 @@ SENSE::Init () {
 	Attribute ("compgfm", &m_compgfm);
 	Attribute ("nthreads",  &m_nthreads);
 	Attribute ("lambda", &m_lambda);
+	Attribute ("replicas", &m_replicas);
+	Attribute ("af", &m_af);
 
 	printf ("... done.\n\n");
 
@@ -54,6 +57,20 @@ SENSE::Process () {
     Matrix<cxfl>& in = Get<cxfl>("aliased");
 
     out = m_cs ->* in;
+
+    if (m_replicas > 0) {
+        PseudoReplica<cxfl> pr (m_cs, m_replicas);
+        if (Exists<cxfl>("noise_cov") == codeare::OK)
+            pr.NoiseCovariance (Get<cxfl>("noise_cov"));
+        pr.Run (in);
+        Matrix<float> snr = pr.SNR(), sd = pr.StdDev();
+        Add("snr", snr);
+        Add("noise_std", sd);
+        if (Exists<float>("noise_std_ref") == codeare::OK) { // fully sampled
+            Matrix<float> g = pr.GFactor (Get<float>("noise_std_ref"), m_af);
+            Add("gfactor", g);
+        }
+    }
     
     return codeare::OK;
 
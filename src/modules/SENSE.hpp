@@ -41,7 +41,7 @@ namespace RRStrategy {
 		 * @brief Default constructor
 		 */
 		SENSE  () :
-			m_nthreads(8), m_af(1), m_compgfm(false), m_lambda(0.0) {};
+			m_nthreads(8), m_af(1), m_compgfm(false), m_lambda(0.0), m_replicas(0) {};
 		
 		
 		/**
@@ -90,6 +90,8 @@ namespace RRStrategy {
 
 		bool           m_compgfm; /**< Compute g-factor map */
 
+		int            m_replicas; /**< # Pseudo-replicas for SNR maps (0: off) */
+
 	};
 
 }
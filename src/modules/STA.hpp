@@ -0,0 +1,311 @@
+/*
+ *  codeare Copyright (C) 2007-2010 Kaveh Vahedipour
+ *                               Forschungszentrum Juelich, Germany
+ *
+ *  This program is free software; you can redistribute it and/or modify
+ *  it under the terms of the GNU General Public License as published by
+ *  the Free Software Foundation; either version 2 of the License, or
+ *  (at your option) any later version.
+ *
+ *  This program is distributed in the hope that it will be useful, but
+ *  WITHOUT ANY WARRANTY; without even the implied warranty of
+ *  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU
+ *  General Public License for more details.
+ *
+ *  You should have received a copy of the GNU General Public License
+ *  along with this program; if not, write to the Free Software
+ *  Foundation, Inc., 51 Franklin Street, Fifth Floor, Boston, MA
+ *  02110-1301  USA
+ */
+
+#ifndef __STA_HPP__
+#define __STA_HPP__
+
+#include "Matrix.hpp"
+#include "Operator.hpp"
+#include "Lapack.hpp"
+#include "SinCos.hpp"
+#include "OMP.hpp"
+
+#include <algorithm>
+#include <vector>
+
+/**
+ * @brief   Small tip angle (STA) encoding of kT-point pulses.<br/>
+ *
+ *          Encoding matrix M (ns x nc*nk) with
+ *          M(s,c*nk+k) = i 2pi gamma b1(s,c) exp(i (k_k r_s + 2pi d_k b0_s)).
+ *
+ *          Spatial positions are processed in tiles by OpenMP threads. Within
+ *          a tile, the phases of one kT-point are evaluated for all positions
+ *          at once with the vectorised sincos, and written to contiguous runs
+ *          of each channel's column.
+ *
+ *          The operator either holds the dense matrix (Build()) or applies M
+ *          and its adjoint tile by tile without ever materialising it. For the
+ *          regularised pseudo-inverse, Gram() accumulates M^H M from tiles.
+ *          b1, b0 and k must outlive the operator.
+ */
+class STA : public Operator<cxfl> {
+
+public:
+
+	/**
+	 * @brief        Set up
+	 *
+	 * @param  ks    kT-points (3 x nk)
+	 * @param  r     Spatial positions (3 x ns)
+	 * @param  b1    B1+ maps (ns x nc)
+	 * @param  b0    B0 map (ns)
+	 * @param  gd    Gradient blip duration (10us)
+	 * @param  pd    Pulse durations (nk, 10us)
+	 * @param  dense Hold dense matrix
+	 * @param  tile  Spatial positions per tile
+	 */
+	STA (const Matrix<float>& ks, const Matrix<float>& r, const Matrix<cxfl>& b1, const Matrix<float>& b0,
+		 const size_t gd, const Matrix<float>& pd, const bool dense = true, const size_t tile = 1024) :
+		m_ks(ks), m_b1(b1), m_b0(b0), m_ns(size(r,1)), m_nk(size(ks,1)), m_nc(size(b1,1)),
+		m_tile(std::max(tile,(size_t)16)), m_g(10.f*TWOPI*GAMMA), m_d(m_nk), m_rx(m_ns), m_ry(m_ns),
+		m_rz(m_ns), m_dense(false) {
+
+		for (size_t s = 0; s < m_ns; ++s) {
+			m_rx[s] = r(0,s);
+			m_ry[s] = r(1,s);
+			m_rz[s] = r(2,s);
+		}
+
+		// Time from each kT-point's centre to the end of the pulse
+		std::vector<float> d (m_nk);
+		for (size_t i = 0; i < m_nk; i++)
+			d[i] = (i==0) ? pd[i] + gd : d[i-1] + pd[i] + gd;
+		std::reverse (d.begin(), d.end());
+		for (size_t i = 0; i < m_nk-1; i++)
+			m_d[i] = TWOPI * (1.0e-5 * d[i+1] + 1.0e-5 * pd[i]/2);
+		m_d[m_nk-1] = TWOPI * 1.0e-5 * pd[m_nk-1] / 2;
+
+		if (dense) {
+			m_m = Build ();
+			m_dense = true;
+		}
+
+	}
+
+	virtual ~STA () {}
+
+	/**
+	 * @brief        Dense encoding matrix (ns x nc*nk)
+	 */
+	Matrix<cxfl> Build () const {
+
+		Matrix<cxfl> m (m_ns, m_nc*m_nk);
+		const size_t nt = Tiles();
+
+#pragma omp parallel
+		{
+			std::vector<float> ph (m_tile), sn (m_tile), cs (m_tile);
+#pragma omp for schedule (dynamic)
+			for (long t = 0; t < (long)nt; ++t) {
+				const size_t s0 = t*m_tile, s1 = std::min (s0+m_tile, m_ns);
+				Fill (s0, s1, &m[0] + s0, m_ns, ph, sn, cs);
+			}
+		}
+
+		return m;
+
+	}
+
+	/**
+	 * @brief        Normal matrix M^H M (nc*nk x nc*nk), accumulated tile by tile
+	 */
+	Matrix<cxfl> Gram () const {
+
+		if (m_dense)
+			return m_m.mult (m_m);
+
+		const size_t nn = m_nc*m_nk, nt = Tiles();
+		Matrix<cxfl> g (nn, nn);
+
+#pragma omp parallel
+		{
+			std::vector<float> ph (m_tile), sn (m_tile), cs (m_tile);
+			Matrix<cxfl> mt (m_tile, nn), gt (nn, nn);
+#pragma omp for schedule (dynamic)
+			for (long t = 0; t < (long)nt; ++t) {
+				const size_t s0 = t*m_tile, s1 = std::min (s0+m_tile, m_ns);
+				if (size(mt,0) != s1 - s0)
+					mt = Matrix<cxfl> (s1-s0, nn);
+				Fill (s0, s1, &mt[0], s1-s0, ph, sn, cs);
+				gt += mt.mult (mt);
+			}
+#pragma omp critical
+			g += gt;
+		}
+
+		return g;
+
+	}
+
+	/**
+	 * @brief        Excitation M x
+	 *
+	 * @param  x     Pulse weights (nc*nk)
+	 * @return       Excitation (ns)
+	 */
+	virtual Matrix<cxfl> operator* (const Matrix<cxfl>& x) const {
+
+		if (m_dense)
+			return gemm (m_m, x);
+
+		Matrix<cxfl> y (m_ns, 1);
+		const size_t nt = Tiles();
+
+#pragma omp parallel
+		{
+			std::vector<float> ph (m_tile), sn (m_tile), cs (m_tile);
+			std::vector<cxfl> w (m_tile);
+#pragma omp for schedule (dynamic)
+			for (long t = 0; t < (long)nt; ++t) {
+				const size_t s0 = t*m_tile, n = std::min (s0+m_tile, m_ns) - s0;
+				for (size_t k = 0; k < m_nk; ++k) {
+					Phases (k, s0, n, ph, sn, cs);
+					for (size_t i = 0; i < n; ++i)
+						w[i] = cxfl(0.f);
+					for (size_t c = 0; c < m_nc; ++c) {
+						const cxfl xc = x[c*m_nk+k];
+						const cxfl* b1 = &m_b1[c*m_ns + s0];
+						for (size_t i = 0; i < n; ++i)
+							w[i] += b1[i] * xc;
+					}
+					for (size_t i = 0; i < n; ++i)
+						y[s0+i] += w[i] * cxfl(-sn[i], cs[i]);
+				}
+				for (size_t i = 0; i < n; ++i)
+					y[s0+i] *= cxfl(m_g, 0.f);
+			}
+		}
+
+		return y;
+
+	}
+
+	/**
+	 * @brief        Adjoint M^H y
+	 *
+	 * @param  y     Excitation (ns)
+	 * @return       Pulse weights (nc*nk)
+	 */
+	virtual Matrix<cxfl> operator/ (const Matrix<cxfl>& y) const {
+
+		if (m_dense)
+			return gemm (m_m, y, 'C');
+
+		const size_t nn = m_nc*m_nk, nt = Tiles();
+		Matrix<cxfl> x (nn, 1);
+
+#pragma omp parallel
+		{
+			std::vector<float> ph (m_tile), sn (m_tile), cs (m_tile);
+			std::vector<cxfl> w (m_tile), xt (nn, cxfl(0.f));
+#pragma omp for schedule (dynamic)
+			for (long t = 0; t < (long)nt; ++t) {
+				const size_t s0 = t*m_tile, n = std::min (s0+m_tile, m_ns) - s0;
+				for (size_t k = 0; k < m_nk; ++k) {
+					Phases (k, s0, n, ph, sn, cs);
+					for (size_t i = 0; i < n; ++i)
+						w[i] = std::conj (cxfl(-sn[i], cs[i])) * y[s0+i];
+					for (size_t c = 0; c < m_nc; ++c) {
+						const cxfl* b1 = &m_b1[c*m_ns + s0];
+						cxfl acc (0.f);
+						for (size_t i = 0; i < n; ++i)
+							acc += std::conj (b1[i]) * w[i];
+						xt[c*m_nk+k] += acc;
+					}
+				}
+			}
+#pragma omp critical
+			for (size_t j = 0; j < nn; ++j)
+				x[j] += m_g * xt[j];
+		}
+
+		return x;
+
+	}
+
+	virtual Matrix<cxfl> operator* (const MatrixType<cxfl>& x) const {
+		const Matrix<cxfl>* m = dynamic_cast<const Matrix<cxfl>*>(&x);
+		return m ? *this * *m : *this * Copy (x);
+	}
+	virtual Matrix<cxfl> operator/ (const MatrixType<cxfl>& y) const {
+		const Matrix<cxfl>* m = dynamic_cast<const Matrix<cxfl>*>(&y);
+		return m ? *this / *m : *this / Copy (y);
+	}
+
+	/**
+	 * @brief        Number of spatial positions
+	 */
+	inline size_t Positions () const { return m_ns; }
+
+	/**
+	 * @brief        Number of unknowns (nc*nk)
+	 */
+	inline size_t Unknowns () const { return m_nc*m_nk; }
+
+	/**
+	 * @brief        Holds dense matrix?
+	 */
+	inline bool Dense () const { return m_dense; }
+
+private:
+
+	inline static Matrix<cxfl> Copy (const MatrixType<cxfl>& v) {
+		Matrix<cxfl> m (v.Size(), 1);
+		for (size_t i = 0; i < v.Size(); ++i)
+			m[i] = v[i];
+		return m;
+	}
+
+	inline size_t Tiles () const { return (m_ns + m_tile - 1) / m_tile; }
+
+	/**
+	 * @brief        sin/cos of kT-point k's phase at positions s0..s0+n
+	 */
+	inline void Phases (const size_t k, const size_t s0, const size_t n, std::vector<float>& ph,
+						std::vector<float>& sn, std::vector<float>& cs) const {
+		const float kx = m_ks(0,k), ky = m_ks(1,k), kz = m_ks(2,k), dk = m_d[k];
+		const float *rx = &m_rx[s0], *ry = &m_ry[s0], *rz = &m_rz[s0], *b0 = &m_b0[s0];
+#pragma omp simd
+		for (size_t i = 0; i < n; ++i)
+			ph[i] = kx*rx[i] + ky*ry[i] + kz*rz[i] + dk*b0[i];
+		sincos (&ph[0], &sn[0], &cs[0], n);
+	}
+
+	/**
+	 * @brief        Rows s0..s1 of M into dst (leading dimension ld)
+	 */
+	inline void Fill (const size_t s0, const size_t s1, cxfl* dst, const size_t ld,
+					  std::vector<float>& ph, std::vector<float>& sn, std::vector<float>& cs) const {
+		const size_t n = s1 - s0;
+		for (size_t k = 0; k < m_nk; ++k) {
+			Phases (k, s0, n, ph, sn, cs);
+			for (size_t c = 0; c < m_nc; ++c) {
+				const cxfl* b1 = &m_b1[c*m_ns + s0];
+				cxfl* col = dst + (c*m_nk+k)*ld;
+				for (size_t i = 0; i < n; ++i)
+					col[i] = b1[i] * cxfl(-m_g*sn[i], m_g*cs[i]);
+			}
+		}
+	}
+
+	const Matrix<float>& m_ks;                   /**< @brief kT-points */
+	const Matrix<cxfl>&  m_b1;                   /**< @brief B1+ maps */
+	const Matrix<float>& m_b0;                   /**< @brief B0 map */
+	size_t m_ns, m_nk, m_nc, m_tile;
+	float  m_g;                                  /**< @brief 10us * 2pi gamma */
+	std::vector<float> m_d;                      /**< @brief 2pi x time to end of pulse */
+	std::vector<float> m_rx, m_ry, m_rz;         /**< @brief Positions */
+	Matrix<cxfl> m_m;                            /**< @brief Dense matrix (if held) */
+	bool   m_dense;                              /**< @brief Holds dense matrix */
+
+};
+
+#endif /* __STA_HPP__ */
@@ -1,5 +1,5 @@
 /*
- *  This file is part of codeare 
+ *  This file is part of codeare
  *
  *  Copyright (C) 2007-2010 Kaveh Vahedipour
  *                          Forschungszentrum Juelich, Germany
@@ -9,26 +9,98 @@
  *  the Free Software Foundation; either version 2 of the License, or
  *  (at your option) any later version.
  *
- *  This program is distributed in the hope that it will be useful, but 
+ *  This program is distributed in the hope that it will be useful, but
  *  WITHOUT ANY WARRANTY; without even the implied warranty of
- *  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU 
+ *  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU
  *  General Public License for more details.
  *
  *  You should have received a copy of the GNU General Public License
  *  along with this program; if not, write to the Free Software
- *  Foundation, Inc., 51 Franklin Street, Fifth Floor, Boston, MA 
+ *  Foundation, Inc., 51 Franklin Street, Fifth Floor, Boston, MA
  *  02110-1301  USA
  */
 
 #ifndef __SIMULATED_ANNEALING_HPP__
 #define __SIMULATED_ANNEALING_HPP__
 
-#include <gsl/gsl_rng.h>
+#include "Matrix.hpp"
+#include "Creators.hpp"
+#include "OMP.hpp"
+
+#include <algorithm>
+#include <vector>
+#include <math.h>
+#include <stdint.h>
 #include <time.h>
 
 
 /**
- * @brief  Travelling k-space-man with simulated annealing.
+ * @brief  Small, fast random number generator (xoroshiro128+), one per replica.
+ */
+class AnnealingRNG {
+
+public:
+
+	/**
+	 * @brief        Seed through splitmix64
+	 */
+	explicit AnnealingRNG (uint64_t seed = 0) {
+		for (size_t i = 0; i < 2; ++i) {
+			uint64_t z = (seed += 0x9E3779B97F4A7C15ULL);
+			z = (z ^ (z >> 30)) * 0xBF58476D1CE4E5B9ULL;
+			z = (z ^ (z >> 27)) * 0x94D049BB133111EBULL;
+			m_s[i] = z ^ (z >> 31);
+		}
+	}
+
+	inline uint64_t Next () {
+		const uint64_t s0 = m_s[0];
+		uint64_t s1 = m_s[1];
+		const uint64_t r = s0 + s1;
+		s1 ^= s0;
+		m_s[0] = ((s0 << 24) | (s0 >> 40)) ^ s1 ^ (s1 << 16);
+		m_s[1] = (s1 << 37) | (s1 >> 27);
+		return r;
+	}
+
+	/**
+	 * @brief        Uniform in [0,1)
+	 */
+	inline double Uniform () {
+		return (Next() >> 11) * (1.0 / 9007199254740992.0);
+	}
+
+	/**
+	 * @brief        Uniform integer in [0,n)
+	 */
+	inline size_t Int (const size_t n) {
+		return (size_t) (Uniform() * n);
+	}
+
+private:
+
+	uint64_t m_s[2];
+
+};
+
+
+/**
+ * @brief  Travelling k-space-man with simulated annealing.<br/>
+ *
+ *         The trip is closed and starts at the first k-space point (centre),
+ *         which stays in place. Candidate moves are 2-opt (reversal of a
+ *         section) and or-opt (relocation of a section of up to three points,
+ *         possibly reversed). Their change of trip length is evaluated from
+ *         the few touched edges on separate x/y/z arrays, i.e. in constant
+ *         time; only accepted moves touch the order.
+ *
+ *         Several replicas anneal in parallel at temperatures spaced
+ *         geometrically between start and final temperature (parallel
+ *         tempering). After every sweep neighbouring replicas exchange their
+ *         trips with the Metropolis probability, and all temperatures are
+ *         lowered by the cooling rate. Each replica draws from its own
+ *         generator. Without accworse, worse trips are never accepted and
+ *         the replicas are independent greedy descents (no exchanges).
  */
 class SimulatedAnnealing {
 
@@ -39,17 +111,19 @@ public:
 	 * @brief           Construct
 	 *
 	 * @param  k        K-Space points
-	 * @param  maxit    Max search iterations
-	 * @param  st       Start temperature
-	 * @param  ft       Final temperature
-	 * @param  cr       Cooling rate 
+	 * @param  maxit    Max search iterations (moves per replica)
+	 * @param  st       Start temperature (hottest replica)
+	 * @param  ft       Final temperature (coldest replica)
+	 * @param  cr       Cooling rate (temperature factor per sweep)
 	 * @param  verb     Verbosity
 	 * @param  accworse Accept worse solutions with a certain probability
+	 * @param  nrep     Replicas (0: one per thread)
+	 * @param  sweep    Moves between exchanges (0: number of points)
 	 */
-	SimulatedAnnealing (const Matrix<double>& k, const size_t& maxit = 1000, const double& st = 300.0, 
-						const double& ft = 0.0, const double& cr = 0.95, const bool& verb = true, 
-						const bool& accworse = false) {
-		
+	SimulatedAnnealing (const Matrix<double>& k, const size_t& maxit = 1000, const double& st = 300.0,
+						const double& ft = 0.0, const double& cr = 0.95, const bool& verb = true,
+						const bool& accworse = false, const size_t& nrep = 0, const size_t& sweep = 0) {
+
 		m_maxit = maxit;
 		m_st    = st;
 		m_ft    = ft;
@@ -57,24 +131,44 @@ public:
 		m_verb  = verb;
 		m_accworse = accworse;
 		m_k     = k;
+		m_nr    = size(k,0);
+		m_sweep = (sweep) ? sweep : m_nr;
+		m_bestn = 0;
+		m_drift = 0.;
+
+		size_t nt = nrep;
+		if (nt == 0) {
+#pragma omp parallel
+			{
+#pragma omp master
+				nt = omp_get_num_threads();
+			}
+		}
+		m_nrep = std::max (nt, (size_t)1);
+
+		m_x.resize (m_nr); m_y.resize (m_nr); m_z.resize (m_nr);
+		for (size_t i = 0; i < m_nr; ++i) {
+			m_x[i] = k(i,0);
+			m_y[i] = (size(k,1) > 1) ? k(i,1) : 0.;
+			m_z[i] = (size(k,1) > 2) ? k(i,2) : 0.;
+		}
 
-		gsl_rng_env_setup();
-		m_rng = gsl_rng_alloc (gsl_rng_taus2);
-		gsl_rng_set (m_rng, time(0));
+		const uint64_t seed = time(0);
+		for (size_t r = 0; r < m_nrep; ++r)
+			m_rng.push_back (AnnealingRNG (seed + 7919*r));
 
 		Initialise ();
-		m_ct = m_st;
 
-		printf ("Simulated annealing set up\n");
+		printf ("Simulated annealing set up (%zu replicas)\n", m_nrep);
 
 	}
-	
+
 
 	/**
 	 * @brief           Clean up behind us
 	 */
 	~SimulatedAnnealing () {};
-	
+
 
 	/**
 	 * @brief           Cool down
@@ -83,234 +177,271 @@ public:
 
 		printf ("  Cooling down ... \n");
 
-		ticks cgstart = getticks();
-		double len, rndn, dl, prob;
-       	size_t i = 0, j = 0;
-
-		while (i < m_maxit && m_ct > m_ft) {
-
-			
-			// Swap two sites
-			SwapRange (m_sol, m_nsol); 
-			len = Lengthiness (m_k, m_nsol);
-			
-			// Shorter than before: keep
-			if (len <= m_len) {
-				
-				m_sol = m_nsol;
-				m_len = len;
-				
-				if (m_verb) {
-					if (j % 5 == 0 && j > 0)
-						printf ("\n");
-					printf ("    %04zu: %02.4f", i, m_len);
-					j++;
-				}
-
-			} else if (m_accworse) {
-				
-				// accept worse solution with some probability
-				dl   = len - m_len;
-				rndn = gsl_rng_uniform (m_rng);
-				prob = exp (- std::abs(dl) / m_ct);
-				
-				if (prob > rndn) {
-					m_sol = m_nsol;
-					m_len = len;
-					
+		const double t0 = omp_get_wtime ();
+		const size_t nsweeps = std::max ((m_maxit + m_sweep - 1) / m_sweep, (size_t)1);
+		size_t j = 0;
+
+		for (size_t s = 0; s < nsweeps; ++s) {
+
+#pragma omp parallel for schedule (static, 1) if (m_nrep > 1)
+			for (long r = 0; r < (long)m_nrep; ++r)
+				Sweep (r);
+
+			// Renormalise accumulated deltas, remember best
+			for (size_t r = 0; r < m_nrep; ++r) {
+				const double len = Length (m_sol[r]);
+				m_drift  = std::max (m_drift, fabs (len - m_len[r]));
+				m_len[r] = len;
+				if (m_len[r] < m_bestlen) {
+					m_bestlen = m_len[r];
+					m_best    = m_sol[r];
+					m_bestn   = (s+1) * m_sweep;
 					if (m_verb) {
 						if (j % 5 == 0 && j > 0)
 							printf ("\n");
-						printf ("    %04zu: %02.4f", i, m_len);
+						printf ("    %04zu: %02.4f", m_bestn, m_bestlen);
 						j++;
 					}
-					
 				}
-				
-		  	}
-			
-			if (m_bestlen > m_len) {
-				m_best = m_sol;
-				m_bestlen = m_len;
-				m_bestn = i;
 			}
 
-			// decrease temperature
-			m_ct -= m_cr;
-			i++;
-			
-		}
+			if (m_accworse)
+				Exchange (s % 2);
+
+			for (size_t r = 0; r < m_nrep; ++r)
+				m_temp[r] *= m_cr;
 
-		
-		printf ("\n  ... done. Best trip length (" JL_SIZE_T_SPECIFIER "): %.4f, WTime: %.4f seconds.\n\n", 
-				m_bestn, m_bestlen, elapsed(getticks(), cgstart) / Toolbox::Instance()->ClockRate());
+		}
 
+		printf ("\n  ... done. Best trip length (%zu): %.4f, WTime: %.4f seconds.\n\n",
+				m_bestn, m_bestlen, omp_get_wtime() - t0);
 
 	}
 
 
 
 	/**
-	 * @brief           Calculate the trajectory length 
-	 * 
-	 * @param  k        K-space points 
+	 * @brief           Calculate the trajectory length
+	 *
+	 * @param  k        K-space points
 	 * @param  order    Order of positions
 	 * @return          Trajectory length
 	 */
 	double Lengthiness (const Matrix<double>& k, const Matrix<size_t>& order) {
-		
-		double length = 0, x[3], y[3];
-		size_t j, nr = numel(order), nx, ny;
-		
-		// calculate the total length of the traj
-		
-		for (j = 0; j < nr; j++) {
-			
-			nx = order[j];
-			ny = order[(j == nr-1) ? 0 : j + 1];
-			
-			x[0] = k (nx,0);
-			x[1] = k (nx,1);
-			x[2] = k (nx,2);
-			
-			y[0] = k (ny,0);
-			y[1] = k (ny,1);
-			y[2] = k (ny,2);
-			
-			length += sqrt(pow(x[0]-y[0],2) + pow(x[1]-y[1],2) + pow(x[2]-y[2],2));
-			
+
+		double length = 0;
+		size_t nr = numel(order);
+
+		for (size_t j = 0; j < nr; j++) {
+			const size_t nx = order[j], ny = order[(j == nr-1) ? 0 : j + 1];
+			const double dx = k(nx,0)-k(ny,0), dy = k(nx,1)-k(ny,1), dz = k(nx,2)-k(ny,2);
+			length += sqrt(dx*dx + dy*dy + dz*dz);
 		}
-		
-		return length;		
-		
-    }	
-	
-	
+
+		return length;
+
+    }
+
+
+	/**
+	 * @brief           Largest difference of booked and recomputed trip length
+	 *                  over all sweeps so far (i.e. accumulated rounding)
+	 */
+	double Drift () const {
+		return m_drift;
+	}
+
+
+	/**
+	 * @brief           Best order found
+	 */
+	Matrix<size_t> GetOrder () const {
+		Matrix<size_t> order (m_nr,1);
+		std::copy (m_best.begin(), m_best.end(), order.Begin());
+		return order;
+	}
+
 
 	Matrix<double> GetSolution () const {
 
 		Matrix<double> res = zeros<double> (size(m_k));
-		size_t    nr       = numel (m_best);
-		
+		size_t    nr       = m_best.size();
+
 		while (nr--)  {
 			size_t npos = m_best[nr];
-			res (nr,0) = m_k(npos,0);
-			res (nr,1) = m_k(npos,1);
-			res (nr,2) = m_k(npos,2);
+			for (size_t d = 0; d < size(m_k,1); ++d)
+				res (nr,d) = m_k(npos,d);
 		}
-		
+
 		return res;
 
 	}
 
-	
+
 	/**
-	 * @brief        Initialise with random 
+	 * @brief        Initialise with random
 	 */
 	void  Initialise () {
 
 		printf ("  Initialising ...\n");
-		
-		size_t nr = size(m_k,0);
-
-		// create an array to hold initial solution and new solutions
-		m_sol  = Matrix<size_t> (nr,1);
-		m_nsol = Matrix<size_t> (nr,1);
-		
-		// and set it to a random permutation
-		Permute (m_sol);
-		
-       	m_len = Lengthiness (m_k, m_sol);	
-		m_bestlen = m_len;
-		
-		printf ("    Initial lenth: %.2f\n", m_len);
+
+		m_sol.resize (m_nrep);
+		m_len.resize (m_nrep);
+		m_temp.resize (m_nrep);
+
+		const double ft = (m_ft > 0.) ? m_ft : 1.e-3 * m_st;
+		for (size_t r = 0; r < m_nrep; ++r) {
+			Permute (m_sol[r], m_rng[r]);
+			m_len[r]  = Length (m_sol[r]);
+			m_temp[r] = (m_nrep > 1) ? m_st * pow (ft/m_st, (double)r/(m_nrep-1)) : m_st;
+		}
+
+		m_best    = m_sol[0];
+		m_bestlen = m_len[0];
+
+		printf ("    Initial lenth: %.2f\n", m_bestlen);
 		printf ("  ... done\n");
-	} 
+
+	}
 
 
-    /** 
-	 * @brief       Random permutation of order 1..N
+    /**
+	 * @brief       Random permutation of order 0..N-1 with 0 kept in front
 	 */
-    void Permute (Matrix<size_t>& sol) {
-		
-		printf ("    Permuting ..."); fflush (stdout);
-
-		size_t nr = numel (sol);
-		
-		// insert integers 1..N do not touch start / end (k-space center)
-		for (size_t i = 1; i < nr-1; i++)
-			sol[i]  = i+1;
-		
-		// shuffle
-		for (size_t i = 1; i < nr-1; i++) {
-			size_t r    = gsl_rng_uniform_int (m_rng, nr - 1) + 1;     // int between 1 and N
-			size_t swap = sol[r];
-			sol[r]      = sol[i];
-			sol[i]      = swap;
-		}
-      
-		printf (" done\n");
+    void Permute (std::vector<size_t>& sol, AnnealingRNG& rng) const {
+
+		sol.resize (m_nr);
+		for (size_t i = 0; i < m_nr; i++)
+			sol[i] = i;
+
+		// Fisher-Yates, do not touch start (k-space center)
+		for (size_t i = m_nr-1; i > 1; i--)
+			std::swap (sol[i], sol[1 + rng.Int(i)]);
+
     }
 
 
+private:
+
+	inline double Dist (const size_t a, const size_t b) const {
+		const double dx = m_x[a]-m_x[b], dy = m_y[a]-m_y[b], dz = m_z[a]-m_z[b];
+		return sqrt (dx*dx + dy*dy + dz*dz);
+	}
+
+	double Length (const std::vector<size_t>& sol) const {
+		double length = 0.;
+		for (size_t j = 0; j < m_nr; ++j)
+			length += Dist (sol[j], sol[(j+1 == m_nr) ? 0 : j+1]);
+		return length;
+	}
+
+	inline bool Accept (const double dl, const double t, AnnealingRNG& rng) const {
+		return dl <= 0. || (m_accworse && t > 0. && exp (-dl/t) > rng.Uniform());
+	}
+
 	/**
-	 * @brief        Swap a ranges order
+	 * @brief        m_sweep moves of replica r at its temperature
 	 */
-    void SwapRange (const Matrix<size_t>& sol, Matrix<size_t>& nsol) {
-		
-		size_t i, x, y, pos, nr = numel(sol);
-		
-		// copy the current solution
-		nsol = sol;
-		
-		// pick two places do not touch start 
-		x = gsl_rng_uniform_int (m_rng, nr-1) + 1;
-		y = gsl_rng_uniform_int (m_rng, nr-1) + 1;
-	    
-		// Swap
-		if (y < x) {
-			pos = x; x = y;	y = pos;
-		} else if (x == y)
+	void Sweep (const size_t r) {
+
+		std::vector<size_t>& s = m_sol[r];
+		AnnealingRNG& rng = m_rng[r];
+		const double t = m_temp[r];
+		const size_t n = m_nr;
+
+		if (n < 4)
 			return;
-	
-		// Create a temporary array that holds all the values between place1 and place2
-		size_t len = y - x + 1;
-		container<size_t> cut (len);
-
-		i = len;
-		while (i--)
-			nsol[x+len-1-i] = sol[x+i];
-		
-    }
 
+		for (size_t it = 0; it < m_sweep; ++it) {
+
+			if (rng.Uniform() < .5) {
+
+				// 2-opt: reverse s[i..j]
+				size_t i = 1 + rng.Int(n-1), j = 1 + rng.Int(n-1);
+				if (i == j)
+					continue;
+				if (j < i)
+					std::swap (i, j);
+				const size_t a = s[i-1], b = s[(j+1 == n) ? 0 : j+1];
+				const double dl = Dist (a, s[j]) + Dist (s[i], b) - Dist (a, s[i]) - Dist (s[j], b);
+				if (Accept (dl, t, rng)) {
+					std::reverse (s.begin()+i, s.begin()+j+1);
+					m_len[r] += dl;
+				}
 
+			} else {
+
+				// or-opt: move s[i..i+l-1] behind s[p], possibly reversed
+				const size_t l = 1 + rng.Int(3);
+				if (n < l + 3)
+					continue;
+				const size_t i = 1 + rng.Int(n-l), e = i+l-1;
+				size_t p = rng.Int(n-l-1);          // any position outside [i-1,e]
+				if (p >= i-1)
+					p += l+1;
+				const size_t a = s[i-1], b = s[(e+1 == n) ? 0 : e+1],
+					c = s[p], d = s[(p+1 == n) ? 0 : p+1];
+				const bool rev = rng.Uniform() < .5;
+				const size_t f = rev ? s[e] : s[i], g = rev ? s[i] : s[e];
+				const double dl = Dist (a, b) - Dist (a, s[i]) - Dist (s[e], b)
+					+ Dist (c, f) + Dist (g, d) - Dist (c, d);
+				if (Accept (dl, t, rng)) {
+					if (rev)
+						std::reverse (s.begin()+i, s.begin()+e+1);
+					if (p > e)
+						std::rotate (s.begin()+i, s.begin()+e+1, s.begin()+p+1);
+					else
+						std::rotate (s.begin()+p+1, s.begin()+i, s.begin()+e+1);
+					m_len[r] += dl;
+				}
 
+			}
+
+		}
+
+	}
+
+	/**
+	 * @brief        Replica exchange of neighbouring temperatures (even or odd pairs)
+	 */
+	void Exchange (const size_t odd) {
+		for (size_t r = odd; r + 1 < m_nrep; r += 2) {
+			if (m_temp[r] <= 0. || m_temp[r+1] <= 0.)
+				continue;
+			const double x = (1./m_temp[r] - 1./m_temp[r+1]) * (m_len[r] - m_len[r+1]);
+			if (x >= 0. || exp (x) > m_rng[r].Uniform()) {
+				std::swap (m_sol[r], m_sol[r+1]);
+				std::swap (m_len[r], m_len[r+1]);
+			}
+		}
+	}
 
-private: 
-	
 	double         m_cr;      /**< @brief Cooling rate                 */
     double         m_st;      /**< @brief Start temperature            */
     double         m_ft;      /**< @brief Final temperature            */
-    double         m_ct;      /**< @brief Current temperature          */
 
-    double         m_len;     /**< @brief Current fitness              */
-	double         m_bestlen;
+	double         m_bestlen; /**< @brief Best fitness                 */
+	double         m_drift;   /**< @brief Largest booking error        */
 
     size_t         m_maxit;   /**< @brief Maximum number of iterations */
     size_t         m_nr;      /**< @brief Number of sites              */
-	size_t         m_bestn;
+	size_t         m_bestn;   /**< @brief Iteration of best            */
+	size_t         m_nrep;    /**< @brief Replicas                     */
+	size_t         m_sweep;   /**< @brief Moves between exchanges      */
 
-    Matrix<size_t> m_sol;  /**< @brief Solution                     */
-    Matrix<size_t> m_nsol; /**< @brief New solution                 */
-    Matrix<size_t> m_best; /**< @brief Best solution                 */
+	std::vector<std::vector<size_t> > m_sol; /**< @brief Replica solutions */
+	std::vector<double> m_len;  /**< @brief Replica fitness              */
+	std::vector<double> m_temp; /**< @brief Replica temperatures         */
+	std::vector<size_t> m_best; /**< @brief Best solution                */
 
+	std::vector<double> m_x, m_y, m_z; /**< @brief Coordinates           */
 	Matrix<double> m_k;  /**< @brief coordinates                  */
 
     bool           m_verb;  /**< @brief Verbose                      */
 	bool           m_accworse; /**< @brief Randomly accept worse trip */
 
-	gsl_rng* m_rng;
-	
+	std::vector<AnnealingRNG> m_rng; /**< @brief Per replica generators */
+
 };
 
 
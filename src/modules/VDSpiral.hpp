@@ -39,14 +39,18 @@ struct SpiralParams {
 };
 
 
-Solution VDSpiral (SpiralParams& sp) {
-
-	GradientParams gp;
+/**
+ * @brief       Variable density spiral k-space trajectory [1/cm] (n x 3)
+ *
+ * @param  sp   Parameters (fov is replaced by its resampled version)
+ * @return      Trajectory
+ */
+Matrix<double> SpiralTrajectory (SpiralParams& sp) {
 
 	Matrix<double>& fov = sp.fov; 
 	Matrix<double>& rad = sp.rad; 
 	double k_max, fov_max, dr;
-	Matrix<double> r, theta;
+	Matrix<double> r, theta, k;
 	long n = 0;
 
 	assert (numel(rad) >= 2);
@@ -54,7 +58,7 @@ Solution VDSpiral (SpiralParams& sp) {
 	assert (numel(rad) == numel(fov));
 
 	k_max   = 5.0 / sp.res;
-	fov_max = m_max(fov);
+	fov_max = mmax(fov);
 
 	dr  = sp.shots / (fov_max);
 	n   = size(fov,1)*100;
@@ -72,13 +76,29 @@ Solution VDSpiral (SpiralParams& sp) {
 
 	theta = cumsum ((2 * PI * dr / sp.shots) * fov);
 
-	gp.k = Matrix<double> (numel(r), 3);
+	k = Matrix<double> (numel(r), 3);
 
 	for (size_t i = 0; i < numel(r); i++) {
-		gp.k(i,0) = r[i] * cos (theta[i]);
-		gp.k(i,1) = r[i] * sin (theta[i]);
+		k(i,0) = r[i] * cos (theta[i]);
+		k(i,1) = r[i] * sin (theta[i]);
 	}
 
+	return k;
+
+}
+
+
+/**
+ * @brief       Variable density spiral with time optimal gradients
+ *
+ * @param  sp   Parameters
+ * @return      Solution
+ */
+Solution VDSpiral (SpiralParams& sp) {
+
+	GradientParams gp;
+
+	gp.k       = SpiralTrajectory (sp);
 	gp.mgr     = sp.mgr;
 	gp.msr     = sp.msr;
 	gp.dt      = sp.dt;
@@ -91,3 +111,44 @@ Solution VDSpiral (SpiralParams& sp) {
 
 }
 
+
+/**
+ * @brief       Batch of variable density spirals. Trajectories are built in
+ *              parallel, gradients are designed jointly for all spirals
+ *              sharing hardware limits.
+ *
+ * @param  sps  Parameters
+ * @return      Solutions (same order as sps)
+ */
+std::vector<Solution> VDSpirals (std::vector<SpiralParams>& sps) {
+
+	const size_t ns = sps.size();
+	std::vector<Matrix<double> > k (ns);
+	std::vector<Solution> s (ns);
+	std::vector<bool> done (ns, false);
+
+#pragma omp parallel for schedule (dynamic)
+	for (long i = 0; i < (long)ns; ++i)
+		k[i] = SpiralTrajectory (sps[i]);
+
+	for (size_t i = 0; i < ns; ++i) {
+		if (done[i])
+			continue;
+		std::vector<size_t> idx;
+		std::vector<Matrix<double> > kb;
+		for (size_t j = i; j < ns; ++j)
+			if (!done[j] && sps[j].mgr == sps[i].mgr && sps[j].msr == sps[i].msr && sps[j].dt == sps[i].dt) {
+				idx.push_back (j);
+				kb.push_back (std::move (k[j]));
+				done[j] = true;
+			}
+		GradientDesign gd (sps[i].mgr, sps[i].msr, sps[i].dt);
+		std::vector<Solution> sb = gd.Compute (kb);
+		for (size_t j = 0; j < idx.size(); ++j)
+			s[idx[j]] = sb[j];
+	}
+
+	return s;
+
+}
+
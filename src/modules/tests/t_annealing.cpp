@@ -0,0 +1,59 @@
+#include "SimulatedAnnealing.hpp"
+
+#include <vector>
+
+/**
+ * Shuffled points on a circle. Any 2-opt optimum of points in convex position
+ * is the circumference polygon, which greedy descent and tempering must find.
+ * The length changes booked for accepted moves must add up to the trip.
+ */
+static Matrix<double> circle (const size_t n) {
+    Matrix<double> k (n, 3);
+    std::vector<size_t> p (n);
+    for (size_t i = 0; i < n; ++i)
+        p[i] = (i * 37) % n;
+    for (size_t i = 0; i < n; ++i) {
+        k(i,0) = cos (2. * PI * p[i] / n);
+        k(i,1) = sin (2. * PI * p[i] / n);
+        k(i,2) = 0.;
+    }
+    return k;
+}
+
+static bool check (const Matrix<double>& k, const bool accworse, const size_t nrep, const char* what) {
+
+    const size_t n = size(k,0);
+    const double opt = 2. * n * sin (PI / n);
+
+    SimulatedAnnealing sa (k, 400*n, 1., 1.e-3, .95, false, accworse, nrep);
+    sa.Cool ();
+
+    const Matrix<size_t> order = sa.GetOrder ();
+    std::vector<bool> seen (n, false);
+    for (size_t i = 0; i < n; ++i)
+        seen[order[i]] = true;
+    if (order[0] != 0 || std::count (seen.begin(), seen.end(), true) != (long)n) {
+        printf ("  %s: order is no permutation starting at the centre\n", what);
+        return false;
+    }
+
+    const double len = sa.Lengthiness (k, order);
+    printf ("  %s: trip %.6f, optimum %.6f, drift %.3g\n", what, len, opt, sa.Drift());
+    return len < opt * (1. + 1.e-9) && sa.Drift() < 1.e-9;
+
+}
+
+int main (int args, char** argv) {
+
+    const Matrix<double> k = circle (64);
+
+    if (!check (k, false, 1, "greedy"))
+        return 1;
+    if (!check (k, false, 4, "greedy, 4 starts"))
+        return 1;
+    if (!check (k, true, 4, "tempering, 4 replicas"))
+        return 1;
+
+    return 0;
+
+}
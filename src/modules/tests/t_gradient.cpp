@@ -0,0 +1,77 @@
+#include "VDSpiral.hpp"
+
+static SpiralParams spiral (const double shots, const double fovc, const double msr) {
+    SpiralParams sp;
+    sp.shots  = shots;
+    sp.res    = 2.;
+    sp.mgr    = 4.;
+    sp.msr    = msr;
+    sp.dt     = 0.004;
+    sp.gunits = 0;
+    sp.lunits = 0;
+    sp.fov    = Matrix<double> (2,1);
+    sp.rad    = Matrix<double> (2,1);
+    sp.fov[0] = fovc; sp.fov[1] = 12.;
+    sp.rad[0] = 0.;   sp.rad[1] = 1.;
+    return sp;
+}
+
+static double norm2 (const Matrix<double>& m, const size_t i) {
+    return sqrt (m(i,0)*m(i,0) + m(i,1)*m(i,1) + m(i,2)*m(i,2));
+}
+
+/**
+ * Batched design must reproduce the single trajectory design. Gradients stay
+ * within the amplitude limit. The slew rate limit holds up to discretisation
+ * away from the end points, i.e. outside the spiral centre (|k| < kmax/5, see
+ * GradientDesign) and before the last sample.
+ */
+static bool check (const Solution& a, const Solution& b, const SpiralParams& sp, const char* what) {
+
+    const size_t n = size(a.g,0);
+    if (size(b.g,0) != n || size(a.g,1) != size(b.g,1)) {
+        printf ("  %s: %zu samples batched, %zu single\n", what, size(b.g,0), n);
+        return false;
+    }
+
+    double dg = 0., gmax = 0., smax = 0., kmax = 0.;
+    for (size_t i = 0; i < numel(a.g); ++i)
+        dg = std::max (dg, fabs (a.g[i] - b.g[i]));
+    for (size_t i = 0; i < n; ++i) {
+        gmax = std::max (gmax, norm2 (b.g, i));
+        kmax = std::max (kmax, norm2 (b.k, i));
+    }
+    for (size_t i = 0; i + 2 < n; ++i)
+        if (norm2 (b.k, i) >= .2 * kmax)
+            smax = std::max (smax, norm2 (b.s, i));
+
+    printf ("  %s: %zu samples, |g_b - g_s| %.3g, max |g| %.4f (%.1f), max |s| %.4f (%.1f)\n",
+            what, n, dg, gmax, sp.mgr, smax, sp.msr);
+
+    return dg < 1.e-9 * sp.mgr && gmax <= sp.mgr * (1. + 1.e-9) && smax <= 1.02 * sp.msr;
+
+}
+
+int main (int args, char** argv) {
+
+    std::vector<SpiralParams> sps;
+    sps.push_back (spiral (8., 24., 15.));
+    sps.push_back (spiral (16., 20., 15.));
+    sps.push_back (spiral (8., 24., 12.));
+    sps.push_back (spiral (4., 30., 15.));
+
+    std::vector<SpiralParams> batch = sps;
+    const std::vector<Solution> sb = VDSpirals (batch);
+
+    int ret = 0;
+    for (size_t i = 0; i < sps.size(); ++i) {
+        SpiralParams sp = sps[i];
+        const Solution ss = VDSpiral (sp);
+        if (!check (ss, sb[i], sps[i], "spiral"))
+            ret = 1;
+    }
+
+    printf (ret ? "failed\n" : "passed\n");
+    return ret;
+
+}
@@ -0,0 +1,65 @@
+#include "STA.hpp"
+#include "Creators.hpp"
+
+static cxdb dot (const Matrix<cxfl>& a, const Matrix<cxfl>& b) {
+    cxdb d (0.);
+    for (size_t i = 0; i < numel(a); ++i)
+        d += cxdb (std::conj (a[i])) * cxdb (b[i]);
+    return d;
+}
+
+static double rel (const Matrix<cxfl>& a, const Matrix<cxfl>& b) {
+    double num = 0., den = 0.;
+    for (size_t i = 0; i < numel(a); ++i) {
+        num += std::norm (cxdb (a[i]) - cxdb (b[i]));
+        den += std::norm (cxdb (b[i]));
+    }
+    return sqrt (num / den);
+}
+
+/**
+ * Matrix-free forward and adjoint against the dense matrix, the tiled Gram
+ * matrix against M^H M, and <Mx,y> = <x,M^H y>. The number of positions is
+ * no multiple of the tile to exercise the last, partial tile.
+ */
+int main (int args, char** argv) {
+
+    const size_t ns = 1000, nk = 5, nc = 4;
+
+    Matrix<float> r (3, ns), ks (3, nk), b0 (ns, 1), pd (nk, 1);
+    Matrix<cxfl>  b1 (ns, nc), x (nc*nk, 1), y (ns, 1);
+
+    for (size_t s = 0; s < ns; ++s) {
+        r(0,s) = .2 * cos (.37 * s);
+        r(1,s) = .2 * sin (.11 * s);
+        r(2,s) = .1 * cos (.05 * s);
+        b0[s]  = 50. * sin (.013 * s);
+        y[s]   = cxfl (cos (.7 * s), sin (.3 * s));
+        for (size_t c = 0; c < nc; ++c)
+            b1(s,c) = std::polar (1.e-6f * (1.f + .5f * c), (float) (.01 * s * (c+1)));
+    }
+    for (size_t k = 0; k < nk; ++k) {
+        ks(0,k) = 30. * k; ks(1,k) = -20. * k; ks(2,k) = 5. * k;
+        pd[k] = 20.;
+        for (size_t c = 0; c < nc; ++c)
+            x[c*nk+k] = cxfl (1. + c, .5 * k);
+    }
+
+    const STA dense (ks, r, b1, b0, 10, pd, true), free (ks, r, b1, b0, 10, pd, false, 96);
+    const Matrix<cxfl> m = dense.Build ();
+
+    const double ef = rel (free * x, gemm (m, x)), ea = rel (free / y, gemm (m, y, 'C')),
+        eg = rel (free.Gram(), dense.Gram());
+    const cxdb lhs = dot (free * x, y), rhs = dot (x, free / y);
+    const double ead = std::abs (lhs - rhs) / std::abs (lhs);
+
+    printf ("  forward: %.3g, adjoint: %.3g, gram: %.3g, <Mx,y>-<x,M^H y>: %.3g\n", ef, ea, eg, ead);
+
+    if (ef > 1.e-5 || ea > 1.e-5 || eg > 1.e-5 || ead > 1.e-5) {
+        printf ("failed\n");
+        return 1;
+    }
+    printf ("passed\n");
+    return 0;
+
+}
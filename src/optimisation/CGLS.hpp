@@ -28,25 +28,41 @@ public:
   virtual ~CGLS () {}
 
   inline virtual Matrix<T> Solve (const Operator<T>& A, const MatrixType<T>& x) {
-    _p = A/x;
+    return Solve (A, x, Matrix<T>());
+  }
+
+  /**
+   * @brief       Solve (A^H A + lambda I + diag(w)) x = A^H b
+   *
+   * @param  A    Operator
+   * @param  b    Right hand side
+   * @param  x0   Initial guess (warm start, ignored if empty)
+   * @return      Solution
+   */
+  inline Matrix<T> Solve (const Operator<T>& A, const MatrixType<T>& b, const Matrix<T>& x0) {
+    _p = A/b;
     if (_maxit == 0)
       return _p;
     _r  = _p;
     _rn = _xn = std::real(dotc(_r,_p));
     Matrix<T> ret;
+    if (x0.Size() == _p.Size()) {
+      ret = x0;
+      _r -= Normal (A, ret);
+      _rn = std::real(dotc(_r,_r));
+      _p  = _r;
+    } else
+      ret = zeros<T>(size(_p));
+    _res.clear();
     for (size_t i = 0; i < _maxit; i++) {
       _res.push_back(_rn/_xn);
-      if (i==0)
-        ret = zeros<T>(size(_p));
       if (boost::math::isnan(_res[i]) || _res[i] <= _epsilon) {
         printf ("    %03zu %.7f\n", i, _res[i]);
         break;
       }
       if (_verbosity)
         printf ("    %03zu %.7f\n", i, _res[i]);
-      _q  = A/(A*_p);
-      if (_lambda)
-        _q += _lambda * _p;
+      _q   = Normal (A, _p);
       _ts  = _rn / std::real(dotc(_p,_q));
       ret += _ts * _p;
       _r  -= _ts * _q;
@@ -57,12 +73,39 @@ public:
     }
     return ret;// * m_ic;
   }
+
+  /**
+   * @brief       Diagonal regularisation weights added to lambda,
+   *              e.g. SAR/power per unknown. Empty matrix resets.
+   */
+  inline void Weights (const Matrix<RT>& w) {
+    _w = w;
+  }
+
+  /**
+   * @brief       Relative residuals of last solve
+   */
+  inline const Vector<RT>& Residuals () const {
+    return _res;
+  }
   
 protected:
+
+  inline Matrix<T> Normal (const Operator<T>& A, const Matrix<T>& p) const {
+    Matrix<T> q = A/(A*p);
+    if (_lambda)
+      q += _lambda * p;
+    if (_w.Size() == p.Size())
+      for (size_t i = 0; i < p.Size(); ++i)
+        q[i] += _w[i] * p[i];
+    return q;
+  }
+
   size_t _nrows, _ncols, _maxit;
   RT _epsilon, _rel_mat_err, _rel_rhs_err, _lambda, _ts;
   RT _rn, _xn, _rno;
   Matrix<T> _p, _r, _q;
+  Matrix<RT> _w;
   Vector<Matrix<cxfl> > vc;
   Vector<RT> _res;
   int _verbosity;
@@ -10,85 +10,294 @@
 
 #include <NonLinear.hpp>
 
-#define LBFGS_FLOAT 32
-#include "lbfgs.h"
-
+#include <algorithm>
+#include <limits>
 
 namespace codeare {
     namespace optimisation {
-        
+
+/**
+ * @brief   Limited memory BFGS (Nocedal 1980) and, for orthantwise_c > 0,
+ *          OWL-QN (Andrew & Gao 2007) for f(x) + c |x|_1.<br/>
+ *
+ *          Works in place on the storage of x. Complex unknowns are treated as
+ *          pairs of reals, i.e. inner products are Re(x^H y). The history of
+ *          the last m steps lives in two preallocated n x m matrices used as
+ *          ring buffers, the two-loop recursion runs on fused axpy/dot sweeps.
+ *          All state is held by the instance. The line search backtracks along
+ *          the direction passed to Operator::Update, like NLCG.<br/>
+ *
+ *          Parameters: nliter, lsiter, lbfgs_m (history), lbfgs_eps (|g| over
+ *          max(|x|,1)), orthantwise_c, verbose (progress per iteration) and,
+ *          as for NLCG, lsa (Armijo factor) and lsb (backtracking factor),
+ *          both in (0,1). Note that the former liblbfgs wrapper passed lsa and
+ *          lsb as minimum and maximum step; such values are out of range and
+ *          replaced by the defaults with a warning.
+ */
 template<class T>
 class LBFGS : public NonLinear<T> {
 
     typedef typename TypeTraits<T>::RT RT;
-    
+
 public:
-    LBFGS () {
-        lbfgs_parameter_init(&_p);
-    }
+    LBFGS () : _nliter(100), _lsiter(20), _m(6), _lsa(1.0e-4), _lsb(0.5), _eps(1.0e-5), _c(0),
+               _verbose(0) {}
 	LBFGS (const Params& p) : NonLinear<T>::NonLinear(p)  {
-        lbfgs_parameter_init(&_p);
-        _p.max_iterations = try_to_fetch<int> (p, "nliter", 0);
-        _p.min_step = try_to_fetch<float> (p, "lsa", 0);
-        _p.max_step = try_to_fetch<float> (p, "lsb", 0);
+        _nliter = try_to_fetch<int> (p, "nliter", 0);
+        _lsiter = try_to_fetch<int> (p, "lsiter", 20);
+        _m      = try_to_fetch<int> (p, "lbfgs_m", 6);
+        _lsa    = try_to_fetch<float> (p, "lsa", 0.0f);
+        _lsb    = try_to_fetch<float> (p, "lsb", 0.0f);
+        _eps    = try_to_fetch<float> (p, "lbfgs_eps", 1.0e-5f);
+        _c      = try_to_fetch<float> (p, "orthantwise_c", 0.0f);
+        _verbose = try_to_fetch<int> (p, "verbose", 0);
+        if (_nliter == 0) _nliter = 100;
+        if (_lsiter == 0) _lsiter = 20;
+        if (_m == 0)      _m      = 6;
+        if (_lsa <= 0 || _lsa >= 1) {
+            if (_lsa != 0)
+                printf ("**WARNING**: lsa (Armijo factor) %g not in (0,1), using 1e-4\n", (double)_lsa);
+            _lsa = 1.0e-4;
+        }
+        if (_lsb <= 0 || _lsb >= 1) {
+            if (_lsb != 0)
+                printf ("**WARNING**: lsb (backtracking factor) %g not in (0,1), using 0.5\n", (double)_lsb);
+            _lsb = 0.5;
+        }
     }
-    LBFGS (const LBFGS& tocopy) {};
     virtual ~LBFGS () {}
 
-    inline static int progress(void *instance, const lbfgsfloatval_t *x, const lbfgsfloatval_t *g,
-        const lbfgsfloatval_t fx, const lbfgsfloatval_t xnorm, const lbfgsfloatval_t gnorm,
-        const lbfgsfloatval_t step, int n, int k, int ls) {
-        printf("    %2d: fx = %f, x[0] = %f, x[1] = %f\n", k, fx, x[0], x[1]);
-        printf("        xnorm = %f, gnorm = %f, step = %f\n", xnorm, gnorm, step);
-        return 0;
-    }
-
-    inline static lbfgsfloatval_t evaluate (void* instance, const lbfgsfloatval_t *x, lbfgsfloatval_t *g,
-            const int n, const lbfgsfloatval_t step) {
-        std::copy (x, x+n, (lbfgsfloatval_t*)&_x[0]);
-        _g = _A->df (_x);
-        (_A)->Update(_g);
-        std::copy ((lbfgsfloatval_t*)&_g[0], (lbfgsfloatval_t*)&_g[0]+n, &g[0]);
-        T t = abs(_A->obj(_x, _g, step, _rmse)) / (lbfgsfloatval_t)(n*n/4) ;
-        lbfgsfloatval_t ret = (lbfgsfloatval_t) std::real(t) ;
-        return ret;
-    }
-    
     inline virtual void Minimise (Operator<T>* A, Matrix<T>& x) {
-        _A = A;
-        _x = x;
-        _g = x;
-        lbfgsfloatval_t fx = 0;
-        int ret = lbfgs(2*x.Size(), (lbfgsfloatval_t*)&x[0], &fx, evaluate, progress, NULL, &_p);
+
+        const size_t n = x.Size() * sizeof(T) / sizeof(RT);
+        const bool owl = (_c > 0);
+        RT rmse = 0, f0 = 0, f1 = 0, t = 1;
+        size_t nh = 0, head = 0, k = 0, li = 0;
+
+        Allocate (x, n);
+        RT *xr = (RT*)x.Ptr(), *gr = (RT*)_g.Ptr(), *dr = (RT*)_d.Ptr(),
+           *xp = (RT*)_xp.Ptr(), *gp = (RT*)_gp.Ptr(), *pg = owl ? (RT*)_pg.Ptr() : gr;
+
+        _g = A->df (x);
+        gr = (RT*)_g.Ptr();
+        if (!owl) pg = gr;
+
+        for (k = 0; k < _nliter; ++k) {
+
+            if (owl)
+                PseudoGradient (xr, gr, pg, n);
+
+            const RT gn = std::sqrt (dot (pg, pg, n)), xn = std::sqrt (dot (xr, xr, n));
+            if (gn <= _eps * std::max (xn, (RT)1)) {
+                printf ("    %02zu - converged, |g|/|x|: %1.4e\n", k, gn / std::max (xn, (RT)1));
+                break;
+            }
+
+            // d = -H pg
+            if (nh == 0) {
+                for (size_t i = 0; i < n; ++i)
+                    dr[i] = -pg[i] / gn;
+            } else
+                Direction (pg, dr, n, nh, head);
+
+            if (owl)                                   // Stay in the orthant of steepest descent
+                for (size_t i = 0; i < n; ++i)
+                    if (dr[i] * pg[i] >= 0)
+                        dr[i] = 0;
+
+            RT dg = dot (dr, pg, n);
+            if (dg >= 0) {                             // Not a descent direction: restart
+                for (size_t i = 0; i < n; ++i)
+                    dr[i] = -pg[i] / gn;
+                dg = -gn;
+                nh = 0;
+            }
+
+            std::copy (xr, xr + n, xp);
+            std::copy (gr, gr + n, gp);
+
+            // Backtracking line search
+            A->Update (_d);
+            f0 = A->obj (x, _d, 0, rmse);
+            if (owl)
+                f0 += _c * L1 (xr, n);
+            t  = 1;
+            for (li = 0; li < _lsiter; ++li, t *= _lsb) {
+                if (!owl) {
+                    f1 = A->obj (x, _d, t, rmse);
+                    if (f1 <= f0 + _lsa * t * dg)
+                        break;
+                } else {
+                    Project (xp, dr, t, xr, n);       // Candidate straight into x
+                    for (size_t i = 0; i < n; ++i)
+                        ((RT*)_dx.Ptr())[i] = xr[i] - xp[i];
+                    A->Update (_dx);
+                    f1 = A->obj (_xp, _dx, 1, rmse) + _c * L1 (xr, n);
+                    if (f1 <= f0 + _lsa * dot ((RT*)_dx.Ptr(), pg, n))
+                        break;
+                }
+            }
+            if (_verbose) {
+                printf ("    %02zu - nrms: %1.4e, l-search: %zu, f: %1.4e\n", k, rmse, li, f1);
+                fflush (stdout);
+            }
+            if (li == _lsiter) {
+                std::copy (xp, xp + n, xr);
+                printf ("Reached max line search, exiting... \n");
+                return;
+            }
+            if (!owl)
+                axpy (t, dr, xr, n);
+
+            // New gradient, update history
+            _g  = A->df (x);
+            gr  = (RT*)_g.Ptr();
+            if (!owl) pg = gr;
+            RT *s = (RT*)_s.Ptr() + head*n, *y = (RT*)_y.Ptr() + head*n;
+            for (size_t i = 0; i < n; ++i) {
+                s[i] = xr[i] - xp[i];
+                y[i] = gr[i] - gp[i];
+            }
+            const RT ys = dot (y, s, n);
+            if (ys > std::numeric_limits<RT>::epsilon() * dot (y, y, n)) {
+                _rho[head] = 1 / ys;
+                head = (head + 1) % _m;
+                nh = std::min (nh + 1, _m);
+            }
+
+        }
+
     }
+
     virtual std::ostream& Print(std::ostream& os) const {
         NonLinear<T>::Print(os);
-        os << "    m(" << _p.m << ") epsilon(" << _p.epsilon << ") past(" << _p.past << ") delta("
-           << _p.delta << ")" << std::endl;
-        os << "    max_iterations(" << _p.max_iterations << ") linesearch(" << _p.linesearch
-           << ") max_linesearch(" << _p.max_linesearch << ")" << std::endl;
-        os << "    min_step(" << _p.min_step << ") max_step(" << _p.max_step << ")" << std::endl;
-        os << "    ftol(" << _p.ftol << ") wolfe(" << _p.wolfe << ") gtol(" << _p.gtol
-           << ") xtol(" << _p.xtol << ")" << std::endl;
-        os << "    orthantwise_c(" << _p.orthantwise_c << ") orthantwise_start("
-           << _p.orthantwise_start << ") orthantwise_end(" << _p.orthantwise_end << ")" << std::endl;
+        os << "    m(" << _m << ") epsilon(" << _eps << ") max_iterations(" << _nliter << ")" << std::endl;
+        os << "    max_linesearch(" << _lsiter << ") lsa(" << _lsa << ") lsb(" << _lsb << ")" << std::endl;
+        os << "    orthantwise_c(" << _c << ") verbose(" << _verbose << ")" << std::endl;
         return os;
     }
 
-    lbfgs_parameter_t _p;
-    static Matrix<T> _x;
-    static Matrix<T> _g;
-    static RT _rmse;
-    static Operator<T>* _A;
+private:
+
+    /**
+     * @brief  Size work space and history once for the problem at hand
+     */
+    inline void Allocate (const Matrix<T>& x, const size_t n) {
+        if (_s.Size() != n*_m) {
+            _s   = Matrix<RT> (n, _m);
+            _y   = Matrix<RT> (n, _m);
+            _rho = Vector<RT> (_m);
+            _alpha = Vector<RT> (_m);
+        }
+        if (_d.Size() != x.Size()) {
+            _d  = Matrix<T> (size(x));
+            _dx = Matrix<T> (size(x));
+            _xp = Matrix<T> (size(x));
+            _gp = Matrix<T> (size(x));
+            _pg = Matrix<T> (size(x));
+        }
+    }
+
+    /**
+     * @brief  Two-loop recursion d = -H q on the ring buffer
+     */
+    inline void Direction (const RT* q, RT* d, const size_t n, const size_t nh, const size_t head) {
+        const RT *s = (const RT*)_s.Ptr(), *y = (const RT*)_y.Ptr();
+        const size_t last = (head + _m - 1) % _m;
+        for (size_t i = 0; i < n; ++i)
+            d[i] = -q[i];
+        size_t j = last;
+        RT sd = dot (s + j*n, d, n);
+        for (size_t i = 0; i < nh; ++i) {           // Newest to oldest
+            _alpha[j] = _rho[j] * sd;
+            const size_t jn = (j + _m - 1) % _m;
+            sd = axpy_dot (-_alpha[j], y + j*n, d, s + jn*n, n);
+            j = jn;
+        }
+        const RT gamma = 1 / (_rho[last] * dot (y + last*n, y + last*n, n));
+        j = (head + _m - nh) % _m;
+        RT yd = gamma * dot (y + j*n, d, n);
+        for (size_t i = 0; i < n; ++i)
+            d[i] *= gamma;
+        for (size_t i = 0; i < nh; ++i) {           // Oldest to newest
+            const size_t jn = (j + 1) % _m;
+            yd = axpy_dot (_alpha[j] - _rho[j] * yd, s + j*n, d, y + jn*n, n);
+            j = jn;
+        }
+    }
+
+    /**
+     * @brief  Pseudo-gradient of f + c|x|_1
+     */
+    inline void PseudoGradient (const RT* x, const RT* g, RT* pg, const size_t n) const {
+        for (size_t i = 0; i < n; ++i)
+            if (x[i] < 0)
+                pg[i] = g[i] - _c;
+            else if (x[i] > 0)
+                pg[i] = g[i] + _c;
+            else if (g[i] + _c < 0)
+                pg[i] = g[i] + _c;
+            else if (g[i] - _c > 0)
+                pg[i] = g[i] - _c;
+            else
+                pg[i] = 0;
+    }
+
+    /**
+     * @brief  x = x0 + t d, zeroing elements that leave the orthant of x0
+     *         (or of -pg where x0 is 0, which d already respects)
+     */
+    inline static void Project (const RT* x0, const RT* d, const RT t, RT* x, const size_t n) {
+        for (size_t i = 0; i < n; ++i) {
+            const RT xi = x0[i] + t * d[i];
+            const RT o  = (x0[i] != 0) ? x0[i] : d[i];
+            x[i] = (xi * o > 0) ? xi : 0;
+        }
+    }
+
+    inline static RT L1 (const RT* x, const size_t n) {
+        RT r = 0;
+#pragma omp parallel for simd reduction (+:r) if (n > 65536)
+        for (long i = 0; i < (long)n; ++i)
+            r += std::abs (x[i]);
+        return r;
+    }
+
+    inline static RT dot (const RT* a, const RT* b, const size_t n) {
+        RT r = 0;
+#pragma omp parallel for simd reduction (+:r) if (n > 65536)
+        for (long i = 0; i < (long)n; ++i)
+            r += a[i] * b[i];
+        return r;
+    }
+
+    inline static void axpy (const RT a, const RT* x, RT* y, const size_t n) {
+#pragma omp parallel for simd if (n > 65536)
+        for (long i = 0; i < (long)n; ++i)
+            y[i] += a * x[i];
+    }
+
+    /**
+     * @brief  y += a x, returns z.y in the same sweep
+     */
+    inline static RT axpy_dot (const RT a, const RT* x, RT* y, const RT* z, const size_t n) {
+        RT r = 0;
+#pragma omp parallel for simd reduction (+:r) if (n > 65536)
+        for (long i = 0; i < (long)n; ++i) {
+            y[i] += a * x[i];
+            r += z[i] * y[i];
+        }
+        return r;
+    }
+
+    size_t _nliter, _lsiter, _m;
+    RT _lsa, _lsb, _eps, _c;
+    int _verbose;
+    Matrix<RT> _s, _y;                        /**< @brief History ring buffers (n x m) */
+    Vector<RT> _rho, _alpha;
+    Matrix<T> _g, _d, _dx, _xp, _gp, _pg;
 };
 
-        template<class T> Operator<T>* LBFGS<T>::_A = 0;
-        template<class T> Matrix<T> LBFGS<T>::_x = Matrix<T>();
-        template<class T> Matrix<T> LBFGS<T>::_g = Matrix<T>();
-        template<class T> typename LBFGS<T>::RT LBFGS<T>::_rmse = 0;
-        
-        
     }}
 
 #endif // _LBFGS_HPP_
-
@@ -1 +0,0 @@
-#include <lbfgs.h>
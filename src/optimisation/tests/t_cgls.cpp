@@ -0,0 +1,75 @@
+#include "CGLS.hpp"
+#include "Creators.hpp"
+
+using namespace codeare::optimisation;
+
+template<class T> class Dense : public Operator<T> {
+public:
+    Dense (const Matrix<T>& a) : m_a(a) {}
+    virtual Matrix<T> operator* (const MatrixType<T>& x) const {
+        return gemm (m_a, static_cast<const Matrix<T>&>(x));
+    }
+    virtual Matrix<T> operator/ (const MatrixType<T>& y) const {
+        return gemm (m_a, static_cast<const Matrix<T>&>(y), 'C');
+    }
+private:
+    Matrix<T> m_a;
+};
+
+template<class T> static double rel (const Matrix<T>& a, const Matrix<T>& b) {
+    double num = 0., den = 0.;
+    for (size_t i = 0; i < numel(a); ++i) {
+        num += std::norm (a[i] - b[i]);
+        den += std::norm (b[i]);
+    }
+    return sqrt (num / den);
+}
+
+/**
+ * Warm started, weighted CGLS against (A^H A + lambda I + diag(w))^-1 A^H b
+ */
+template<class T> static int check (const char* what) {
+
+    typedef typename TypeTraits<T>::RT RT;
+    const size_t m = 60, n = 16;
+    const RT lambda = 1.e-2;
+
+    Matrix<T> a (m, n), b (m, 1), x0 (n, 1);
+    Matrix<RT> w (n, 1);
+    for (size_t j = 0; j < n; ++j) {
+        for (size_t i = 0; i < m; ++i)
+            a(i,j) = T(cos (.3*i*(j+1) + .1*j)) + RT(.1)*(i==j);
+        w[j]  = .05 * (j % 4);
+        x0[j] = T(sin (1.*j));
+    }
+    for (size_t i = 0; i < m; ++i)
+        b[i] = T(sin (.2*i) + .3);
+
+    Matrix<T> n2 = gemm (a, a, 'C');
+    for (size_t j = 0; j < n; ++j)
+        n2(j,j) += lambda + w[j];
+    const Matrix<T> xs = gemm (inv (n2), gemm (a, b, 'C'));
+
+    const Dense<T> op (a);
+    CGLS<T> cgls (100, 1.e-20, lambda);
+    cgls.Weights (w);
+
+    const double cold = rel (cgls.Solve (op, b, Matrix<T>()), xs);
+    const size_t ncold = cgls.Residuals().size();
+    const double warm = rel (cgls.Solve (op, b, x0), xs);
+    const double exact = rel (cgls.Solve (op, b, xs), xs);
+    const size_t nexact = cgls.Residuals().size();
+
+    printf ("  %s: cold %.3g (%zu its), warm %.3g, warm at solution %.3g (%zu its)\n",
+            what, cold, ncold, warm, exact, nexact);
+    return (cold < 1.e-8 && warm < 1.e-8 && exact < 1.e-12 && nexact == 1) ? 0 : 1;
+
+}
+
+int main (int args, char** argv) {
+
+    int ret = check<double> ("double") + check<cxdb> ("complex double");
+    printf (ret ? "failed\n" : "passed\n");
+    return ret;
+
+}
@@ -0,0 +1,88 @@
+#include "LBFGS.hpp"
+#include "Creators.hpp"
+
+using namespace codeare::optimisation;
+
+/**
+ * f(x) = |Ax - b|^2, obj() evaluates f(x + t dx) like the CS operators
+ */
+class LeastSquares : public Operator<double> {
+public:
+    LeastSquares (const Matrix<double>& a, const Matrix<double>& b) : m_a(a), m_b(b) {}
+    virtual double obj (const Matrix<double>& x, const Matrix<double>& dx, const double& t,
+                        double& rmse) const {
+        const Matrix<double> r = gemm (m_a, Matrix<double>(x + t * dx)) - m_b;
+        rmse = sqrt (real (r.dotc (r)) / numel(r));
+        return real (r.dotc (r));
+    }
+    virtual Matrix<double> df (const Matrix<double>& x) {
+        return 2. * gemm (m_a, Matrix<double>(gemm (m_a, x) - m_b), 'T');
+    }
+private:
+    Matrix<double> m_a, m_b;
+};
+
+static Params params (const float c) {
+    Params p;
+    p["nliter"]        = 500;
+    p["lsiter"]        = 40;
+    p["lbfgs_m"]       = 6;
+    p["lsa"]           = 1.0e-4f;
+    p["lsb"]           = 0.5f;
+    p["lbfgs_eps"]     = 1.0e-7f;
+    p["orthantwise_c"] = c;
+    p["verbose"]       = 0;
+    return p;
+}
+
+int main (int args, char** argv) {
+
+    const size_t m = 80, n = 30;
+    Matrix<double> a (m, n), b (m, 1);
+    for (size_t j = 0; j < n; ++j)
+        for (size_t i = 0; i < m; ++i)
+            a(i,j) = cos (.17*i*(j+1) + .3*j) + .5*(i==j);
+    for (size_t i = 0; i < m; ++i)
+        b[i] = sin (.25*i) + .1*i/m;
+
+    int ret = 0;
+
+    // Least squares: gradient vanishes at the minimum
+    {
+        LeastSquares f (a, b);
+        LBFGS<double> lbfgs (params (0.f));
+        Matrix<double> x (n, 1);
+        lbfgs.Minimise (&f, x);
+        const Matrix<double> g = f.df (x);
+        const double gn = norm (g) / norm (f.df (Matrix<double>(n, 1)));
+        printf ("  least squares: |g|/|g0| %.3g\n", gn);
+        if (gn > 1.e-5)
+            ret = 1;
+    }
+
+    // Lasso (OWL-QN): g_i = -c sign(x_i) where x_i != 0, |g_i| <= c elsewhere
+    {
+        const float c = .5f;
+        LeastSquares f (a, b);
+        LBFGS<double> lbfgs (params (c));
+        Matrix<double> x (n, 1);
+        lbfgs.Minimise (&f, x);
+        const Matrix<double> g = f.df (x);
+        double kkt = 0.;
+        size_t nz = 0;
+        for (size_t i = 0; i < n; ++i)
+            if (x[i] != 0.)
+                kkt = std::max (kkt, fabs (g[i] + c * ((x[i] > 0.) ? 1. : -1.)));
+            else {
+                kkt = std::max (kkt, std::max (fabs (g[i]) - c, 0.));
+                ++nz;
+            }
+        printf ("  lasso: KKT violation %.3g, %zu of %zu zero\n", kkt / c, nz, n);
+        if (kkt > 1.e-4 * c || nz == 0 || nz == n)
+            ret = 1;
+    }
+
+    printf (ret ? "failed\n" : "passed\n");
+    return ret;
+
+}